@@ -18,16 +18,22 @@
 #include <pybind11/stl.h>
 
 #include <algorithm>
+#include <fstream>
+#include <iterator>
 #include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "init.h"
+#include "async_logger.h"
 #include "index.h"
+#include "index_bundle.h"
 #include "knnquery.h"
 #include "knnqueue.h"
+#include "rangequery.h"
 #include "methodfactory.h"
 #include "space.h"
 #include "space/space_vector.h"
@@ -41,6 +47,9 @@ namespace py = pybind11;
 namespace similarity {
 const char * module_name = "nmslib";
 
+// Converting fewer rows per thread doesn't pay off the cost of starting threads
+const size_t MIN_CSR_ROWS_PER_THREAD = 1024;
+
 enum DistType {
   DISTTYPE_FLOAT,
   DISTTYPE_DOUBLE,
@@ -69,9 +78,10 @@ struct IndexWrapper {
         py::object space_params,
         DataType data_type,
         DistType dist_type)
-      : method(method), space_type(space_type), data_type(data_type), dist_type(dist_type),
+      : method(method), space_type(space_type), space_params(loadParams(space_params)),
+        data_type(data_type), dist_type(dist_type),
         space(SpaceFactoryRegistry<dist_t>::Instance().CreateSpace(space_type,
-                                                                   loadParams(space_params))) {
+                                                                   this->space_params)) {
     auto vectSpacePtr = dynamic_cast<VectorSpace<dist_t>*>(space.get());
     if (data_type == DATATYPE_DENSE_VECTOR && vectSpacePtr == nullptr) {
       throw std::invalid_argument("The space type " + space_type + 
@@ -86,6 +96,8 @@ struct IndexWrapper {
 
   void createIndex(py::object index_params, bool print_progress = false) {
     AnyParams params = loadParams(index_params);
+    bundle_location.clear();
+    query_time_params = AnyParams();
 
     py::gil_scoped_release l;
     auto factory = MethodFactoryRegistry<dist_t>::Instance();
@@ -93,23 +105,53 @@ struct IndexWrapper {
     index->CreateIndex(params);
   }
 
-  void loadIndex(const std::string & filename, bool print_progress = false) {
+  void loadIndex(const std::string & filename, bool print_progress = false, bool load_data = false) {
     py::gil_scoped_release l;
-    auto factory = MethodFactoryRegistry<dist_t>::Instance();
-    index.reset(factory.CreateMethod(print_progress, method, space_type, *space, data));
-    index->LoadIndex(filename);
+    if (load_data) {
+      // data points are memory mapped from the bundle and replace the current ones
+      std::unique_ptr<IndexBundle> new_bundle(new IndexBundle(filename));
+      if (new_bundle->GetSpaceType() != space_type || new_bundle->GetMethodName() != method) {
+        throw std::invalid_argument("The index in " + filename + " was created for the method " +
+                                    new_bundle->GetMethodName() + " and the space " +
+                                    new_bundle->GetSpaceType());
+      }
+      index.reset();
+      freeObjectVector(&data);
+      data.clear();
+      std::vector<std::string> externIds;
+      new_bundle->ReadData(data, externIds);
+      bundle = std::move(new_bundle);
+      index.reset(bundle->LoadIndex(print_progress, *space, data));
+      bundle_location = filename;
+    } else {
+      auto factory = MethodFactoryRegistry<dist_t>::Instance();
+      index.reset(factory.CreateMethod(print_progress, method, space_type, *space, data));
+      index->LoadIndex(filename);
+    }
 
     // querying reloaded indices don't seem to work correctly (at least hnsw ones) until
     // SetQueryTimeParams is called
     index->ResetQueryTimeParams();
+    query_time_params = AnyParams();
   }
 
-  void saveIndex(const std::string & filename) {
+  void setQueryTimeParams(py::object params) {
+    AnyParams new_params = loadParams(params);
+    index->SetQueryTimeParams(new_params);
+    query_time_params = new_params;
+  }
+
+  void saveIndex(const std::string & filename, bool save_data = false) {
     if (!index) {
       throw std::invalid_argument("Must call createIndex or loadIndex before this method");
     }
     py::gil_scoped_release l;
-    index->SaveIndex(filename);
+    if (save_data) {
+      IndexBundle::Save(filename, space_type, space_params, method, data,
+                        std::vector<std::string>(data.size()), *index);
+    } else {
+      index->SaveIndex(filename);
+    }
   }
 
   py::object knnQuery(py::object input, size_t k) {
@@ -127,13 +169,35 @@ struct IndexWrapper {
     return convertResult(res.get());
   }
 
+  py::object knnQueryWithStat(py::object input, size_t k) {
+    if (!index) {
+      throw std::invalid_argument("Must call createIndex or loadIndex before this method");
+    }
+
+    std::unique_ptr<const Object> query(readObject(input));
+    KNNQuery<dist_t> knn(*space, query.get(), k);
+    {
+      py::gil_scoped_release l;
+      index->Search(&knn, -1);
+    }
+    std::unique_ptr<KNNQueue<dist_t>> res(knn.Result()->Clone());
+    py::tuple ret = convertResult(res.get());
+
+    py::dict stat;
+    stat["dist_comp"] = knn.DistanceComputations();
+    for (const auto& e : knn.GetSearchStat().GetNamedValues()) {
+      stat[py::str(e.first)] = e.second;
+    }
+    return py::make_tuple(ret[0], ret[1], stat);
+  }
+
   py::object knnQueryBatch(py::object input, size_t k, int num_threads) {
     if (!index) {
       throw std::invalid_argument("Must call createIndex or loadIndex before this method");
     }
 
     ObjectVector queries;
-    readObjectVector(input, &queries);
+    readObjectVector(input, &queries, py::none(), num_threads);
     std::vector<std::unique_ptr<KNNQueue<dist_t>>> results(queries.size());
     {
       py::gil_scoped_release l;
@@ -155,6 +219,85 @@ struct IndexWrapper {
     return ret;
   }
 
+  py::object rangeQuery(py::object input, dist_t radius) {
+    if (!index) {
+      throw std::invalid_argument("Must call createIndex or loadIndex before this method");
+    }
+
+    std::unique_ptr<const Object> query(readObject(input));
+    std::vector<std::pair<dist_t, IdType>> res;
+    {
+      py::gil_scoped_release l;
+      searchRange(query.get(), radius, res);
+    }
+    py::array_t<int> ids(res.size());
+    py::array_t<dist_t> distances(res.size());
+    for (size_t i = 0; i < res.size(); ++i) {
+      ids.mutable_at(i) = res[i].second;
+      distances.mutable_at(i) = res[i].first;
+    }
+    return py::make_tuple(ids, distances);
+  }
+
+  // Results of all queries are returned in the CSR format: results of the i-th query
+  // are ids[indptr[i]:indptr[i+1]] and distances[indptr[i]:indptr[i+1]]
+  py::object rangeQueryBatch(py::object input, dist_t radius, int num_threads) {
+    if (!index) {
+      throw std::invalid_argument("Must call createIndex or loadIndex before this method");
+    }
+
+    ObjectVector queries;
+    readObjectVector(input, &queries, py::none(), num_threads);
+    std::vector<std::vector<std::pair<dist_t, IdType>>> results(queries.size());
+    {
+      py::gil_scoped_release l;
+
+      ParallelFor(0, queries.size(), num_threads, [&](size_t query_index) {
+        searchRange(queries[query_index], radius, results[query_index]);
+      });
+
+      freeObjectVector(&queries);
+    }
+
+    py::array_t<int64_t> indptr(results.size() + 1);
+    int64_t total = 0;
+    indptr.mutable_at(0) = 0;
+    for (size_t i = 0; i < results.size(); ++i) {
+      total += results[i].size();
+      indptr.mutable_at(i + 1) = total;
+    }
+    py::array_t<int> ids(total);
+    py::array_t<dist_t> distances(total);
+    int * pIds = ids.mutable_data();
+    dist_t * pDists = distances.mutable_data();
+    {
+      py::gil_scoped_release l;
+      for (auto & result : results) {
+        for (const auto & e : result) {
+          *pIds++ = e.second;
+          *pDists++ = e.first;
+        }
+        // results of processed queries are freed as soon as possible
+        std::vector<std::pair<dist_t, IdType>>().swap(result);
+      }
+    }
+    return py::make_tuple(indptr, ids, distances);
+  }
+
+  // Finds all points within the radius, the result is sorted by the distance
+  void searchRange(const Object * query, dist_t radius,
+                   std::vector<std::pair<dist_t, IdType>> & res) const {
+    RangeQuery<dist_t> range(*space, query, radius);
+    index->Search(&range, -1);
+    const ObjectVector & objs = *range.Result();
+    const std::vector<dist_t> & dists = *range.ResultDists();
+    res.resize(objs.size());
+    for (size_t i = 0; i < objs.size(); ++i) {
+      res[i] = std::make_pair(dists[i], objs[i]->id());
+    }
+    std::sort(res.begin(), res.end());
+  }
+
   py::object convertResult(KNNQueue<dist_t> * res) {
     // Create numpy arrays for the output
     size_t size = res->Size();
@@ -212,7 +355,7 @@ struct IndexWrapper {
   // reads multiple items from a python object and inserts onto a similarity::ObjectVector
   // returns the number of elements inserted
   size_t readObjectVector(py::object input, ObjectVector * output,
-                          py::object ids_ = py::none()) {
+                          py::object ids_ = py::none(), int num_threads = 0) {
     std::vector<int> ids;
     if (!ids_.is_none()) {
       ids = py::cast<std::vector<int>>(ids_);
@@ -268,26 +411,70 @@ struct IndexWrapper {
       }
 
       // try to intrepret input data as a CSR matrix
-      py::array_t<int> indptr(input.attr("indptr"));
-      py::array_t<int> indices(input.attr("indices"));
-      py::array_t<dist_t> sparse_data(input.attr("data"));
+      py::array_t<int64_t, py::array::c_style | py::array::forcecast> indptr(input.attr("indptr"));
+      py::array_t<int, py::array::c_style | py::array::forcecast> indices(input.attr("indices"));
+      py::array_t<dist_t, py::array::c_style | py::array::forcecast> sparse_data(input.attr("data"));
+      // elements of each row are sorted only if scipy doesn't know that they're sorted already
+      bool sorted = py::hasattr(input, "has_sorted_indices") &&
+                    py::cast<bool>(input.attr("has_sorted_indices"));
+
+      size_t rows = indptr.size() ? indptr.size() - 1 : 0;
+      if (ids.size() && ids.size() < rows) throw std::invalid_argument("not enough ids");
+      const int64_t * pIndptr = indptr.data();
+      const int * pIndices = indices.data();
+      const dist_t * pData = sparse_data.data();
+      for (size_t row = 0; row < rows; ++row) {
+        if (pIndptr[row] < 0 || pIndptr[row] > pIndptr[row + 1] ||
+            pIndptr[row + 1] > static_cast<int64_t>(std::min(indices.size(), sparse_data.size()))) {
+          throw std::invalid_argument("invalid indptr of the CSR matrix");
+        }
+      }
 
-      // read each row from the sparse matrix, and insert
+      /*
+       * Rows are converted without the GIL. For spaces storing elements as is,
+       * elements are written directly to object buffers, otherwise, the space creates objects.
+       * Large matrices are converted in parallel, but each thread gets at least
+       * MIN_CSR_ROWS_PER_THREAD rows, so small inputs (e.g., single queries) are converted inline.
+       */
+      size_t start = output->size();
+      output->resize(start + rows, nullptr);
       auto sparse_space = reinterpret_cast<const SpaceSparseVector<dist_t>*>(space.get());
-      std::vector<SparseVectElem<dist_t>> sparse_items;
-      for (int rowid = 0; rowid < indptr.size() - 1; ++rowid) {
-        sparse_items.clear();
-
-        for (int i = indptr.at(rowid); i < indptr.at(rowid + 1); ++i) {
-          sparse_items.push_back(SparseVectElem<dist_t>(indices.at(i),
-                                 sparse_data.at(i)));
+      bool simple_storage = dynamic_cast<const SpaceSparseVectorSimpleStorage<dist_t>*>(space.get()) != nullptr;
+      size_t thread_qty = num_threads > 0 ? num_threads : std::thread::hardware_concurrency();
+      thread_qty = std::min(thread_qty, rows / MIN_CSR_ROWS_PER_THREAD);
+      try {
+        py::gil_scoped_release l;
+        auto convert_row = [&](size_t row) {
+          int id = ids.size() ? ids[row] : row;
+          int64_t beg = pIndptr[row], end = pIndptr[row + 1];
+          if (simple_storage) {
+            Object * obj = new Object(id, -1, (end - beg) * sizeof(SparseVectElem<dist_t>), NULL);
+            auto elems = reinterpret_cast<SparseVectElem<dist_t>*>(obj->data());
+            for (int64_t i = beg; i < end; ++i) {
+              elems[i - beg] = SparseVectElem<dist_t>(pIndices[i], pData[i]);
+            }
+            if (!sorted) std::sort(elems, elems + (end - beg));
+            (*output)[start + row] = obj;
+          } else {
+            std::vector<SparseVectElem<dist_t>> sparse_items;
+            for (int64_t i = beg; i < end; ++i) {
+              sparse_items.push_back(SparseVectElem<dist_t>(pIndices[i], pData[i]));
+            }
+            if (!sorted) std::sort(sparse_items.begin(), sparse_items.end());
+            (*output)[start + row] = sparse_space->CreateObjFromVect(id, -1, sparse_items);
+          }
+        };
+        if (thread_qty > 1) {
+          ParallelFor(0, rows, thread_qty, convert_row);
+        } else {
+          for (size_t row = 0; row < rows; ++row) convert_row(row);
         }
-        std::sort(sparse_items.begin(), sparse_items.end());
-
-        int id = ids.size() ? ids.at(rowid) : rowid;
-        output->push_back(sparse_space->CreateObjFromVect(id, -1, sparse_items));
+      } catch (...) {
+        for (size_t i = start; i < output->size(); ++i) delete (*output)[i];
+        output->resize(start);
+        throw;
       }
-      return indptr.size() - 1;
+      return rows;
     }
 
     throw std::invalid_argument("Unknown data type");
@@ -323,16 +510,95 @@ struct IndexWrapper {
   }
 
   size_t addDataPoint(int id, py::object input) {
+    bundle_location.clear();
     data.push_back(readObject(input, id));
     return data.size() - 1;
   }
 
-  size_t addDataPointBatch(py::object input, py::object ids = py::none()) {
-    return readObjectVector(input, &data, ids);
+  size_t addDataPointBatch(py::object input, py::object ids = py::none(), int num_threads = 0) {
+    bundle_location.clear();
+    return readObjectVector(input, &data, ids, num_threads);
   }
 
   inline size_t size() const { return data.size(); }
 
+  /*
+   * The pickled state of an index loaded with loadIndex(filename, load_data=True)
+   * (and not modified since) is just the location of the file, so all processes
+   * unpickling the index map the same file and share one physical copy of data points.
+   * Otherwise, the state has contents of files saved by saveIndex(filename, save_data=True).
+   * The index (if the method can map it, e.g., the optimized HNSW index) is shared as well.
+   * Query-time parameters set by setQueryTimeParams are restored after unpickling.
+   */
+  py::tuple getState() {
+    if (!index) {
+      throw std::invalid_argument("Must call createIndex or loadIndex before pickling the index");
+    }
+    py::object location = py::none(), bundle_data = py::none(), index_data = py::none();
+    if (!bundle_location.empty()) {
+      location = py::module::import("os.path").attr("abspath")(bundle_location);
+    } else {
+      TempDir dir;
+      std::string filename = dir.name + "/index";
+      saveIndex(filename, true);
+      bundle_data = py::bytes(readFile(filename));
+      index_data = py::bytes(readFile(IndexBundle::GetIndexFileName(filename)));
+    }
+    return py::make_tuple(method, space_type, paramsToList(space_params), data_type, dist_type,
+                          location, bundle_data, index_data, paramsToList(query_time_params));
+  }
+
+  static IndexWrapper * setState(py::tuple state) {
+    if (state.size() != 9) {
+      throw std::runtime_error("Invalid state of the pickled index");
+    }
+    std::unique_ptr<IndexWrapper> ret(new IndexWrapper(py::cast<std::string>(state[0]),
+                                                       py::cast<std::string>(state[1]),
+                                                       state[2],
+                                                       py::cast<DataType>(state[3]),
+                                                       py::cast<DistType>(state[4])));
+    if (!state[5].is_none()) {
+      ret->loadIndex(py::cast<std::string>(state[5]), false, true);
+    } else {
+      // the mapped data remains available after temporary files are deleted
+      TempDir dir;
+      std::string filename = dir.name + "/index";
+      writeFile(filename, py::cast<std::string>(state[6]));
+      writeFile(IndexBundle::GetIndexFileName(filename), py::cast<std::string>(state[7]));
+      ret->loadIndex(filename, false, true);
+      ret->bundle_location.clear();
+    }
+    ret->setQueryTimeParams(state[8]);
+    return ret.release();
+  }
+
+  static std::vector<std::string> paramsToList(const AnyParams & params) {
+    std::vector<std::string> ret;
+    for (size_t i = 0; i < params.ParamNames.size(); ++i) {
+      ret.push_back(params.ParamNames[i] + "=" + params.ParamValues[i]);
+    }
+    return ret;
+  }
+
+  // A temporary directory, which is deleted with its contents
+  struct TempDir {
+    TempDir() : name(py::cast<std::string>(py::module::import("tempfile").attr("mkdtemp")())) {}
+    ~TempDir() { py::module::import("shutil").attr("rmtree")(name, true); }
+    std::string name;
+  };
+
+  static std::string readFile(const std::string & filename) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) throw std::runtime_error("Cannot open file " + filename);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+
+  static void writeFile(const std::string & filename, const std::string & contents) {
+    std::ofstream out(filename, std::ios::binary);
+    out.write(contents.data(), contents.size());
+    if (!out) throw std::runtime_error("Cannot write file " + filename);
+  }
+
   py::object at(size_t pos) { return writeObject(data.at(pos)); }
 
   dist_t getDistance(size_t pos1, size_t pos2) const {
@@ -354,13 +620,55 @@ struct IndexWrapper {
 
   std::string method;
   std::string space_type;
+  AnyParams space_params;
   DataType data_type;
   DistType dist_type;
+  // data points loaded from a bundle point to its memory, so it is destroyed last
+  std::unique_ptr<IndexBundle> bundle;
+  // the location of the bundle if the index was loaded from it and wasn't modified
+  std::string bundle_location;
+  // the last parameters passed to setQueryTimeParams, they are restored after unpickling
+  AnyParams query_time_params;
   std::unique_ptr<Space<dist_t>> space;
   std::unique_ptr<Index<dist_t>> index;
   ObjectVector data;
 };
 
+// Runs a batch of range queries chunk by chunk, so that results of all queries
+// don't have to be kept in memory at once
+template <typename dist_t>
+struct RangeQueryIterator {
+  RangeQueryIterator(IndexWrapper<dist_t> * index, py::object queries, dist_t radius,
+                     size_t chunk_size, int num_threads)
+      : index(index), queries(queries), radius(radius), chunk_size(chunk_size),
+        num_threads(num_threads), pos(0) {
+    if (chunk_size == 0) {
+      throw std::invalid_argument("chunk_size should be positive");
+    }
+    // len isn't defined for scipy sparse matrices
+    qty = py::hasattr(queries, "shape") ? py::cast<size_t>(py::tuple(queries.attr("shape"))[0])
+                                        : py::len(queries);
+  }
+
+  py::object next() {
+    if (pos >= qty) {
+      throw py::stop_iteration();
+    }
+    size_t end = std::min(pos + chunk_size, qty);
+    py::object chunk = queries.attr("__getitem__")(py::slice(pos, end, 1));
+    pos = end;
+    return index->rangeQueryBatch(chunk, radius, num_threads);
+  }
+
+  IndexWrapper<dist_t> * index;
+  py::object queries;
+  dist_t radius;
+  size_t chunk_size;
+  int num_threads;
+  size_t pos;
+  size_t qty;
+};
+
 class PythonLogger
   : public Logger {
  public:
@@ -402,13 +710,22 @@ PYBIND11_MODULE(nmslib, m) {
 PYBIND11_PLUGIN(nmslib) {
   py::module m(module_name, "Python Bindings for Non-Metric Space Library (NMSLIB)");
 #endif
-  // Log using the python logger, instead of defaults built in here
+  // Log using the python logger, instead of defaults built in here.
+  // Messages are passed to python in a background thread, so that
+  // indexing and search threads never wait for the GIL.
   py::module logging = py::module::import("logging");
   py::module nmslibLogger = logging.attr("getLogger")("nmslib");
-  setGlobalLogger(new PythonLogger(nmslibLogger));
+  setGlobalLogger(new AsyncLogger(new PythonLogger(nmslibLogger)));
 
   initLibrary(0 /* seed */, LIB_LOGCUSTOM, NULL);
 
+  // The background thread needs the GIL, so it has to stop before the interpreter shuts down
+  py::module::import("atexit").attr("register")(py::cpp_function([]() {
+    py::gil_scoped_release l;
+    AsyncLogger * logger = dynamic_cast<AsyncLogger *>(getGlobalLogger());
+    if (logger) logger->stop();
+  }));
+
 
 #ifdef VERSION_INFO
   m.attr("__version__") = py::str(VERSION_INFO);
@@ -416,6 +733,9 @@ PYBIND11_PLUGIN(nmslib) {
   m.attr("__version__") = py::str("dev");
 #endif
 
+  m.def("searchStatEnabled", &IsSearchStatEnabled,
+    "Returns True if search methods collect traversal statistics (see knnQueryWithStat)\n");
+
   py::enum_<DistType>(m, "DistType")
     .value("FLOAT", DISTTYPE_FLOAT)
     .value("DOUBLE", DISTTYPE_DOUBLE)
@@ -526,6 +846,29 @@ void exportIndex(py::module * m) {
       "distances: array_like.\n"
       "    A 1D vector of the distance to each nearest neigbhour.\n")
 
+    .def("knnQueryWithStat", &IndexWrapper<dist_t>::knnQueryWithStat,
+      py::arg("vector"), py::arg("k") = 10,
+      "Same as knnQuery, but also returns per-query traversal statistics.\n"
+      "The statistics are collected only if the library is compiled with\n"
+      "WITH_SEARCH_STAT (see also searchStatEnabled), otherwise, only\n"
+      "the number of distance computations is returned.\n\n"
+      "Parameters\n"
+      "----------\n"
+      "vector: array_like\n"
+      "    A 1D vector to query for.\n"
+      "k: int optional\n"
+      "    The number of neighbours to return\n"
+      "\n"
+      "Returns\n"
+      "----------\n"
+      "ids: array_like.\n"
+      "    A 1D vector of the ids of each nearest neighbour.\n"
+      "distances: array_like.\n"
+      "    A 1D vector of the distance to each nearest neigbhour.\n"
+      "stat: dict\n"
+      "    Non-zero statistics, e.g., dist_comp, hops_l0 (hops at layer 0), visited,\n"
+      "    heap_ops, leaves, leaf_limit, cands, cand_limit.\n")
+
     .def("knnQueryBatch", &IndexWrapper<dist_t>::knnQueryBatch,
       py::arg("queries"), py::arg("k") = 10, py::arg("num_threads") = 0,
       "Performs multiple queries on the index, distributing the work over \n"
@@ -544,29 +887,106 @@ void exportIndex(py::module * m) {
       "list:\n"
       "   A list of tuples of (ids, distances)\n ")
 
+    .def("rangeQuery", &IndexWrapper<dist_t>::rangeQuery,
+      py::arg("vector"), py::arg("radius"),
+      "Finds all points of the index within the radius of a vector\n\n"
+      "Parameters\n"
+      "----------\n"
+      "vector: array_like\n"
+      "    A 1D vector to query for.\n"
+      "radius: float\n"
+      "    The maximum distance to returned points\n"
+      "\n"
+      "Returns\n"
+      "----------\n"
+      "ids: array_like.\n"
+      "    A 1D vector of the ids of found points sorted by the distance.\n"
+      "distances: array_like.\n"
+      "    A 1D vector of the distance to each found point.\n")
+
+    .def("rangeQueryBatch", &IndexWrapper<dist_t>::rangeQueryBatch,
+      py::arg("queries"), py::arg("radius"), py::arg("num_threads") = 0,
+      "Performs multiple range queries on the index, distributing the work over \n"
+      "a thread pool\n\n"
+      "Parameters\n"
+      "----------\n"
+      "input: list\n"
+      "    A list of queries to query for\n"
+      "radius: float\n"
+      "    The maximum distance to returned points\n"
+      "num_threads: int optional\n"
+      "    The number of threads to use\n"
+      "\n"
+      "Returns\n"
+      "----------\n"
+      "indptr, ids, distances: array_like\n"
+      "   Results in the CSR format: ids and distances of points found for\n"
+      "   the i-th query are ids[indptr[i]:indptr[i+1]] and distances[indptr[i]:indptr[i+1]]\n"
+      "   (sorted by the distance)\n")
+
+    .def("rangeQueryBatchIter",
+      [](IndexWrapper<dist_t> * self, py::object queries, dist_t radius,
+         size_t chunk_size, int num_threads) {
+        return RangeQueryIterator<dist_t>(self, queries, radius, chunk_size, num_threads);
+      },
+      py::arg("queries"), py::arg("radius"), py::arg("chunk_size") = 10000,
+      py::arg("num_threads") = 0,
+      py::keep_alive<0, 1>(),
+      "Same as rangeQueryBatch, but queries are processed in chunks of chunk_size\n"
+      "queries and results are returned chunk by chunk, so that results of\n"
+      "all queries are never kept in memory at once\n\n"
+      "Returns\n"
+      "----------\n"
+      "iterator:\n"
+      "   An iterator over tuples (indptr, ids, distances), one tuple per chunk\n")
+
     .def("loadIndex", &IndexWrapper<dist_t>::loadIndex,
       py::arg("filename"),
       py::arg("print_progress") = false,
+      py::arg("load_data") = false,
       "Loads the index from disk\n\n"
       "Parameters\n"
       "----------\n"
       "filename: str\n"
       "    The filename to read from\n",
       "print_progress: bool optional\n"
-      "    Whether or not to display progress bar when creating index\n")
+      "    Whether or not to display progress bar when creating index\n"
+      "load_data: bool optional\n"
+      "    Load data points from the file saved with save_data=True\n"
+      "    (they replace the current ones), otherwise, the same data points\n"
+      "    should be added before loading the index\n")
 
     .def("saveIndex", &IndexWrapper<dist_t>::saveIndex,
       py::arg("filename"),
+      py::arg("save_data") = false,
       "Saves the index to disk\n\n"
       "Parameters\n"
       "----------\n"
       "filename: str\n"
-      "    The filename to save to\n")
+      "    The filename to save to\n"
+      "save_data: bool optional\n"
+      "    Save data points and the space description along with the index, so that\n"
+      "    loadIndex(filename, load_data=True) needs no data. The index itself is saved\n"
+      "    to the file filename + '.index'\n")
+
+    .def("getBuildProfile",
+      [](IndexWrapper<dist_t> * self) {
+        if (!self->index) {
+          throw std::invalid_argument("Must call createIndex before this method");
+        }
+        py::module json = py::module::import("json");
+        return json.attr("loads")(self->index->GetBuildProfile().ToJSON());
+      },
+      "Returns the profile of the last createIndex call: per-phase wall and CPU times,\n"
+      "the peak resident memory size, accumulated times of insertion sub-phases,\n"
+      "and the insertion throughput timeline. The profile is empty for methods\n"
+      "that don't record build phases.\n\n"
+      "Returns\n"
+      "----------\n"
+      "    A dictionary with keys 'peakRssMB', 'peakRssIncreaseMB', 'phases', 'subPhases', and 'progress'\n")
 
-    .def("setQueryTimeParams",
-      [](IndexWrapper<dist_t> * self, py::object params) {
-        self->index->SetQueryTimeParams(loadParams(params));
-      }, py::arg("params") = py::none(),
+    .def("setQueryTimeParams", &IndexWrapper<dist_t>::setQueryTimeParams,
+      py::arg("params") = py::none(),
       "Sets parameters used in knnQuery.\n\n"
       "Parameters\n"
       "----------\n"
@@ -591,6 +1011,7 @@ void exportIndex(py::module * m) {
     .def("addDataPointBatch", &IndexWrapper<dist_t>::addDataPointBatch,
       py::arg("data"),
       py::arg("ids") = py::none(),
+      py::arg("num_threads") = 0,
       "Adds multiple datapoints to the index\n\n"
       "Parameters\n"
       "----------\n"
@@ -599,6 +1020,8 @@ void exportIndex(py::module * m) {
       "ids: array_like optional\n"
       "    The ids of the object being inserted. If not set will default to the \n"
       "    row id of each object in the dataset\n"
+      "num_threads: int optional\n"
+      "    The number of threads converting rows of a sparse (CSR) matrix\n"
       "Returns\n"
       "----------\n"
       "int\n"
@@ -609,7 +1032,15 @@ void exportIndex(py::module * m) {
     .def("__len__", &IndexWrapper<dist_t>::size)
     .def("__getitem__", &IndexWrapper<dist_t>::at)
     .def("getDistance", &IndexWrapper<dist_t>::getDistance)
-    .def("__repr__", &IndexWrapper<dist_t>::repr);
+    .def("__repr__", &IndexWrapper<dist_t>::repr)
+    .def(py::pickle(&IndexWrapper<dist_t>::getState, &IndexWrapper<dist_t>::setState));
+
+  std::string iterator_name = distName<dist_t>() + "RangeQueryIterator";
+  py::class_<RangeQueryIterator<dist_t>>(*m, iterator_name.c_str())
+    .def("__iter__", [](py::object self) { return self; })
+    .def("__next__", &RangeQueryIterator<dist_t>::next)
+    // python 2
+    .def("next", &RangeQueryIterator<dist_t>::next);
 }
 
 template <> std::string distName<int>() { return "Int"; }
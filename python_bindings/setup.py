@@ -12,6 +12,10 @@ source_files = ['nmslib.cc']
 
 libraries = []
 extra_objects = []
+# Per-query traversal statistics (see knnQueryWithStat), set NMSLIB_SEARCH_STAT=0 to compile them out
+define_macros = []
+if os.environ.get('NMSLIB_SEARCH_STAT', '1') != '0':
+    define_macros.append(('WITH_SEARCH_STAT', '1'))
 
 if os.path.exists(library_file):
     # if we have a prebuilt nmslib library file, use that.
@@ -38,6 +42,7 @@ ext_modules = [
         'nmslib',
         source_files,
         include_dirs=[os.path.join(libdir, "include")],
+        define_macros=define_macros,
         libraries=libraries,
         language='c++',
         extra_objects=extra_objects,
@@ -136,7 +141,7 @@ setup(
  likely to be sufficient in all cases. Also note that exact solutions are hardly efficient in
  high dimensions and/or non-metric spaces. Hence, the main focus is on approximate methods.""",
     ext_modules=ext_modules,
-    install_requires=['pybind11>=2.0', 'numpy'],
+    install_requires=['pybind11>=2.2', 'numpy'],
     cmdclass={'build_ext': BuildExt},
     test_suite="tests",
     zip_safe=False,
@@ -1,4 +1,8 @@
 import itertools
+import multiprocessing
+import pickle
+import subprocess
+import sys
 import tempfile
 import unittest
 
@@ -18,6 +22,11 @@ def get_hitrate(ground_truth, ids):
     return len(set(i for i, _ in ground_truth).intersection(ids))
 
 
+def knn_query_state(index, query):
+    # runs in a multiprocessing worker, which unpickles the index
+    return index.knnQuery(query), index.__getstate__()[-1]
+
+
 class DenseIndexTestMixin(object):
     def _get_index(self, space='cosinesimil'):
         raise NotImplementedError()
@@ -34,6 +43,22 @@ class DenseIndexTestMixin(object):
         ids, distances = index.knnQuery(row, k=10)
         self.assertTrue(get_hitrate(get_exact_cosine(row, data), ids) >= 5)
 
+    def testKnnQueryWithStat(self):
+        np.random.seed(23)
+        data = np.random.randn(1000, 10).astype(np.float32)
+
+        index = self._get_index()
+        index.addDataPointBatch(data)
+        index.createIndex()
+
+        row = np.array([1, 1, 1, 1, 1, 1, 1, 1, 1, 1.])
+        ids, distances, stat = index.knnQueryWithStat(row, k=10)
+        self.assertTrue(get_hitrate(get_exact_cosine(row, data), ids) >= 5)
+        self.assertTrue(stat['dist_comp'] > 0)
+        if nmslib.searchStatEnabled():
+            # graph methods report hops and visited nodes, trees report leaves
+            self.assertTrue(len(stat) > 1)
+
     def testKnnQueryBatch(self):
         np.random.seed(23)
         data = np.random.randn(1000, 10).astype(np.float32)
@@ -86,6 +111,64 @@ class DenseIndexTestMixin(object):
             npt.assert_allclose(original_results,
                                 reloaded_results)
 
+    def testReloadIndexWithData(self):
+        np.random.seed(23)
+        data = np.random.randn(1000, 10).astype(np.float32)
+
+        original = self._get_index()
+        original.addDataPointBatch(data)
+        original.createIndex()
+
+        # the saved file has data points, so nothing is added before loading
+        with tempfile.NamedTemporaryFile() as tmp:
+            original.saveIndex(tmp.name + ".bundle", save_data=True)
+
+            reloaded = self._get_index()
+            reloaded.loadIndex(tmp.name + ".bundle", load_data=True)
+            self.assertEqual(len(reloaded), len(original))
+            npt.assert_allclose(reloaded[10], original[10])
+
+            original_results = original.knnQuery(data[0])
+            reloaded_results = reloaded.knnQuery(data[0])
+            npt.assert_allclose(original_results,
+                                reloaded_results)
+
+    def testPickle(self):
+        np.random.seed(23)
+        data = np.random.randn(1000, 10).astype(np.float32)
+
+        original = self._get_index()
+        original.addDataPointBatch(data)
+        original.createIndex()
+
+        reloaded = pickle.loads(pickle.dumps(original))
+        self.assertEqual(len(reloaded), len(original))
+        npt.assert_allclose(original.knnQuery(data[0]), reloaded.knnQuery(data[0]))
+
+        # an index loaded with its data is pickled by reference to the file
+        with tempfile.NamedTemporaryFile() as tmp:
+            original.saveIndex(tmp.name + ".bundle", save_data=True)
+            loaded = self._get_index()
+            loaded.loadIndex(tmp.name + ".bundle", load_data=True)
+
+            loaded.setQueryTimeParams({'efSearch': 50})
+
+            state = pickle.dumps(loaded)
+            self.assertTrue(len(state) < data.nbytes)
+            reloaded = pickle.loads(state)
+            npt.assert_allclose(loaded.knnQuery(data[0]), reloaded.knnQuery(data[0]))
+
+            # workers unpickle the index with the same query-time parameters
+            pool = multiprocessing.Pool(2)
+            try:
+                results = pool.starmap(knn_query_state, [(loaded, row) for row in data[:4]])
+            finally:
+                pool.close()
+                pool.join()
+            for row, (result, query_time_params) in zip(data[:4], results):
+                npt.assert_allclose(loaded.knnQuery(row), result)
+                self.assertEqual(query_time_params, loaded.__getstate__()[-1])
+
 
 class HNSWTestCase(unittest.TestCase, DenseIndexTestMixin):
     def _get_index(self, space='cosinesimil'):
@@ -125,6 +208,44 @@ class BallTreeTestCase(unittest.TestCase, DenseIndexTestMixin):
     def testReloadIndex(self):
         return NotImplemented
 
+    def testReloadIndexWithData(self):
+        return NotImplemented
+
+    def testPickle(self):
+        return NotImplemented
+
+
+class RangeQueryTestCase(unittest.TestCase):
+    def testRangeQuery(self):
+        np.random.seed(23)
+        data = np.random.randn(1000, 10).astype(np.float32)
+        queries = data[:50]
+        radius = 3.0
+
+        index = nmslib.init(method='seq_search', space='l2')
+        index.addDataPointBatch(data)
+        index.createIndex()
+
+        def get_exact(row):
+            distances = np.linalg.norm(data - row, axis=-1)
+            return set(np.nonzero(distances <= radius)[0])
+
+        ids, distances = index.rangeQuery(queries[0], radius=radius)
+        self.assertEqual(set(ids), get_exact(queries[0]))
+        self.assertTrue(np.all(np.diff(distances) >= 0))
+
+        indptr, ids, distances = index.rangeQueryBatch(queries, radius=radius)
+        self.assertEqual(len(indptr), len(queries) + 1)
+        self.assertEqual(indptr[-1], len(ids))
+        for i, query in enumerate(queries):
+            self.assertEqual(set(ids[indptr[i]:indptr[i + 1]]), get_exact(query))
+
+        # the iterator returns the same results chunk by chunk
+        chunks = list(index.rangeQueryBatchIter(queries, radius=radius, chunk_size=16))
+        self.assertEqual(len(chunks), 4)
+        npt.assert_array_equal(np.concatenate([chunk_ids for _, chunk_ids, _ in chunks]), ids)
+        npt.assert_allclose(np.concatenate([chunk_dists for _, _, chunk_dists in chunks]), distances)
+
 
 class StringTestCase(unittest.TestCase):
     def testStringLeven(self):
@@ -168,6 +289,58 @@ class SparseTestCase(unittest.TestCase):
         self.assertEqual(len(index), 4)
         self.assertEqual(index[3], [(3, 1.0)])
 
+    def testSparseCSR(self):
+        try:
+            from scipy.sparse import csr_matrix
+        except ImportError:
+            return
+
+        # indices of each row are in the reverse order, so rows have to be sorted;
+        # there are enough rows to be converted by 4 threads
+        np.random.seed(23)
+        qty = 5000
+        indptr = np.arange(0, (qty + 1) * 5, 5)
+        indices = np.array([sorted(np.random.choice(100, 5, replace=False), reverse=True)
+                            for _ in range(qty)]).ravel()
+        values = np.random.rand(len(indices)).astype(np.float32)
+        data = csr_matrix((values, indices, indptr), shape=(qty, 100))
+        self.assertFalse(data.has_sorted_indices)
+
+        for space in ['cosinesimil_sparse', 'cosinesimil_sparse_fast']:
+            index = nmslib.init(method='seq_search', space=space,
+                                data_type=nmslib.DataType.SPARSE_VECTOR)
+            index.addDataPointBatch(data, num_threads=4)
+            self.assertEqual(len(index), qty)
+            if space == 'cosinesimil_sparse':
+                for i in [7, qty - 1]:
+                    row = data[i].sorted_indices()
+                    self.assertEqual(index[i], [(j, v) for j, v in zip(row.indices, row.data)])
+            index.createIndex()
+
+            # small batches of queries are converted without extra threads
+            results = index.knnQueryBatch(data[:20], k=1, num_threads=4)
+            for i, (ids, distances) in enumerate(results):
+                self.assertEqual(ids[0], i)
+
+            # a sparse matrix has no len(), the iterator uses its shape
+            chunks = list(index.rangeQueryBatchIter(data[:50], radius=1e-5, chunk_size=16))
+            self.assertEqual(len(chunks), 4)
+            found = np.concatenate([chunk_ids for _, chunk_ids, _ in chunks])
+            self.assertTrue(set(range(50)).issubset(found))
+
+
+class LoggingTestCase(unittest.TestCase):
+    def testExitWithPendingMessages(self):
+        # the background logging thread is stopped at exit, so the interpreter exits cleanly
+        script = "\n".join([
+            "import logging, numpy as np, nmslib",
+            "logging.basicConfig(level=logging.DEBUG)",
+            "index = nmslib.init(method='hnsw', space='l2')",
+            "index.addDataPointBatch(np.random.rand(1000, 10).astype(np.float32))",
+            "index.createIndex({'post': 2}, print_progress=True)",
+        ])
+        self.assertEqual(subprocess.call([sys.executable, "-c", script]), 0)
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -16,6 +16,8 @@
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <vector>
+#include <cstring>
 
 #include <thrift/protocol/TBinaryProtocol.h>
 #include <thrift/transport/TSocket.h>
@@ -38,6 +40,7 @@ using std::cout;
 using std::cin;
 using std::endl;
 using std::unique_ptr;
+using std::vector;
 
 using namespace  ::similarity;
 
@@ -51,6 +54,32 @@ enum SearchType {
   kNoSearch, kKNNSearch, kRangeSearch
 };
 
+/*
+ * Converts a dense vector (numbers separated by spaces) or a sparse vector
+ * (dim:value pairs separated by spaces) into the binary format of knnQueryBatchBinary.
+ */
+string CreateBinaryQuery(const string& line) {
+  stringstream  ss(line);
+  string        token, res;
+  while (ss >> token) {
+    size_t pos = token.find(':');
+    if (pos != string::npos) {
+      uint32_t dim = std::stoul(token.substr(0, pos));
+      res.append(reinterpret_cast<const char*>(&dim), sizeof(dim));
+    }
+    float val = std::stof(pos == string::npos ? token : token.substr(pos + 1));
+    res.append(reinterpret_cast<const char*>(&val), sizeof(val));
+  }
+  return res;
+}
+
+static void PrintResult(const ReplyEntryList& res, bool retExternId, bool retObj) {
+  for (auto e: res) {
+    cout << "id=" << e.id << " dist=" << e.dist << ( retExternId ? " externId=" + e.externId : string("")) << endl; 
+    if (retObj) cout << e.obj << endl;
+  }
+}
+
 static void Usage(const char *prog,
                   const po::options_description& desc) {
     std::cout << prog << std::endl
@@ -65,7 +94,9 @@ void ParseCommandLineForClient(int argc, char*argv[],
                       double&                 r,
                       bool&                   retExternId,
                       bool&                   retObj,
-                      string&                 queryTimeParams
+                      string&                 queryTimeParams,
+                      bool&                   batch,
+                      bool&                   binary
                       ) {
   po::options_description ProgOptDesc("Allowed options");
   ProgOptDesc.add_options()
@@ -77,6 +108,8 @@ void ParseCommandLineForClient(int argc, char*argv[],
     (QUERY_TIME_PARAMS_PARAM_OPT.c_str(), po::value<string>(&queryTimeParams)->default_value(""), QUERY_TIME_PARAMS_PARAM_MSG.c_str())
     (RET_EXT_ID_PARAM_OPT.c_str(),   RET_EXT_ID_PARAM_MSG.c_str())
     (RET_OBJ_PARAM_OPT.c_str(), RET_EXT_ID_PARAM_MSG.c_str())
+    (BATCH_PARAM_OPT.c_str(),   po::bool_switch(&batch), BATCH_PARAM_MSG.c_str())
+    (BINARY_PARAM_OPT.c_str(),  po::bool_switch(&binary), BINARY_PARAM_MSG.c_str())
     ;
 
   po::variables_map vm;
@@ -111,6 +144,17 @@ void ParseCommandLineForClient(int argc, char*argv[],
 
   retObj = vm.count("retObj") != 0;
 
+  if (batch && searchType != kKNNSearch) {
+    cerr << "Batch mode is supported only for the KNN search" << endl;
+    Usage(argv[0], ProgOptDesc);
+    exit(1);
+  }
+  if (binary && !batch) {
+    cerr << "Binary queries are supported only in the batch mode" << endl;
+    Usage(argv[0], ProgOptDesc);
+    exit(1);
+  }
+
   if (vm.count("help")  ) {
     Usage(argv[0], ProgOptDesc);
     exit(0);
@@ -126,6 +170,8 @@ int main(int argc, char *argv[]) {
   bool        retObj;
   SearchType  searchType;
   string      queryTimeParams;
+  bool        batch = false;
+  bool        binary = false;
 
   ParseCommandLineForClient(argc, argv,
                       host,
@@ -134,15 +180,22 @@ int main(int argc, char *argv[]) {
                       k, r,
                       retExternId,
                       retObj,
-                      queryTimeParams);
+                      queryTimeParams,
+                      batch,
+                      binary);
 
   // Let's read the query from the input stream
-  string        s;
-  stringstream  ss;
+  string          s;
+  stringstream    ss;
+  vector<string>  batchQueries;
 
   if (kNoSearch != searchType) {
     while (getline(cin, s)) {
-      ss << s << endl;
+      if (!batch) {
+        ss << s << endl;
+      } else if (!s.empty()) {
+        batchQueries.push_back(binary ? CreateBinaryQuery(s) : s);
+      }
     }
   }
 
@@ -158,16 +211,25 @@ int main(int argc, char *argv[]) {
 
     try {
 
-      if (!queryTimeParams.empty()) {
+      // A batch carries its own query-time parameters
+      if (!queryTimeParams.empty() && !batch) {
         client.setQueryTimeParams(queryTimeParams);
       }
 
       WallClockTimer wtm;
       wtm.reset();
 
-      ReplyEntryList res;
-
-      if (kKNNSearch == searchType) {
+      ReplyEntryList          res;
+      vector<ReplyEntryList>  batchRes;
+
+      if (batch) {
+        cout << "Running a batch of " << batchQueries.size() << " " << k << "-NN queries" << endl;
+        if (binary) {
+          client.knnQueryBatchBinary(batchRes, k, batchQueries, retExternId, retObj, queryTimeParams);
+        } else {
+          client.knnQueryBatch(batchRes, k, batchQueries, retExternId, retObj, queryTimeParams);
+        }
+      } else if (kKNNSearch == searchType) {
         cout << "Running a " << k << "-NN query" << endl;;
         client.knnQuery(res, k, queryObjStr, retExternId, retObj);
       } 
@@ -180,9 +242,13 @@ int main(int argc, char *argv[]) {
 
       cout << "Finished in: " << wtm.elapsed() / 1e3f << " ms" << endl;
 
-      for (auto e: res) {
-        cout << "id=" << e.id << " dist=" << e.dist << ( retExternId ? " externId=" + e.externId : string("")) << endl; 
-        if (retObj) cout << e.obj << endl;
+      if (batch) {
+        for (size_t i = 0; i < batchRes.size(); ++i) {
+          cout << "Query #" << i << endl;
+          PrintResult(batchRes[i], retExternId, retObj);
+        }
+      } else {
+        PrintResult(res, retExternId, retObj);
       }
     } catch (const QueryException& e) {
       cerr << "Query execution error: " << e.message << endl;
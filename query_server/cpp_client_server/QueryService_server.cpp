@@ -18,6 +18,11 @@
 #include <thread>
 #include <chrono>
 #include <iostream>
+#include <atomic>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include <cstring>
 
 #include "QueryService.h"
 #include <thrift/protocol/TBinaryProtocol.h>
@@ -27,6 +32,7 @@
 #include <thrift/concurrency/ThreadManager.h>
 #include <thrift/concurrency/PosixThreadFactory.h>
 #include <thrift/server/TThreadPoolServer.h>
+#include <thrift/transport/TSocket.h>
 
 #include <boost/program_options.hpp>
 
@@ -43,6 +49,11 @@
 #include "init.h"
 #include "logging.h"
 #include "ztimer.h"
+#include "thread_pool.h"
+#include "string_store.h"
+#include "index_bundle.h"
+#include "space/space_vector.h"
+#include "space/space_sparse_vector.h"
 
 #define MAX_SPIN_LOCK_QTY 1000000
 #define SLEEP_DURATION    10
@@ -61,15 +72,19 @@ using std::unique_ptr;
 using std::exception;
 using std::mutex;
 using std::unique_lock;
+using std::vector;
 
 using namespace  ::similarity;
 
 class LockedCounterManager {
 public:
-  LockedCounterManager(int& counter, mutex& mtx) : counter_(counter), mtx_(mtx) 
+  // If increment is false, the counter must have been increased by the caller
+  LockedCounterManager(int& counter, mutex& mtx, bool increment = true) : counter_(counter), mtx_(mtx) 
   {
-    unique_lock<mutex> lock(mtx_);
-    ++counter_;
+    if (increment) {
+      unique_lock<mutex> lock(mtx_);
+      ++counter_;
+    }
   }
 
   ~LockedCounterManager() {
@@ -82,11 +97,63 @@ private:
   mutex&   mtx_;
 };
 
+// Sparse vector spaces aren't instantiated for integer distances
+template <class dist_t>
+const SpaceSparseVector<dist_t>* AsSparseVectorSpace(const Space<dist_t>* space) {
+  return dynamic_cast<const SpaceSparseVector<dist_t>*>(space);
+}
+
+template <>
+const SpaceSparseVector<int>* AsSparseVectorSpace(const Space<int>*) {
+  return nullptr;
+}
+
+/*
+ * Creates a query object from the binary format of knnQueryBatchBinary (see protocol.thrift):
+ * an array of 32-bit floats for dense vectors and an array of (32-bit dimension, 32-bit float)
+ * pairs for sparse vectors. The byte order is the native one, i.e., little-endian on x86.
+ */
+template <class dist_t>
+unique_ptr<Object> CreateObjFromBinary(const Space<dist_t>* space, const string& bin) {
+  if (const VectorSpace<dist_t>* denseSpace = dynamic_cast<const VectorSpace<dist_t>*>(space)) {
+    CHECK_MSG(bin.size() % sizeof(float) == 0,
+              "The size of a binary dense vector should be a multiple of " + ConvertToString(sizeof(float)));
+    vector<dist_t> v(bin.size() / sizeof(float));
+    for (size_t i = 0; i < v.size(); ++i) {
+      float val;
+      memcpy(&val, bin.data() + i * sizeof(val), sizeof(val));
+      v[i] = static_cast<dist_t>(val);
+    }
+    return unique_ptr<Object>(denseSpace->CreateObjFromVect(0, -1, v));
+  }
+  if (const SpaceSparseVector<dist_t>* sparseSpace = AsSparseVectorSpace(space)) {
+    const size_t elemSize = sizeof(uint32_t) + sizeof(float);
+    CHECK_MSG(bin.size() % elemSize == 0,
+              "The size of a binary sparse vector should be a multiple of " + ConvertToString(elemSize));
+    vector<SparseVectElem<dist_t>> v(bin.size() / elemSize);
+    for (size_t i = 0; i < v.size(); ++i) {
+      uint32_t  id;
+      float     val;
+      memcpy(&id, bin.data() + i * elemSize, sizeof(id));
+      memcpy(&val, bin.data() + i * elemSize + sizeof(id), sizeof(val));
+      v[i] = SparseVectElem<dist_t>(id, static_cast<dist_t>(val));
+    }
+    if (!std::is_sorted(v.begin(), v.end())) std::sort(v.begin(), v.end());
+    for (size_t i = 1; i < v.size(); ++i) {
+      CHECK_MSG(v[i].id_ != v[i-1].id_, "Repeating dimension in a binary sparse vector: " + ConvertToString(v[i].id_));
+    }
+    CHECK_MSG(!v.empty(), "Encountered an empty sparse vector: this is not allowed!");
+    return unique_ptr<Object>(sparseSpace->CreateObjFromVect(0, -1, v));
+  }
+  throw runtime_error("Binary queries are supported only by dense and sparse vector spaces");
+}
+
 template <class dist_t>
 class QueryServiceHandler : virtual public QueryServiceIf {
  public:
   QueryServiceHandler(
                       bool                               debugPrint,
+                      unsigned                           searchStatSample,
                       const string&                      SpaceType,
                       const AnyParams&                   SpaceParams,
                       const string&                      DataFile,
@@ -94,47 +161,78 @@ class QueryServiceHandler : virtual public QueryServiceIf {
                       const string&                      MethodName,
                       const string&                      LoadIndexLoc,
                       const string&                      SaveIndexLoc,
+                      const string&                      IndexBundleLoc,
                       const AnyParams&                   IndexParams,
-                      const AnyParams&                   QueryTimeParams) :
+                      const AnyParams&                   QueryTimeParams,
+                      size_t                             batchThreadQty,
+                      bool                               cacheReplyStr,
+                      const string&                      replyStrFile) :
     debugPrint_(debugPrint),
+    searchStatSample_(searchStatSample),
     methName_(MethodName),
-    space_(SpaceFactoryRegistry<dist_t>::Instance().CreateSpace(SpaceType, SpaceParams)),
-    counter_(0)
+    counter_(0),
+    knnQueryQty_(0)
 
   {
-    unique_ptr<DataFileInputState> inpState(space_->ReadDataset(dataSet_,
-                                                                externIds_,
-                                                                DataFile,
-                                                                MaxNumData));
-    space_->UpdateParamsFromFile(*inpState);
-
-    CHECK(dataSet_.size() == externIds_.size());
-
-    index_.reset(MethodFactoryRegistry<dist_t>::Instance().
-                                CreateMethod(true /* print progress */,
-                                        methName_,
-                                        SpaceType,
-                                        *space_.get(),
-                                        dataSet_));
-
-    if (!LoadIndexLoc.empty() && DoesFileExist(LoadIndexLoc)) {
-      LOG(LIB_INFO) << "Loading index from location: " << LoadIndexLoc; 
-      index_->LoadIndex(LoadIndexLoc);
+    // The request-handling thread executes queries of its batch as well
+    batchPool_.reset(new ThreadPool(std::max(batchThreadQty, size_t(1)) - 1));
+
+    if (!IndexBundleLoc.empty() && DoesFileExist(IndexBundleLoc)) {
+      // The bundle has everything: the space description, data points, and the index
+      LOG(LIB_INFO) << "Loading the index bundle from location: " << IndexBundleLoc;
+      bundle_.reset(new IndexBundle(IndexBundleLoc));
+      methName_ = bundle_->GetMethodName();
+      space_.reset(bundle_->CreateSpace<dist_t>());
+      bundle_->ReadData(dataSet_, externIds_);
+      index_.reset(bundle_->LoadIndex(true /* print progress */, *space_, dataSet_));
       LOG(LIB_INFO) << "The index is loaded!";
     } else {
-      LOG(LIB_INFO) << "Creating a new index copy"; 
-      index_->CreateIndex(IndexParams);      
-      LOG(LIB_INFO) << "The index is created!";
+      space_.reset(SpaceFactoryRegistry<dist_t>::Instance().CreateSpace(SpaceType, SpaceParams));
+      unique_ptr<DataFileInputState> inpState(space_->ReadDataset(dataSet_,
+                                                                  externIds_,
+                                                                  DataFile,
+                                                                  MaxNumData));
+      space_->UpdateParamsFromFile(*inpState);
+
+      CHECK(dataSet_.size() == externIds_.size());
+
+      index_.reset(MethodFactoryRegistry<dist_t>::Instance().
+                                  CreateMethod(true /* print progress */,
+                                          methName_,
+                                          SpaceType,
+                                          *space_.get(),
+                                          dataSet_));
+
+      if (!LoadIndexLoc.empty() && DoesFileExist(LoadIndexLoc)) {
+        LOG(LIB_INFO) << "Loading index from location: " << LoadIndexLoc; 
+        index_->LoadIndex(LoadIndexLoc);
+        LOG(LIB_INFO) << "The index is loaded!";
+      } else {
+        LOG(LIB_INFO) << "Creating a new index copy"; 
+        index_->CreateIndex(IndexParams);      
+        LOG(LIB_INFO) << "The index is created!";
+      }
+
+      if (!SaveIndexLoc.empty() && !DoesFileExist(SaveIndexLoc)) {
+        LOG(LIB_INFO) << "Saving the index";
+        index_->SaveIndex(SaveIndexLoc);
+        LOG(LIB_INFO) << "The index is saved!";
+      }
+
+      if (!IndexBundleLoc.empty()) {
+        LOG(LIB_INFO) << "Saving the index bundle";
+        IndexBundle::Save(IndexBundleLoc, SpaceType, SpaceParams, methName_, dataSet_, externIds_, *index_);
+        LOG(LIB_INFO) << "The index bundle is saved!";
+      }
     }
 
-    if (!SaveIndexLoc.empty() && !DoesFileExist(SaveIndexLoc)) {
-      LOG(LIB_INFO) << "Saving the index";
-      index_->SaveIndex(SaveIndexLoc);
-      LOG(LIB_INFO) << "The index is saved!";
+    if (cacheReplyStr || !replyStrFile.empty()) {
+      initReplyStr(replyStrFile);
     }
 
     LOG(LIB_INFO) << "Setting query-time parameters";
     index_->SetQueryTimeParams(QueryTimeParams);
+    queryTimeParams_ = QueryTimeParams;
   }
 
   ~QueryServiceHandler() {
@@ -143,26 +241,7 @@ class QueryServiceHandler : virtual public QueryServiceIf {
 
   void setQueryTimeParams(const string& queryTimeParamStr) {
     try {
-      // Query time parameters are essentially spin-locked
-      while (true) {
-        for (size_t i = 0; i < MAX_SPIN_LOCK_QTY; ++i) {
-          unique_lock<mutex> lock(mtx_);
-          if (0 == counter_) {
-            vector<string>  desc;
-            ParseArg(queryTimeParamStr, desc);
-            if (debugPrint_) {
-              LOG(LIB_INFO) << "Setting query time parameters (" << queryTimeParamStr << ")";
-              for (string s: desc) {
-                LOG(LIB_INFO) << s;
-              }
-            }
-            index_->SetQueryTimeParams(AnyParams(desc));
-            return;
-          }
-        } // the lock will be released in the end of the block
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(SLEEP_DURATION));
-      }
+      changeQueryTimeParams(queryTimeParamStr, false);
     } catch (const exception& e) {
         QueryException qe;
         qe.__set_message(e.what());
@@ -192,64 +271,22 @@ class QueryServiceHandler : virtual public QueryServiceIf {
       RangeQuery<dist_t> range(*space_, queryObj.get(), r);
       index_->Search(&range, -1);
 
-      _return.clear();
-
       wtm.split();
 
       if (debugPrint_) {
         LOG(LIB_INFO) << "Finished in: " << wtm.elapsed() / 1e3f << " ms";
       }
 
-      vector<IdType> ids;
-      vector<double> dists;
-      vector<string> externIds;
-      vector<string> objs;
-
-     
-      if (debugPrint_) { 
-        LOG(LIB_INFO) << "Results: ";
-      }
-      
       const ObjectVector&     vResObjs  = *range.Result(); 
       const vector<dist_t>&   vResDists = *range.ResultDists();
 
+      // Entries are placed in the reverse order of the result
+      _return.resize(vResObjs.size());
       for (size_t i = 0; i < vResObjs.size(); ++i) {
-        const Object* pObj = vResObjs[i];
-        dist_t dist        = vResDists[i];
-
-        ReplyEntry e;
-
-        e.__set_id(pObj->id());
-        e.__set_dist(dist);
-
-        if (debugPrint_) {
-          ids.insert(ids.begin(), e.id);
-          dists.insert(dists.begin(), e.dist);
-        }
-
-        string externId;
-
-        if (retExternId || retObj) {
-          CHECK(e.id < externIds_.size());
-          externId = externIds_[e.id];
-          e.__set_externId(externId);
-          externIds.insert(externIds.begin(), e.externId);
-        }
-
-        if (retObj) {
-          const string& s = space_->CreateStrFromObj(pObj, externId);
-          e.__set_obj(s);
-          if (debugPrint_) {
-            objs.insert(objs.begin(), s);
-          }
-        }
-        _return.insert(_return.begin(), e);
+        fillReplyEntry(vResObjs[i], vResDists[i], retExternId, retObj, _return[vResObjs.size() - 1 - i]);
       }
       if (debugPrint_) {
-        for (size_t i = 0; i < ids.size(); ++i) {
-          LOG(LIB_INFO) << "id=" << ids[i] << " dist=" << dists[i] << ( retExternId ? " " + externIds[i] : string(""));
-          if (retObj) LOG(LIB_INFO) << objs[i]; 
-        }
+        logReply(_return, retExternId, retObj);
       }
     } catch (const exception& e) {
         QueryException qe;
@@ -312,9 +349,6 @@ class QueryServiceHandler : virtual public QueryServiceIf {
 
       KNNQuery<dist_t> knn(*space_, queryObj.get(), k);
       index_->Search(&knn, -1);
-      unique_ptr<KNNQueue<dist_t>> res(knn.Result()->Clone());
-
-      _return.clear();
 
       wtm.split();
 
@@ -322,54 +356,164 @@ class QueryServiceHandler : virtual public QueryServiceIf {
         LOG(LIB_INFO) << "Finished in: " << wtm.elapsed() / 1e3f << " ms";
       }
 
-      vector<IdType> ids;
-      vector<double> dists;
-      vector<string> objs;
-      vector<string> externIds;
-
-     
-      if (debugPrint_) { 
-        LOG(LIB_INFO) << "Results: ";
+      // Sampling is cheap: statistics are collected for every query anyways
+      uint64_t queryNum = knnQueryQty_.fetch_add(1) + 1;
+      if (debugPrint_ || (searchStatSample_ && queryNum % searchStatSample_ == 0)) {
+        LOG(LIB_INFO) << "Query #" << queryNum << " time: " << wtm.elapsed() / 1e3f << " ms"
+                      << " dist. comp: " << knn.DistanceComputations()
+                      << " traversal stat.: " << knn.GetSearchStat().ToString(1);
       }
 
-      while (!res->Empty()) {
-        const Object* topObj = res->TopObject();
-        dist_t topDist = res->TopDistance();
+      fillKNNReply(*knn.Result(), retExternId, retObj, _return);
+      if (debugPrint_) {
+        logReply(_return, retExternId, retObj);
+      }
+    } catch (const exception& e) {
+        QueryException qe;
+        qe.__set_message(e.what());
+        throw qe;
+    } catch (...) {
+        QueryException qe;
+        qe.__set_message("Unknown exception");
+        throw qe;
+    }
 
-        ReplyEntry e;
 
-        e.__set_id(topObj->id());
-        e.__set_dist(topDist);
+  }
 
-        if (debugPrint_) {
-          ids.insert(ids.begin(), e.id);
-          dists.insert(dists.begin(), e.dist);
-        }
+  void knnQueryBatch(vector<ReplyEntryList>& _return, const int32_t k, const vector<string>& queryObjStrs,
+                     const bool retExternId, const bool retObj, const string& queryTimeParamStr) {
+    knnQueryBatchImpl(_return, k, queryObjStrs.size(), [&](size_t i) {
+      return space_->CreateObjFromStr(0, -1, queryObjStrs[i], NULL);
+    }, retExternId, retObj, queryTimeParamStr);
+  }
 
-        string externId;
+  void knnQueryBatchBinary(vector<ReplyEntryList>& _return, const int32_t k, const vector<string>& queryObjs,
+                           const bool retExternId, const bool retObj, const string& queryTimeParamStr) {
+    knnQueryBatchImpl(_return, k, queryObjs.size(), [&](size_t i) {
+      return CreateObjFromBinary(space_.get(), queryObjs[i]);
+    }, retExternId, retObj, queryTimeParamStr);
+  }
 
-        if (retExternId || retObj) {
-          CHECK(e.id < externIds_.size());
-          externId = externIds_[e.id];
-          e.__set_externId(externId);
-          externIds.insert(externIds.begin(), e.externId);
+ private:
+  /*
+   * Waits until no query is running and sets query-time parameters. If holdCounter
+   * is true, the counter of running queries is increased before the lock is released:
+   * the caller must decrease it later (no parameter change can happen meanwhile).
+   */
+  void changeQueryTimeParams(const string& queryTimeParamStr, bool holdCounter) {
+    // Query time parameters are essentially spin-locked
+    while (true) {
+      for (size_t i = 0; i < MAX_SPIN_LOCK_QTY; ++i) {
+        unique_lock<mutex> lock(mtx_);
+        if (0 == counter_) {
+          vector<string>  desc;
+          ParseArg(queryTimeParamStr, desc);
+          if (debugPrint_) {
+            LOG(LIB_INFO) << "Setting query time parameters (" << queryTimeParamStr << ")";
+            for (string s: desc) {
+              LOG(LIB_INFO) << s;
+            }
+          }
+          AnyParams params(desc);
+          index_->SetQueryTimeParams(params);
+          if (holdCounter) {
+            // Parameters of a batch are temporary and are reverted by restoreQueryTimeParams
+            ++counter_;
+          } else {
+            queryTimeParams_ = params;
+          }
+          return;
         }
+      } // the lock will be released in the end of the block
 
-        if (retObj) {
-          const string& s = space_->CreateStrFromObj(topObj, externId);
-          e.__set_obj(s);
-          if (debugPrint_) {
-            objs.insert(objs.begin(), s);
+      std::this_thread::sleep_for(std::chrono::milliseconds(SLEEP_DURATION));
+    }
+  }
+
+  /*
+   * Releases the counter increased by changeQueryTimeParams(..., true) and restores
+   * query-time parameters set by the constructor or by setQueryTimeParams. This is done
+   * under the same lock once the caller is the only running query: no query can start
+   * with the parameters of the batch after the batch is finished.
+   */
+  void restoreQueryTimeParams() {
+    while (true) {
+      for (size_t i = 0; i < MAX_SPIN_LOCK_QTY; ++i) {
+        unique_lock<mutex> lock(mtx_);
+        if (1 == counter_) {
+          try {
+            index_->SetQueryTimeParams(queryTimeParams_);
+          } catch (const exception& e) {
+            LOG(LIB_ERROR) << "Cannot restore query time parameters: " << e.what();
           }
+          --counter_;
+          return;
         }
-        _return.insert(_return.begin(), e);
-        res->Pop();
+      } // the lock will be released in the end of the block
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(SLEEP_DURATION));
+    }
+  }
+
+  // Restores query-time parameters when a batch with its own parameters is finished
+  class BatchParamsGuard {
+  public:
+    explicit BatchParamsGuard(QueryServiceHandler& handler) : handler_(handler) {}
+    ~BatchParamsGuard() { handler_.restoreQueryTimeParams(); }
+  private:
+    QueryServiceHandler& handler_;
+  };
+
+  // Queries of the batch are executed by the pool, createQueryObj(i) creates the i-th query object
+  template <class CreateQueryObj>
+  void knnQueryBatchImpl(vector<ReplyEntryList>& _return, int32_t k, size_t queryQty,
+                         CreateQueryObj createQueryObj,
+                         bool retExternId, bool retObj, const string& queryTimeParamStr) {
+    try {
+      // This will prevent modification of query time parameters until the batch is finished.
+      // Parameters of the batch are in effect only while the batch is running.
+      unique_ptr<LockedCounterManager> mngr;
+      unique_ptr<BatchParamsGuard>     paramGuard;
+      if (queryTimeParamStr.empty()) {
+        mngr.reset(new LockedCounterManager(counter_, mtx_));
+      } else {
+        changeQueryTimeParams(queryTimeParamStr, true);
+        paramGuard.reset(new BatchParamsGuard(*this));
       }
+
       if (debugPrint_) {
-        for (size_t i = 0; i < ids.size(); ++i) {
-          LOG(LIB_INFO) << "id=" << ids[i] << " dist=" << dists[i] << ( retExternId ? " " + externIds[i] : string(""));
-          if (retObj) LOG(LIB_INFO) << objs[i]; 
+        LOG(LIB_INFO) << "Running a batch of " << queryQty << " " << k << "-NN queries"
+                      << " retExternId=" << retExternId << " retObj=" << retObj;
+      }
+      WallClockTimer wtm;
+
+      wtm.reset();
+
+      _return.assign(queryQty, ReplyEntryList());
+      batchPool_->ParallelFor(0, queryQty, [&](size_t i) {
+        WallClockTimer qtm;
+        qtm.reset();
+
+        unique_ptr<Object>  queryObj(createQueryObj(i));
+        KNNQuery<dist_t> knn(*space_, queryObj.get(), k);
+        index_->Search(&knn, -1);
+
+        qtm.split();
+        uint64_t queryNum = knnQueryQty_.fetch_add(1) + 1;
+        if (searchStatSample_ && queryNum % searchStatSample_ == 0) {
+          LOG(LIB_INFO) << "Query #" << queryNum << " time: " << qtm.elapsed() / 1e3f << " ms"
+                        << " dist. comp: " << knn.DistanceComputations()
+                        << " traversal stat.: " << knn.GetSearchStat().ToString(1);
         }
+
+        fillKNNReply(*knn.Result(), retExternId, retObj, _return[i]);
+      });
+
+      wtm.split();
+
+      if (debugPrint_) {
+        LOG(LIB_INFO) << "Finished in: " << wtm.elapsed() / 1e3f << " ms";
       }
     } catch (const exception& e) {
         QueryException qe;
@@ -380,13 +524,109 @@ class QueryServiceHandler : virtual public QueryServiceIf {
         qe.__set_message("Unknown exception");
         throw qe;
     }
+  }
+
+  // The queue is drained once: entries are placed from the farthest (the top) to the closest
+  void fillKNNReply(const KNNQueue<dist_t>& queue, bool retExternId, bool retObj, ReplyEntryList& reply) {
+    unique_ptr<KNNQueue<dist_t>> res(queue.Clone());
+    reply.resize(res->Size());
+    for (size_t i = reply.size(); i-- > 0; res->Pop()) {
+      fillReplyEntry(res->TopObject(), res->TopDistance(), retExternId, retObj, reply[i]);
+    }
+  }
 
+  void fillReplyEntry(const Object* obj, dist_t dist, bool retExternId, bool retObj, ReplyEntry& e) {
+    e.__set_id(obj->id());
+    e.__set_dist(dist);
+
+    if (!retExternId && !retObj) return;
+    CHECK(e.id >= 0 && static_cast<size_t>(e.id) < dataSet_.size());
+    if (replyStr_) {
+      // Strings are copied from the store without any formatting
+      e.externId.assign(replyStr_->data(2 * e.id), replyStr_->length(2 * e.id));
+      e.__isset.externId = true;
+      if (retObj) {
+        e.obj.assign(replyStr_->data(2 * e.id + 1), replyStr_->length(2 * e.id + 1));
+        e.__isset.obj = true;
+      }
+    } else {
+      e.__set_externId(externIds_[e.id]);
+      if (retObj) {
+        e.__set_obj(space_->CreateStrFromObj(obj, e.externId));
+      }
+    }
+  }
 
+  void logReply(const ReplyEntryList& reply, bool retExternId, bool retObj) {
+    LOG(LIB_INFO) << "Results: ";
+    for (const ReplyEntry& e : reply) {
+      LOG(LIB_INFO) << "id=" << e.id << " dist=" << e.dist << ( retExternId ? " " + e.externId : string(""));
+      if (retObj) LOG(LIB_INFO) << e.obj; 
+    }
+  }
+
+  /*
+   * Precomputes external IDs and string representations of data points: the 2i-th and
+   * the (2i+1)-th entries of the store belong to the i-th data point. If the location
+   * is given, the store is memory mapped from this file (unless the file is missing, can't
+   * be loaded, or its fingerprint doesn't match the data set, in which case, it is recomputed
+   * and saved). External IDs are then kept only in the store.
+   */
+  void initReplyStr(const string& location) {
+    const uint64_t fingerprint = computeDataFingerprint();
+    replyStr_.reset(new StringStore());
+    bool loaded = false;
+    if (!location.empty() && DoesFileExist(location)) {
+      try {
+        replyStr_->Load(location);
+        loaded = replyStr_->size() == 2 * dataSet_.size() && replyStr_->GetFingerprint() == fingerprint;
+      } catch (const exception& e) {
+        LOG(LIB_INFO) << "Failed to load the file " << location << ": " << e.what();
+      }
+      if (!loaded) {
+        LOG(LIB_INFO) << "The file " << location << " doesn't match the data set, strings are recomputed";
+      }
+    }
+    if (!loaded) {
+      LOG(LIB_INFO) << "Precomputing string representations of data points";
+      replyStr_->Build(2 * dataSet_.size(), [&](size_t i) {
+        return i % 2 ? space_->CreateStrFromObj(dataSet_[i / 2], externIds_[i / 2]) : externIds_[i / 2];
+      });
+      replyStr_->SetFingerprint(fingerprint);
+      if (!location.empty()) replyStr_->Save(location);
+    }
+    vector<string>().swap(externIds_);
+  }
+
+  /*
+   * The 64-bit FNV-1a hash of the space description, serialized data points, and
+   * their external IDs. String representations are determined by these, so a stored
+   * copy is reused only if the fingerprint is the same.
+   */
+  uint64_t computeDataFingerprint() const {
+    uint64_t hash = 14695981039346656037ULL;
+    auto     update = [&hash](const char* data, size_t len) {
+      for (size_t i = 0; i < len; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+      }
+    };
+    auto     updateStr = [&update](const string& s) {
+      uint64_t len = s.size();
+      update(reinterpret_cast<const char*>(&len), sizeof(len));
+      update(s.data(), s.size());
+    };
+    updateStr(space_->StrDesc());
+    for (const Object* pObj : dataSet_) update(pObj->buffer(), pObj->bufferlength());
+    for (const string& id : externIds_) updateStr(id);
+    return hash;
   }
 
- private:
   bool                        debugPrint_;
+  unsigned                    searchStatSample_;
   string                      methName_;
+  // Loaded data points point to the bundle, so it is destroyed last
+  unique_ptr<IndexBundle>     bundle_;
   unique_ptr<Space<dist_t>>   space_;
   unique_ptr<Index<dist_t>>   index_;
   vector<string>              externIds_;
@@ -394,6 +634,323 @@ class QueryServiceHandler : virtual public QueryServiceIf {
 
   int                         counter_; 
   mutex                       mtx_;
+  // Query-time parameters restored after a batch with its own parameters (guarded by mtx_)
+  AnyParams                   queryTimeParams_;
+
+  std::atomic<uint64_t>       knnQueryQty_;
+  unique_ptr<ThreadPool>      batchPool_;
+  unique_ptr<StringStore>     replyStr_;
+};
+
+/*
+ * A router sends each query to all backend query servers (each of which
+ * typically holds one shard of the data) concurrently and merges their replies.
+ * The merged list is sorted by the distance. For k-NN queries, only the global
+ * top-k entries are returned.
+ *
+ * Object IDs are assigned by backends (an ID is the position of the object in the
+ * backend's data file), so the ID of each reply entry is increased by idOffset of the backend.
+ * If shard data files are consecutive chunks of one data file, offsets can be selected so that
+ * IDs become positions in the original file.
+ *
+ * Thrift clients aren't thread-safe, hence, each backend has a pool of idle connections.
+ * A connection is discarded after a transport error or a timeout. Note that the timeout
+ * applies to each socket operation (connecting, sending, and receiving) rather than to the whole call.
+ */
+class QueryRouterHandler : virtual public QueryServiceIf {
+ public:
+  QueryRouterHandler(bool                  debugPrint,
+                     const vector<string>& backendDesc,
+                     unsigned              shardTimeout,
+                     bool                  partialResults,
+                     size_t                threadQty) :
+    debugPrint_(debugPrint),
+    shardTimeout_(shardTimeout),
+    partialResults_(partialResults)
+  {
+    CHECK_MSG(!backendDesc.empty(), "There should be at least one backend");
+    for (const string& desc : backendDesc) {
+      vector<string> parts;
+      CHECK_MSG(SplitStr(desc, parts, ':') && (parts.size() == 2 || parts.size() == 3) && !parts[0].empty(),
+                "Invalid backend description '" + desc + "', expected host:port[:idOffset]");
+      unique_ptr<Backend> backend(new Backend());
+      backend->desc = desc;
+      backend->host = parts[0];
+      ConvertFromString(parts[1], backend->port);
+      if (parts.size() == 3) ConvertFromString(parts[2], backend->idOffset);
+      LOG(LIB_INFO) << "Backend: " << backend->host << ":" << backend->port << " ID offset: " << backend->idOffset;
+      backends_.push_back(std::move(backend));
+    }
+    /*
+     * Each request-handling thread may wait for all backends but one
+     * (the request-handling thread itself queries one backend).
+     */
+    pool_.reset(new ThreadPool(threadQty * (backends_.size() - 1)));
+  }
+
+  void setQueryTimeParams(const string& queryTimeParamStr) {
+    try {
+      if (debugPrint_) {
+        LOG(LIB_INFO) << "Setting query time parameters (" << queryTimeParamStr << ") for all backends";
+      }
+      vector<ReplyEntryList> replies;
+      // Parameters must be changed everywhere, so partial success isn't accepted
+      fanOut([&](QueryServiceClient& client, ReplyEntryList&) {
+        client.setQueryTimeParams(queryTimeParamStr);
+      }, false, replies);
+    } catch (const QueryException&) {
+      throw;
+    } catch (const exception& e) {
+        QueryException qe;
+        qe.__set_message(e.what());
+        throw qe;
+    }
+  }
+
+  void rangeQuery(ReplyEntryList& _return, const double r, const string& queryObjStr,
+                  const bool retExternId, const bool retObj) {
+    try {
+      if (debugPrint_) {
+        LOG(LIB_INFO) << "Routing a range query, r=" << r << " retExternId=" << retExternId << " retObj=" << retObj;
+      }
+      vector<ReplyEntryList> replies;
+      fanOut([&](QueryServiceClient& client, ReplyEntryList& reply) {
+        client.rangeQuery(reply, r, queryObjStr, retExternId, retObj);
+      }, partialResults_, replies);
+      mergeReplies(replies, std::numeric_limits<size_t>::max(), _return);
+    } catch (const QueryException&) {
+      throw;
+    } catch (const exception& e) {
+        QueryException qe;
+        qe.__set_message(e.what());
+        throw qe;
+    }
+  }
+
+  void knnQuery(ReplyEntryList& _return, const int32_t k,
+                const std::string& queryObjStr, const bool retExternId, const bool retObj) {
+    try {
+      if (debugPrint_) {
+        LOG(LIB_INFO) << "Routing a " << k << "-NN query" << " retExternId=" << retExternId << " retObj=" << retObj;
+      }
+      WallClockTimer wtm;
+      wtm.reset();
+
+      vector<ReplyEntryList> replies;
+      fanOut([&](QueryServiceClient& client, ReplyEntryList& reply) {
+        client.knnQuery(reply, k, queryObjStr, retExternId, retObj);
+      }, partialResults_, replies);
+      mergeReplies(replies, std::max(k, 0), _return);
+
+      wtm.split();
+      if (debugPrint_) {
+        LOG(LIB_INFO) << "Finished in: " << wtm.elapsed() / 1e3f << " ms";
+        for (const ReplyEntry& e : _return) {
+          LOG(LIB_INFO) << "id=" << e.id << " dist=" << e.dist << (e.__isset.externId ? " " + e.externId : string(""));
+        }
+      }
+    } catch (const QueryException&) {
+      throw;
+    } catch (const exception& e) {
+        QueryException qe;
+        qe.__set_message(e.what());
+        throw qe;
+    }
+  }
+
+  void knnQueryBatch(vector<ReplyEntryList>& _return, const int32_t k, const vector<string>& queryObjStrs,
+                     const bool retExternId, const bool retObj, const string& queryTimeParamStr) {
+    routeKNNQueryBatch(_return, k, queryObjStrs.size(),
+                       [&](QueryServiceClient& client, vector<ReplyEntryList>& reply) {
+      client.knnQueryBatch(reply, k, queryObjStrs, retExternId, retObj, queryTimeParamStr);
+    });
+  }
+
+  // Binary queries are forwarded as is
+  void knnQueryBatchBinary(vector<ReplyEntryList>& _return, const int32_t k, const vector<string>& queryObjs,
+                           const bool retExternId, const bool retObj, const string& queryTimeParamStr) {
+    routeKNNQueryBatch(_return, k, queryObjs.size(),
+                       [&](QueryServiceClient& client, vector<ReplyEntryList>& reply) {
+      client.knnQueryBatchBinary(reply, k, queryObjs, retExternId, retObj, queryTimeParamStr);
+    });
+  }
+
+  // All backends use the same space, so any of them can compute the distance
+  double getDistance(const std::string& objStr1, const std::string& objStr2) {
+    try {
+      Backend&               backend = *backends_[0];
+      unique_ptr<Connection> conn = acquire(backend);
+      double                 res;
+      try {
+        res = conn->client->getDistance(objStr1, objStr2);
+      } catch (const QueryException&) {
+        release(backend, std::move(conn));
+        throw;
+      }
+      release(backend, std::move(conn));
+      return res;
+    } catch (const QueryException&) {
+      throw;
+    } catch (const exception& e) {
+        QueryException qe;
+        qe.__set_message(e.what());
+        throw qe;
+    }
+  }
+
+ private:
+  struct Connection {
+    boost::shared_ptr<TTransport>   transport;
+    unique_ptr<QueryServiceClient>  client;
+  };
+
+  struct Backend {
+    string                          desc;
+    string                          host;
+    int                             port = 0;
+    int32_t                         idOffset = 0;
+    mutex                           mtx;
+    vector<unique_ptr<Connection>>  idle;
+  };
+
+  unique_ptr<Connection> acquire(Backend& backend) {
+    {
+      unique_lock<mutex> lock(backend.mtx);
+      if (!backend.idle.empty()) {
+        unique_ptr<Connection> conn = std::move(backend.idle.back());
+        backend.idle.pop_back();
+        return conn;
+      }
+    }
+    boost::shared_ptr<TSocket> socket(new TSocket(backend.host, backend.port));
+    socket->setConnTimeout(shardTimeout_);
+    socket->setSendTimeout(shardTimeout_);
+    socket->setRecvTimeout(shardTimeout_);
+    unique_ptr<Connection> conn(new Connection());
+    conn->transport.reset(new TBufferedTransport(socket));
+    boost::shared_ptr<TProtocol> protocol(new TBinaryProtocol(conn->transport));
+    conn->client.reset(new QueryServiceClient(protocol));
+    conn->transport->open();
+    return conn;
+  }
+
+  void release(Backend& backend, unique_ptr<Connection> conn) {
+    unique_lock<mutex> lock(backend.mtx);
+    backend.idle.push_back(std::move(conn));
+  }
+
+  // Each backend receives the whole batch, results are merged query by query
+  template <class Call>
+  void routeKNNQueryBatch(vector<ReplyEntryList>& _return, int32_t k, size_t queryQty, Call call) {
+    try {
+      if (debugPrint_) {
+        LOG(LIB_INFO) << "Routing a batch of " << queryQty << " " << k << "-NN queries";
+      }
+      WallClockTimer wtm;
+      wtm.reset();
+
+      vector<vector<ReplyEntryList>> replies;
+      fanOut(call, partialResults_, replies);
+      for (size_t i = 0; i < backends_.size(); ++i) {
+        // Failed backends have empty replies
+        CHECK_MSG(replies[i].empty() || replies[i].size() == queryQty,
+                  "Backend " + backends_[i]->desc + " returned an incomplete batch reply");
+      }
+      _return.resize(queryQty);
+      vector<ReplyEntryList> queryReplies(backends_.size());
+      for (size_t q = 0; q < queryQty; ++q) {
+        for (size_t i = 0; i < backends_.size(); ++i) {
+          queryReplies[i].clear();
+          if (!replies[i].empty()) queryReplies[i].swap(replies[i][q]);
+        }
+        mergeReplies(queryReplies, std::max(k, 0), _return[q]);
+      }
+
+      wtm.split();
+      if (debugPrint_) {
+        LOG(LIB_INFO) << "Finished in: " << wtm.elapsed() / 1e3f << " ms";
+      }
+    } catch (const QueryException&) {
+      throw;
+    } catch (const exception& e) {
+        QueryException qe;
+        qe.__set_message(e.what());
+        throw qe;
+    }
+  }
+
+  static void shiftIds(ReplyEntryList& reply, int32_t idOffset) {
+    for (ReplyEntry& e : reply) e.id += idOffset;
+  }
+
+  static void shiftIds(vector<ReplyEntryList>& replies, int32_t idOffset) {
+    for (ReplyEntryList& reply : replies) shiftIds(reply, idOffset);
+  }
+
+  /*
+   * Calls call(client, replies[i]) for every backend i concurrently.
+   * IDs in replies are shifted by backend offsets. If a backend fails and
+   * partialResults is true, its reply is empty, unless all backends fail.
+   */
+  template <class Call, class Reply>
+  void fanOut(Call call, bool partialResults, vector<Reply>& replies) {
+    replies.assign(backends_.size(), Reply());
+    vector<string> errors(backends_.size());
+    pool_->ParallelFor(0, backends_.size(), [&](size_t i) {
+      Backend& backend = *backends_[i];
+      try {
+        unique_ptr<Connection> conn = acquire(backend);
+        try {
+          call(*conn->client, replies[i]);
+        } catch (const QueryException&) {
+          // The backend has reported an error, but the connection is still usable
+          release(backend, std::move(conn));
+          throw;
+        }
+        release(backend, std::move(conn));
+        shiftIds(replies[i], backend.idOffset);
+      } catch (const QueryException& e) {
+        errors[i] = e.message;
+      } catch (const exception& e) {
+        errors[i] = e.what();
+      }
+    });
+
+    size_t failQty = 0;
+    for (size_t i = 0; i < backends_.size(); ++i) {
+      if (errors[i].empty()) continue;
+      ++failQty;
+      replies[i].clear();
+      string msg = "Backend " + backends_[i]->desc + " failed: " + errors[i];
+      if (!partialResults || failQty == backends_.size()) throw runtime_error(msg);
+      LOG(LIB_WARNING) << msg;
+    }
+  }
+
+  /*
+   * Merges replies and keeps at most maxQty closest entries. Replies to k-NN queries
+   * are already sorted by the distance, but replies to range queries aren't.
+   */
+  static void mergeReplies(vector<ReplyEntryList>& replies, size_t maxQty, ReplyEntryList& _return) {
+    auto distLess = [](const ReplyEntry& e1, const ReplyEntry& e2) { return e1.dist < e2.dist; };
+    _return.clear();
+    size_t totalQty = 0;
+    for (const ReplyEntryList& reply : replies) totalQty += reply.size();
+    _return.reserve(totalQty);
+    for (ReplyEntryList& reply : replies) {
+      if (!std::is_sorted(reply.begin(), reply.end(), distLess)) std::sort(reply.begin(), reply.end(), distLess);
+      size_t mid = _return.size();
+      std::move(reply.begin(), reply.end(), std::back_inserter(_return));
+      std::inplace_merge(_return.begin(), _return.begin() + mid, _return.end(), distLess);
+    }
+    if (_return.size() > maxQty) _return.resize(maxQty);
+  }
+
+  bool                        debugPrint_;
+  unsigned                    shardTimeout_;
+  bool                        partialResults_;
+  vector<unique_ptr<Backend>> backends_;
+  unique_ptr<ThreadPool>      pool_;
 };
 
 namespace po = boost::program_options;
@@ -406,8 +963,10 @@ static void Usage(const char *prog,
 
 void ParseCommandLineForServer(int argc, char*argv[],
                       bool&                   debugPrint,
+                      unsigned&               searchStatSample,
                       string&                 LoadIndexLoc,
                       string&                 SaveIndexLoc,
+                      string&                 IndexBundleLoc,
                       int&                    port,
                       size_t&                 threadQty,
                       string&                 LogFile,
@@ -418,13 +977,20 @@ void ParseCommandLineForServer(int argc, char*argv[],
                       unsigned&               MaxNumData,
                       string&                         MethodName,
                       std::shared_ptr<AnyParams>&     IndexTimeParams,
-                      std::shared_ptr<AnyParams>&     QueryTimeParams) {
+                      std::shared_ptr<AnyParams>&     QueryTimeParams,
+                      vector<string>&         Backends,
+                      unsigned&               shardTimeout,
+                      bool&                   partialResults,
+                      size_t&                 batchThreadQty,
+                      bool&                   cacheReplyStr,
+                      string&                 replyStrFile) {
   string          methParams;
   size_t          defaultThreadQty = THREAD_COEFF * thread::hardware_concurrency();
 
   string          indexTimeParamStr;
   string          queryTimeParamStr;
   string          spaceParamStr;
+  string          backendsStr;
 
   po::options_description ProgOptDesc("Allowed options");
   ProgOptDesc.add_options()
@@ -432,16 +998,24 @@ void ParseCommandLineForServer(int argc, char*argv[],
     (DEBUG_PARAM_OPT.c_str(),         po::bool_switch(&debugPrint), DEBUG_PARAM_MSG.c_str())
     (PORT_PARAM_OPT.c_str(),          po::value<int>(&port)->required(), PORT_PARAM_MSG.c_str())
     (THREAD_PARAM_OPT.c_str(),        po::value<size_t>(&threadQty)->default_value(defaultThreadQty), THREAD_PARAM_MSG.c_str())
+    (SEARCH_STAT_SAMPLE_PARAM_OPT.c_str(), po::value<unsigned>(&searchStatSample)->default_value(SEARCH_STAT_SAMPLE_PARAM_DEFAULT), SEARCH_STAT_SAMPLE_PARAM_MSG.c_str())
     (LOG_FILE_PARAM_OPT.c_str(),      po::value<string>(&LogFile)->default_value(LOG_FILE_PARAM_DEFAULT), LOG_FILE_PARAM_MSG.c_str())
-    (SPACE_TYPE_PARAM_OPT.c_str(),    po::value<string>(&spaceParamStr)->required(),                SPACE_TYPE_PARAM_MSG.c_str())
+    (SPACE_TYPE_PARAM_OPT.c_str(),    po::value<string>(&spaceParamStr)->default_value(""),         SPACE_TYPE_PARAM_MSG.c_str())
     (DIST_TYPE_PARAM_OPT.c_str(),     po::value<string>(&DistType)->default_value(DIST_TYPE_FLOAT), DIST_TYPE_PARAM_MSG.c_str())
-    (DATA_FILE_PARAM_OPT.c_str(),     po::value<string>(&DataFile)->required(),                     DATA_FILE_PARAM_MSG.c_str())
+    (DATA_FILE_PARAM_OPT.c_str(),     po::value<string>(&DataFile)->default_value(""),              DATA_FILE_PARAM_MSG.c_str())
     (MAX_NUM_DATA_PARAM_OPT.c_str(),  po::value<unsigned>(&MaxNumData)->default_value(MAX_NUM_DATA_PARAM_DEFAULT), MAX_NUM_DATA_PARAM_MSG.c_str())
     (METHOD_PARAM_OPT.c_str(),        po::value<string>(&MethodName)->default_value(METHOD_PARAM_DEFAULT), METHOD_PARAM_MSG.c_str())
     (LOAD_INDEX_PARAM_OPT.c_str(),    po::value<string>(&LoadIndexLoc)->default_value(LOAD_INDEX_PARAM_DEFAULT),   LOAD_INDEX_PARAM_MSG.c_str())
     (SAVE_INDEX_PARAM_OPT.c_str(),    po::value<string>(&SaveIndexLoc)->default_value(SAVE_INDEX_PARAM_DEFAULT),   SAVE_INDEX_PARAM_MSG.c_str())
+    (INDEX_BUNDLE_PARAM_OPT.c_str(),  po::value<string>(&IndexBundleLoc)->default_value(""),        INDEX_BUNDLE_PARAM_MSG.c_str())
     (QUERY_TIME_PARAMS_PARAM_OPT.c_str(), po::value<string>(&queryTimeParamStr)->default_value(""), QUERY_TIME_PARAMS_PARAM_MSG.c_str())
     (INDEX_TIME_PARAMS_PARAM_OPT.c_str(), po::value<string>(&indexTimeParamStr)->default_value(""), INDEX_TIME_PARAMS_PARAM_MSG.c_str())
+    (BACKENDS_PARAM_OPT.c_str(),      po::value<string>(&backendsStr)->default_value(""),           BACKENDS_PARAM_MSG.c_str())
+    (SHARD_TIMEOUT_PARAM_OPT.c_str(), po::value<unsigned>(&shardTimeout)->default_value(SHARD_TIMEOUT_PARAM_DEFAULT), SHARD_TIMEOUT_PARAM_MSG.c_str())
+    (PARTIAL_RESULTS_PARAM_OPT.c_str(), po::bool_switch(&partialResults), PARTIAL_RESULTS_PARAM_MSG.c_str())
+    (BATCH_THREAD_QTY_PARAM_OPT.c_str(), po::value<size_t>(&batchThreadQty)->default_value(BATCH_THREAD_QTY_PARAM_DEFAULT), BATCH_THREAD_QTY_PARAM_MSG.c_str())
+    (CACHE_REPLY_STR_PARAM_OPT.c_str(), po::bool_switch(&cacheReplyStr), CACHE_REPLY_STR_PARAM_MSG.c_str())
+    (REPLY_STR_FILE_PARAM_OPT.c_str(), po::value<string>(&replyStrFile)->default_value(""),       REPLY_STR_FILE_PARAM_MSG.c_str())
     ;
 
   po::variables_map vm;
@@ -458,7 +1032,10 @@ void ParseCommandLineForServer(int argc, char*argv[],
     exit(0);
   }
 
-  if (vm.count("method") != 1) {
+  // An existing index bundle provides the space, the method, and the data
+  const bool fromBundle = !IndexBundleLoc.empty() && DoesFileExist(IndexBundleLoc);
+
+  if (vm.count("method") != 1 && !fromBundle) {
     Usage(argv[0], ProgOptDesc);
     LOG(LIB_FATAL) << "There should be exactly one method specified!";
   }
@@ -466,11 +1043,24 @@ void ParseCommandLineForServer(int argc, char*argv[],
   ToLower(DistType);
   ToLower(spaceParamStr);
   ToLower(MethodName);
+
+  if (!batchThreadQty) batchThreadQty = thread::hardware_concurrency();
  
   try {
+    if (!SplitStr(backendsStr, Backends, ',')) {
+      LOG(LIB_FATAL) << "Cannot parse the list of backends: " << backendsStr;
+    }
+    // The router doesn't load any data
+    if (!Backends.empty()) return;
+
+    if (spaceParamStr.empty() && !fromBundle) {
+      Usage(argv[0], ProgOptDesc);
+      LOG(LIB_FATAL) << "space type is not specified!";
+    }
+
     {
       vector<string>     desc;
-      ParseSpaceArg(spaceParamStr, SpaceType, desc);
+      if (!spaceParamStr.empty()) ParseSpaceArg(spaceParamStr, SpaceType, desc);
       SpaceParams = shared_ptr<AnyParams>(new AnyParams(desc));
     }
 
@@ -487,6 +1077,8 @@ void ParseCommandLineForServer(int argc, char*argv[],
       QueryTimeParams = shared_ptr<AnyParams>(new AnyParams(desc));
     }
     
+    if (fromBundle) return;
+
     if (DataFile.empty()) {
       LOG(LIB_FATAL) << "data file is not specified!";
     }
@@ -501,6 +1093,7 @@ void ParseCommandLineForServer(int argc, char*argv[],
 
 int main(int argc, char *argv[]) {
   bool        debugPrint = 0;
+  unsigned    searchStatSample = 0;
   int         port = 0;
   size_t      threadQty = 0;
   string      LogFile;
@@ -516,11 +1109,21 @@ int main(int argc, char *argv[]) {
 
   string      LoadIndexLoc;
   string      SaveIndexLoc;
+  string      IndexBundleLoc;
+
+  vector<string>  Backends;
+  unsigned        shardTimeout = 0;
+  bool            partialResults = false;
+  size_t          batchThreadQty = 0;
+  bool            cacheReplyStr = false;
+  string          replyStrFile;
 
   ParseCommandLineForServer(argc, argv,
                       debugPrint,
+                      searchStatSample,
                       LoadIndexLoc,
                       SaveIndexLoc,
+                      IndexBundleLoc,
                       port,
                       threadQty,
                       LogFile,
@@ -531,17 +1134,39 @@ int main(int argc, char *argv[]) {
                       MaxNumData,
                       MethodName,
                       IndexParams,
-                      QueryTimeParams
+                      QueryTimeParams,
+                      Backends,
+                      shardTimeout,
+                      partialResults,
+                      batchThreadQty,
+                      cacheReplyStr,
+                      replyStrFile
   );
 
   initLibrary(0, LogFile.empty() ? LIB_LOGSTDERR:LIB_LOGFILE, LogFile.c_str());
+  // Request-handling threads shouldn't wait for each other while logging
+  EnableAsyncLogging();
 
+  if (Backends.empty() && !IndexBundleLoc.empty() && DoesFileExist(IndexBundleLoc)) {
+    try {
+      DistType = IndexBundle(IndexBundleLoc).GetDistType();
+    } catch (const exception& e) {
+      LOG(LIB_FATAL) << "Exception: " << e.what();
+    }
+  }
   ToLower(DistType);
 
   unique_ptr<QueryServiceIf>   queryHandler;
 
-  if (DIST_TYPE_INT == DistType) {
+  if (!Backends.empty()) {
+    queryHandler.reset(new QueryRouterHandler(debugPrint,
+                                              Backends,
+                                              shardTimeout,
+                                              partialResults,
+                                              threadQty));
+  } else if (DIST_TYPE_INT == DistType) {
     queryHandler.reset(new QueryServiceHandler<int>(debugPrint,
+                                                    searchStatSample,
                                                     SpaceType,
                                                     *SpaceParams,
                                                     DataFile,
@@ -549,10 +1174,15 @@ int main(int argc, char *argv[]) {
                                                     MethodName,
                                                     LoadIndexLoc,
                                                     SaveIndexLoc,
+                                                    IndexBundleLoc,
                                                     *IndexParams,
-                                                    *QueryTimeParams));
+                                                    *QueryTimeParams,
+                                                    batchThreadQty,
+                                                    cacheReplyStr,
+                                                    replyStrFile));
   } else if (DIST_TYPE_FLOAT == DistType) {
     queryHandler.reset(new QueryServiceHandler<float>(debugPrint,
+                                                    searchStatSample,
                                                     SpaceType,
                                                     *SpaceParams,
                                                     DataFile,
@@ -560,10 +1190,15 @@ int main(int argc, char *argv[]) {
                                                     MethodName,
                                                     LoadIndexLoc,
                                                     SaveIndexLoc,
+                                                    IndexBundleLoc,
                                                     *IndexParams,
-                                                    *QueryTimeParams));
+                                                    *QueryTimeParams,
+                                                    batchThreadQty,
+                                                    cacheReplyStr,
+                                                    replyStrFile));
   } else if (DIST_TYPE_DOUBLE == DistType) {
     queryHandler.reset(new QueryServiceHandler<double>(debugPrint,
+                                                    searchStatSample,
                                                     SpaceType,
                                                     *SpaceParams,
                                                     DataFile,
@@ -571,8 +1206,12 @@ int main(int argc, char *argv[]) {
                                                     MethodName,
                                                     LoadIndexLoc,
                                                     SaveIndexLoc,
+                                                    IndexBundleLoc,
                                                     *IndexParams,
-                                                    *QueryTimeParams));
+                                                    *QueryTimeParams,
+                                                    batchThreadQty,
+                                                    cacheReplyStr,
+                                                    replyStrFile));
   
   } else {
     LOG(LIB_FATAL) << "Unknown distance value type: " << DistType;
@@ -19,6 +19,8 @@ class QueryServiceIf {
   virtual void knnQuery(ReplyEntryList& _return, const int32_t k, const std::string& queryObj, const bool retExternId, const bool retObj) = 0;
   virtual void rangeQuery(ReplyEntryList& _return, const double r, const std::string& queryObj, const bool retExternId, const bool retObj) = 0;
   virtual double getDistance(const std::string& obj1, const std::string& obj2) = 0;
+  virtual void knnQueryBatch(std::vector<ReplyEntryList> & _return, const int32_t k, const std::vector<std::string> & queryObj, const bool retExternId, const bool retObj, const std::string& queryTimeParams) = 0;
+  virtual void knnQueryBatchBinary(std::vector<ReplyEntryList> & _return, const int32_t k, const std::vector<std::string> & queryObj, const bool retExternId, const bool retObj, const std::string& queryTimeParams) = 0;
 };
 
 class QueryServiceIfFactory {
@@ -61,6 +63,12 @@ class QueryServiceNull : virtual public QueryServiceIf {
     double _return = (double)0;
     return _return;
   }
+  void knnQueryBatch(std::vector<ReplyEntryList> & /* _return */, const int32_t /* k */, const std::vector<std::string> & /* queryObj */, const bool /* retExternId */, const bool /* retObj */, const std::string& /* queryTimeParams */) {
+    return;
+  }
+  void knnQueryBatchBinary(std::vector<ReplyEntryList> & /* _return */, const int32_t /* k */, const std::vector<std::string> & /* queryObj */, const bool /* retExternId */, const bool /* retObj */, const std::string& /* queryTimeParams */) {
+    return;
+  }
 };
 
 
@@ -585,6 +593,298 @@ class QueryService_getDistance_presult {
   friend std::ostream& operator<<(std::ostream& out, const QueryService_getDistance_presult& obj);
 };
 
+
+class QueryService_knnQueryBatch_args {
+ public:
+
+  static const char* ascii_fingerprint; // = "AB8DE8417D8B06C4A403B695251C811A";
+  static const uint8_t binary_fingerprint[16]; // = {0xAB,0x8D,0xE8,0x41,0x7D,0x8B,0x06,0xC4,0xA4,0x03,0xB6,0x95,0x25,0x1C,0x81,0x1A};
+
+  QueryService_knnQueryBatch_args(const QueryService_knnQueryBatch_args&);
+  QueryService_knnQueryBatch_args& operator=(const QueryService_knnQueryBatch_args&);
+  QueryService_knnQueryBatch_args() : k(0), retExternId(0), retObj(0), queryTimeParams() {
+  }
+
+  virtual ~QueryService_knnQueryBatch_args() throw();
+  int32_t k;
+  std::vector<std::string>  queryObj;
+  bool retExternId;
+  bool retObj;
+  std::string queryTimeParams;
+
+  void __set_k(const int32_t val);
+
+  void __set_queryObj(const std::vector<std::string> & val);
+
+  void __set_retExternId(const bool val);
+
+  void __set_retObj(const bool val);
+
+  void __set_queryTimeParams(const std::string& val);
+
+  bool operator == (const QueryService_knnQueryBatch_args & rhs) const
+  {
+    if (!(k == rhs.k))
+      return false;
+    if (!(queryObj == rhs.queryObj))
+      return false;
+    if (!(retExternId == rhs.retExternId))
+      return false;
+    if (!(retObj == rhs.retObj))
+      return false;
+    if (!(queryTimeParams == rhs.queryTimeParams))
+      return false;
+    return true;
+  }
+  bool operator != (const QueryService_knnQueryBatch_args &rhs) const {
+    return !(*this == rhs);
+  }
+
+  bool operator < (const QueryService_knnQueryBatch_args & ) const;
+
+  uint32_t read(::apache::thrift::protocol::TProtocol* iprot);
+  uint32_t write(::apache::thrift::protocol::TProtocol* oprot) const;
+
+  friend std::ostream& operator<<(std::ostream& out, const QueryService_knnQueryBatch_args& obj);
+};
+
+
+class QueryService_knnQueryBatch_pargs {
+ public:
+
+  static const char* ascii_fingerprint; // = "AB8DE8417D8B06C4A403B695251C811A";
+  static const uint8_t binary_fingerprint[16]; // = {0xAB,0x8D,0xE8,0x41,0x7D,0x8B,0x06,0xC4,0xA4,0x03,0xB6,0x95,0x25,0x1C,0x81,0x1A};
+
+
+  virtual ~QueryService_knnQueryBatch_pargs() throw();
+  const int32_t* k;
+  const std::vector<std::string> * queryObj;
+  const bool* retExternId;
+  const bool* retObj;
+  const std::string* queryTimeParams;
+
+  uint32_t write(::apache::thrift::protocol::TProtocol* oprot) const;
+
+  friend std::ostream& operator<<(std::ostream& out, const QueryService_knnQueryBatch_pargs& obj);
+};
+
+typedef struct _QueryService_knnQueryBatch_result__isset {
+  _QueryService_knnQueryBatch_result__isset() : success(false), err(false) {}
+  bool success :1;
+  bool err :1;
+} _QueryService_knnQueryBatch_result__isset;
+
+class QueryService_knnQueryBatch_result {
+ public:
+
+  static const char* ascii_fingerprint; // = "49B56A9B90B040D6FB7E6150C599DE1B";
+  static const uint8_t binary_fingerprint[16]; // = {0x49,0xB5,0x6A,0x9B,0x90,0xB0,0x40,0xD6,0xFB,0x7E,0x61,0x50,0xC5,0x99,0xDE,0x1B};
+
+  QueryService_knnQueryBatch_result(const QueryService_knnQueryBatch_result&);
+  QueryService_knnQueryBatch_result& operator=(const QueryService_knnQueryBatch_result&);
+  QueryService_knnQueryBatch_result() {
+  }
+
+  virtual ~QueryService_knnQueryBatch_result() throw();
+  std::vector<ReplyEntryList>  success;
+  QueryException err;
+
+  _QueryService_knnQueryBatch_result__isset __isset;
+
+  void __set_success(const std::vector<ReplyEntryList> & val);
+
+  void __set_err(const QueryException& val);
+
+  bool operator == (const QueryService_knnQueryBatch_result & rhs) const
+  {
+    if (!(success == rhs.success))
+      return false;
+    if (!(err == rhs.err))
+      return false;
+    return true;
+  }
+  bool operator != (const QueryService_knnQueryBatch_result &rhs) const {
+    return !(*this == rhs);
+  }
+
+  bool operator < (const QueryService_knnQueryBatch_result & ) const;
+
+  uint32_t read(::apache::thrift::protocol::TProtocol* iprot);
+  uint32_t write(::apache::thrift::protocol::TProtocol* oprot) const;
+
+  friend std::ostream& operator<<(std::ostream& out, const QueryService_knnQueryBatch_result& obj);
+};
+
+typedef struct _QueryService_knnQueryBatch_presult__isset {
+  _QueryService_knnQueryBatch_presult__isset() : success(false), err(false) {}
+  bool success :1;
+  bool err :1;
+} _QueryService_knnQueryBatch_presult__isset;
+
+class QueryService_knnQueryBatch_presult {
+ public:
+
+  static const char* ascii_fingerprint; // = "49B56A9B90B040D6FB7E6150C599DE1B";
+  static const uint8_t binary_fingerprint[16]; // = {0x49,0xB5,0x6A,0x9B,0x90,0xB0,0x40,0xD6,0xFB,0x7E,0x61,0x50,0xC5,0x99,0xDE,0x1B};
+
+
+  virtual ~QueryService_knnQueryBatch_presult() throw();
+  std::vector<ReplyEntryList>  * success;
+  QueryException err;
+
+  _QueryService_knnQueryBatch_presult__isset __isset;
+
+  uint32_t read(::apache::thrift::protocol::TProtocol* iprot);
+
+  friend std::ostream& operator<<(std::ostream& out, const QueryService_knnQueryBatch_presult& obj);
+};
+
+
+class QueryService_knnQueryBatchBinary_args {
+ public:
+
+  static const char* ascii_fingerprint; // = "AB8DE8417D8B06C4A403B695251C811A";
+  static const uint8_t binary_fingerprint[16]; // = {0xAB,0x8D,0xE8,0x41,0x7D,0x8B,0x06,0xC4,0xA4,0x03,0xB6,0x95,0x25,0x1C,0x81,0x1A};
+
+  QueryService_knnQueryBatchBinary_args(const QueryService_knnQueryBatchBinary_args&);
+  QueryService_knnQueryBatchBinary_args& operator=(const QueryService_knnQueryBatchBinary_args&);
+  QueryService_knnQueryBatchBinary_args() : k(0), retExternId(0), retObj(0), queryTimeParams() {
+  }
+
+  virtual ~QueryService_knnQueryBatchBinary_args() throw();
+  int32_t k;
+  std::vector<std::string>  queryObj;
+  bool retExternId;
+  bool retObj;
+  std::string queryTimeParams;
+
+  void __set_k(const int32_t val);
+
+  void __set_queryObj(const std::vector<std::string> & val);
+
+  void __set_retExternId(const bool val);
+
+  void __set_retObj(const bool val);
+
+  void __set_queryTimeParams(const std::string& val);
+
+  bool operator == (const QueryService_knnQueryBatchBinary_args & rhs) const
+  {
+    if (!(k == rhs.k))
+      return false;
+    if (!(queryObj == rhs.queryObj))
+      return false;
+    if (!(retExternId == rhs.retExternId))
+      return false;
+    if (!(retObj == rhs.retObj))
+      return false;
+    if (!(queryTimeParams == rhs.queryTimeParams))
+      return false;
+    return true;
+  }
+  bool operator != (const QueryService_knnQueryBatchBinary_args &rhs) const {
+    return !(*this == rhs);
+  }
+
+  bool operator < (const QueryService_knnQueryBatchBinary_args & ) const;
+
+  uint32_t read(::apache::thrift::protocol::TProtocol* iprot);
+  uint32_t write(::apache::thrift::protocol::TProtocol* oprot) const;
+
+  friend std::ostream& operator<<(std::ostream& out, const QueryService_knnQueryBatchBinary_args& obj);
+};
+
+
+class QueryService_knnQueryBatchBinary_pargs {
+ public:
+
+  static const char* ascii_fingerprint; // = "AB8DE8417D8B06C4A403B695251C811A";
+  static const uint8_t binary_fingerprint[16]; // = {0xAB,0x8D,0xE8,0x41,0x7D,0x8B,0x06,0xC4,0xA4,0x03,0xB6,0x95,0x25,0x1C,0x81,0x1A};
+
+
+  virtual ~QueryService_knnQueryBatchBinary_pargs() throw();
+  const int32_t* k;
+  const std::vector<std::string> * queryObj;
+  const bool* retExternId;
+  const bool* retObj;
+  const std::string* queryTimeParams;
+
+  uint32_t write(::apache::thrift::protocol::TProtocol* oprot) const;
+
+  friend std::ostream& operator<<(std::ostream& out, const QueryService_knnQueryBatchBinary_pargs& obj);
+};
+
+typedef struct _QueryService_knnQueryBatchBinary_result__isset {
+  _QueryService_knnQueryBatchBinary_result__isset() : success(false), err(false) {}
+  bool success :1;
+  bool err :1;
+} _QueryService_knnQueryBatchBinary_result__isset;
+
+class QueryService_knnQueryBatchBinary_result {
+ public:
+
+  static const char* ascii_fingerprint; // = "49B56A9B90B040D6FB7E6150C599DE1B";
+  static const uint8_t binary_fingerprint[16]; // = {0x49,0xB5,0x6A,0x9B,0x90,0xB0,0x40,0xD6,0xFB,0x7E,0x61,0x50,0xC5,0x99,0xDE,0x1B};
+
+  QueryService_knnQueryBatchBinary_result(const QueryService_knnQueryBatchBinary_result&);
+  QueryService_knnQueryBatchBinary_result& operator=(const QueryService_knnQueryBatchBinary_result&);
+  QueryService_knnQueryBatchBinary_result() {
+  }
+
+  virtual ~QueryService_knnQueryBatchBinary_result() throw();
+  std::vector<ReplyEntryList>  success;
+  QueryException err;
+
+  _QueryService_knnQueryBatchBinary_result__isset __isset;
+
+  void __set_success(const std::vector<ReplyEntryList> & val);
+
+  void __set_err(const QueryException& val);
+
+  bool operator == (const QueryService_knnQueryBatchBinary_result & rhs) const
+  {
+    if (!(success == rhs.success))
+      return false;
+    if (!(err == rhs.err))
+      return false;
+    return true;
+  }
+  bool operator != (const QueryService_knnQueryBatchBinary_result &rhs) const {
+    return !(*this == rhs);
+  }
+
+  bool operator < (const QueryService_knnQueryBatchBinary_result & ) const;
+
+  uint32_t read(::apache::thrift::protocol::TProtocol* iprot);
+  uint32_t write(::apache::thrift::protocol::TProtocol* oprot) const;
+
+  friend std::ostream& operator<<(std::ostream& out, const QueryService_knnQueryBatchBinary_result& obj);
+};
+
+typedef struct _QueryService_knnQueryBatchBinary_presult__isset {
+  _QueryService_knnQueryBatchBinary_presult__isset() : success(false), err(false) {}
+  bool success :1;
+  bool err :1;
+} _QueryService_knnQueryBatchBinary_presult__isset;
+
+class QueryService_knnQueryBatchBinary_presult {
+ public:
+
+  static const char* ascii_fingerprint; // = "49B56A9B90B040D6FB7E6150C599DE1B";
+  static const uint8_t binary_fingerprint[16]; // = {0x49,0xB5,0x6A,0x9B,0x90,0xB0,0x40,0xD6,0xFB,0x7E,0x61,0x50,0xC5,0x99,0xDE,0x1B};
+
+
+  virtual ~QueryService_knnQueryBatchBinary_presult() throw();
+  std::vector<ReplyEntryList>  * success;
+  QueryException err;
+
+  _QueryService_knnQueryBatchBinary_presult__isset __isset;
+
+  uint32_t read(::apache::thrift::protocol::TProtocol* iprot);
+
+  friend std::ostream& operator<<(std::ostream& out, const QueryService_knnQueryBatchBinary_presult& obj);
+};
+
 class QueryServiceClient : virtual public QueryServiceIf {
  public:
   QueryServiceClient(boost::shared_ptr< ::apache::thrift::protocol::TProtocol> prot) {
@@ -622,6 +922,12 @@ class QueryServiceClient : virtual public QueryServiceIf {
   double getDistance(const std::string& obj1, const std::string& obj2);
   void send_getDistance(const std::string& obj1, const std::string& obj2);
   double recv_getDistance();
+  void knnQueryBatch(std::vector<ReplyEntryList> & _return, const int32_t k, const std::vector<std::string> & queryObj, const bool retExternId, const bool retObj, const std::string& queryTimeParams);
+  void send_knnQueryBatch(const int32_t k, const std::vector<std::string> & queryObj, const bool retExternId, const bool retObj, const std::string& queryTimeParams);
+  void recv_knnQueryBatch(std::vector<ReplyEntryList> & _return);
+  void knnQueryBatchBinary(std::vector<ReplyEntryList> & _return, const int32_t k, const std::vector<std::string> & queryObj, const bool retExternId, const bool retObj, const std::string& queryTimeParams);
+  void send_knnQueryBatchBinary(const int32_t k, const std::vector<std::string> & queryObj, const bool retExternId, const bool retObj, const std::string& queryTimeParams);
+  void recv_knnQueryBatchBinary(std::vector<ReplyEntryList> & _return);
  protected:
   boost::shared_ptr< ::apache::thrift::protocol::TProtocol> piprot_;
   boost::shared_ptr< ::apache::thrift::protocol::TProtocol> poprot_;
@@ -641,6 +947,8 @@ class QueryServiceProcessor : public ::apache::thrift::TDispatchProcessor {
   void process_knnQuery(int32_t seqid, ::apache::thrift::protocol::TProtocol* iprot, ::apache::thrift::protocol::TProtocol* oprot, void* callContext);
   void process_rangeQuery(int32_t seqid, ::apache::thrift::protocol::TProtocol* iprot, ::apache::thrift::protocol::TProtocol* oprot, void* callContext);
   void process_getDistance(int32_t seqid, ::apache::thrift::protocol::TProtocol* iprot, ::apache::thrift::protocol::TProtocol* oprot, void* callContext);
+  void process_knnQueryBatch(int32_t seqid, ::apache::thrift::protocol::TProtocol* iprot, ::apache::thrift::protocol::TProtocol* oprot, void* callContext);
+  void process_knnQueryBatchBinary(int32_t seqid, ::apache::thrift::protocol::TProtocol* iprot, ::apache::thrift::protocol::TProtocol* oprot, void* callContext);
  public:
   QueryServiceProcessor(boost::shared_ptr<QueryServiceIf> iface) :
     iface_(iface) {
@@ -648,6 +956,8 @@ class QueryServiceProcessor : public ::apache::thrift::TDispatchProcessor {
     processMap_["knnQuery"] = &QueryServiceProcessor::process_knnQuery;
     processMap_["rangeQuery"] = &QueryServiceProcessor::process_rangeQuery;
     processMap_["getDistance"] = &QueryServiceProcessor::process_getDistance;
+    processMap_["knnQueryBatch"] = &QueryServiceProcessor::process_knnQueryBatch;
+    processMap_["knnQueryBatchBinary"] = &QueryServiceProcessor::process_knnQueryBatchBinary;
   }
 
   virtual ~QueryServiceProcessor() {}
@@ -714,6 +1024,26 @@ class QueryServiceMultiface : virtual public QueryServiceIf {
     return ifaces_[i]->getDistance(obj1, obj2);
   }
 
+  void knnQueryBatch(std::vector<ReplyEntryList> & _return, const int32_t k, const std::vector<std::string> & queryObj, const bool retExternId, const bool retObj, const std::string& queryTimeParams) {
+    size_t sz = ifaces_.size();
+    size_t i = 0;
+    for (; i < (sz - 1); ++i) {
+      ifaces_[i]->knnQueryBatch(_return, k, queryObj, retExternId, retObj, queryTimeParams);
+    }
+    ifaces_[i]->knnQueryBatch(_return, k, queryObj, retExternId, retObj, queryTimeParams);
+    return;
+  }
+
+  void knnQueryBatchBinary(std::vector<ReplyEntryList> & _return, const int32_t k, const std::vector<std::string> & queryObj, const bool retExternId, const bool retObj, const std::string& queryTimeParams) {
+    size_t sz = ifaces_.size();
+    size_t i = 0;
+    for (; i < (sz - 1); ++i) {
+      ifaces_[i]->knnQueryBatchBinary(_return, k, queryObj, retExternId, retObj, queryTimeParams);
+    }
+    ifaces_[i]->knnQueryBatchBinary(_return, k, queryObj, retExternId, retObj, queryTimeParams);
+    return;
+  }
+
 };
 
 } // namespace
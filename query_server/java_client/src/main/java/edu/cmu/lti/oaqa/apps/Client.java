@@ -25,6 +25,8 @@ import edu.cmu.lti.oaqa.similarity.*;
 import org.apache.thrift.protocol.*;
 
 import java.io.*;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
 import java.util.*;
 
 
@@ -61,6 +63,13 @@ public class Client {
   private final static String RET_EXTERN_ID_SHORT_PARAM = "e";
   private final static String RET_EXTERN_ID_LONG_PARAM = "retExternId";
   private final static String RET_EXTERN_ID_DESC = "Return external IDs?";  
+
+  private final static String BATCH_SHORT_PARAM = "b";
+  private final static String BATCH_LONG_PARAM = "batch";
+  private final static String BATCH_DESC = "Each input line is a separate k-NN query, all queries are sent in one batch";
+
+  private final static String BINARY_LONG_PARAM = "binary";
+  private final static String BINARY_DESC = "Send batch queries in the binary format: each input line is either a dense vector (space-separated numbers) or a sparse vector (space-separated dim:value pairs)";
  
   
   static void Usage(String err) {
@@ -72,7 +81,9 @@ public class Client {
                        "-%s [%s] arg \t\t\t %s \n" +
                        "-%s [%s] arg \t %s \n" +
                        "-%s [%s] \t\t %s \n" +
-                       "-%s [%s] \t\t\t %s \n"
+                       "-%s [%s] \t\t\t %s \n" +
+                       "-%s [%s] \t\t\t %s \n" +
+                       "--%s \t\t\t %s \n"
                         ,
                        PORT_SHORT_PARAM, PORT_LONG_PARAM, PORT_DESC,
                        HOST_SHORT_PARAM, HOST_LONG_PARAM, HOST_DESC,
@@ -80,11 +91,40 @@ public class Client {
                        R_SHORT_PARAM, R_LONG_PARAM, R_DESC,
                        QUERY_TIME_SHORT_PARAM, QUERY_TIME_LONG_PARAM, QUERY_TIME_DESC,
                        RET_EXTERN_ID_SHORT_PARAM, RET_EXTERN_ID_LONG_PARAM, RET_EXTERN_ID_DESC,
-                       RET_OBJ_SHORT_PARAM, RET_OBJ_LONG_PARAM, RET_OBJ_DESC
+                       RET_OBJ_SHORT_PARAM, RET_OBJ_LONG_PARAM, RET_OBJ_DESC,
+                       BATCH_SHORT_PARAM, BATCH_LONG_PARAM, BATCH_DESC,
+                       BINARY_LONG_PARAM, BINARY_DESC
                        
 ));
     System.exit(1);
   }
+
+  /*
+   * Converts a dense vector (space-separated numbers) or a sparse vector
+   * (space-separated dim:value pairs) into the binary format of knnQueryBatchBinary.
+   */
+  static ByteBuffer createBinaryQuery(String line) {
+    String[] tokens = line.trim().split("\\s+");
+    ByteBuffer res = ByteBuffer.allocate(8 * tokens.length).order(ByteOrder.LITTLE_ENDIAN);
+    for (String token : tokens) {
+      int pos = token.indexOf(':');
+      if (pos >= 0) {
+        res.putInt((int)Long.parseLong(token.substring(0, pos)));
+        res.putFloat(Float.parseFloat(token.substring(pos + 1)));
+      } else {
+        res.putFloat(Float.parseFloat(token));
+      }
+    }
+    res.flip();
+    return res;
+  }
+
+  static void printResult(List<ReplyEntry> res, boolean retExternId, boolean retObj) {
+    for (ReplyEntry e: res) {
+      System.out.println(String.format("id=%d dist=%g %s", e.getId(), e.getDist(), retExternId ? "externId="+e.getExternId():"" ));
+      if (retObj) System.out.println(e.getObj());
+    }
+  }
   
   
   public static void main(String args[]) {
@@ -103,6 +143,8 @@ public class Client {
     opt.addOption(QUERY_TIME_SHORT_PARAM, QUERY_TIME_LONG_PARAM, true, QUERY_TIME_DESC);
     opt.addOption(RET_OBJ_SHORT_PARAM, RET_OBJ_LONG_PARAM, false, RET_OBJ_DESC);
     opt.addOption(RET_EXTERN_ID_SHORT_PARAM, RET_EXTERN_ID_LONG_PARAM, false, RET_EXTERN_ID_DESC);
+    opt.addOption(BATCH_SHORT_PARAM, BATCH_LONG_PARAM, false, BATCH_DESC);
+    opt.addOption(null, BINARY_LONG_PARAM, false, BINARY_DESC);
     
     CommandLineParser parser = new org.apache.commons.cli.GnuParser();
     
@@ -125,6 +167,8 @@ public class Client {
       
       boolean retObj      = cmd.hasOption(RET_OBJ_SHORT_PARAM);
       boolean retExternId = cmd.hasOption(RET_EXTERN_ID_SHORT_PARAM);
+      boolean batch       = cmd.hasOption(BATCH_SHORT_PARAM);
+      boolean binary      = cmd.hasOption(BINARY_LONG_PARAM);
       
       String queryTimeParams = cmd.getOptionValue(QUERY_TIME_SHORT_PARAM);
       if (null == queryTimeParams) queryTimeParams = "";
@@ -158,15 +202,28 @@ public class Client {
       } else {
         Usage("One has to specify either range or KNN-search parameter");
       }
+      if (batch && searchType != SearchType.kKNNSearch) {
+        Usage("Batch mode is supported only for the KNN search");
+      }
+      if (binary && !batch) {
+        Usage("Binary queries are supported only in the batch mode");
+      }
 
       String separator = System.getProperty("line.separator");
       
-      StringBuffer sb = new StringBuffer();
-      String       s;
+      StringBuffer      sb = new StringBuffer();
+      String            s;
+      List<String>      batchQueries = new ArrayList<String>();
+      List<ByteBuffer>  batchBinQueries = new ArrayList<ByteBuffer>();
       
       while ((s=inp.readLine()) != null) {
-        sb.append(s);
-        sb.append(separator);
+        if (!batch) {
+          sb.append(s);
+          sb.append(separator);
+        } else if (!s.trim().isEmpty()) {
+          if (binary) batchBinQueries.add(createBinaryQuery(s));
+          else batchQueries.add(s);
+        }
       }
       
       String queryObj = sb.toString();
@@ -178,14 +235,23 @@ public class Client {
         TProtocol               protocol = new  TBinaryProtocol(transport);
         QueryService.Client     client = new QueryService.Client(protocol);
         
-        if (!queryTimeParams.isEmpty())
+        // A batch carries its own query-time parameters
+        if (!queryTimeParams.isEmpty() && !batch)
           client.setQueryTimeParams(queryTimeParams);
         
-        List<ReplyEntry> res = null;
+        List<ReplyEntry>        res = null;
+        List<List<ReplyEntry>>  batchRes = null;
         
         long t1 = System.nanoTime();
         
-        if (searchType == SearchType.kKNNSearch) {
+        if (batch) {
+          System.out.println(String.format("Running a batch of %d %d-NN queries", 
+                             binary ? batchBinQueries.size() : batchQueries.size(), k));
+          if (binary)
+            batchRes = client.knnQueryBatchBinary(k, batchBinQueries, retExternId, retObj, queryTimeParams);
+          else
+            batchRes = client.knnQueryBatch(k, batchQueries, retExternId, retObj, queryTimeParams);
+        } else if (searchType == SearchType.kKNNSearch) {
           System.out.println(String.format("Running a %d-NN search", k));
           res = client.knnQuery(k, queryObj, retExternId, retObj);
         } else {
@@ -197,9 +263,13 @@ public class Client {
         
         System.out.println(String.format("Finished in %g ms", (t2 - t1)/1e6));
         
-        for (ReplyEntry e: res) {
-          System.out.println(String.format("id=%d dist=%g %s", e.getId(), e.getDist(), retExternId ? "externId="+e.getExternId():"" ));
-          if (retObj) System.out.println(e.getObj());
+        if (batch) {
+          for (int i = 0; i < batchRes.size(); ++i) {
+            System.out.println(String.format("Query #%d", i));
+            printResult(batchRes.get(i), retExternId, retObj);
+          }
+        } else {
+          printResult(res, retExternId, retObj);
         }
        
         transport.close(); // Close transport/socket !
@@ -47,6 +47,10 @@ public class QueryService {
 
     public double getDistance(String obj1, String obj2) throws QueryException, org.apache.thrift.TException;
 
+    public List<List<ReplyEntry>> knnQueryBatch(int k, List<String> queryObj, boolean retExternId, boolean retObj, String queryTimeParams) throws QueryException, org.apache.thrift.TException;
+
+    public List<List<ReplyEntry>> knnQueryBatchBinary(int k, List<ByteBuffer> queryObj, boolean retExternId, boolean retObj, String queryTimeParams) throws QueryException, org.apache.thrift.TException;
+
   }
 
   public interface AsyncIface {
@@ -59,6 +63,10 @@ public class QueryService {
 
     public void getDistance(String obj1, String obj2, org.apache.thrift.async.AsyncMethodCallback resultHandler) throws org.apache.thrift.TException;
 
+    public void knnQueryBatch(int k, List<String> queryObj, boolean retExternId, boolean retObj, String queryTimeParams, org.apache.thrift.async.AsyncMethodCallback resultHandler) throws org.apache.thrift.TException;
+
+    public void knnQueryBatchBinary(int k, List<ByteBuffer> queryObj, boolean retExternId, boolean retObj, String queryTimeParams, org.apache.thrift.async.AsyncMethodCallback resultHandler) throws org.apache.thrift.TException;
+
   }
 
   public static class Client extends org.apache.thrift.TServiceClient implements Iface {
@@ -189,6 +197,66 @@ public class QueryService {
       throw new org.apache.thrift.TApplicationException(org.apache.thrift.TApplicationException.MISSING_RESULT, "getDistance failed: unknown result");
     }
 
+    public List<List<ReplyEntry>> knnQueryBatch(int k, List<String> queryObj, boolean retExternId, boolean retObj, String queryTimeParams) throws QueryException, org.apache.thrift.TException
+    {
+      send_knnQueryBatch(k, queryObj, retExternId, retObj, queryTimeParams);
+      return recv_knnQueryBatch();
+    }
+
+    public void send_knnQueryBatch(int k, List<String> queryObj, boolean retExternId, boolean retObj, String queryTimeParams) throws org.apache.thrift.TException
+    {
+      knnQueryBatch_args args = new knnQueryBatch_args();
+      args.setK(k);
+      args.setQueryObj(queryObj);
+      args.setRetExternId(retExternId);
+      args.setRetObj(retObj);
+      args.setQueryTimeParams(queryTimeParams);
+      sendBase("knnQueryBatch", args);
+    }
+
+    public List<List<ReplyEntry>> recv_knnQueryBatch() throws QueryException, org.apache.thrift.TException
+    {
+      knnQueryBatch_result result = new knnQueryBatch_result();
+      receiveBase(result, "knnQueryBatch");
+      if (result.isSetSuccess()) {
+        return result.success;
+      }
+      if (result.err != null) {
+        throw result.err;
+      }
+      throw new org.apache.thrift.TApplicationException(org.apache.thrift.TApplicationException.MISSING_RESULT, "knnQueryBatch failed: unknown result");
+    }
+
+    public List<List<ReplyEntry>> knnQueryBatchBinary(int k, List<ByteBuffer> queryObj, boolean retExternId, boolean retObj, String queryTimeParams) throws QueryException, org.apache.thrift.TException
+    {
+      send_knnQueryBatchBinary(k, queryObj, retExternId, retObj, queryTimeParams);
+      return recv_knnQueryBatchBinary();
+    }
+
+    public void send_knnQueryBatchBinary(int k, List<ByteBuffer> queryObj, boolean retExternId, boolean retObj, String queryTimeParams) throws org.apache.thrift.TException
+    {
+      knnQueryBatchBinary_args args = new knnQueryBatchBinary_args();
+      args.setK(k);
+      args.setQueryObj(queryObj);
+      args.setRetExternId(retExternId);
+      args.setRetObj(retObj);
+      args.setQueryTimeParams(queryTimeParams);
+      sendBase("knnQueryBatchBinary", args);
+    }
+
+    public List<List<ReplyEntry>> recv_knnQueryBatchBinary() throws QueryException, org.apache.thrift.TException
+    {
+      knnQueryBatchBinary_result result = new knnQueryBatchBinary_result();
+      receiveBase(result, "knnQueryBatchBinary");
+      if (result.isSetSuccess()) {
+        return result.success;
+      }
+      if (result.err != null) {
+        throw result.err;
+      }
+      throw new org.apache.thrift.TApplicationException(org.apache.thrift.TApplicationException.MISSING_RESULT, "knnQueryBatchBinary failed: unknown result");
+    }
+
   }
   public static class AsyncClient extends org.apache.thrift.async.TAsyncClient implements AsyncIface {
     public static class Factory implements org.apache.thrift.async.TAsyncClientFactory<AsyncClient> {
@@ -356,6 +424,94 @@ public class QueryService {
       }
     }
 
+    public void knnQueryBatch(int k, List<String> queryObj, boolean retExternId, boolean retObj, String queryTimeParams, org.apache.thrift.async.AsyncMethodCallback resultHandler) throws org.apache.thrift.TException {
+      checkReady();
+      knnQueryBatch_call method_call = new knnQueryBatch_call(k, queryObj, retExternId, retObj, queryTimeParams, resultHandler, this, ___protocolFactory, ___transport);
+      this.___currentMethod = method_call;
+      ___manager.call(method_call);
+    }
+
+    public static class knnQueryBatch_call extends org.apache.thrift.async.TAsyncMethodCall {
+      private int k;
+      private List<String> queryObj;
+      private boolean retExternId;
+      private boolean retObj;
+      private String queryTimeParams;
+      public knnQueryBatch_call(int k, List<String> queryObj, boolean retExternId, boolean retObj, String queryTimeParams, org.apache.thrift.async.AsyncMethodCallback resultHandler, org.apache.thrift.async.TAsyncClient client, org.apache.thrift.protocol.TProtocolFactory protocolFactory, org.apache.thrift.transport.TNonblockingTransport transport) throws org.apache.thrift.TException {
+        super(client, protocolFactory, transport, resultHandler, false);
+        this.k = k;
+        this.queryObj = queryObj;
+        this.retExternId = retExternId;
+        this.retObj = retObj;
+        this.queryTimeParams = queryTimeParams;
+      }
+
+      public void write_args(org.apache.thrift.protocol.TProtocol prot) throws org.apache.thrift.TException {
+        prot.writeMessageBegin(new org.apache.thrift.protocol.TMessage("knnQueryBatch", org.apache.thrift.protocol.TMessageType.CALL, 0));
+        knnQueryBatch_args args = new knnQueryBatch_args();
+        args.setK(k);
+        args.setQueryObj(queryObj);
+        args.setRetExternId(retExternId);
+        args.setRetObj(retObj);
+        args.setQueryTimeParams(queryTimeParams);
+        args.write(prot);
+        prot.writeMessageEnd();
+      }
+
+      public List<List<ReplyEntry>> getResult() throws QueryException, org.apache.thrift.TException {
+        if (getState() != org.apache.thrift.async.TAsyncMethodCall.State.RESPONSE_READ) {
+          throw new IllegalStateException("Method call not finished!");
+        }
+        org.apache.thrift.transport.TMemoryInputTransport memoryTransport = new org.apache.thrift.transport.TMemoryInputTransport(getFrameBuffer().array());
+        org.apache.thrift.protocol.TProtocol prot = client.getProtocolFactory().getProtocol(memoryTransport);
+        return (new Client(prot)).recv_knnQueryBatch();
+      }
+    }
+
+    public void knnQueryBatchBinary(int k, List<ByteBuffer> queryObj, boolean retExternId, boolean retObj, String queryTimeParams, org.apache.thrift.async.AsyncMethodCallback resultHandler) throws org.apache.thrift.TException {
+      checkReady();
+      knnQueryBatchBinary_call method_call = new knnQueryBatchBinary_call(k, queryObj, retExternId, retObj, queryTimeParams, resultHandler, this, ___protocolFactory, ___transport);
+      this.___currentMethod = method_call;
+      ___manager.call(method_call);
+    }
+
+    public static class knnQueryBatchBinary_call extends org.apache.thrift.async.TAsyncMethodCall {
+      private int k;
+      private List<ByteBuffer> queryObj;
+      private boolean retExternId;
+      private boolean retObj;
+      private String queryTimeParams;
+      public knnQueryBatchBinary_call(int k, List<ByteBuffer> queryObj, boolean retExternId, boolean retObj, String queryTimeParams, org.apache.thrift.async.AsyncMethodCallback resultHandler, org.apache.thrift.async.TAsyncClient client, org.apache.thrift.protocol.TProtocolFactory protocolFactory, org.apache.thrift.transport.TNonblockingTransport transport) throws org.apache.thrift.TException {
+        super(client, protocolFactory, transport, resultHandler, false);
+        this.k = k;
+        this.queryObj = queryObj;
+        this.retExternId = retExternId;
+        this.retObj = retObj;
+        this.queryTimeParams = queryTimeParams;
+      }
+
+      public void write_args(org.apache.thrift.protocol.TProtocol prot) throws org.apache.thrift.TException {
+        prot.writeMessageBegin(new org.apache.thrift.protocol.TMessage("knnQueryBatchBinary", org.apache.thrift.protocol.TMessageType.CALL, 0));
+        knnQueryBatchBinary_args args = new knnQueryBatchBinary_args();
+        args.setK(k);
+        args.setQueryObj(queryObj);
+        args.setRetExternId(retExternId);
+        args.setRetObj(retObj);
+        args.setQueryTimeParams(queryTimeParams);
+        args.write(prot);
+        prot.writeMessageEnd();
+      }
+
+      public List<List<ReplyEntry>> getResult() throws QueryException, org.apache.thrift.TException {
+        if (getState() != org.apache.thrift.async.TAsyncMethodCall.State.RESPONSE_READ) {
+          throw new IllegalStateException("Method call not finished!");
+        }
+        org.apache.thrift.transport.TMemoryInputTransport memoryTransport = new org.apache.thrift.transport.TMemoryInputTransport(getFrameBuffer().array());
+        org.apache.thrift.protocol.TProtocol prot = client.getProtocolFactory().getProtocol(memoryTransport);
+        return (new Client(prot)).recv_knnQueryBatchBinary();
+      }
+    }
+
   }
 
   public static class Processor<I extends Iface> extends org.apache.thrift.TBaseProcessor<I> implements org.apache.thrift.TProcessor {
@@ -373,6 +529,8 @@ public class QueryService {
       processMap.put("knnQuery", new knnQuery());
       processMap.put("rangeQuery", new rangeQuery());
       processMap.put("getDistance", new getDistance());
+      processMap.put("knnQueryBatch", new knnQueryBatch());
+      processMap.put("knnQueryBatchBinary", new knnQueryBatchBinary());
       return processMap;
     }
 
@@ -473,6 +631,54 @@ public class QueryService {
       }
     }
 
+    public static class knnQueryBatch<I extends Iface> extends org.apache.thrift.ProcessFunction<I, knnQueryBatch_args> {
+      public knnQueryBatch() {
+        super("knnQueryBatch");
+      }
+
+      public knnQueryBatch_args getEmptyArgsInstance() {
+        return new knnQueryBatch_args();
+      }
+
+      protected boolean isOneway() {
+        return false;
+      }
+
+      public knnQueryBatch_result getResult(I iface, knnQueryBatch_args args) throws org.apache.thrift.TException {
+        knnQueryBatch_result result = new knnQueryBatch_result();
+        try {
+          result.success = iface.knnQueryBatch(args.k, args.queryObj, args.retExternId, args.retObj, args.queryTimeParams);
+        } catch (QueryException err) {
+          result.err = err;
+        }
+        return result;
+      }
+    }
+
+    public static class knnQueryBatchBinary<I extends Iface> extends org.apache.thrift.ProcessFunction<I, knnQueryBatchBinary_args> {
+      public knnQueryBatchBinary() {
+        super("knnQueryBatchBinary");
+      }
+
+      public knnQueryBatchBinary_args getEmptyArgsInstance() {
+        return new knnQueryBatchBinary_args();
+      }
+
+      protected boolean isOneway() {
+        return false;
+      }
+
+      public knnQueryBatchBinary_result getResult(I iface, knnQueryBatchBinary_args args) throws org.apache.thrift.TException {
+        knnQueryBatchBinary_result result = new knnQueryBatchBinary_result();
+        try {
+          result.success = iface.knnQueryBatchBinary(args.k, args.queryObj, args.retExternId, args.retObj, args.queryTimeParams);
+        } catch (QueryException err) {
+          result.err = err;
+        }
+        return result;
+      }
+    }
+
   }
 
   public static class AsyncProcessor<I extends AsyncIface> extends org.apache.thrift.TBaseAsyncProcessor<I> {
@@ -490,6 +696,8 @@ public class QueryService {
       processMap.put("knnQuery", new knnQuery());
       processMap.put("rangeQuery", new rangeQuery());
       processMap.put("getDistance", new getDistance());
+      processMap.put("knnQueryBatch", new knnQueryBatch());
+      processMap.put("knnQueryBatchBinary", new knnQueryBatchBinary());
       return processMap;
     }
 
@@ -721,6 +929,120 @@ public class QueryService {
       }
     }
 
+    public static class knnQueryBatch<I extends AsyncIface> extends org.apache.thrift.AsyncProcessFunction<I, knnQueryBatch_args, List<List<ReplyEntry>>> {
+      public knnQueryBatch() {
+        super("knnQueryBatch");
+      }
+
+      public knnQueryBatch_args getEmptyArgsInstance() {
+        return new knnQueryBatch_args();
+      }
+
+      public AsyncMethodCallback<List<List<ReplyEntry>>> getResultHandler(final AsyncFrameBuffer fb, final int seqid) {
+        final org.apache.thrift.AsyncProcessFunction fcall = this;
+        return new AsyncMethodCallback<List<List<ReplyEntry>>>() { 
+          public void onComplete(List<List<ReplyEntry>> o) {
+            knnQueryBatch_result result = new knnQueryBatch_result();
+            result.success = o;
+            try {
+              fcall.sendResponse(fb,result, org.apache.thrift.protocol.TMessageType.REPLY,seqid);
+              return;
+            } catch (Exception e) {
+              LOGGER.error("Exception writing to internal frame buffer", e);
+            }
+            fb.close();
+          }
+          public void onError(Exception e) {
+            byte msgType = org.apache.thrift.protocol.TMessageType.REPLY;
+            org.apache.thrift.TBase msg;
+            knnQueryBatch_result result = new knnQueryBatch_result();
+            if (e instanceof QueryException) {
+                        result.err = (QueryException) e;
+                        result.setErrIsSet(true);
+                        msg = result;
+            }
+             else 
+            {
+              msgType = org.apache.thrift.protocol.TMessageType.EXCEPTION;
+              msg = (org.apache.thrift.TBase)new org.apache.thrift.TApplicationException(org.apache.thrift.TApplicationException.INTERNAL_ERROR, e.getMessage());
+            }
+            try {
+              fcall.sendResponse(fb,msg,msgType,seqid);
+              return;
+            } catch (Exception ex) {
+              LOGGER.error("Exception writing to internal frame buffer", ex);
+            }
+            fb.close();
+          }
+        };
+      }
+
+      protected boolean isOneway() {
+        return false;
+      }
+
+      public void start(I iface, knnQueryBatch_args args, org.apache.thrift.async.AsyncMethodCallback<List<List<ReplyEntry>>> resultHandler) throws TException {
+        iface.knnQueryBatch(args.k, args.queryObj, args.retExternId, args.retObj, args.queryTimeParams,resultHandler);
+      }
+    }
+
+    public static class knnQueryBatchBinary<I extends AsyncIface> extends org.apache.thrift.AsyncProcessFunction<I, knnQueryBatchBinary_args, List<List<ReplyEntry>>> {
+      public knnQueryBatchBinary() {
+        super("knnQueryBatchBinary");
+      }
+
+      public knnQueryBatchBinary_args getEmptyArgsInstance() {
+        return new knnQueryBatchBinary_args();
+      }
+
+      public AsyncMethodCallback<List<List<ReplyEntry>>> getResultHandler(final AsyncFrameBuffer fb, final int seqid) {
+        final org.apache.thrift.AsyncProcessFunction fcall = this;
+        return new AsyncMethodCallback<List<List<ReplyEntry>>>() { 
+          public void onComplete(List<List<ReplyEntry>> o) {
+            knnQueryBatchBinary_result result = new knnQueryBatchBinary_result();
+            result.success = o;
+            try {
+              fcall.sendResponse(fb,result, org.apache.thrift.protocol.TMessageType.REPLY,seqid);
+              return;
+            } catch (Exception e) {
+              LOGGER.error("Exception writing to internal frame buffer", e);
+            }
+            fb.close();
+          }
+          public void onError(Exception e) {
+            byte msgType = org.apache.thrift.protocol.TMessageType.REPLY;
+            org.apache.thrift.TBase msg;
+            knnQueryBatchBinary_result result = new knnQueryBatchBinary_result();
+            if (e instanceof QueryException) {
+                        result.err = (QueryException) e;
+                        result.setErrIsSet(true);
+                        msg = result;
+            }
+             else 
+            {
+              msgType = org.apache.thrift.protocol.TMessageType.EXCEPTION;
+              msg = (org.apache.thrift.TBase)new org.apache.thrift.TApplicationException(org.apache.thrift.TApplicationException.INTERNAL_ERROR, e.getMessage());
+            }
+            try {
+              fcall.sendResponse(fb,msg,msgType,seqid);
+              return;
+            } catch (Exception ex) {
+              LOGGER.error("Exception writing to internal frame buffer", ex);
+            }
+            fb.close();
+          }
+        };
+      }
+
+      protected boolean isOneway() {
+        return false;
+      }
+
+      public void start(I iface, knnQueryBatchBinary_args args, org.apache.thrift.async.AsyncMethodCallback<List<List<ReplyEntry>>> resultHandler) throws TException {
+        iface.knnQueryBatchBinary(args.k, args.queryObj, args.retExternId, args.retObj, args.queryTimeParams,resultHandler);
+      }
+    }
+
   }
 
   public static class setQueryTimeParams_args implements org.apache.thrift.TBase<setQueryTimeParams_args, setQueryTimeParams_args._Fields>, java.io.Serializable, Cloneable, Comparable<setQueryTimeParams_args>   {
@@ -4689,4 +5011,2705 @@ public class QueryService {
 
   }
 
+  public static class knnQueryBatch_args implements org.apache.thrift.TBase<knnQueryBatch_args, knnQueryBatch_args._Fields>, java.io.Serializable, Cloneable, Comparable<knnQueryBatch_args>   {
+    private static final org.apache.thrift.protocol.TStruct STRUCT_DESC = new org.apache.thrift.protocol.TStruct("knnQueryBatch_args");
+
+    private static final org.apache.thrift.protocol.TField K_FIELD_DESC = new org.apache.thrift.protocol.TField("k", org.apache.thrift.protocol.TType.I32, (short)1);
+    private static final org.apache.thrift.protocol.TField QUERY_OBJ_FIELD_DESC = new org.apache.thrift.protocol.TField("queryObj", org.apache.thrift.protocol.TType.LIST, (short)2);
+    private static final org.apache.thrift.protocol.TField RET_EXTERN_ID_FIELD_DESC = new org.apache.thrift.protocol.TField("retExternId", org.apache.thrift.protocol.TType.BOOL, (short)3);
+    private static final org.apache.thrift.protocol.TField RET_OBJ_FIELD_DESC = new org.apache.thrift.protocol.TField("retObj", org.apache.thrift.protocol.TType.BOOL, (short)4);
+    private static final org.apache.thrift.protocol.TField QUERY_TIME_PARAMS_FIELD_DESC = new org.apache.thrift.protocol.TField("queryTimeParams", org.apache.thrift.protocol.TType.STRING, (short)5);
+
+    private static final Map<Class<? extends IScheme>, SchemeFactory> schemes = new HashMap<Class<? extends IScheme>, SchemeFactory>();
+    static {
+      schemes.put(StandardScheme.class, new knnQueryBatch_argsStandardSchemeFactory());
+      schemes.put(TupleScheme.class, new knnQueryBatch_argsTupleSchemeFactory());
+    }
+
+    public int k; // required
+    public List<String> queryObj; // required
+    public boolean retExternId; // required
+    public boolean retObj; // required
+    public String queryTimeParams; // required
+
+    /** The set of fields this struct contains, along with convenience methods for finding and manipulating them. */
+    public enum _Fields implements org.apache.thrift.TFieldIdEnum {
+      K((short)1, "k"),
+      QUERY_OBJ((short)2, "queryObj"),
+      RET_EXTERN_ID((short)3, "retExternId"),
+      RET_OBJ((short)4, "retObj"),
+      QUERY_TIME_PARAMS((short)5, "queryTimeParams");
+
+      private static final Map<String, _Fields> byName = new HashMap<String, _Fields>();
+
+      static {
+        for (_Fields field : EnumSet.allOf(_Fields.class)) {
+          byName.put(field.getFieldName(), field);
+        }
+      }
+
+      /**
+       * Find the _Fields constant that matches fieldId, or null if its not found.
+       */
+      public static _Fields findByThriftId(int fieldId) {
+        switch(fieldId) {
+          case 1: // K
+            return K;
+          case 2: // QUERY_OBJ
+            return QUERY_OBJ;
+          case 3: // RET_EXTERN_ID
+            return RET_EXTERN_ID;
+          case 4: // RET_OBJ
+            return RET_OBJ;
+          case 5: // QUERY_TIME_PARAMS
+            return QUERY_TIME_PARAMS;
+          default:
+            return null;
+        }
+      }
+
+      /**
+       * Find the _Fields constant that matches fieldId, throwing an exception
+       * if it is not found.
+       */
+      public static _Fields findByThriftIdOrThrow(int fieldId) {
+        _Fields fields = findByThriftId(fieldId);
+        if (fields == null) throw new IllegalArgumentException("Field " + fieldId + " doesn't exist!");
+        return fields;
+      }
+
+      /**
+       * Find the _Fields constant that matches name, or null if its not found.
+       */
+      public static _Fields findByName(String name) {
+        return byName.get(name);
+      }
+
+      private final short _thriftId;
+      private final String _fieldName;
+
+      _Fields(short thriftId, String fieldName) {
+        _thriftId = thriftId;
+        _fieldName = fieldName;
+      }
+
+      public short getThriftFieldId() {
+        return _thriftId;
+      }
+
+      public String getFieldName() {
+        return _fieldName;
+      }
+    }
+
+    // isset id assignments
+    private static final int __K_ISSET_ID = 0;
+    private static final int __RETEXTERNID_ISSET_ID = 1;
+    private static final int __RETOBJ_ISSET_ID = 2;
+    private byte __isset_bitfield = 0;
+    public static final Map<_Fields, org.apache.thrift.meta_data.FieldMetaData> metaDataMap;
+    static {
+      Map<_Fields, org.apache.thrift.meta_data.FieldMetaData> tmpMap = new EnumMap<_Fields, org.apache.thrift.meta_data.FieldMetaData>(_Fields.class);
+      tmpMap.put(_Fields.K, new org.apache.thrift.meta_data.FieldMetaData("k", org.apache.thrift.TFieldRequirementType.REQUIRED, 
+          new org.apache.thrift.meta_data.FieldValueMetaData(org.apache.thrift.protocol.TType.I32)));
+      tmpMap.put(_Fields.QUERY_OBJ, new org.apache.thrift.meta_data.FieldMetaData("queryObj", org.apache.thrift.TFieldRequirementType.REQUIRED, 
+          new org.apache.thrift.meta_data.ListMetaData(org.apache.thrift.protocol.TType.LIST, 
+              new org.apache.thrift.meta_data.FieldValueMetaData(org.apache.thrift.protocol.TType.STRING))));
+      tmpMap.put(_Fields.RET_EXTERN_ID, new org.apache.thrift.meta_data.FieldMetaData("retExternId", org.apache.thrift.TFieldRequirementType.REQUIRED, 
+          new org.apache.thrift.meta_data.FieldValueMetaData(org.apache.thrift.protocol.TType.BOOL)));
+      tmpMap.put(_Fields.RET_OBJ, new org.apache.thrift.meta_data.FieldMetaData("retObj", org.apache.thrift.TFieldRequirementType.REQUIRED, 
+          new org.apache.thrift.meta_data.FieldValueMetaData(org.apache.thrift.protocol.TType.BOOL)));
+      tmpMap.put(_Fields.QUERY_TIME_PARAMS, new org.apache.thrift.meta_data.FieldMetaData("queryTimeParams", org.apache.thrift.TFieldRequirementType.REQUIRED, 
+          new org.apache.thrift.meta_data.FieldValueMetaData(org.apache.thrift.protocol.TType.STRING)));
+      metaDataMap = Collections.unmodifiableMap(tmpMap);
+      org.apache.thrift.meta_data.FieldMetaData.addStructMetaDataMap(knnQueryBatch_args.class, metaDataMap);
+    }
+
+    public knnQueryBatch_args() {
+    }
+
+    public knnQueryBatch_args(
+      int k,
+      List<String> queryObj,
+      boolean retExternId,
+      boolean retObj,
+      String queryTimeParams)
+    {
+      this();
+      this.k = k;
+      setKIsSet(true);
+      this.queryObj = queryObj;
+      this.retExternId = retExternId;
+      setRetExternIdIsSet(true);
+      this.retObj = retObj;
+      setRetObjIsSet(true);
+      this.queryTimeParams = queryTimeParams;
+    }
+
+    /**
+     * Performs a deep copy on <i>other</i>.
+     */
+    public knnQueryBatch_args(knnQueryBatch_args other) {
+      __isset_bitfield = other.__isset_bitfield;
+      this.k = other.k;
+      if (other.isSetQueryObj()) {
+        List<String> __this__queryObj = new ArrayList<String>(other.queryObj);
+        this.queryObj = __this__queryObj;
+      }
+      this.retExternId = other.retExternId;
+      this.retObj = other.retObj;
+      if (other.isSetQueryTimeParams()) {
+        this.queryTimeParams = other.queryTimeParams;
+      }
+    }
+
+    public knnQueryBatch_args deepCopy() {
+      return new knnQueryBatch_args(this);
+    }
+
+    @Override
+    public void clear() {
+      setKIsSet(false);
+      this.k = 0;
+      this.queryObj = null;
+      setRetExternIdIsSet(false);
+      this.retExternId = false;
+      setRetObjIsSet(false);
+      this.retObj = false;
+      this.queryTimeParams = null;
+    }
+
+    public int getK() {
+      return this.k;
+    }
+
+    public knnQueryBatch_args setK(int k) {
+      this.k = k;
+      setKIsSet(true);
+      return this;
+    }
+
+    public void unsetK() {
+      __isset_bitfield = EncodingUtils.clearBit(__isset_bitfield, __K_ISSET_ID);
+    }
+
+    /** Returns true if field k is set (has been assigned a value) and false otherwise */
+    public boolean isSetK() {
+      return EncodingUtils.testBit(__isset_bitfield, __K_ISSET_ID);
+    }
+
+    public void setKIsSet(boolean value) {
+      __isset_bitfield = EncodingUtils.setBit(__isset_bitfield, __K_ISSET_ID, value);
+    }
+
+    public int getQueryObjSize() {
+      return (this.queryObj == null) ? 0 : this.queryObj.size();
+    }
+
+    public java.util.Iterator<String> getQueryObjIterator() {
+      return (this.queryObj == null) ? null : this.queryObj.iterator();
+    }
+
+    public void addToQueryObj(String elem) {
+      if (this.queryObj == null) {
+        this.queryObj = new ArrayList<String>();
+      }
+      this.queryObj.add(elem);
+    }
+
+    public List<String> getQueryObj() {
+      return this.queryObj;
+    }
+
+    public knnQueryBatch_args setQueryObj(List<String> queryObj) {
+      this.queryObj = queryObj;
+      return this;
+    }
+
+    public void unsetQueryObj() {
+      this.queryObj = null;
+    }
+
+    /** Returns true if field queryObj is set (has been assigned a value) and false otherwise */
+    public boolean isSetQueryObj() {
+      return this.queryObj != null;
+    }
+
+    public void setQueryObjIsSet(boolean value) {
+      if (!value) {
+        this.queryObj = null;
+      }
+    }
+
+    public boolean isRetExternId() {
+      return this.retExternId;
+    }
+
+    public knnQueryBatch_args setRetExternId(boolean retExternId) {
+      this.retExternId = retExternId;
+      setRetExternIdIsSet(true);
+      return this;
+    }
+
+    public void unsetRetExternId() {
+      __isset_bitfield = EncodingUtils.clearBit(__isset_bitfield, __RETEXTERNID_ISSET_ID);
+    }
+
+    /** Returns true if field retExternId is set (has been assigned a value) and false otherwise */
+    public boolean isSetRetExternId() {
+      return EncodingUtils.testBit(__isset_bitfield, __RETEXTERNID_ISSET_ID);
+    }
+
+    public void setRetExternIdIsSet(boolean value) {
+      __isset_bitfield = EncodingUtils.setBit(__isset_bitfield, __RETEXTERNID_ISSET_ID, value);
+    }
+
+    public boolean isRetObj() {
+      return this.retObj;
+    }
+
+    public knnQueryBatch_args setRetObj(boolean retObj) {
+      this.retObj = retObj;
+      setRetObjIsSet(true);
+      return this;
+    }
+
+    public void unsetRetObj() {
+      __isset_bitfield = EncodingUtils.clearBit(__isset_bitfield, __RETOBJ_ISSET_ID);
+    }
+
+    /** Returns true if field retObj is set (has been assigned a value) and false otherwise */
+    public boolean isSetRetObj() {
+      return EncodingUtils.testBit(__isset_bitfield, __RETOBJ_ISSET_ID);
+    }
+
+    public void setRetObjIsSet(boolean value) {
+      __isset_bitfield = EncodingUtils.setBit(__isset_bitfield, __RETOBJ_ISSET_ID, value);
+    }
+
+    public String getQueryTimeParams() {
+      return this.queryTimeParams;
+    }
+
+    public knnQueryBatch_args setQueryTimeParams(String queryTimeParams) {
+      this.queryTimeParams = queryTimeParams;
+      return this;
+    }
+
+    public void unsetQueryTimeParams() {
+      this.queryTimeParams = null;
+    }
+
+    /** Returns true if field queryTimeParams is set (has been assigned a value) and false otherwise */
+    public boolean isSetQueryTimeParams() {
+      return this.queryTimeParams != null;
+    }
+
+    public void setQueryTimeParamsIsSet(boolean value) {
+      if (!value) {
+        this.queryTimeParams = null;
+      }
+    }
+
+    public void setFieldValue(_Fields field, Object value) {
+      switch (field) {
+      case K:
+        if (value == null) {
+          unsetK();
+        } else {
+          setK((Integer)value);
+        }
+        break;
+
+      case QUERY_OBJ:
+        if (value == null) {
+          unsetQueryObj();
+        } else {
+          setQueryObj((List<String>)value);
+        }
+        break;
+
+      case RET_EXTERN_ID:
+        if (value == null) {
+          unsetRetExternId();
+        } else {
+          setRetExternId((Boolean)value);
+        }
+        break;
+
+      case RET_OBJ:
+        if (value == null) {
+          unsetRetObj();
+        } else {
+          setRetObj((Boolean)value);
+        }
+        break;
+
+      case QUERY_TIME_PARAMS:
+        if (value == null) {
+          unsetQueryTimeParams();
+        } else {
+          setQueryTimeParams((String)value);
+        }
+        break;
+
+      }
+    }
+
+    public Object getFieldValue(_Fields field) {
+      switch (field) {
+      case K:
+        return Integer.valueOf(getK());
+
+      case QUERY_OBJ:
+        return getQueryObj();
+
+      case RET_EXTERN_ID:
+        return Boolean.valueOf(isRetExternId());
+
+      case RET_OBJ:
+        return Boolean.valueOf(isRetObj());
+
+      case QUERY_TIME_PARAMS:
+        return getQueryTimeParams();
+
+      }
+      throw new IllegalStateException();
+    }
+
+    /** Returns true if field corresponding to fieldID is set (has been assigned a value) and false otherwise */
+    public boolean isSet(_Fields field) {
+      if (field == null) {
+        throw new IllegalArgumentException();
+      }
+
+      switch (field) {
+      case K:
+        return isSetK();
+      case QUERY_OBJ:
+        return isSetQueryObj();
+      case RET_EXTERN_ID:
+        return isSetRetExternId();
+      case RET_OBJ:
+        return isSetRetObj();
+      case QUERY_TIME_PARAMS:
+        return isSetQueryTimeParams();
+      }
+      throw new IllegalStateException();
+    }
+
+    @Override
+    public boolean equals(Object that) {
+      if (that == null)
+        return false;
+      if (that instanceof knnQueryBatch_args)
+        return this.equals((knnQueryBatch_args)that);
+      return false;
+    }
+
+    public boolean equals(knnQueryBatch_args that) {
+      if (that == null)
+        return false;
+
+      boolean this_present_k = true;
+      boolean that_present_k = true;
+      if (this_present_k || that_present_k) {
+        if (!(this_present_k && that_present_k))
+          return false;
+        if (this.k != that.k)
+          return false;
+      }
+
+      boolean this_present_queryObj = true && this.isSetQueryObj();
+      boolean that_present_queryObj = true && that.isSetQueryObj();
+      if (this_present_queryObj || that_present_queryObj) {
+        if (!(this_present_queryObj && that_present_queryObj))
+          return false;
+        if (!this.queryObj.equals(that.queryObj))
+          return false;
+      }
+
+      boolean this_present_retExternId = true;
+      boolean that_present_retExternId = true;
+      if (this_present_retExternId || that_present_retExternId) {
+        if (!(this_present_retExternId && that_present_retExternId))
+          return false;
+        if (this.retExternId != that.retExternId)
+          return false;
+      }
+
+      boolean this_present_retObj = true;
+      boolean that_present_retObj = true;
+      if (this_present_retObj || that_present_retObj) {
+        if (!(this_present_retObj && that_present_retObj))
+          return false;
+        if (this.retObj != that.retObj)
+          return false;
+      }
+
+      boolean this_present_queryTimeParams = true && this.isSetQueryTimeParams();
+      boolean that_present_queryTimeParams = true && that.isSetQueryTimeParams();
+      if (this_present_queryTimeParams || that_present_queryTimeParams) {
+        if (!(this_present_queryTimeParams && that_present_queryTimeParams))
+          return false;
+        if (!this.queryTimeParams.equals(that.queryTimeParams))
+          return false;
+      }
+
+      return true;
+    }
+
+    @Override
+    public int hashCode() {
+      List<Object> list = new ArrayList<Object>();
+
+      boolean present_k = true;
+      list.add(present_k);
+      if (present_k)
+        list.add(k);
+
+      boolean present_queryObj = true && (isSetQueryObj());
+      list.add(present_queryObj);
+      if (present_queryObj)
+        list.add(queryObj);
+
+      boolean present_retExternId = true;
+      list.add(present_retExternId);
+      if (present_retExternId)
+        list.add(retExternId);
+
+      boolean present_retObj = true;
+      list.add(present_retObj);
+      if (present_retObj)
+        list.add(retObj);
+
+      boolean present_queryTimeParams = true && (isSetQueryTimeParams());
+      list.add(present_queryTimeParams);
+      if (present_queryTimeParams)
+        list.add(queryTimeParams);
+
+      return list.hashCode();
+    }
+
+    @Override
+    public int compareTo(knnQueryBatch_args other) {
+      if (!getClass().equals(other.getClass())) {
+        return getClass().getName().compareTo(other.getClass().getName());
+      }
+
+      int lastComparison = 0;
+
+      lastComparison = Boolean.valueOf(isSetK()).compareTo(other.isSetK());
+      if (lastComparison != 0) {
+        return lastComparison;
+      }
+      if (isSetK()) {
+        lastComparison = org.apache.thrift.TBaseHelper.compareTo(this.k, other.k);
+        if (lastComparison != 0) {
+          return lastComparison;
+        }
+      }
+      lastComparison = Boolean.valueOf(isSetQueryObj()).compareTo(other.isSetQueryObj());
+      if (lastComparison != 0) {
+        return lastComparison;
+      }
+      if (isSetQueryObj()) {
+        lastComparison = org.apache.thrift.TBaseHelper.compareTo(this.queryObj, other.queryObj);
+        if (lastComparison != 0) {
+          return lastComparison;
+        }
+      }
+      lastComparison = Boolean.valueOf(isSetRetExternId()).compareTo(other.isSetRetExternId());
+      if (lastComparison != 0) {
+        return lastComparison;
+      }
+      if (isSetRetExternId()) {
+        lastComparison = org.apache.thrift.TBaseHelper.compareTo(this.retExternId, other.retExternId);
+        if (lastComparison != 0) {
+          return lastComparison;
+        }
+      }
+      lastComparison = Boolean.valueOf(isSetRetObj()).compareTo(other.isSetRetObj());
+      if (lastComparison != 0) {
+        return lastComparison;
+      }
+      if (isSetRetObj()) {
+        lastComparison = org.apache.thrift.TBaseHelper.compareTo(this.retObj, other.retObj);
+        if (lastComparison != 0) {
+          return lastComparison;
+        }
+      }
+      lastComparison = Boolean.valueOf(isSetQueryTimeParams()).compareTo(other.isSetQueryTimeParams());
+      if (lastComparison != 0) {
+        return lastComparison;
+      }
+      if (isSetQueryTimeParams()) {
+        lastComparison = org.apache.thrift.TBaseHelper.compareTo(this.queryTimeParams, other.queryTimeParams);
+        if (lastComparison != 0) {
+          return lastComparison;
+        }
+      }
+      return 0;
+    }
+
+    public _Fields fieldForId(int fieldId) {
+      return _Fields.findByThriftId(fieldId);
+    }
+
+    public void read(org.apache.thrift.protocol.TProtocol iprot) throws org.apache.thrift.TException {
+      schemes.get(iprot.getScheme()).getScheme().read(iprot, this);
+    }
+
+    public void write(org.apache.thrift.protocol.TProtocol oprot) throws org.apache.thrift.TException {
+      schemes.get(oprot.getScheme()).getScheme().write(oprot, this);
+    }
+
+    @Override
+    public String toString() {
+      StringBuilder sb = new StringBuilder("knnQueryBatch_args(");
+      boolean first = true;
+
+      sb.append("k:");
+      sb.append(this.k);
+      first = false;
+      if (!first) sb.append(", ");
+      sb.append("queryObj:");
+      if (this.queryObj == null) {
+        sb.append("null");
+      } else {
+        sb.append(this.queryObj);
+      }
+      first = false;
+      if (!first) sb.append(", ");
+      sb.append("retExternId:");
+      sb.append(this.retExternId);
+      first = false;
+      if (!first) sb.append(", ");
+      sb.append("retObj:");
+      sb.append(this.retObj);
+      first = false;
+      if (!first) sb.append(", ");
+      sb.append("queryTimeParams:");
+      if (this.queryTimeParams == null) {
+        sb.append("null");
+      } else {
+        sb.append(this.queryTimeParams);
+      }
+      first = false;
+      sb.append(")");
+      return sb.toString();
+    }
+
+    public void validate() throws org.apache.thrift.TException {
+      // check for required fields
+      // alas, we cannot check 'k' because it's a primitive and you chose the non-beans generator.
+      if (queryObj == null) {
+        throw new org.apache.thrift.protocol.TProtocolException("Required field 'queryObj' was not present! Struct: " + toString());
+      }
+      // alas, we cannot check 'retExternId' because it's a primitive and you chose the non-beans generator.
+      // alas, we cannot check 'retObj' because it's a primitive and you chose the non-beans generator.
+      if (queryTimeParams == null) {
+        throw new org.apache.thrift.protocol.TProtocolException("Required field 'queryTimeParams' was not present! Struct: " + toString());
+      }
+      // check for sub-struct validity
+    }
+
+    private void writeObject(java.io.ObjectOutputStream out) throws java.io.IOException {
+      try {
+        write(new org.apache.thrift.protocol.TCompactProtocol(new org.apache.thrift.transport.TIOStreamTransport(out)));
+      } catch (org.apache.thrift.TException te) {
+        throw new java.io.IOException(te);
+      }
+    }
+
+    private void readObject(java.io.ObjectInputStream in) throws java.io.IOException, ClassNotFoundException {
+      try {
+        // it doesn't seem like you should have to do this, but java serialization is wacky, and doesn't call the default constructor.
+        __isset_bitfield = 0;
+        read(new org.apache.thrift.protocol.TCompactProtocol(new org.apache.thrift.transport.TIOStreamTransport(in)));
+      } catch (org.apache.thrift.TException te) {
+        throw new java.io.IOException(te);
+      }
+    }
+
+    private static class knnQueryBatch_argsStandardSchemeFactory implements SchemeFactory {
+      public knnQueryBatch_argsStandardScheme getScheme() {
+        return new knnQueryBatch_argsStandardScheme();
+      }
+    }
+
+    private static class knnQueryBatch_argsStandardScheme extends StandardScheme<knnQueryBatch_args> {
+
+      public void read(org.apache.thrift.protocol.TProtocol iprot, knnQueryBatch_args struct) throws org.apache.thrift.TException {
+        org.apache.thrift.protocol.TField schemeField;
+        iprot.readStructBegin();
+        while (true)
+        {
+          schemeField = iprot.readFieldBegin();
+          if (schemeField.type == org.apache.thrift.protocol.TType.STOP) { 
+            break;
+          }
+          switch (schemeField.id) {
+            case 1: // K
+              if (schemeField.type == org.apache.thrift.protocol.TType.I32) {
+                struct.k = iprot.readI32();
+                struct.setKIsSet(true);
+              } else { 
+                org.apache.thrift.protocol.TProtocolUtil.skip(iprot, schemeField.type);
+              }
+              break;
+            case 2: // QUERY_OBJ
+              if (schemeField.type == org.apache.thrift.protocol.TType.LIST) {
+                {
+                  org.apache.thrift.protocol.TList _list16 = iprot.readListBegin();
+                  struct.queryObj = new ArrayList<String>(_list16.size);
+                  String _elem17;
+                  for (int _i18 = 0; _i18 < _list16.size; ++_i18)
+                  {
+                    _elem17 = iprot.readString();
+                    struct.queryObj.add(_elem17);
+                  }
+                  iprot.readListEnd();
+                }
+                struct.setQueryObjIsSet(true);
+              } else { 
+                org.apache.thrift.protocol.TProtocolUtil.skip(iprot, schemeField.type);
+              }
+              break;
+            case 3: // RET_EXTERN_ID
+              if (schemeField.type == org.apache.thrift.protocol.TType.BOOL) {
+                struct.retExternId = iprot.readBool();
+                struct.setRetExternIdIsSet(true);
+              } else { 
+                org.apache.thrift.protocol.TProtocolUtil.skip(iprot, schemeField.type);
+              }
+              break;
+            case 4: // RET_OBJ
+              if (schemeField.type == org.apache.thrift.protocol.TType.BOOL) {
+                struct.retObj = iprot.readBool();
+                struct.setRetObjIsSet(true);
+              } else { 
+                org.apache.thrift.protocol.TProtocolUtil.skip(iprot, schemeField.type);
+              }
+              break;
+            case 5: // QUERY_TIME_PARAMS
+              if (schemeField.type == org.apache.thrift.protocol.TType.STRING) {
+                struct.queryTimeParams = iprot.readString();
+                struct.setQueryTimeParamsIsSet(true);
+              } else { 
+                org.apache.thrift.protocol.TProtocolUtil.skip(iprot, schemeField.type);
+              }
+              break;
+            default:
+              org.apache.thrift.protocol.TProtocolUtil.skip(iprot, schemeField.type);
+          }
+          iprot.readFieldEnd();
+        }
+        iprot.readStructEnd();
+
+        // check for required fields of primitive type, which can't be checked in the validate method
+        if (!struct.isSetK()) {
+          throw new org.apache.thrift.protocol.TProtocolException("Required field 'k' was not found in serialized data! Struct: " + toString());
+        }
+        if (!struct.isSetRetExternId()) {
+          throw new org.apache.thrift.protocol.TProtocolException("Required field 'retExternId' was not found in serialized data! Struct: " + toString());
+        }
+        if (!struct.isSetRetObj()) {
+          throw new org.apache.thrift.protocol.TProtocolException("Required field 'retObj' was not found in serialized data! Struct: " + toString());
+        }
+        struct.validate();
+      }
+
+      public void write(org.apache.thrift.protocol.TProtocol oprot, knnQueryBatch_args struct) throws org.apache.thrift.TException {
+        struct.validate();
+
+        oprot.writeStructBegin(STRUCT_DESC);
+        oprot.writeFieldBegin(K_FIELD_DESC);
+        oprot.writeI32(struct.k);
+        oprot.writeFieldEnd();
+        if (struct.queryObj != null) {
+          oprot.writeFieldBegin(QUERY_OBJ_FIELD_DESC);
+          {
+            oprot.writeListBegin(new org.apache.thrift.protocol.TList(org.apache.thrift.protocol.TType.STRING, struct.queryObj.size()));
+            for (String _iter19 : struct.queryObj)
+            {
+              oprot.writeString(_iter19);
+            }
+            oprot.writeListEnd();
+          }
+          oprot.writeFieldEnd();
+        }
+        oprot.writeFieldBegin(RET_EXTERN_ID_FIELD_DESC);
+        oprot.writeBool(struct.retExternId);
+        oprot.writeFieldEnd();
+        oprot.writeFieldBegin(RET_OBJ_FIELD_DESC);
+        oprot.writeBool(struct.retObj);
+        oprot.writeFieldEnd();
+        if (struct.queryTimeParams != null) {
+          oprot.writeFieldBegin(QUERY_TIME_PARAMS_FIELD_DESC);
+          oprot.writeString(struct.queryTimeParams);
+          oprot.writeFieldEnd();
+        }
+        oprot.writeFieldStop();
+        oprot.writeStructEnd();
+      }
+
+    }
+
+    private static class knnQueryBatch_argsTupleSchemeFactory implements SchemeFactory {
+      public knnQueryBatch_argsTupleScheme getScheme() {
+        return new knnQueryBatch_argsTupleScheme();
+      }
+    }
+
+    private static class knnQueryBatch_argsTupleScheme extends TupleScheme<knnQueryBatch_args> {
+
+      @Override
+      public void write(org.apache.thrift.protocol.TProtocol prot, knnQueryBatch_args struct) throws org.apache.thrift.TException {
+        TTupleProtocol oprot = (TTupleProtocol) prot;
+        oprot.writeI32(struct.k);
+        {
+          oprot.writeI32(struct.queryObj.size());
+          for (String _iter20 : struct.queryObj)
+          {
+            oprot.writeString(_iter20);
+          }
+        }
+        oprot.writeBool(struct.retExternId);
+        oprot.writeBool(struct.retObj);
+        oprot.writeString(struct.queryTimeParams);
+      }
+
+      @Override
+      public void read(org.apache.thrift.protocol.TProtocol prot, knnQueryBatch_args struct) throws org.apache.thrift.TException {
+        TTupleProtocol iprot = (TTupleProtocol) prot;
+        struct.k = iprot.readI32();
+        struct.setKIsSet(true);
+        {
+          org.apache.thrift.protocol.TList _list21 = new org.apache.thrift.protocol.TList(org.apache.thrift.protocol.TType.STRING, iprot.readI32());
+          struct.queryObj = new ArrayList<String>(_list21.size);
+          String _elem22;
+          for (int _i23 = 0; _i23 < _list21.size; ++_i23)
+          {
+            _elem22 = iprot.readString();
+            struct.queryObj.add(_elem22);
+          }
+        }
+        struct.setQueryObjIsSet(true);
+        struct.retExternId = iprot.readBool();
+        struct.setRetExternIdIsSet(true);
+        struct.retObj = iprot.readBool();
+        struct.setRetObjIsSet(true);
+        struct.queryTimeParams = iprot.readString();
+        struct.setQueryTimeParamsIsSet(true);
+      }
+    }
+
+  }
+
+  public static class knnQueryBatch_result implements org.apache.thrift.TBase<knnQueryBatch_result, knnQueryBatch_result._Fields>, java.io.Serializable, Cloneable, Comparable<knnQueryBatch_result>   {
+    private static final org.apache.thrift.protocol.TStruct STRUCT_DESC = new org.apache.thrift.protocol.TStruct("knnQueryBatch_result");
+
+    private static final org.apache.thrift.protocol.TField SUCCESS_FIELD_DESC = new org.apache.thrift.protocol.TField("success", org.apache.thrift.protocol.TType.LIST, (short)0);
+    private static final org.apache.thrift.protocol.TField ERR_FIELD_DESC = new org.apache.thrift.protocol.TField("err", org.apache.thrift.protocol.TType.STRUCT, (short)1);
+
+    private static final Map<Class<? extends IScheme>, SchemeFactory> schemes = new HashMap<Class<? extends IScheme>, SchemeFactory>();
+    static {
+      schemes.put(StandardScheme.class, new knnQueryBatch_resultStandardSchemeFactory());
+      schemes.put(TupleScheme.class, new knnQueryBatch_resultTupleSchemeFactory());
+    }
+
+    public List<List<ReplyEntry>> success; // required
+    public QueryException err; // required
+
+    /** The set of fields this struct contains, along with convenience methods for finding and manipulating them. */
+    public enum _Fields implements org.apache.thrift.TFieldIdEnum {
+      SUCCESS((short)0, "success"),
+      ERR((short)1, "err");
+
+      private static final Map<String, _Fields> byName = new HashMap<String, _Fields>();
+
+      static {
+        for (_Fields field : EnumSet.allOf(_Fields.class)) {
+          byName.put(field.getFieldName(), field);
+        }
+      }
+
+      /**
+       * Find the _Fields constant that matches fieldId, or null if its not found.
+       */
+      public static _Fields findByThriftId(int fieldId) {
+        switch(fieldId) {
+          case 0: // SUCCESS
+            return SUCCESS;
+          case 1: // ERR
+            return ERR;
+          default:
+            return null;
+        }
+      }
+
+      /**
+       * Find the _Fields constant that matches fieldId, throwing an exception
+       * if it is not found.
+       */
+      public static _Fields findByThriftIdOrThrow(int fieldId) {
+        _Fields fields = findByThriftId(fieldId);
+        if (fields == null) throw new IllegalArgumentException("Field " + fieldId + " doesn't exist!");
+        return fields;
+      }
+
+      /**
+       * Find the _Fields constant that matches name, or null if its not found.
+       */
+      public static _Fields findByName(String name) {
+        return byName.get(name);
+      }
+
+      private final short _thriftId;
+      private final String _fieldName;
+
+      _Fields(short thriftId, String fieldName) {
+        _thriftId = thriftId;
+        _fieldName = fieldName;
+      }
+
+      public short getThriftFieldId() {
+        return _thriftId;
+      }
+
+      public String getFieldName() {
+        return _fieldName;
+      }
+    }
+
+    // isset id assignments
+    public static final Map<_Fields, org.apache.thrift.meta_data.FieldMetaData> metaDataMap;
+    static {
+      Map<_Fields, org.apache.thrift.meta_data.FieldMetaData> tmpMap = new EnumMap<_Fields, org.apache.thrift.meta_data.FieldMetaData>(_Fields.class);
+      tmpMap.put(_Fields.SUCCESS, new org.apache.thrift.meta_data.FieldMetaData("success", org.apache.thrift.TFieldRequirementType.DEFAULT, 
+          new org.apache.thrift.meta_data.ListMetaData(org.apache.thrift.protocol.TType.LIST, 
+              new org.apache.thrift.meta_data.FieldValueMetaData(org.apache.thrift.protocol.TType.LIST              , "ReplyEntryList"))));
+      tmpMap.put(_Fields.ERR, new org.apache.thrift.meta_data.FieldMetaData("err", org.apache.thrift.TFieldRequirementType.DEFAULT, 
+          new org.apache.thrift.meta_data.FieldValueMetaData(org.apache.thrift.protocol.TType.STRUCT)));
+      metaDataMap = Collections.unmodifiableMap(tmpMap);
+      org.apache.thrift.meta_data.FieldMetaData.addStructMetaDataMap(knnQueryBatch_result.class, metaDataMap);
+    }
+
+    public knnQueryBatch_result() {
+    }
+
+    public knnQueryBatch_result(
+      List<List<ReplyEntry>> success,
+      QueryException err)
+    {
+      this();
+      this.success = success;
+      this.err = err;
+    }
+
+    /**
+     * Performs a deep copy on <i>other</i>.
+     */
+    public knnQueryBatch_result(knnQueryBatch_result other) {
+      if (other.isSetSuccess()) {
+        List<List<ReplyEntry>> __this__success = new ArrayList<List<ReplyEntry>>(other.success.size());
+        for (List<ReplyEntry> other_element : other.success) {
+          __this__success.add(other_element);
+        }
+        this.success = __this__success;
+      }
+      if (other.isSetErr()) {
+        this.err = new QueryException(other.err);
+      }
+    }
+
+    public knnQueryBatch_result deepCopy() {
+      return new knnQueryBatch_result(this);
+    }
+
+    @Override
+    public void clear() {
+      this.success = null;
+      this.err = null;
+    }
+
+    public int getSuccessSize() {
+      return (this.success == null) ? 0 : this.success.size();
+    }
+
+    public java.util.Iterator<List<ReplyEntry>> getSuccessIterator() {
+      return (this.success == null) ? null : this.success.iterator();
+    }
+
+    public void addToSuccess(List<ReplyEntry> elem) {
+      if (this.success == null) {
+        this.success = new ArrayList<List<ReplyEntry>>();
+      }
+      this.success.add(elem);
+    }
+
+    public List<List<ReplyEntry>> getSuccess() {
+      return this.success;
+    }
+
+    public knnQueryBatch_result setSuccess(List<List<ReplyEntry>> success) {
+      this.success = success;
+      return this;
+    }
+
+    public void unsetSuccess() {
+      this.success = null;
+    }
+
+    /** Returns true if field success is set (has been assigned a value) and false otherwise */
+    public boolean isSetSuccess() {
+      return this.success != null;
+    }
+
+    public void setSuccessIsSet(boolean value) {
+      if (!value) {
+        this.success = null;
+      }
+    }
+
+    public QueryException getErr() {
+      return this.err;
+    }
+
+    public knnQueryBatch_result setErr(QueryException err) {
+      this.err = err;
+      return this;
+    }
+
+    public void unsetErr() {
+      this.err = null;
+    }
+
+    /** Returns true if field err is set (has been assigned a value) and false otherwise */
+    public boolean isSetErr() {
+      return this.err != null;
+    }
+
+    public void setErrIsSet(boolean value) {
+      if (!value) {
+        this.err = null;
+      }
+    }
+
+    public void setFieldValue(_Fields field, Object value) {
+      switch (field) {
+      case SUCCESS:
+        if (value == null) {
+          unsetSuccess();
+        } else {
+          setSuccess((List<List<ReplyEntry>>)value);
+        }
+        break;
+
+      case ERR:
+        if (value == null) {
+          unsetErr();
+        } else {
+          setErr((QueryException)value);
+        }
+        break;
+
+      }
+    }
+
+    public Object getFieldValue(_Fields field) {
+      switch (field) {
+      case SUCCESS:
+        return getSuccess();
+
+      case ERR:
+        return getErr();
+
+      }
+      throw new IllegalStateException();
+    }
+
+    /** Returns true if field corresponding to fieldID is set (has been assigned a value) and false otherwise */
+    public boolean isSet(_Fields field) {
+      if (field == null) {
+        throw new IllegalArgumentException();
+      }
+
+      switch (field) {
+      case SUCCESS:
+        return isSetSuccess();
+      case ERR:
+        return isSetErr();
+      }
+      throw new IllegalStateException();
+    }
+
+    @Override
+    public boolean equals(Object that) {
+      if (that == null)
+        return false;
+      if (that instanceof knnQueryBatch_result)
+        return this.equals((knnQueryBatch_result)that);
+      return false;
+    }
+
+    public boolean equals(knnQueryBatch_result that) {
+      if (that == null)
+        return false;
+
+      boolean this_present_success = true && this.isSetSuccess();
+      boolean that_present_success = true && that.isSetSuccess();
+      if (this_present_success || that_present_success) {
+        if (!(this_present_success && that_present_success))
+          return false;
+        if (!this.success.equals(that.success))
+          return false;
+      }
+
+      boolean this_present_err = true && this.isSetErr();
+      boolean that_present_err = true && that.isSetErr();
+      if (this_present_err || that_present_err) {
+        if (!(this_present_err && that_present_err))
+          return false;
+        if (!this.err.equals(that.err))
+          return false;
+      }
+
+      return true;
+    }
+
+    @Override
+    public int hashCode() {
+      List<Object> list = new ArrayList<Object>();
+
+      boolean present_success = true && (isSetSuccess());
+      list.add(present_success);
+      if (present_success)
+        list.add(success);
+
+      boolean present_err = true && (isSetErr());
+      list.add(present_err);
+      if (present_err)
+        list.add(err);
+
+      return list.hashCode();
+    }
+
+    @Override
+    public int compareTo(knnQueryBatch_result other) {
+      if (!getClass().equals(other.getClass())) {
+        return getClass().getName().compareTo(other.getClass().getName());
+      }
+
+      int lastComparison = 0;
+
+      lastComparison = Boolean.valueOf(isSetSuccess()).compareTo(other.isSetSuccess());
+      if (lastComparison != 0) {
+        return lastComparison;
+      }
+      if (isSetSuccess()) {
+        lastComparison = org.apache.thrift.TBaseHelper.compareTo(this.success, other.success);
+        if (lastComparison != 0) {
+          return lastComparison;
+        }
+      }
+      lastComparison = Boolean.valueOf(isSetErr()).compareTo(other.isSetErr());
+      if (lastComparison != 0) {
+        return lastComparison;
+      }
+      if (isSetErr()) {
+        lastComparison = org.apache.thrift.TBaseHelper.compareTo(this.err, other.err);
+        if (lastComparison != 0) {
+          return lastComparison;
+        }
+      }
+      return 0;
+    }
+
+    public _Fields fieldForId(int fieldId) {
+      return _Fields.findByThriftId(fieldId);
+    }
+
+    public void read(org.apache.thrift.protocol.TProtocol iprot) throws org.apache.thrift.TException {
+      schemes.get(iprot.getScheme()).getScheme().read(iprot, this);
+    }
+
+    public void write(org.apache.thrift.protocol.TProtocol oprot) throws org.apache.thrift.TException {
+      schemes.get(oprot.getScheme()).getScheme().write(oprot, this);
+      }
+
+    @Override
+    public String toString() {
+      StringBuilder sb = new StringBuilder("knnQueryBatch_result(");
+      boolean first = true;
+
+      sb.append("success:");
+      if (this.success == null) {
+        sb.append("null");
+      } else {
+        sb.append(this.success);
+      }
+      first = false;
+      if (!first) sb.append(", ");
+      sb.append("err:");
+      if (this.err == null) {
+        sb.append("null");
+      } else {
+        sb.append(this.err);
+      }
+      first = false;
+      sb.append(")");
+      return sb.toString();
+    }
+
+    public void validate() throws org.apache.thrift.TException {
+      // check for required fields
+      // check for sub-struct validity
+    }
+
+    private void writeObject(java.io.ObjectOutputStream out) throws java.io.IOException {
+      try {
+        write(new org.apache.thrift.protocol.TCompactProtocol(new org.apache.thrift.transport.TIOStreamTransport(out)));
+      } catch (org.apache.thrift.TException te) {
+        throw new java.io.IOException(te);
+      }
+    }
+
+    private void readObject(java.io.ObjectInputStream in) throws java.io.IOException, ClassNotFoundException {
+      try {
+        read(new org.apache.thrift.protocol.TCompactProtocol(new org.apache.thrift.transport.TIOStreamTransport(in)));
+      } catch (org.apache.thrift.TException te) {
+        throw new java.io.IOException(te);
+      }
+    }
+
+    private static class knnQueryBatch_resultStandardSchemeFactory implements SchemeFactory {
+      public knnQueryBatch_resultStandardScheme getScheme() {
+        return new knnQueryBatch_resultStandardScheme();
+      }
+    }
+
+    private static class knnQueryBatch_resultStandardScheme extends StandardScheme<knnQueryBatch_result> {
+
+      public void read(org.apache.thrift.protocol.TProtocol iprot, knnQueryBatch_result struct) throws org.apache.thrift.TException {
+        org.apache.thrift.protocol.TField schemeField;
+        iprot.readStructBegin();
+        while (true)
+        {
+          schemeField = iprot.readFieldBegin();
+          if (schemeField.type == org.apache.thrift.protocol.TType.STOP) { 
+            break;
+          }
+          switch (schemeField.id) {
+            case 0: // SUCCESS
+              if (schemeField.type == org.apache.thrift.protocol.TType.LIST) {
+                {
+                  org.apache.thrift.protocol.TList _list24 = iprot.readListBegin();
+                  struct.success = new ArrayList<List<ReplyEntry>>(_list24.size);
+                  List<ReplyEntry> _elem25;
+                  for (int _i26 = 0; _i26 < _list24.size; ++_i26)
+                  {
+                    {
+                      org.apache.thrift.protocol.TList _list27 = iprot.readListBegin();
+                      _elem25 = new ArrayList<ReplyEntry>(_list27.size);
+                      ReplyEntry _elem28;
+                      for (int _i29 = 0; _i29 < _list27.size; ++_i29)
+                      {
+                        _elem28 = new ReplyEntry();
+                        _elem28.read(iprot);
+                        _elem25.add(_elem28);
+                      }
+                      iprot.readListEnd();
+                    }
+                    struct.success.add(_elem25);
+                  }
+                  iprot.readListEnd();
+                }
+                struct.setSuccessIsSet(true);
+              } else { 
+                org.apache.thrift.protocol.TProtocolUtil.skip(iprot, schemeField.type);
+              }
+              break;
+            case 1: // ERR
+              if (schemeField.type == org.apache.thrift.protocol.TType.STRUCT) {
+                struct.err = new QueryException();
+                struct.err.read(iprot);
+                struct.setErrIsSet(true);
+              } else { 
+                org.apache.thrift.protocol.TProtocolUtil.skip(iprot, schemeField.type);
+              }
+              break;
+            default:
+              org.apache.thrift.protocol.TProtocolUtil.skip(iprot, schemeField.type);
+          }
+          iprot.readFieldEnd();
+        }
+        iprot.readStructEnd();
+
+        // check for required fields of primitive type, which can't be checked in the validate method
+        struct.validate();
+      }
+
+      public void write(org.apache.thrift.protocol.TProtocol oprot, knnQueryBatch_result struct) throws org.apache.thrift.TException {
+        struct.validate();
+
+        oprot.writeStructBegin(STRUCT_DESC);
+        if (struct.success != null) {
+          oprot.writeFieldBegin(SUCCESS_FIELD_DESC);
+          {
+            oprot.writeListBegin(new org.apache.thrift.protocol.TList(org.apache.thrift.protocol.TType.LIST, struct.success.size()));
+            for (List<ReplyEntry> _iter30 : struct.success)
+            {
+              {
+                oprot.writeListBegin(new org.apache.thrift.protocol.TList(org.apache.thrift.protocol.TType.STRUCT, _iter30.size()));
+                for (ReplyEntry _iter31 : _iter30)
+                {
+                  _iter31.write(oprot);
+                }
+                oprot.writeListEnd();
+              }
+            }
+            oprot.writeListEnd();
+          }
+          oprot.writeFieldEnd();
+        }
+        if (struct.err != null) {
+          oprot.writeFieldBegin(ERR_FIELD_DESC);
+          struct.err.write(oprot);
+          oprot.writeFieldEnd();
+        }
+        oprot.writeFieldStop();
+        oprot.writeStructEnd();
+      }
+
+    }
+
+    private static class knnQueryBatch_resultTupleSchemeFactory implements SchemeFactory {
+      public knnQueryBatch_resultTupleScheme getScheme() {
+        return new knnQueryBatch_resultTupleScheme();
+      }
+    }
+
+    private static class knnQueryBatch_resultTupleScheme extends TupleScheme<knnQueryBatch_result> {
+
+      @Override
+      public void write(org.apache.thrift.protocol.TProtocol prot, knnQueryBatch_result struct) throws org.apache.thrift.TException {
+        TTupleProtocol oprot = (TTupleProtocol) prot;
+        BitSet optionals = new BitSet();
+        if (struct.isSetSuccess()) {
+          optionals.set(0);
+        }
+        if (struct.isSetErr()) {
+          optionals.set(1);
+        }
+        oprot.writeBitSet(optionals, 2);
+        if (struct.isSetSuccess()) {
+          {
+            oprot.writeI32(struct.success.size());
+            for (List<ReplyEntry> _iter32 : struct.success)
+            {
+              {
+                oprot.writeI32(_iter32.size());
+                for (ReplyEntry _iter33 : _iter32)
+                {
+                  _iter33.write(oprot);
+                }
+              }
+            }
+          }
+        }
+        if (struct.isSetErr()) {
+          struct.err.write(oprot);
+        }
+      }
+
+      @Override
+      public void read(org.apache.thrift.protocol.TProtocol prot, knnQueryBatch_result struct) throws org.apache.thrift.TException {
+        TTupleProtocol iprot = (TTupleProtocol) prot;
+        BitSet incoming = iprot.readBitSet(2);
+        if (incoming.get(0)) {
+          {
+            org.apache.thrift.protocol.TList _list34 = new org.apache.thrift.protocol.TList(org.apache.thrift.protocol.TType.LIST, iprot.readI32());
+            struct.success = new ArrayList<List<ReplyEntry>>(_list34.size);
+            List<ReplyEntry> _elem35;
+            for (int _i36 = 0; _i36 < _list34.size; ++_i36)
+            {
+              {
+                org.apache.thrift.protocol.TList _list37 = new org.apache.thrift.protocol.TList(org.apache.thrift.protocol.TType.STRUCT, iprot.readI32());
+                _elem35 = new ArrayList<ReplyEntry>(_list37.size);
+                ReplyEntry _elem38;
+                for (int _i39 = 0; _i39 < _list37.size; ++_i39)
+                {
+                  _elem38 = new ReplyEntry();
+                  _elem38.read(iprot);
+                  _elem35.add(_elem38);
+                }
+              }
+              struct.success.add(_elem35);
+            }
+          }
+          struct.setSuccessIsSet(true);
+        }
+        if (incoming.get(1)) {
+          struct.err = new QueryException();
+          struct.err.read(iprot);
+          struct.setErrIsSet(true);
+        }
+      }
+    }
+
+  }
+
+
+  public static class knnQueryBatchBinary_args implements org.apache.thrift.TBase<knnQueryBatchBinary_args, knnQueryBatchBinary_args._Fields>, java.io.Serializable, Cloneable, Comparable<knnQueryBatchBinary_args>   {
+    private static final org.apache.thrift.protocol.TStruct STRUCT_DESC = new org.apache.thrift.protocol.TStruct("knnQueryBatchBinary_args");
+
+    private static final org.apache.thrift.protocol.TField K_FIELD_DESC = new org.apache.thrift.protocol.TField("k", org.apache.thrift.protocol.TType.I32, (short)1);
+    private static final org.apache.thrift.protocol.TField QUERY_OBJ_FIELD_DESC = new org.apache.thrift.protocol.TField("queryObj", org.apache.thrift.protocol.TType.LIST, (short)2);
+    private static final org.apache.thrift.protocol.TField RET_EXTERN_ID_FIELD_DESC = new org.apache.thrift.protocol.TField("retExternId", org.apache.thrift.protocol.TType.BOOL, (short)3);
+    private static final org.apache.thrift.protocol.TField RET_OBJ_FIELD_DESC = new org.apache.thrift.protocol.TField("retObj", org.apache.thrift.protocol.TType.BOOL, (short)4);
+    private static final org.apache.thrift.protocol.TField QUERY_TIME_PARAMS_FIELD_DESC = new org.apache.thrift.protocol.TField("queryTimeParams", org.apache.thrift.protocol.TType.STRING, (short)5);
+
+    private static final Map<Class<? extends IScheme>, SchemeFactory> schemes = new HashMap<Class<? extends IScheme>, SchemeFactory>();
+    static {
+      schemes.put(StandardScheme.class, new knnQueryBatchBinary_argsStandardSchemeFactory());
+      schemes.put(TupleScheme.class, new knnQueryBatchBinary_argsTupleSchemeFactory());
+    }
+
+    public int k; // required
+    public List<ByteBuffer> queryObj; // required
+    public boolean retExternId; // required
+    public boolean retObj; // required
+    public String queryTimeParams; // required
+
+    /** The set of fields this struct contains, along with convenience methods for finding and manipulating them. */
+    public enum _Fields implements org.apache.thrift.TFieldIdEnum {
+      K((short)1, "k"),
+      QUERY_OBJ((short)2, "queryObj"),
+      RET_EXTERN_ID((short)3, "retExternId"),
+      RET_OBJ((short)4, "retObj"),
+      QUERY_TIME_PARAMS((short)5, "queryTimeParams");
+
+      private static final Map<String, _Fields> byName = new HashMap<String, _Fields>();
+
+      static {
+        for (_Fields field : EnumSet.allOf(_Fields.class)) {
+          byName.put(field.getFieldName(), field);
+        }
+      }
+
+      /**
+       * Find the _Fields constant that matches fieldId, or null if its not found.
+       */
+      public static _Fields findByThriftId(int fieldId) {
+        switch(fieldId) {
+          case 1: // K
+            return K;
+          case 2: // QUERY_OBJ
+            return QUERY_OBJ;
+          case 3: // RET_EXTERN_ID
+            return RET_EXTERN_ID;
+          case 4: // RET_OBJ
+            return RET_OBJ;
+          case 5: // QUERY_TIME_PARAMS
+            return QUERY_TIME_PARAMS;
+          default:
+            return null;
+        }
+      }
+
+      /**
+       * Find the _Fields constant that matches fieldId, throwing an exception
+       * if it is not found.
+       */
+      public static _Fields findByThriftIdOrThrow(int fieldId) {
+        _Fields fields = findByThriftId(fieldId);
+        if (fields == null) throw new IllegalArgumentException("Field " + fieldId + " doesn't exist!");
+        return fields;
+      }
+
+      /**
+       * Find the _Fields constant that matches name, or null if its not found.
+       */
+      public static _Fields findByName(String name) {
+        return byName.get(name);
+      }
+
+      private final short _thriftId;
+      private final String _fieldName;
+
+      _Fields(short thriftId, String fieldName) {
+        _thriftId = thriftId;
+        _fieldName = fieldName;
+      }
+
+      public short getThriftFieldId() {
+        return _thriftId;
+      }
+
+      public String getFieldName() {
+        return _fieldName;
+      }
+    }
+
+    // isset id assignments
+    private static final int __K_ISSET_ID = 0;
+    private static final int __RETEXTERNID_ISSET_ID = 1;
+    private static final int __RETOBJ_ISSET_ID = 2;
+    private byte __isset_bitfield = 0;
+    public static final Map<_Fields, org.apache.thrift.meta_data.FieldMetaData> metaDataMap;
+    static {
+      Map<_Fields, org.apache.thrift.meta_data.FieldMetaData> tmpMap = new EnumMap<_Fields, org.apache.thrift.meta_data.FieldMetaData>(_Fields.class);
+      tmpMap.put(_Fields.K, new org.apache.thrift.meta_data.FieldMetaData("k", org.apache.thrift.TFieldRequirementType.REQUIRED, 
+          new org.apache.thrift.meta_data.FieldValueMetaData(org.apache.thrift.protocol.TType.I32)));
+      tmpMap.put(_Fields.QUERY_OBJ, new org.apache.thrift.meta_data.FieldMetaData("queryObj", org.apache.thrift.TFieldRequirementType.REQUIRED, 
+          new org.apache.thrift.meta_data.ListMetaData(org.apache.thrift.protocol.TType.LIST, 
+              new org.apache.thrift.meta_data.FieldValueMetaData(org.apache.thrift.protocol.TType.STRING            , true))));
+      tmpMap.put(_Fields.RET_EXTERN_ID, new org.apache.thrift.meta_data.FieldMetaData("retExternId", org.apache.thrift.TFieldRequirementType.REQUIRED, 
+          new org.apache.thrift.meta_data.FieldValueMetaData(org.apache.thrift.protocol.TType.BOOL)));
+      tmpMap.put(_Fields.RET_OBJ, new org.apache.thrift.meta_data.FieldMetaData("retObj", org.apache.thrift.TFieldRequirementType.REQUIRED, 
+          new org.apache.thrift.meta_data.FieldValueMetaData(org.apache.thrift.protocol.TType.BOOL)));
+      tmpMap.put(_Fields.QUERY_TIME_PARAMS, new org.apache.thrift.meta_data.FieldMetaData("queryTimeParams", org.apache.thrift.TFieldRequirementType.REQUIRED, 
+          new org.apache.thrift.meta_data.FieldValueMetaData(org.apache.thrift.protocol.TType.STRING)));
+      metaDataMap = Collections.unmodifiableMap(tmpMap);
+      org.apache.thrift.meta_data.FieldMetaData.addStructMetaDataMap(knnQueryBatchBinary_args.class, metaDataMap);
+    }
+
+    public knnQueryBatchBinary_args() {
+    }
+
+    public knnQueryBatchBinary_args(
+      int k,
+      List<ByteBuffer> queryObj,
+      boolean retExternId,
+      boolean retObj,
+      String queryTimeParams)
+    {
+      this();
+      this.k = k;
+      setKIsSet(true);
+      this.queryObj = queryObj;
+      this.retExternId = retExternId;
+      setRetExternIdIsSet(true);
+      this.retObj = retObj;
+      setRetObjIsSet(true);
+      this.queryTimeParams = queryTimeParams;
+    }
+
+    /**
+     * Performs a deep copy on <i>other</i>.
+     */
+    public knnQueryBatchBinary_args(knnQueryBatchBinary_args other) {
+      __isset_bitfield = other.__isset_bitfield;
+      this.k = other.k;
+      if (other.isSetQueryObj()) {
+        List<ByteBuffer> __this__queryObj = new ArrayList<ByteBuffer>(other.queryObj);
+        this.queryObj = __this__queryObj;
+      }
+      this.retExternId = other.retExternId;
+      this.retObj = other.retObj;
+      if (other.isSetQueryTimeParams()) {
+        this.queryTimeParams = other.queryTimeParams;
+      }
+    }
+
+    public knnQueryBatchBinary_args deepCopy() {
+      return new knnQueryBatchBinary_args(this);
+    }
+
+    @Override
+    public void clear() {
+      setKIsSet(false);
+      this.k = 0;
+      this.queryObj = null;
+      setRetExternIdIsSet(false);
+      this.retExternId = false;
+      setRetObjIsSet(false);
+      this.retObj = false;
+      this.queryTimeParams = null;
+    }
+
+    public int getK() {
+      return this.k;
+    }
+
+    public knnQueryBatchBinary_args setK(int k) {
+      this.k = k;
+      setKIsSet(true);
+      return this;
+    }
+
+    public void unsetK() {
+      __isset_bitfield = EncodingUtils.clearBit(__isset_bitfield, __K_ISSET_ID);
+    }
+
+    /** Returns true if field k is set (has been assigned a value) and false otherwise */
+    public boolean isSetK() {
+      return EncodingUtils.testBit(__isset_bitfield, __K_ISSET_ID);
+    }
+
+    public void setKIsSet(boolean value) {
+      __isset_bitfield = EncodingUtils.setBit(__isset_bitfield, __K_ISSET_ID, value);
+    }
+
+    public int getQueryObjSize() {
+      return (this.queryObj == null) ? 0 : this.queryObj.size();
+    }
+
+    public java.util.Iterator<ByteBuffer> getQueryObjIterator() {
+      return (this.queryObj == null) ? null : this.queryObj.iterator();
+    }
+
+    public void addToQueryObj(ByteBuffer elem) {
+      if (this.queryObj == null) {
+        this.queryObj = new ArrayList<ByteBuffer>();
+      }
+      this.queryObj.add(elem);
+    }
+
+    public List<ByteBuffer> getQueryObj() {
+      return this.queryObj;
+    }
+
+    public knnQueryBatchBinary_args setQueryObj(List<ByteBuffer> queryObj) {
+      this.queryObj = queryObj;
+      return this;
+    }
+
+    public void unsetQueryObj() {
+      this.queryObj = null;
+    }
+
+    /** Returns true if field queryObj is set (has been assigned a value) and false otherwise */
+    public boolean isSetQueryObj() {
+      return this.queryObj != null;
+    }
+
+    public void setQueryObjIsSet(boolean value) {
+      if (!value) {
+        this.queryObj = null;
+      }
+    }
+
+    public boolean isRetExternId() {
+      return this.retExternId;
+    }
+
+    public knnQueryBatchBinary_args setRetExternId(boolean retExternId) {
+      this.retExternId = retExternId;
+      setRetExternIdIsSet(true);
+      return this;
+    }
+
+    public void unsetRetExternId() {
+      __isset_bitfield = EncodingUtils.clearBit(__isset_bitfield, __RETEXTERNID_ISSET_ID);
+    }
+
+    /** Returns true if field retExternId is set (has been assigned a value) and false otherwise */
+    public boolean isSetRetExternId() {
+      return EncodingUtils.testBit(__isset_bitfield, __RETEXTERNID_ISSET_ID);
+    }
+
+    public void setRetExternIdIsSet(boolean value) {
+      __isset_bitfield = EncodingUtils.setBit(__isset_bitfield, __RETEXTERNID_ISSET_ID, value);
+    }
+
+    public boolean isRetObj() {
+      return this.retObj;
+    }
+
+    public knnQueryBatchBinary_args setRetObj(boolean retObj) {
+      this.retObj = retObj;
+      setRetObjIsSet(true);
+      return this;
+    }
+
+    public void unsetRetObj() {
+      __isset_bitfield = EncodingUtils.clearBit(__isset_bitfield, __RETOBJ_ISSET_ID);
+    }
+
+    /** Returns true if field retObj is set (has been assigned a value) and false otherwise */
+    public boolean isSetRetObj() {
+      return EncodingUtils.testBit(__isset_bitfield, __RETOBJ_ISSET_ID);
+    }
+
+    public void setRetObjIsSet(boolean value) {
+      __isset_bitfield = EncodingUtils.setBit(__isset_bitfield, __RETOBJ_ISSET_ID, value);
+    }
+
+    public String getQueryTimeParams() {
+      return this.queryTimeParams;
+    }
+
+    public knnQueryBatchBinary_args setQueryTimeParams(String queryTimeParams) {
+      this.queryTimeParams = queryTimeParams;
+      return this;
+    }
+
+    public void unsetQueryTimeParams() {
+      this.queryTimeParams = null;
+    }
+
+    /** Returns true if field queryTimeParams is set (has been assigned a value) and false otherwise */
+    public boolean isSetQueryTimeParams() {
+      return this.queryTimeParams != null;
+    }
+
+    public void setQueryTimeParamsIsSet(boolean value) {
+      if (!value) {
+        this.queryTimeParams = null;
+      }
+    }
+
+    public void setFieldValue(_Fields field, Object value) {
+      switch (field) {
+      case K:
+        if (value == null) {
+          unsetK();
+        } else {
+          setK((Integer)value);
+        }
+        break;
+
+      case QUERY_OBJ:
+        if (value == null) {
+          unsetQueryObj();
+        } else {
+          setQueryObj((List<ByteBuffer>)value);
+        }
+        break;
+
+      case RET_EXTERN_ID:
+        if (value == null) {
+          unsetRetExternId();
+        } else {
+          setRetExternId((Boolean)value);
+        }
+        break;
+
+      case RET_OBJ:
+        if (value == null) {
+          unsetRetObj();
+        } else {
+          setRetObj((Boolean)value);
+        }
+        break;
+
+      case QUERY_TIME_PARAMS:
+        if (value == null) {
+          unsetQueryTimeParams();
+        } else {
+          setQueryTimeParams((String)value);
+        }
+        break;
+
+      }
+    }
+
+    public Object getFieldValue(_Fields field) {
+      switch (field) {
+      case K:
+        return Integer.valueOf(getK());
+
+      case QUERY_OBJ:
+        return getQueryObj();
+
+      case RET_EXTERN_ID:
+        return Boolean.valueOf(isRetExternId());
+
+      case RET_OBJ:
+        return Boolean.valueOf(isRetObj());
+
+      case QUERY_TIME_PARAMS:
+        return getQueryTimeParams();
+
+      }
+      throw new IllegalStateException();
+    }
+
+    /** Returns true if field corresponding to fieldID is set (has been assigned a value) and false otherwise */
+    public boolean isSet(_Fields field) {
+      if (field == null) {
+        throw new IllegalArgumentException();
+      }
+
+      switch (field) {
+      case K:
+        return isSetK();
+      case QUERY_OBJ:
+        return isSetQueryObj();
+      case RET_EXTERN_ID:
+        return isSetRetExternId();
+      case RET_OBJ:
+        return isSetRetObj();
+      case QUERY_TIME_PARAMS:
+        return isSetQueryTimeParams();
+      }
+      throw new IllegalStateException();
+    }
+
+    @Override
+    public boolean equals(Object that) {
+      if (that == null)
+        return false;
+      if (that instanceof knnQueryBatchBinary_args)
+        return this.equals((knnQueryBatchBinary_args)that);
+      return false;
+    }
+
+    public boolean equals(knnQueryBatchBinary_args that) {
+      if (that == null)
+        return false;
+
+      boolean this_present_k = true;
+      boolean that_present_k = true;
+      if (this_present_k || that_present_k) {
+        if (!(this_present_k && that_present_k))
+          return false;
+        if (this.k != that.k)
+          return false;
+      }
+
+      boolean this_present_queryObj = true && this.isSetQueryObj();
+      boolean that_present_queryObj = true && that.isSetQueryObj();
+      if (this_present_queryObj || that_present_queryObj) {
+        if (!(this_present_queryObj && that_present_queryObj))
+          return false;
+        if (!this.queryObj.equals(that.queryObj))
+          return false;
+      }
+
+      boolean this_present_retExternId = true;
+      boolean that_present_retExternId = true;
+      if (this_present_retExternId || that_present_retExternId) {
+        if (!(this_present_retExternId && that_present_retExternId))
+          return false;
+        if (this.retExternId != that.retExternId)
+          return false;
+      }
+
+      boolean this_present_retObj = true;
+      boolean that_present_retObj = true;
+      if (this_present_retObj || that_present_retObj) {
+        if (!(this_present_retObj && that_present_retObj))
+          return false;
+        if (this.retObj != that.retObj)
+          return false;
+      }
+
+      boolean this_present_queryTimeParams = true && this.isSetQueryTimeParams();
+      boolean that_present_queryTimeParams = true && that.isSetQueryTimeParams();
+      if (this_present_queryTimeParams || that_present_queryTimeParams) {
+        if (!(this_present_queryTimeParams && that_present_queryTimeParams))
+          return false;
+        if (!this.queryTimeParams.equals(that.queryTimeParams))
+          return false;
+      }
+
+      return true;
+    }
+
+    @Override
+    public int hashCode() {
+      List<Object> list = new ArrayList<Object>();
+
+      boolean present_k = true;
+      list.add(present_k);
+      if (present_k)
+        list.add(k);
+
+      boolean present_queryObj = true && (isSetQueryObj());
+      list.add(present_queryObj);
+      if (present_queryObj)
+        list.add(queryObj);
+
+      boolean present_retExternId = true;
+      list.add(present_retExternId);
+      if (present_retExternId)
+        list.add(retExternId);
+
+      boolean present_retObj = true;
+      list.add(present_retObj);
+      if (present_retObj)
+        list.add(retObj);
+
+      boolean present_queryTimeParams = true && (isSetQueryTimeParams());
+      list.add(present_queryTimeParams);
+      if (present_queryTimeParams)
+        list.add(queryTimeParams);
+
+      return list.hashCode();
+    }
+
+    @Override
+    public int compareTo(knnQueryBatchBinary_args other) {
+      if (!getClass().equals(other.getClass())) {
+        return getClass().getName().compareTo(other.getClass().getName());
+      }
+
+      int lastComparison = 0;
+
+      lastComparison = Boolean.valueOf(isSetK()).compareTo(other.isSetK());
+      if (lastComparison != 0) {
+        return lastComparison;
+      }
+      if (isSetK()) {
+        lastComparison = org.apache.thrift.TBaseHelper.compareTo(this.k, other.k);
+        if (lastComparison != 0) {
+          return lastComparison;
+        }
+      }
+      lastComparison = Boolean.valueOf(isSetQueryObj()).compareTo(other.isSetQueryObj());
+      if (lastComparison != 0) {
+        return lastComparison;
+      }
+      if (isSetQueryObj()) {
+        lastComparison = org.apache.thrift.TBaseHelper.compareTo(this.queryObj, other.queryObj);
+        if (lastComparison != 0) {
+          return lastComparison;
+        }
+      }
+      lastComparison = Boolean.valueOf(isSetRetExternId()).compareTo(other.isSetRetExternId());
+      if (lastComparison != 0) {
+        return lastComparison;
+      }
+      if (isSetRetExternId()) {
+        lastComparison = org.apache.thrift.TBaseHelper.compareTo(this.retExternId, other.retExternId);
+        if (lastComparison != 0) {
+          return lastComparison;
+        }
+      }
+      lastComparison = Boolean.valueOf(isSetRetObj()).compareTo(other.isSetRetObj());
+      if (lastComparison != 0) {
+        return lastComparison;
+      }
+      if (isSetRetObj()) {
+        lastComparison = org.apache.thrift.TBaseHelper.compareTo(this.retObj, other.retObj);
+        if (lastComparison != 0) {
+          return lastComparison;
+        }
+      }
+      lastComparison = Boolean.valueOf(isSetQueryTimeParams()).compareTo(other.isSetQueryTimeParams());
+      if (lastComparison != 0) {
+        return lastComparison;
+      }
+      if (isSetQueryTimeParams()) {
+        lastComparison = org.apache.thrift.TBaseHelper.compareTo(this.queryTimeParams, other.queryTimeParams);
+        if (lastComparison != 0) {
+          return lastComparison;
+        }
+      }
+      return 0;
+    }
+
+    public _Fields fieldForId(int fieldId) {
+      return _Fields.findByThriftId(fieldId);
+    }
+
+    public void read(org.apache.thrift.protocol.TProtocol iprot) throws org.apache.thrift.TException {
+      schemes.get(iprot.getScheme()).getScheme().read(iprot, this);
+    }
+
+    public void write(org.apache.thrift.protocol.TProtocol oprot) throws org.apache.thrift.TException {
+      schemes.get(oprot.getScheme()).getScheme().write(oprot, this);
+    }
+
+    @Override
+    public String toString() {
+      StringBuilder sb = new StringBuilder("knnQueryBatchBinary_args(");
+      boolean first = true;
+
+      sb.append("k:");
+      sb.append(this.k);
+      first = false;
+      if (!first) sb.append(", ");
+      sb.append("queryObj:");
+      if (this.queryObj == null) {
+        sb.append("null");
+      } else {
+        sb.append(this.queryObj);
+      }
+      first = false;
+      if (!first) sb.append(", ");
+      sb.append("retExternId:");
+      sb.append(this.retExternId);
+      first = false;
+      if (!first) sb.append(", ");
+      sb.append("retObj:");
+      sb.append(this.retObj);
+      first = false;
+      if (!first) sb.append(", ");
+      sb.append("queryTimeParams:");
+      if (this.queryTimeParams == null) {
+        sb.append("null");
+      } else {
+        sb.append(this.queryTimeParams);
+      }
+      first = false;
+      sb.append(")");
+      return sb.toString();
+    }
+
+    public void validate() throws org.apache.thrift.TException {
+      // check for required fields
+      // alas, we cannot check 'k' because it's a primitive and you chose the non-beans generator.
+      if (queryObj == null) {
+        throw new org.apache.thrift.protocol.TProtocolException("Required field 'queryObj' was not present! Struct: " + toString());
+      }
+      // alas, we cannot check 'retExternId' because it's a primitive and you chose the non-beans generator.
+      // alas, we cannot check 'retObj' because it's a primitive and you chose the non-beans generator.
+      if (queryTimeParams == null) {
+        throw new org.apache.thrift.protocol.TProtocolException("Required field 'queryTimeParams' was not present! Struct: " + toString());
+      }
+      // check for sub-struct validity
+    }
+
+    private void writeObject(java.io.ObjectOutputStream out) throws java.io.IOException {
+      try {
+        write(new org.apache.thrift.protocol.TCompactProtocol(new org.apache.thrift.transport.TIOStreamTransport(out)));
+      } catch (org.apache.thrift.TException te) {
+        throw new java.io.IOException(te);
+      }
+    }
+
+    private void readObject(java.io.ObjectInputStream in) throws java.io.IOException, ClassNotFoundException {
+      try {
+        // it doesn't seem like you should have to do this, but java serialization is wacky, and doesn't call the default constructor.
+        __isset_bitfield = 0;
+        read(new org.apache.thrift.protocol.TCompactProtocol(new org.apache.thrift.transport.TIOStreamTransport(in)));
+      } catch (org.apache.thrift.TException te) {
+        throw new java.io.IOException(te);
+      }
+    }
+
+    private static class knnQueryBatchBinary_argsStandardSchemeFactory implements SchemeFactory {
+      public knnQueryBatchBinary_argsStandardScheme getScheme() {
+        return new knnQueryBatchBinary_argsStandardScheme();
+      }
+    }
+
+    private static class knnQueryBatchBinary_argsStandardScheme extends StandardScheme<knnQueryBatchBinary_args> {
+
+      public void read(org.apache.thrift.protocol.TProtocol iprot, knnQueryBatchBinary_args struct) throws org.apache.thrift.TException {
+        org.apache.thrift.protocol.TField schemeField;
+        iprot.readStructBegin();
+        while (true)
+        {
+          schemeField = iprot.readFieldBegin();
+          if (schemeField.type == org.apache.thrift.protocol.TType.STOP) { 
+            break;
+          }
+          switch (schemeField.id) {
+            case 1: // K
+              if (schemeField.type == org.apache.thrift.protocol.TType.I32) {
+                struct.k = iprot.readI32();
+                struct.setKIsSet(true);
+              } else { 
+                org.apache.thrift.protocol.TProtocolUtil.skip(iprot, schemeField.type);
+              }
+              break;
+            case 2: // QUERY_OBJ
+              if (schemeField.type == org.apache.thrift.protocol.TType.LIST) {
+                {
+                  org.apache.thrift.protocol.TList _list40 = iprot.readListBegin();
+                  struct.queryObj = new ArrayList<ByteBuffer>(_list40.size);
+                  ByteBuffer _elem41;
+                  for (int _i42 = 0; _i42 < _list40.size; ++_i42)
+                  {
+                    _elem41 = iprot.readBinary();
+                    struct.queryObj.add(_elem41);
+                  }
+                  iprot.readListEnd();
+                }
+                struct.setQueryObjIsSet(true);
+              } else { 
+                org.apache.thrift.protocol.TProtocolUtil.skip(iprot, schemeField.type);
+              }
+              break;
+            case 3: // RET_EXTERN_ID
+              if (schemeField.type == org.apache.thrift.protocol.TType.BOOL) {
+                struct.retExternId = iprot.readBool();
+                struct.setRetExternIdIsSet(true);
+              } else { 
+                org.apache.thrift.protocol.TProtocolUtil.skip(iprot, schemeField.type);
+              }
+              break;
+            case 4: // RET_OBJ
+              if (schemeField.type == org.apache.thrift.protocol.TType.BOOL) {
+                struct.retObj = iprot.readBool();
+                struct.setRetObjIsSet(true);
+              } else { 
+                org.apache.thrift.protocol.TProtocolUtil.skip(iprot, schemeField.type);
+              }
+              break;
+            case 5: // QUERY_TIME_PARAMS
+              if (schemeField.type == org.apache.thrift.protocol.TType.STRING) {
+                struct.queryTimeParams = iprot.readString();
+                struct.setQueryTimeParamsIsSet(true);
+              } else { 
+                org.apache.thrift.protocol.TProtocolUtil.skip(iprot, schemeField.type);
+              }
+              break;
+            default:
+              org.apache.thrift.protocol.TProtocolUtil.skip(iprot, schemeField.type);
+          }
+          iprot.readFieldEnd();
+        }
+        iprot.readStructEnd();
+
+        // check for required fields of primitive type, which can't be checked in the validate method
+        if (!struct.isSetK()) {
+          throw new org.apache.thrift.protocol.TProtocolException("Required field 'k' was not found in serialized data! Struct: " + toString());
+        }
+        if (!struct.isSetRetExternId()) {
+          throw new org.apache.thrift.protocol.TProtocolException("Required field 'retExternId' was not found in serialized data! Struct: " + toString());
+        }
+        if (!struct.isSetRetObj()) {
+          throw new org.apache.thrift.protocol.TProtocolException("Required field 'retObj' was not found in serialized data! Struct: " + toString());
+        }
+        struct.validate();
+      }
+
+      public void write(org.apache.thrift.protocol.TProtocol oprot, knnQueryBatchBinary_args struct) throws org.apache.thrift.TException {
+        struct.validate();
+
+        oprot.writeStructBegin(STRUCT_DESC);
+        oprot.writeFieldBegin(K_FIELD_DESC);
+        oprot.writeI32(struct.k);
+        oprot.writeFieldEnd();
+        if (struct.queryObj != null) {
+          oprot.writeFieldBegin(QUERY_OBJ_FIELD_DESC);
+          {
+            oprot.writeListBegin(new org.apache.thrift.protocol.TList(org.apache.thrift.protocol.TType.STRING, struct.queryObj.size()));
+            for (ByteBuffer _iter43 : struct.queryObj)
+            {
+              oprot.writeBinary(_iter43);
+            }
+            oprot.writeListEnd();
+          }
+          oprot.writeFieldEnd();
+        }
+        oprot.writeFieldBegin(RET_EXTERN_ID_FIELD_DESC);
+        oprot.writeBool(struct.retExternId);
+        oprot.writeFieldEnd();
+        oprot.writeFieldBegin(RET_OBJ_FIELD_DESC);
+        oprot.writeBool(struct.retObj);
+        oprot.writeFieldEnd();
+        if (struct.queryTimeParams != null) {
+          oprot.writeFieldBegin(QUERY_TIME_PARAMS_FIELD_DESC);
+          oprot.writeString(struct.queryTimeParams);
+          oprot.writeFieldEnd();
+        }
+        oprot.writeFieldStop();
+        oprot.writeStructEnd();
+      }
+
+    }
+
+    private static class knnQueryBatchBinary_argsTupleSchemeFactory implements SchemeFactory {
+      public knnQueryBatchBinary_argsTupleScheme getScheme() {
+        return new knnQueryBatchBinary_argsTupleScheme();
+      }
+    }
+
+    private static class knnQueryBatchBinary_argsTupleScheme extends TupleScheme<knnQueryBatchBinary_args> {
+
+      @Override
+      public void write(org.apache.thrift.protocol.TProtocol prot, knnQueryBatchBinary_args struct) throws org.apache.thrift.TException {
+        TTupleProtocol oprot = (TTupleProtocol) prot;
+        oprot.writeI32(struct.k);
+        {
+          oprot.writeI32(struct.queryObj.size());
+          for (ByteBuffer _iter44 : struct.queryObj)
+          {
+            oprot.writeBinary(_iter44);
+          }
+        }
+        oprot.writeBool(struct.retExternId);
+        oprot.writeBool(struct.retObj);
+        oprot.writeString(struct.queryTimeParams);
+      }
+
+      @Override
+      public void read(org.apache.thrift.protocol.TProtocol prot, knnQueryBatchBinary_args struct) throws org.apache.thrift.TException {
+        TTupleProtocol iprot = (TTupleProtocol) prot;
+        struct.k = iprot.readI32();
+        struct.setKIsSet(true);
+        {
+          org.apache.thrift.protocol.TList _list45 = new org.apache.thrift.protocol.TList(org.apache.thrift.protocol.TType.STRING, iprot.readI32());
+          struct.queryObj = new ArrayList<ByteBuffer>(_list45.size);
+          ByteBuffer _elem46;
+          for (int _i47 = 0; _i47 < _list45.size; ++_i47)
+          {
+            _elem46 = iprot.readBinary();
+            struct.queryObj.add(_elem46);
+          }
+        }
+        struct.setQueryObjIsSet(true);
+        struct.retExternId = iprot.readBool();
+        struct.setRetExternIdIsSet(true);
+        struct.retObj = iprot.readBool();
+        struct.setRetObjIsSet(true);
+        struct.queryTimeParams = iprot.readString();
+        struct.setQueryTimeParamsIsSet(true);
+      }
+    }
+
+  }
+
+  public static class knnQueryBatchBinary_result implements org.apache.thrift.TBase<knnQueryBatchBinary_result, knnQueryBatchBinary_result._Fields>, java.io.Serializable, Cloneable, Comparable<knnQueryBatchBinary_result>   {
+    private static final org.apache.thrift.protocol.TStruct STRUCT_DESC = new org.apache.thrift.protocol.TStruct("knnQueryBatchBinary_result");
+
+    private static final org.apache.thrift.protocol.TField SUCCESS_FIELD_DESC = new org.apache.thrift.protocol.TField("success", org.apache.thrift.protocol.TType.LIST, (short)0);
+    private static final org.apache.thrift.protocol.TField ERR_FIELD_DESC = new org.apache.thrift.protocol.TField("err", org.apache.thrift.protocol.TType.STRUCT, (short)1);
+
+    private static final Map<Class<? extends IScheme>, SchemeFactory> schemes = new HashMap<Class<? extends IScheme>, SchemeFactory>();
+    static {
+      schemes.put(StandardScheme.class, new knnQueryBatchBinary_resultStandardSchemeFactory());
+      schemes.put(TupleScheme.class, new knnQueryBatchBinary_resultTupleSchemeFactory());
+    }
+
+    public List<List<ReplyEntry>> success; // required
+    public QueryException err; // required
+
+    /** The set of fields this struct contains, along with convenience methods for finding and manipulating them. */
+    public enum _Fields implements org.apache.thrift.TFieldIdEnum {
+      SUCCESS((short)0, "success"),
+      ERR((short)1, "err");
+
+      private static final Map<String, _Fields> byName = new HashMap<String, _Fields>();
+
+      static {
+        for (_Fields field : EnumSet.allOf(_Fields.class)) {
+          byName.put(field.getFieldName(), field);
+        }
+      }
+
+      /**
+       * Find the _Fields constant that matches fieldId, or null if its not found.
+       */
+      public static _Fields findByThriftId(int fieldId) {
+        switch(fieldId) {
+          case 0: // SUCCESS
+            return SUCCESS;
+          case 1: // ERR
+            return ERR;
+          default:
+            return null;
+        }
+      }
+
+      /**
+       * Find the _Fields constant that matches fieldId, throwing an exception
+       * if it is not found.
+       */
+      public static _Fields findByThriftIdOrThrow(int fieldId) {
+        _Fields fields = findByThriftId(fieldId);
+        if (fields == null) throw new IllegalArgumentException("Field " + fieldId + " doesn't exist!");
+        return fields;
+      }
+
+      /**
+       * Find the _Fields constant that matches name, or null if its not found.
+       */
+      public static _Fields findByName(String name) {
+        return byName.get(name);
+      }
+
+      private final short _thriftId;
+      private final String _fieldName;
+
+      _Fields(short thriftId, String fieldName) {
+        _thriftId = thriftId;
+        _fieldName = fieldName;
+      }
+
+      public short getThriftFieldId() {
+        return _thriftId;
+      }
+
+      public String getFieldName() {
+        return _fieldName;
+      }
+    }
+
+    // isset id assignments
+    public static final Map<_Fields, org.apache.thrift.meta_data.FieldMetaData> metaDataMap;
+    static {
+      Map<_Fields, org.apache.thrift.meta_data.FieldMetaData> tmpMap = new EnumMap<_Fields, org.apache.thrift.meta_data.FieldMetaData>(_Fields.class);
+      tmpMap.put(_Fields.SUCCESS, new org.apache.thrift.meta_data.FieldMetaData("success", org.apache.thrift.TFieldRequirementType.DEFAULT, 
+          new org.apache.thrift.meta_data.ListMetaData(org.apache.thrift.protocol.TType.LIST, 
+              new org.apache.thrift.meta_data.FieldValueMetaData(org.apache.thrift.protocol.TType.LIST              , "ReplyEntryList"))));
+      tmpMap.put(_Fields.ERR, new org.apache.thrift.meta_data.FieldMetaData("err", org.apache.thrift.TFieldRequirementType.DEFAULT, 
+          new org.apache.thrift.meta_data.FieldValueMetaData(org.apache.thrift.protocol.TType.STRUCT)));
+      metaDataMap = Collections.unmodifiableMap(tmpMap);
+      org.apache.thrift.meta_data.FieldMetaData.addStructMetaDataMap(knnQueryBatchBinary_result.class, metaDataMap);
+    }
+
+    public knnQueryBatchBinary_result() {
+    }
+
+    public knnQueryBatchBinary_result(
+      List<List<ReplyEntry>> success,
+      QueryException err)
+    {
+      this();
+      this.success = success;
+      this.err = err;
+    }
+
+    /**
+     * Performs a deep copy on <i>other</i>.
+     */
+    public knnQueryBatchBinary_result(knnQueryBatchBinary_result other) {
+      if (other.isSetSuccess()) {
+        List<List<ReplyEntry>> __this__success = new ArrayList<List<ReplyEntry>>(other.success.size());
+        for (List<ReplyEntry> other_element : other.success) {
+          __this__success.add(other_element);
+        }
+        this.success = __this__success;
+      }
+      if (other.isSetErr()) {
+        this.err = new QueryException(other.err);
+      }
+    }
+
+    public knnQueryBatchBinary_result deepCopy() {
+      return new knnQueryBatchBinary_result(this);
+    }
+
+    @Override
+    public void clear() {
+      this.success = null;
+      this.err = null;
+    }
+
+    public int getSuccessSize() {
+      return (this.success == null) ? 0 : this.success.size();
+    }
+
+    public java.util.Iterator<List<ReplyEntry>> getSuccessIterator() {
+      return (this.success == null) ? null : this.success.iterator();
+    }
+
+    public void addToSuccess(List<ReplyEntry> elem) {
+      if (this.success == null) {
+        this.success = new ArrayList<List<ReplyEntry>>();
+      }
+      this.success.add(elem);
+    }
+
+    public List<List<ReplyEntry>> getSuccess() {
+      return this.success;
+    }
+
+    public knnQueryBatchBinary_result setSuccess(List<List<ReplyEntry>> success) {
+      this.success = success;
+      return this;
+    }
+
+    public void unsetSuccess() {
+      this.success = null;
+    }
+
+    /** Returns true if field success is set (has been assigned a value) and false otherwise */
+    public boolean isSetSuccess() {
+      return this.success != null;
+    }
+
+    public void setSuccessIsSet(boolean value) {
+      if (!value) {
+        this.success = null;
+      }
+    }
+
+    public QueryException getErr() {
+      return this.err;
+    }
+
+    public knnQueryBatchBinary_result setErr(QueryException err) {
+      this.err = err;
+      return this;
+    }
+
+    public void unsetErr() {
+      this.err = null;
+    }
+
+    /** Returns true if field err is set (has been assigned a value) and false otherwise */
+    public boolean isSetErr() {
+      return this.err != null;
+    }
+
+    public void setErrIsSet(boolean value) {
+      if (!value) {
+        this.err = null;
+      }
+    }
+
+    public void setFieldValue(_Fields field, Object value) {
+      switch (field) {
+      case SUCCESS:
+        if (value == null) {
+          unsetSuccess();
+        } else {
+          setSuccess((List<List<ReplyEntry>>)value);
+        }
+        break;
+
+      case ERR:
+        if (value == null) {
+          unsetErr();
+        } else {
+          setErr((QueryException)value);
+        }
+        break;
+
+      }
+    }
+
+    public Object getFieldValue(_Fields field) {
+      switch (field) {
+      case SUCCESS:
+        return getSuccess();
+
+      case ERR:
+        return getErr();
+
+      }
+      throw new IllegalStateException();
+    }
+
+    /** Returns true if field corresponding to fieldID is set (has been assigned a value) and false otherwise */
+    public boolean isSet(_Fields field) {
+      if (field == null) {
+        throw new IllegalArgumentException();
+      }
+
+      switch (field) {
+      case SUCCESS:
+        return isSetSuccess();
+      case ERR:
+        return isSetErr();
+      }
+      throw new IllegalStateException();
+    }
+
+    @Override
+    public boolean equals(Object that) {
+      if (that == null)
+        return false;
+      if (that instanceof knnQueryBatchBinary_result)
+        return this.equals((knnQueryBatchBinary_result)that);
+      return false;
+    }
+
+    public boolean equals(knnQueryBatchBinary_result that) {
+      if (that == null)
+        return false;
+
+      boolean this_present_success = true && this.isSetSuccess();
+      boolean that_present_success = true && that.isSetSuccess();
+      if (this_present_success || that_present_success) {
+        if (!(this_present_success && that_present_success))
+          return false;
+        if (!this.success.equals(that.success))
+          return false;
+      }
+
+      boolean this_present_err = true && this.isSetErr();
+      boolean that_present_err = true && that.isSetErr();
+      if (this_present_err || that_present_err) {
+        if (!(this_present_err && that_present_err))
+          return false;
+        if (!this.err.equals(that.err))
+          return false;
+      }
+
+      return true;
+    }
+
+    @Override
+    public int hashCode() {
+      List<Object> list = new ArrayList<Object>();
+
+      boolean present_success = true && (isSetSuccess());
+      list.add(present_success);
+      if (present_success)
+        list.add(success);
+
+      boolean present_err = true && (isSetErr());
+      list.add(present_err);
+      if (present_err)
+        list.add(err);
+
+      return list.hashCode();
+    }
+
+    @Override
+    public int compareTo(knnQueryBatchBinary_result other) {
+      if (!getClass().equals(other.getClass())) {
+        return getClass().getName().compareTo(other.getClass().getName());
+      }
+
+      int lastComparison = 0;
+
+      lastComparison = Boolean.valueOf(isSetSuccess()).compareTo(other.isSetSuccess());
+      if (lastComparison != 0) {
+        return lastComparison;
+      }
+      if (isSetSuccess()) {
+        lastComparison = org.apache.thrift.TBaseHelper.compareTo(this.success, other.success);
+        if (lastComparison != 0) {
+          return lastComparison;
+        }
+      }
+      lastComparison = Boolean.valueOf(isSetErr()).compareTo(other.isSetErr());
+      if (lastComparison != 0) {
+        return lastComparison;
+      }
+      if (isSetErr()) {
+        lastComparison = org.apache.thrift.TBaseHelper.compareTo(this.err, other.err);
+        if (lastComparison != 0) {
+          return lastComparison;
+        }
+      }
+      return 0;
+    }
+
+    public _Fields fieldForId(int fieldId) {
+      return _Fields.findByThriftId(fieldId);
+    }
+
+    public void read(org.apache.thrift.protocol.TProtocol iprot) throws org.apache.thrift.TException {
+      schemes.get(iprot.getScheme()).getScheme().read(iprot, this);
+    }
+
+    public void write(org.apache.thrift.protocol.TProtocol oprot) throws org.apache.thrift.TException {
+      schemes.get(oprot.getScheme()).getScheme().write(oprot, this);
+      }
+
+    @Override
+    public String toString() {
+      StringBuilder sb = new StringBuilder("knnQueryBatchBinary_result(");
+      boolean first = true;
+
+      sb.append("success:");
+      if (this.success == null) {
+        sb.append("null");
+      } else {
+        sb.append(this.success);
+      }
+      first = false;
+      if (!first) sb.append(", ");
+      sb.append("err:");
+      if (this.err == null) {
+        sb.append("null");
+      } else {
+        sb.append(this.err);
+      }
+      first = false;
+      sb.append(")");
+      return sb.toString();
+    }
+
+    public void validate() throws org.apache.thrift.TException {
+      // check for required fields
+      // check for sub-struct validity
+    }
+
+    private void writeObject(java.io.ObjectOutputStream out) throws java.io.IOException {
+      try {
+        write(new org.apache.thrift.protocol.TCompactProtocol(new org.apache.thrift.transport.TIOStreamTransport(out)));
+      } catch (org.apache.thrift.TException te) {
+        throw new java.io.IOException(te);
+      }
+    }
+
+    private void readObject(java.io.ObjectInputStream in) throws java.io.IOException, ClassNotFoundException {
+      try {
+        read(new org.apache.thrift.protocol.TCompactProtocol(new org.apache.thrift.transport.TIOStreamTransport(in)));
+      } catch (org.apache.thrift.TException te) {
+        throw new java.io.IOException(te);
+      }
+    }
+
+    private static class knnQueryBatchBinary_resultStandardSchemeFactory implements SchemeFactory {
+      public knnQueryBatchBinary_resultStandardScheme getScheme() {
+        return new knnQueryBatchBinary_resultStandardScheme();
+      }
+    }
+
+    private static class knnQueryBatchBinary_resultStandardScheme extends StandardScheme<knnQueryBatchBinary_result> {
+
+      public void read(org.apache.thrift.protocol.TProtocol iprot, knnQueryBatchBinary_result struct) throws org.apache.thrift.TException {
+        org.apache.thrift.protocol.TField schemeField;
+        iprot.readStructBegin();
+        while (true)
+        {
+          schemeField = iprot.readFieldBegin();
+          if (schemeField.type == org.apache.thrift.protocol.TType.STOP) { 
+            break;
+          }
+          switch (schemeField.id) {
+            case 0: // SUCCESS
+              if (schemeField.type == org.apache.thrift.protocol.TType.LIST) {
+                {
+                  org.apache.thrift.protocol.TList _list48 = iprot.readListBegin();
+                  struct.success = new ArrayList<List<ReplyEntry>>(_list48.size);
+                  List<ReplyEntry> _elem49;
+                  for (int _i50 = 0; _i50 < _list48.size; ++_i50)
+                  {
+                    {
+                      org.apache.thrift.protocol.TList _list51 = iprot.readListBegin();
+                      _elem49 = new ArrayList<ReplyEntry>(_list51.size);
+                      ReplyEntry _elem52;
+                      for (int _i53 = 0; _i53 < _list51.size; ++_i53)
+                      {
+                        _elem52 = new ReplyEntry();
+                        _elem52.read(iprot);
+                        _elem49.add(_elem52);
+                      }
+                      iprot.readListEnd();
+                    }
+                    struct.success.add(_elem49);
+                  }
+                  iprot.readListEnd();
+                }
+                struct.setSuccessIsSet(true);
+              } else { 
+                org.apache.thrift.protocol.TProtocolUtil.skip(iprot, schemeField.type);
+              }
+              break;
+            case 1: // ERR
+              if (schemeField.type == org.apache.thrift.protocol.TType.STRUCT) {
+                struct.err = new QueryException();
+                struct.err.read(iprot);
+                struct.setErrIsSet(true);
+              } else { 
+                org.apache.thrift.protocol.TProtocolUtil.skip(iprot, schemeField.type);
+              }
+              break;
+            default:
+              org.apache.thrift.protocol.TProtocolUtil.skip(iprot, schemeField.type);
+          }
+          iprot.readFieldEnd();
+        }
+        iprot.readStructEnd();
+
+        // check for required fields of primitive type, which can't be checked in the validate method
+        struct.validate();
+      }
+
+      public void write(org.apache.thrift.protocol.TProtocol oprot, knnQueryBatchBinary_result struct) throws org.apache.thrift.TException {
+        struct.validate();
+
+        oprot.writeStructBegin(STRUCT_DESC);
+        if (struct.success != null) {
+          oprot.writeFieldBegin(SUCCESS_FIELD_DESC);
+          {
+            oprot.writeListBegin(new org.apache.thrift.protocol.TList(org.apache.thrift.protocol.TType.LIST, struct.success.size()));
+            for (List<ReplyEntry> _iter54 : struct.success)
+            {
+              {
+                oprot.writeListBegin(new org.apache.thrift.protocol.TList(org.apache.thrift.protocol.TType.STRUCT, _iter54.size()));
+                for (ReplyEntry _iter55 : _iter54)
+                {
+                  _iter55.write(oprot);
+                }
+                oprot.writeListEnd();
+              }
+            }
+            oprot.writeListEnd();
+          }
+          oprot.writeFieldEnd();
+        }
+        if (struct.err != null) {
+          oprot.writeFieldBegin(ERR_FIELD_DESC);
+          struct.err.write(oprot);
+          oprot.writeFieldEnd();
+        }
+        oprot.writeFieldStop();
+        oprot.writeStructEnd();
+      }
+
+    }
+
+    private static class knnQueryBatchBinary_resultTupleSchemeFactory implements SchemeFactory {
+      public knnQueryBatchBinary_resultTupleScheme getScheme() {
+        return new knnQueryBatchBinary_resultTupleScheme();
+      }
+    }
+
+    private static class knnQueryBatchBinary_resultTupleScheme extends TupleScheme<knnQueryBatchBinary_result> {
+
+      @Override
+      public void write(org.apache.thrift.protocol.TProtocol prot, knnQueryBatchBinary_result struct) throws org.apache.thrift.TException {
+        TTupleProtocol oprot = (TTupleProtocol) prot;
+        BitSet optionals = new BitSet();
+        if (struct.isSetSuccess()) {
+          optionals.set(0);
+        }
+        if (struct.isSetErr()) {
+          optionals.set(1);
+        }
+        oprot.writeBitSet(optionals, 2);
+        if (struct.isSetSuccess()) {
+          {
+            oprot.writeI32(struct.success.size());
+            for (List<ReplyEntry> _iter56 : struct.success)
+            {
+              {
+                oprot.writeI32(_iter56.size());
+                for (ReplyEntry _iter57 : _iter56)
+                {
+                  _iter57.write(oprot);
+                }
+              }
+            }
+          }
+        }
+        if (struct.isSetErr()) {
+          struct.err.write(oprot);
+        }
+      }
+
+      @Override
+      public void read(org.apache.thrift.protocol.TProtocol prot, knnQueryBatchBinary_result struct) throws org.apache.thrift.TException {
+        TTupleProtocol iprot = (TTupleProtocol) prot;
+        BitSet incoming = iprot.readBitSet(2);
+        if (incoming.get(0)) {
+          {
+            org.apache.thrift.protocol.TList _list58 = new org.apache.thrift.protocol.TList(org.apache.thrift.protocol.TType.LIST, iprot.readI32());
+            struct.success = new ArrayList<List<ReplyEntry>>(_list58.size);
+            List<ReplyEntry> _elem59;
+            for (int _i60 = 0; _i60 < _list58.size; ++_i60)
+            {
+              {
+                org.apache.thrift.protocol.TList _list61 = new org.apache.thrift.protocol.TList(org.apache.thrift.protocol.TType.STRUCT, iprot.readI32());
+                _elem59 = new ArrayList<ReplyEntry>(_list61.size);
+                ReplyEntry _elem62;
+                for (int _i63 = 0; _i63 < _list61.size; ++_i63)
+                {
+                  _elem62 = new ReplyEntry();
+                  _elem62.read(iprot);
+                  _elem59.add(_elem62);
+                }
+              }
+              struct.success.add(_elem59);
+            }
+          }
+          struct.setSuccessIsSet(true);
+        }
+        if (incoming.get(1)) {
+          struct.err = new QueryException();
+          struct.err.read(iprot);
+          struct.setErrIsSet(true);
+        }
+      }
+    }
+
+  }
+
 }
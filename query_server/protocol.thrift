@@ -43,5 +43,36 @@ service QueryService {
    */
   double getDistance(1: required string obj1,
                      2: required string obj2)
+  throws (1: QueryException err),
+
+  /*
+   * Run a batch of k-NN queries, which are executed in parallel.
+   * The i-th list of the reply contains answers to the i-th query.
+   * If queryTimeParams isn't empty, query-time parameters are set
+   * before the batch is executed. This has the same global effect
+   * as calling setQueryTimeParams, but no other thread can change
+   * the parameters while the batch is running. When the batch is
+   * finished, the parameters set on start-up or by the last call of
+   * setQueryTimeParams are restored.
+   */
+  list<ReplyEntryList> knnQueryBatch(1: required i32 k,                  // k as in k-NN
+                                     2: required list<string> queryObj,  // string representations of query objects
+                                     3: required bool retExternId,       // if true, we will return an external ID
+                                     4: required bool retObj,            // if true, we will return a string representation of each answer object
+                                     5: required string queryTimeParams) // query-time parameters (can be empty)
+  throws (1: QueryException err),
+
+  /*
+   * The same as knnQueryBatch, but query objects are dense or sparse
+   * vectors in a binary format, which is cheaper to create and to parse.
+   * A dense vector is an array of 32-bit floats. A sparse vector is an array
+   * of (32-bit unsigned dimension, 32-bit float value) pairs sorted by dimension.
+   * All numbers are in the little-endian byte order.
+   */
+  list<ReplyEntryList> knnQueryBatchBinary(1: required i32 k,
+                                           2: required list<binary> queryObj,
+                                           3: required bool retExternId,
+                                           4: required bool retObj,
+                                           5: required string queryTimeParams)
   throws (1: QueryException err)
 }
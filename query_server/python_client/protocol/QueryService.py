@@ -53,6 +53,28 @@ class Iface:
     """
     pass
 
+  def knnQueryBatch(self, k, queryObj, retExternId, retObj, queryTimeParams):
+    """
+    Parameters:
+     - k
+     - queryObj
+     - retExternId
+     - retObj
+     - queryTimeParams
+    """
+    pass
+
+  def knnQueryBatchBinary(self, k, queryObj, retExternId, retObj, queryTimeParams):
+    """
+    Parameters:
+     - k
+     - queryObj
+     - retExternId
+     - retObj
+     - queryTimeParams
+    """
+    pass
+
 
 class Client(Iface):
   def __init__(self, iprot, oprot=None):
@@ -205,6 +227,88 @@ class Client(Iface):
       raise result.err
     raise TApplicationException(TApplicationException.MISSING_RESULT, "getDistance failed: unknown result");
 
+  def knnQueryBatch(self, k, queryObj, retExternId, retObj, queryTimeParams):
+    """
+    Parameters:
+     - k
+     - queryObj
+     - retExternId
+     - retObj
+     - queryTimeParams
+    """
+    self.send_knnQueryBatch(k, queryObj, retExternId, retObj, queryTimeParams)
+    return self.recv_knnQueryBatch()
+
+  def send_knnQueryBatch(self, k, queryObj, retExternId, retObj, queryTimeParams):
+    self._oprot.writeMessageBegin('knnQueryBatch', TMessageType.CALL, self._seqid)
+    args = knnQueryBatch_args()
+    args.k = k
+    args.queryObj = queryObj
+    args.retExternId = retExternId
+    args.retObj = retObj
+    args.queryTimeParams = queryTimeParams
+    args.write(self._oprot)
+    self._oprot.writeMessageEnd()
+    self._oprot.trans.flush()
+
+  def recv_knnQueryBatch(self):
+    iprot = self._iprot
+    (fname, mtype, rseqid) = iprot.readMessageBegin()
+    if mtype == TMessageType.EXCEPTION:
+      x = TApplicationException()
+      x.read(iprot)
+      iprot.readMessageEnd()
+      raise x
+    result = knnQueryBatch_result()
+    result.read(iprot)
+    iprot.readMessageEnd()
+    if result.success is not None:
+      return result.success
+    if result.err is not None:
+      raise result.err
+    raise TApplicationException(TApplicationException.MISSING_RESULT, "knnQueryBatch failed: unknown result");
+
+  def knnQueryBatchBinary(self, k, queryObj, retExternId, retObj, queryTimeParams):
+    """
+    Parameters:
+     - k
+     - queryObj
+     - retExternId
+     - retObj
+     - queryTimeParams
+    """
+    self.send_knnQueryBatchBinary(k, queryObj, retExternId, retObj, queryTimeParams)
+    return self.recv_knnQueryBatchBinary()
+
+  def send_knnQueryBatchBinary(self, k, queryObj, retExternId, retObj, queryTimeParams):
+    self._oprot.writeMessageBegin('knnQueryBatchBinary', TMessageType.CALL, self._seqid)
+    args = knnQueryBatchBinary_args()
+    args.k = k
+    args.queryObj = queryObj
+    args.retExternId = retExternId
+    args.retObj = retObj
+    args.queryTimeParams = queryTimeParams
+    args.write(self._oprot)
+    self._oprot.writeMessageEnd()
+    self._oprot.trans.flush()
+
+  def recv_knnQueryBatchBinary(self):
+    iprot = self._iprot
+    (fname, mtype, rseqid) = iprot.readMessageBegin()
+    if mtype == TMessageType.EXCEPTION:
+      x = TApplicationException()
+      x.read(iprot)
+      iprot.readMessageEnd()
+      raise x
+    result = knnQueryBatchBinary_result()
+    result.read(iprot)
+    iprot.readMessageEnd()
+    if result.success is not None:
+      return result.success
+    if result.err is not None:
+      raise result.err
+    raise TApplicationException(TApplicationException.MISSING_RESULT, "knnQueryBatchBinary failed: unknown result");
+
 
 class Processor(Iface, TProcessor):
   def __init__(self, handler):
@@ -214,6 +318,8 @@ class Processor(Iface, TProcessor):
     self._processMap["knnQuery"] = Processor.process_knnQuery
     self._processMap["rangeQuery"] = Processor.process_rangeQuery
     self._processMap["getDistance"] = Processor.process_getDistance
+    self._processMap["knnQueryBatch"] = Processor.process_knnQueryBatch
+    self._processMap["knnQueryBatchBinary"] = Processor.process_knnQueryBatchBinary
 
   def process(self, iprot, oprot):
     (name, type, seqid) = iprot.readMessageBegin()
@@ -286,6 +392,34 @@ class Processor(Iface, TProcessor):
     oprot.writeMessageEnd()
     oprot.trans.flush()
 
+  def process_knnQueryBatch(self, seqid, iprot, oprot):
+    args = knnQueryBatch_args()
+    args.read(iprot)
+    iprot.readMessageEnd()
+    result = knnQueryBatch_result()
+    try:
+      result.success = self._handler.knnQueryBatch(args.k, args.queryObj, args.retExternId, args.retObj, args.queryTimeParams)
+    except(QueryException, err):
+      result.err = err
+    oprot.writeMessageBegin("knnQueryBatch", TMessageType.REPLY, seqid)
+    result.write(oprot)
+    oprot.writeMessageEnd()
+    oprot.trans.flush()
+
+  def process_knnQueryBatchBinary(self, seqid, iprot, oprot):
+    args = knnQueryBatchBinary_args()
+    args.read(iprot)
+    iprot.readMessageEnd()
+    result = knnQueryBatchBinary_result()
+    try:
+      result.success = self._handler.knnQueryBatchBinary(args.k, args.queryObj, args.retExternId, args.retObj, args.queryTimeParams)
+    except(QueryException, err):
+      result.err = err
+    oprot.writeMessageBegin("knnQueryBatchBinary", TMessageType.REPLY, seqid)
+    result.write(oprot)
+    oprot.writeMessageEnd()
+    oprot.trans.flush()
+
 
 # HELPER FUNCTIONS AND STRUCTURES
 
@@ -979,3 +1113,467 @@ class getDistance_result:
 
   def __ne__(self, other):
     return not (self == other)
+
+class knnQueryBatch_args:
+  """
+  Attributes:
+   - k
+   - queryObj
+   - retExternId
+   - retObj
+   - queryTimeParams
+  """
+
+  thrift_spec = (
+    None, # 0
+    (1, TType.I32, 'k', None, None, ), # 1
+    (2, TType.LIST, 'queryObj', (TType.STRING,None), None, ), # 2
+    (3, TType.BOOL, 'retExternId', None, None, ), # 3
+    (4, TType.BOOL, 'retObj', None, None, ), # 4
+    (5, TType.STRING, 'queryTimeParams', None, None, ), # 5
+  )
+
+  def __init__(self, k=None, queryObj=None, retExternId=None, retObj=None, queryTimeParams=None,):
+    self.k = k
+    self.queryObj = queryObj
+    self.retExternId = retExternId
+    self.retObj = retObj
+    self.queryTimeParams = queryTimeParams
+
+  def read(self, iprot):
+    if iprot.__class__ == TBinaryProtocol.TBinaryProtocolAccelerated and isinstance(iprot.trans, TTransport.CReadableTransport) and self.thrift_spec is not None and fastbinary is not None:
+      fastbinary.decode_binary(self, iprot.trans, (self.__class__, self.thrift_spec))
+      return
+    iprot.readStructBegin()
+    while True:
+      (fname, ftype, fid) = iprot.readFieldBegin()
+      if ftype == TType.STOP:
+        break
+      if fid == 1:
+        if ftype == TType.I32:
+          self.k = iprot.readI32();
+        else:
+          iprot.skip(ftype)
+      elif fid == 2:
+        if ftype == TType.LIST:
+          self.queryObj = []
+          (_etype17, _size14) = iprot.readListBegin()
+          for _i18 in xrange(_size14):
+            _elem19 = iprot.readString();
+            self.queryObj.append(_elem19)
+          iprot.readListEnd()
+        else:
+          iprot.skip(ftype)
+      elif fid == 3:
+        if ftype == TType.BOOL:
+          self.retExternId = iprot.readBool();
+        else:
+          iprot.skip(ftype)
+      elif fid == 4:
+        if ftype == TType.BOOL:
+          self.retObj = iprot.readBool();
+        else:
+          iprot.skip(ftype)
+      elif fid == 5:
+        if ftype == TType.STRING:
+          self.queryTimeParams = iprot.readString();
+        else:
+          iprot.skip(ftype)
+      else:
+        iprot.skip(ftype)
+      iprot.readFieldEnd()
+    iprot.readStructEnd()
+
+  def write(self, oprot):
+    if oprot.__class__ == TBinaryProtocol.TBinaryProtocolAccelerated and self.thrift_spec is not None and fastbinary is not None:
+      oprot.trans.write(fastbinary.encode_binary(self, (self.__class__, self.thrift_spec)))
+      return
+    oprot.writeStructBegin('knnQueryBatch_args')
+    if self.k is not None:
+      oprot.writeFieldBegin('k', TType.I32, 1)
+      oprot.writeI32(self.k)
+      oprot.writeFieldEnd()
+    if self.queryObj is not None:
+      oprot.writeFieldBegin('queryObj', TType.LIST, 2)
+      oprot.writeListBegin(TType.STRING, len(self.queryObj))
+      for iter20 in self.queryObj:
+        oprot.writeString(iter20)
+      oprot.writeListEnd()
+      oprot.writeFieldEnd()
+    if self.retExternId is not None:
+      oprot.writeFieldBegin('retExternId', TType.BOOL, 3)
+      oprot.writeBool(self.retExternId)
+      oprot.writeFieldEnd()
+    if self.retObj is not None:
+      oprot.writeFieldBegin('retObj', TType.BOOL, 4)
+      oprot.writeBool(self.retObj)
+      oprot.writeFieldEnd()
+    if self.queryTimeParams is not None:
+      oprot.writeFieldBegin('queryTimeParams', TType.STRING, 5)
+      oprot.writeString(self.queryTimeParams)
+      oprot.writeFieldEnd()
+    oprot.writeFieldStop()
+    oprot.writeStructEnd()
+
+  def validate(self):
+    if self.k is None:
+      raise TProtocol.TProtocolException(message='Required field k is unset!')
+    if self.queryObj is None:
+      raise TProtocol.TProtocolException(message='Required field queryObj is unset!')
+    if self.retExternId is None:
+      raise TProtocol.TProtocolException(message='Required field retExternId is unset!')
+    if self.retObj is None:
+      raise TProtocol.TProtocolException(message='Required field retObj is unset!')
+    if self.queryTimeParams is None:
+      raise TProtocol.TProtocolException(message='Required field queryTimeParams is unset!')
+    return
+
+
+  def __hash__(self):
+    value = 17
+    value = (value * 31) ^ hash(self.k)
+    value = (value * 31) ^ hash(self.queryObj)
+    value = (value * 31) ^ hash(self.retExternId)
+    value = (value * 31) ^ hash(self.retObj)
+    value = (value * 31) ^ hash(self.queryTimeParams)
+    return value
+
+
+  def __repr__(self):
+    L = ['%s=%r' % (key, value)
+      for key, value in self.__dict__.iteritems()]
+    return '%s(%s)' % (self.__class__.__name__, ', '.join(L))
+
+  def __eq__(self, other):
+    return isinstance(other, self.__class__) and self.__dict__ == other.__dict__
+
+  def __ne__(self, other):
+    return not (self == other)
+
+class knnQueryBatch_result:
+  """
+  Attributes:
+   - success
+   - err
+  """
+
+  thrift_spec = (
+    (0, TType.LIST, 'success', (TType.LIST,(TType.STRUCT,(ReplyEntry, ReplyEntry.thrift_spec))), None, ), # 0
+    (1, TType.STRUCT, 'err', (QueryException, QueryException.thrift_spec), None, ), # 1
+  )
+
+  def __init__(self, success=None, err=None,):
+    self.success = success
+    self.err = err
+
+  def read(self, iprot):
+    if iprot.__class__ == TBinaryProtocol.TBinaryProtocolAccelerated and isinstance(iprot.trans, TTransport.CReadableTransport) and self.thrift_spec is not None and fastbinary is not None:
+      fastbinary.decode_binary(self, iprot.trans, (self.__class__, self.thrift_spec))
+      return
+    iprot.readStructBegin()
+    while True:
+      (fname, ftype, fid) = iprot.readFieldBegin()
+      if ftype == TType.STOP:
+        break
+      if fid == 0:
+        if ftype == TType.LIST:
+          self.success = []
+          (_etype24, _size21) = iprot.readListBegin()
+          for _i25 in xrange(_size21):
+            _elem26 = []
+            (_etype30, _size27) = iprot.readListBegin()
+            for _i31 in xrange(_size27):
+              _elem32 = ReplyEntry()
+              _elem32.read(iprot)
+              _elem26.append(_elem32)
+            iprot.readListEnd()
+            self.success.append(_elem26)
+          iprot.readListEnd()
+        else:
+          iprot.skip(ftype)
+      elif fid == 1:
+        if ftype == TType.STRUCT:
+          self.err = QueryException()
+          self.err.read(iprot)
+        else:
+          iprot.skip(ftype)
+      else:
+        iprot.skip(ftype)
+      iprot.readFieldEnd()
+    iprot.readStructEnd()
+
+  def write(self, oprot):
+    if oprot.__class__ == TBinaryProtocol.TBinaryProtocolAccelerated and self.thrift_spec is not None and fastbinary is not None:
+      oprot.trans.write(fastbinary.encode_binary(self, (self.__class__, self.thrift_spec)))
+      return
+    oprot.writeStructBegin('knnQueryBatch_result')
+    if self.success is not None:
+      oprot.writeFieldBegin('success', TType.LIST, 0)
+      oprot.writeListBegin(TType.LIST, len(self.success))
+      for iter33 in self.success:
+        oprot.writeListBegin(TType.STRUCT, len(iter33))
+        for iter34 in iter33:
+          iter34.write(oprot)
+        oprot.writeListEnd()
+      oprot.writeListEnd()
+      oprot.writeFieldEnd()
+    if self.err is not None:
+      oprot.writeFieldBegin('err', TType.STRUCT, 1)
+      self.err.write(oprot)
+      oprot.writeFieldEnd()
+    oprot.writeFieldStop()
+    oprot.writeStructEnd()
+
+  def validate(self):
+    return
+
+
+  def __hash__(self):
+    value = 17
+    value = (value * 31) ^ hash(self.success)
+    value = (value * 31) ^ hash(self.err)
+    return value
+
+
+  def __repr__(self):
+    L = ['%s=%r' % (key, value)
+      for key, value in self.__dict__.iteritems()]
+    return '%s(%s)' % (self.__class__.__name__, ', '.join(L))
+
+  def __eq__(self, other):
+    return isinstance(other, self.__class__) and self.__dict__ == other.__dict__
+
+  def __ne__(self, other):
+    return not (self == other)
+
+class knnQueryBatchBinary_args:
+  """
+  Attributes:
+   - k
+   - queryObj
+   - retExternId
+   - retObj
+   - queryTimeParams
+  """
+
+  thrift_spec = (
+    None, # 0
+    (1, TType.I32, 'k', None, None, ), # 1
+    (2, TType.LIST, 'queryObj', (TType.STRING,None), None, ), # 2
+    (3, TType.BOOL, 'retExternId', None, None, ), # 3
+    (4, TType.BOOL, 'retObj', None, None, ), # 4
+    (5, TType.STRING, 'queryTimeParams', None, None, ), # 5
+  )
+
+  def __init__(self, k=None, queryObj=None, retExternId=None, retObj=None, queryTimeParams=None,):
+    self.k = k
+    self.queryObj = queryObj
+    self.retExternId = retExternId
+    self.retObj = retObj
+    self.queryTimeParams = queryTimeParams
+
+  def read(self, iprot):
+    if iprot.__class__ == TBinaryProtocol.TBinaryProtocolAccelerated and isinstance(iprot.trans, TTransport.CReadableTransport) and self.thrift_spec is not None and fastbinary is not None:
+      fastbinary.decode_binary(self, iprot.trans, (self.__class__, self.thrift_spec))
+      return
+    iprot.readStructBegin()
+    while True:
+      (fname, ftype, fid) = iprot.readFieldBegin()
+      if ftype == TType.STOP:
+        break
+      if fid == 1:
+        if ftype == TType.I32:
+          self.k = iprot.readI32();
+        else:
+          iprot.skip(ftype)
+      elif fid == 2:
+        if ftype == TType.LIST:
+          self.queryObj = []
+          (_etype38, _size35) = iprot.readListBegin()
+          for _i39 in xrange(_size35):
+            _elem40 = iprot.readString();
+            self.queryObj.append(_elem40)
+          iprot.readListEnd()
+        else:
+          iprot.skip(ftype)
+      elif fid == 3:
+        if ftype == TType.BOOL:
+          self.retExternId = iprot.readBool();
+        else:
+          iprot.skip(ftype)
+      elif fid == 4:
+        if ftype == TType.BOOL:
+          self.retObj = iprot.readBool();
+        else:
+          iprot.skip(ftype)
+      elif fid == 5:
+        if ftype == TType.STRING:
+          self.queryTimeParams = iprot.readString();
+        else:
+          iprot.skip(ftype)
+      else:
+        iprot.skip(ftype)
+      iprot.readFieldEnd()
+    iprot.readStructEnd()
+
+  def write(self, oprot):
+    if oprot.__class__ == TBinaryProtocol.TBinaryProtocolAccelerated and self.thrift_spec is not None and fastbinary is not None:
+      oprot.trans.write(fastbinary.encode_binary(self, (self.__class__, self.thrift_spec)))
+      return
+    oprot.writeStructBegin('knnQueryBatchBinary_args')
+    if self.k is not None:
+      oprot.writeFieldBegin('k', TType.I32, 1)
+      oprot.writeI32(self.k)
+      oprot.writeFieldEnd()
+    if self.queryObj is not None:
+      oprot.writeFieldBegin('queryObj', TType.LIST, 2)
+      oprot.writeListBegin(TType.STRING, len(self.queryObj))
+      for iter41 in self.queryObj:
+        oprot.writeString(iter41)
+      oprot.writeListEnd()
+      oprot.writeFieldEnd()
+    if self.retExternId is not None:
+      oprot.writeFieldBegin('retExternId', TType.BOOL, 3)
+      oprot.writeBool(self.retExternId)
+      oprot.writeFieldEnd()
+    if self.retObj is not None:
+      oprot.writeFieldBegin('retObj', TType.BOOL, 4)
+      oprot.writeBool(self.retObj)
+      oprot.writeFieldEnd()
+    if self.queryTimeParams is not None:
+      oprot.writeFieldBegin('queryTimeParams', TType.STRING, 5)
+      oprot.writeString(self.queryTimeParams)
+      oprot.writeFieldEnd()
+    oprot.writeFieldStop()
+    oprot.writeStructEnd()
+
+  def validate(self):
+    if self.k is None:
+      raise TProtocol.TProtocolException(message='Required field k is unset!')
+    if self.queryObj is None:
+      raise TProtocol.TProtocolException(message='Required field queryObj is unset!')
+    if self.retExternId is None:
+      raise TProtocol.TProtocolException(message='Required field retExternId is unset!')
+    if self.retObj is None:
+      raise TProtocol.TProtocolException(message='Required field retObj is unset!')
+    if self.queryTimeParams is None:
+      raise TProtocol.TProtocolException(message='Required field queryTimeParams is unset!')
+    return
+
+
+  def __hash__(self):
+    value = 17
+    value = (value * 31) ^ hash(self.k)
+    value = (value * 31) ^ hash(self.queryObj)
+    value = (value * 31) ^ hash(self.retExternId)
+    value = (value * 31) ^ hash(self.retObj)
+    value = (value * 31) ^ hash(self.queryTimeParams)
+    return value
+
+
+  def __repr__(self):
+    L = ['%s=%r' % (key, value)
+      for key, value in self.__dict__.iteritems()]
+    return '%s(%s)' % (self.__class__.__name__, ', '.join(L))
+
+  def __eq__(self, other):
+    return isinstance(other, self.__class__) and self.__dict__ == other.__dict__
+
+  def __ne__(self, other):
+    return not (self == other)
+
+class knnQueryBatchBinary_result:
+  """
+  Attributes:
+   - success
+   - err
+  """
+
+  thrift_spec = (
+    (0, TType.LIST, 'success', (TType.LIST,(TType.STRUCT,(ReplyEntry, ReplyEntry.thrift_spec))), None, ), # 0
+    (1, TType.STRUCT, 'err', (QueryException, QueryException.thrift_spec), None, ), # 1
+  )
+
+  def __init__(self, success=None, err=None,):
+    self.success = success
+    self.err = err
+
+  def read(self, iprot):
+    if iprot.__class__ == TBinaryProtocol.TBinaryProtocolAccelerated and isinstance(iprot.trans, TTransport.CReadableTransport) and self.thrift_spec is not None and fastbinary is not None:
+      fastbinary.decode_binary(self, iprot.trans, (self.__class__, self.thrift_spec))
+      return
+    iprot.readStructBegin()
+    while True:
+      (fname, ftype, fid) = iprot.readFieldBegin()
+      if ftype == TType.STOP:
+        break
+      if fid == 0:
+        if ftype == TType.LIST:
+          self.success = []
+          (_etype45, _size42) = iprot.readListBegin()
+          for _i46 in xrange(_size42):
+            _elem47 = []
+            (_etype51, _size48) = iprot.readListBegin()
+            for _i52 in xrange(_size48):
+              _elem53 = ReplyEntry()
+              _elem53.read(iprot)
+              _elem47.append(_elem53)
+            iprot.readListEnd()
+            self.success.append(_elem47)
+          iprot.readListEnd()
+        else:
+          iprot.skip(ftype)
+      elif fid == 1:
+        if ftype == TType.STRUCT:
+          self.err = QueryException()
+          self.err.read(iprot)
+        else:
+          iprot.skip(ftype)
+      else:
+        iprot.skip(ftype)
+      iprot.readFieldEnd()
+    iprot.readStructEnd()
+
+  def write(self, oprot):
+    if oprot.__class__ == TBinaryProtocol.TBinaryProtocolAccelerated and self.thrift_spec is not None and fastbinary is not None:
+      oprot.trans.write(fastbinary.encode_binary(self, (self.__class__, self.thrift_spec)))
+      return
+    oprot.writeStructBegin('knnQueryBatchBinary_result')
+    if self.success is not None:
+      oprot.writeFieldBegin('success', TType.LIST, 0)
+      oprot.writeListBegin(TType.LIST, len(self.success))
+      for iter54 in self.success:
+        oprot.writeListBegin(TType.STRUCT, len(iter54))
+        for iter55 in iter54:
+          iter55.write(oprot)
+        oprot.writeListEnd()
+      oprot.writeListEnd()
+      oprot.writeFieldEnd()
+    if self.err is not None:
+      oprot.writeFieldBegin('err', TType.STRUCT, 1)
+      self.err.write(oprot)
+      oprot.writeFieldEnd()
+    oprot.writeFieldStop()
+    oprot.writeStructEnd()
+
+  def validate(self):
+    return
+
+
+  def __hash__(self):
+    value = 17
+    value = (value * 31) ^ hash(self.success)
+    value = (value * 31) ^ hash(self.err)
+    return value
+
+
+  def __repr__(self):
+    L = ['%s=%r' % (key, value)
+      for key, value in self.__dict__.iteritems()]
+    return '%s(%s)' % (self.__class__.__name__, ', '.join(L))
+
+  def __eq__(self, other):
+    return isinstance(other, self.__class__) and self.__dict__ == other.__dict__
+
+  def __ne__(self, other):
+    return not (self == other)
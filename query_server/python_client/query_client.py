@@ -1,5 +1,5 @@
 #!/usr/bin/env python
-import sys, glob
+import sys, glob, struct
 
 from thrift import Thrift
 from thrift.transport import TSocket
@@ -17,6 +17,27 @@ def error_exit(s):
   print("Error: %s" % s)
   sys.exit(1)
 
+# Converts a dense vector (space-separated numbers) or a sparse vector
+# (space-separated dim:value pairs) into the binary format of knnQueryBatchBinary
+def create_binary_query(line):
+  res = b''
+  for token in line.split():
+    if ':' in token:
+      dim, val = token.split(':')
+      res += struct.pack('<If', int(dim), float(val))
+    else:
+      res += struct.pack('<f', float(token))
+  return res
+
+def print_result(res):
+  for e in res:
+    s=''
+    if retExternId:
+      s='externId=' + e.externId
+    print("id=%d dist=%f %s" % (e.id, e.dist, s))
+    if retObj:
+      print(e.obj)
+
 parser = argparse.ArgumentParser()
 
 parser.add_argument('-p', '--port', help='TCP/IP server port number', action='store', type=int,required=True)
@@ -26,6 +47,8 @@ parser.add_argument('-r', '--range', help='range for the range search', action='
 parser.add_argument('-t', '--queryTimeParams', help='Query time parameter', action='store', default='')
 parser.add_argument('-o', '--retObj', help='Return string representation of found objects?', action='store_true', default=False)
 parser.add_argument('-e', '--retExternId', help='Return external IDs?', action='store_true', default=False)
+parser.add_argument('-b', '--batch', help='Each input line is a separate k-NN query, all queries are sent in one batch', action='store_true', default=False)
+parser.add_argument('--binary', help='Send batch queries in the binary format: each input line is either a dense vector (space-separated numbers) or a sparse vector (space-separated dim:value pairs)', action='store_true', default=False)
 
 args = parser.parse_args()
 
@@ -49,16 +72,34 @@ try:
   transport.open()
 
   queryObj = '' 
+  batchQueries = []
   for s in sys.stdin:
-    queryObj = queryObj + s + '\n'
+    if not args.batch:
+      queryObj = queryObj + s + '\n'
+    elif s.strip() != '':
+      batchQueries.append(create_binary_query(s) if args.binary else s.strip())
+
+  if args.binary and not args.batch:
+    error_exit('Binary queries are supported only in the batch mode')
 
-  if args.queryTimeParams != '': 
+  # A batch carries its own query-time parameters
+  if args.queryTimeParams != '' and not args.batch: 
     client.setQueryTimeParams(args.queryTimeParams)
 
   t1 = datetime.now()
 
   res = None
-  if not args.knn is None:
+  batchRes = None
+  if args.batch:
+    if args.knn is None or not args.range is None:
+      error_exit('Batch mode is supported only for the KNN search')
+    k = args.knn
+    print("Running a batch of %d %d-NN queries" % (len(batchQueries), k))
+    if args.binary:
+      batchRes = client.knnQueryBatchBinary(k, batchQueries, retExternId, retObj, queryTimeParams)
+    else:
+      batchRes = client.knnQueryBatch(k, batchQueries, retExternId, retObj, queryTimeParams)
+  elif not args.knn is None:
     k = args.knn
     if not args.range is None:
       error_exit('Range search is not allowed if the KNN search is specified!')
@@ -81,13 +122,12 @@ try:
 
   print("Finished in %f ms" % elapsed)
 
-  for e in res:
-    s=''
-    if retExternId:
-      s='externId=' + e.externId
-    print("id=%d dist=%f %s" % (e.id, e.dist, s))
-    if retObj:
-      print(e.obj)
+  if batchRes is not None:
+    for i, queryRes in enumerate(batchRes):
+      print("Query #%d" % i)
+      print_result(queryRes)
+  else:
+    print_result(res)
 
 # Close!
   transport.close()
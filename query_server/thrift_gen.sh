@@ -1,6 +1,7 @@
-thrift --gen java protocol.thrift
-thrift --gen cpp  protocol.thrift
-thrift --gen py  protocol.thrift
-
-
-
+#!/bin/bash -e
+# Regenerates the server and client code from protocol.thrift (Thrift 0.9.2)
+cd "$(dirname "$0")"
+thrift --gen java -out java_client/src/main/java protocol.thrift
+thrift --gen cpp  -out cpp_client_server/gen-thrift protocol.thrift
+rm -f cpp_client_server/gen-thrift/QueryService_server.skeleton.cpp
+thrift --gen py   -out python_client protocol.thrift
@@ -37,6 +37,7 @@
 #include "permutation_utils.h"
 #include "ztimer.h"
 #include "pow.h"
+#include "perf_counters.h"
 
 #include "../test/testdataset.h"
 
@@ -51,6 +52,37 @@ namespace similarity {
 using std::unique_ptr;
 using std::vector;
 
+/*
+ * If set (command-line option --perfCounters), benchmarks also
+ * collect hardware performance counters (Linux only).
+ */
+bool gUsePerfCounters = false;
+
+/*
+ * A wall-clock timer that optionally collects hardware performance counters.
+ * The counters are printed by split() normalized per distance computation.
+ */
+class BenchTimer : public WallClockTimer {
+public:
+  BenchTimer() {
+    if (gUsePerfCounters) perf_.reset(new PerfCounters());
+  }
+  void reset() {
+    if (perf_) perf_->Start();
+    WallClockTimer::reset();
+  }
+  uint64_t split(uint64_t distQty) {
+    uint64_t res = WallClockTimer::split();
+    if (perf_) {
+      perf_->Stop();
+      LOG(LIB_INFO) << "HW counters per distance: " << perf_->Read().ToString(distQty);
+    }
+    return res;
+  }
+private:
+  unique_ptr<PerfCounters> perf_;
+};
+
 
 template <class T> 
 inline void Normalize(T* pVect, size_t qty) {
@@ -135,7 +167,7 @@ void TestLInfNormStandard(size_t N, size_t dim, size_t Rep) {
         GenRandVect(p, dim, -T(RANGE), T(RANGE));
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -154,7 +186,7 @@ void TestLInfNormStandard(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of standard LInfs per second: " << (1e6/tDiff) * N * Rep ;
@@ -172,7 +204,7 @@ void TestLInfNorm(size_t N, size_t dim, size_t Rep) {
         GenRandVect(p, dim, -T(RANGE), T(RANGE));
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -191,7 +223,7 @@ void TestLInfNorm(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of optim. LInfs per second: " << (1e6/tDiff) * N * Rep ;
@@ -209,7 +241,7 @@ void TestLInfNormSIMD(size_t N, size_t dim, size_t Rep) {
         GenRandVect(p, dim, -T(RANGE), T(RANGE));
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -228,7 +260,7 @@ void TestLInfNormSIMD(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of SIMD LInfs per second: " << (1e6/tDiff) * N * Rep ;
@@ -247,7 +279,7 @@ void TestL1NormStandard(size_t N, size_t dim, size_t Rep) {
         GenRandVect(p, dim, -T(RANGE), T(RANGE));
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -266,7 +298,7 @@ void TestL1NormStandard(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of standard L1s per second: " << (1e6/tDiff) * N * Rep ;
@@ -284,7 +316,7 @@ void TestL1Norm(size_t N, size_t dim, size_t Rep) {
         GenRandVect(p, dim, -T(RANGE), T(RANGE));
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -303,7 +335,7 @@ void TestL1Norm(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of optim. L1s per second: " << (1e6/tDiff) * N * Rep ;
@@ -321,7 +353,7 @@ void TestL1NormSIMD(size_t N, size_t dim, size_t Rep) {
         GenRandVect(p, dim, -T(RANGE), T(RANGE));
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -340,7 +372,7 @@ void TestL1NormSIMD(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of SIMD L1s per second: " << (1e6/tDiff) * N * Rep ;
@@ -358,7 +390,7 @@ void TestL2NormStandard(size_t N, size_t dim, size_t Rep) {
         GenRandVect(p, dim, -T(RANGE), T(RANGE));
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -377,7 +409,7 @@ void TestL2NormStandard(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of standard L2s per second: " << (1e6/tDiff) * N * Rep ;
@@ -395,7 +427,7 @@ void TestL2Norm(size_t N, size_t dim, size_t Rep) {
         GenRandVect(p, dim, -T(RANGE), T(RANGE));
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -414,7 +446,7 @@ void TestL2Norm(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of optim. L2s per second: " << (1e6/tDiff) * N * Rep ;
@@ -432,7 +464,7 @@ void TestL2NormSIMD(size_t N, size_t dim, size_t Rep) {
         GenRandVect(p, dim, -T(RANGE), T(RANGE));
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -451,7 +483,7 @@ void TestL2NormSIMD(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
  
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
  
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of SIMD L2s per second: " << (1e6/tDiff) * N * Rep ;
@@ -470,7 +502,7 @@ void TestLPGeneric(size_t N, size_t dim, size_t Rep, T power) {
         GenRandVect(p, dim, T(-RANGE), T(RANGE));
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -490,7 +522,7 @@ void TestLPGeneric(size_t N, size_t dim, size_t Rep, T power) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of Generic L" << power << " per second: " << (1e6/tDiff) * N * Rep ;
@@ -508,7 +540,7 @@ void TestLPGenericOptim(size_t N, size_t dim, size_t Rep, T power) {
         GenRandVect(p, dim, T(-RANGE), T(RANGE));
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -528,7 +560,7 @@ void TestLPGenericOptim(size_t N, size_t dim, size_t Rep, T power) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of Optimized generic L" << power << " per second: " << (1e6/tDiff) * N * Rep ;
@@ -547,7 +579,7 @@ void TestItakuraSaitoPrecomp(size_t N, size_t dim, size_t Rep) {
         PrecompLogarithms(p, dim);
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -567,7 +599,7 @@ void TestItakuraSaitoPrecomp(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of precomp. ItakuraSaito per second: " << (1e6/tDiff) * N * Rep ;
@@ -586,7 +618,7 @@ void TestItakuraSaitoPrecompSIMD(size_t N, size_t dim, size_t Rep) {
         PrecompLogarithms(p, dim);
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -606,7 +638,7 @@ void TestItakuraSaitoPrecompSIMD(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of SIMD precomp. ItakuraSaito per second: " << (1e6/tDiff) * N * Rep ;
@@ -624,7 +656,7 @@ void TestItakuraSaitoStandard(size_t N, size_t dim, size_t Rep) {
         GenRandVect(p, dim, T(RANGE_SMALL), T(1.0));
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -644,7 +676,7 @@ void TestItakuraSaitoStandard(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of ItakuraSaito per second: " << (1e6/tDiff) * N * Rep ;
@@ -664,7 +696,7 @@ void TestKLPrecomp(size_t N, size_t dim, size_t Rep) {
         PrecompLogarithms(p, dim);
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -684,7 +716,7 @@ void TestKLPrecomp(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of precomp. KLs per second: " << (1e6/tDiff) * N * Rep ;
@@ -703,7 +735,7 @@ void TestKLPrecompSIMD(size_t N, size_t dim, size_t Rep) {
         PrecompLogarithms(p, dim);
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -723,7 +755,7 @@ void TestKLPrecompSIMD(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of SIMD precomp. KLs per second: " << (1e6/tDiff) * N * Rep ;
@@ -741,7 +773,7 @@ void TestKLStandard(size_t N, size_t dim, size_t Rep) {
         GenRandVect(p, dim, T(RANGE_SMALL), T(1.0), true /* norm. for regular KL */);
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -761,7 +793,7 @@ void TestKLStandard(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of KLs per second: " << (1e6/tDiff) * N * Rep ;
@@ -781,7 +813,7 @@ void TestKLGeneralPrecomp(size_t N, size_t dim, size_t Rep) {
         PrecompLogarithms(p, dim);
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -801,7 +833,7 @@ void TestKLGeneralPrecomp(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of precomp. general. KLs per second: " << (1e6/tDiff) * N * Rep ;
@@ -820,7 +852,7 @@ void TestKLGeneralPrecompSIMD(size_t N, size_t dim, size_t Rep) {
         PrecompLogarithms(p, dim);
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -840,7 +872,7 @@ void TestKLGeneralPrecompSIMD(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of SIMD precomp. general. KLs per second: " << (1e6/tDiff) * N * Rep ;
@@ -858,7 +890,7 @@ void TestKLGeneralStandard(size_t N, size_t dim, size_t Rep) {
         GenRandVect(p, dim, T(RANGE_SMALL), T(1.0));
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -878,7 +910,7 @@ void TestKLGeneralStandard(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of general. KLs per second: " << (1e6/tDiff) * N * Rep ;
@@ -898,7 +930,7 @@ void TestJSStandard(size_t N, size_t dim, size_t Rep, float pZero) {
         Normalize(p, dim);
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -918,7 +950,7 @@ void TestJSStandard(size_t N, size_t dim, size_t Rep, float pZero) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of JSs (sparsity:" << pZero << ") per second: " << (1e6/tDiff) * N * Rep ;
@@ -938,7 +970,7 @@ void TestJSPrecomp(size_t N, size_t dim, size_t Rep, float pZero) {
         PrecompLogarithms(p, dim);
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -958,7 +990,7 @@ void TestJSPrecomp(size_t N, size_t dim, size_t Rep, float pZero) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of JSs (precomp) (sparsity:" << pZero << ")  per second: " << (1e6/tDiff) * N * Rep ;
@@ -978,7 +1010,7 @@ void TestJSPrecompApproxLog(size_t N, size_t dim, size_t Rep, float pZero) {
         PrecompLogarithms(p, dim);
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -998,7 +1030,7 @@ void TestJSPrecompApproxLog(size_t N, size_t dim, size_t Rep, float pZero) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of JSs (precomp, one log approx) (sparsity:" << pZero << ") per second: " << (1e6/tDiff) * N * Rep ;
@@ -1018,7 +1050,7 @@ void TestJSPrecompSIMDApproxLog(size_t N, size_t dim, size_t Rep, float pZero) {
         PrecompLogarithms(p, dim);
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1038,7 +1070,7 @@ void TestJSPrecompSIMDApproxLog(size_t N, size_t dim, size_t Rep, float pZero) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of JSs (precomp, one log approx, SIMD) (sparsity:" << pZero << ") per second: " << (1e6/tDiff) * N * Rep ;
@@ -1055,7 +1087,7 @@ void TestSpearmanRho(size_t N, size_t dim, size_t Rep) {
         GenRandIntVect(p, dim);
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1075,7 +1107,7 @@ void TestSpearmanRho(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << "Elapsed: " << tDiff / 1e3 << " ms " << " # of standard SpearmanRho per second: " << (1e6/tDiff) * N * Rep ;
@@ -1092,7 +1124,7 @@ void TestSpearmanRhoSIMD(size_t N, size_t dim, size_t Rep) {
         GenRandIntVect(p, dim);
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1112,7 +1144,7 @@ void TestSpearmanRhoSIMD(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << "Elapsed: " << tDiff / 1e3 << " ms " << " # of SpearmanRhoSIMD per second: " << (1e6/tDiff) * N * Rep ;
@@ -1129,7 +1161,7 @@ void TestSpearmanFootrule(size_t N, size_t dim, size_t Rep) {
         GenRandIntVect(p, dim);
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1149,7 +1181,7 @@ void TestSpearmanFootrule(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << "Elapsed: " << tDiff / 1e3 << " ms " << " # of standard SpearmanFootrule per second: " << (1e6/tDiff) * N * Rep ;
@@ -1166,7 +1198,7 @@ void TestSpearmanFootruleSIMD(size_t N, size_t dim, size_t Rep) {
         GenRandIntVect(p, dim);
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1186,7 +1218,7 @@ void TestSpearmanFootruleSIMD(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << "Elapsed: " << tDiff / 1e3 << " ms " << " # of SpearmanFootruleSIMD per second: " << (1e6/tDiff) * N * Rep ;
@@ -1209,7 +1241,7 @@ void TestSQFDGeneric(size_t N, size_t Rep, SqfdFunction<T>& func) {
 
     N = min(N, elems.size());
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1229,7 +1261,7 @@ void TestSQFDGeneric(size_t N, size_t Rep, SqfdFunction<T>& func) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) <<  typeid(T).name() << " Elapsed: " << tDiff / 1e3 << " ms " << 
@@ -1268,7 +1300,7 @@ void TestLevenshtein(size_t N, size_t Rep) {
 
     N = min(N, elems.size());
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1288,7 +1320,7 @@ void TestLevenshtein(size_t N, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << " Elapsed: " << tDiff / 1e3 << " ms " << 
@@ -1307,7 +1339,7 @@ void TestSparseLp(size_t N, size_t Rep, T power) {
 
     N = min(N, elems.size());
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1327,7 +1359,7 @@ void TestSparseLp(size_t N, size_t Rep, T power) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << 
@@ -1346,7 +1378,7 @@ void TestSparseAngularDistance(const string& dataFile, size_t N, size_t Rep) {
 
     N = min(N, elems.size());
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1366,7 +1398,7 @@ void TestSparseAngularDistance(const string& dataFile, size_t N, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " File: " << dataFile 
@@ -1387,7 +1419,7 @@ void TestSparseCosineSimilarityFast(const string& dataFile, size_t N, size_t Rep
 
     N = min(N, elems.size());
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1407,7 +1439,7 @@ void TestSparseCosineSimilarityFast(const string& dataFile, size_t N, size_t Rep
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " File: " << dataFile << 
@@ -1428,7 +1460,7 @@ void TestSparseAngularDistanceFast(const string& dataFile, size_t N, size_t Rep)
 
     N = min(N, elems.size());
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1448,7 +1480,7 @@ void TestSparseAngularDistanceFast(const string& dataFile, size_t N, size_t Rep)
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " File: " << dataFile <<
@@ -1469,7 +1501,7 @@ void TestSparseNegativeScalarProductFast(const string& dataFile, size_t N, size_
 
     N = min(N, elems.size());
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1489,7 +1521,7 @@ void TestSparseNegativeScalarProductFast(const string& dataFile, size_t N, size_
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " File: " << dataFile << 
@@ -1510,7 +1542,7 @@ void TestSparseQueryNormNegativeScalarProductFast(const string& dataFile, size_t
 
     N = min(N, elems.size());
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1530,7 +1562,7 @@ void TestSparseQueryNormNegativeScalarProductFast(const string& dataFile, size_t
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " File: " << dataFile << 
@@ -1551,7 +1583,7 @@ void TestSparseCosineSimilarity(const string& dataFile, size_t N, size_t Rep) {
 
     N = min(N, elems.size());
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1571,7 +1603,7 @@ void TestSparseCosineSimilarity(const string& dataFile, size_t N, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " File: " << dataFile 
@@ -1591,7 +1623,7 @@ void TestSparseNegativeScalarProduct(const string& dataFile, size_t N, size_t Re
 
     N = min(N, elems.size());
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1611,7 +1643,7 @@ void TestSparseNegativeScalarProduct(const string& dataFile, size_t N, size_t Re
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " File: " << dataFile 
@@ -1631,7 +1663,7 @@ void TestSparseQueryNormNegativeScalarProduct(const string& dataFile, size_t N,
 
     N = min(N, elems.size());
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1651,7 +1683,7 @@ void TestSparseQueryNormNegativeScalarProduct(const string& dataFile, size_t N,
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " File: " << dataFile 
@@ -1668,7 +1700,7 @@ void TestScalarProduct(size_t N, size_t dim, size_t Rep) {
         GenRandVect(p, dim, -T(RANGE), T(RANGE));
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1687,7 +1719,7 @@ void TestScalarProduct(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of ScalarProduct per second: " << (1e6/tDiff) * N * Rep ;
@@ -1705,7 +1737,7 @@ void TestScalarProductSIMD(size_t N, size_t dim, size_t Rep) {
         GenRandVect(p, dim, -T(RANGE), T(RANGE));
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1724,7 +1756,7 @@ void TestScalarProductSIMD(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of ScalarProduct SIMD per second: " << (1e6/tDiff) * N * Rep ;
@@ -1742,7 +1774,7 @@ void TestNormScalarProduct(size_t N, size_t dim, size_t Rep) {
         GenRandVect(p, dim, -T(RANGE), T(RANGE));
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1761,7 +1793,7 @@ void TestNormScalarProduct(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of NormScalarProduct per second: " << (1e6/tDiff) * N * Rep ;
@@ -1779,7 +1811,7 @@ void TestNormScalarProductSIMD(size_t N, size_t dim, size_t Rep) {
         GenRandVect(p, dim, -T(RANGE), T(RANGE));
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1798,7 +1830,7 @@ void TestNormScalarProductSIMD(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of NormScalarProduct SIMD per second: " << (1e6/tDiff) * N * Rep ;
@@ -1816,7 +1848,7 @@ void TestCosineSimilarity(size_t N, size_t dim, size_t Rep) {
         GenRandVect(p, dim, -T(RANGE), T(RANGE));
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1835,7 +1867,7 @@ void TestCosineSimilarity(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of standard CosineSimilarity per second: " << (1e6/tDiff) * N * Rep ;
@@ -1853,7 +1885,7 @@ void TestAngularDistance(size_t N, size_t dim, size_t Rep) {
         GenRandVect(p, dim, -T(RANGE), T(RANGE));
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1872,7 +1904,7 @@ void TestAngularDistance(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of standard AngularDistance per second: " << (1e6/tDiff) * N * Rep ;
@@ -1897,7 +1929,7 @@ void TestBitHamming(size_t N, size_t dim, size_t Rep) {
         memcpy(p, &h[0], WordQty * sizeof(h[0]));
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1917,7 +1949,7 @@ void TestBitHamming(size_t N, size_t dim, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << "Elapsed: " << tDiff / 1e3 << " ms " << " # of BitHamming per second: " << (1e6/tDiff) * N * Rep ;
@@ -1939,7 +1971,7 @@ void TestSparseJaccardSimilarity(const string& dataFile, size_t N, size_t Rep) {
 
     N = min(N, elems.size());
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1959,7 +1991,7 @@ void TestSparseJaccardSimilarity(const string& dataFile, size_t N, size_t Rep) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " File: " << dataFile << 
@@ -1977,7 +2009,7 @@ void TestRenyiDivSlow(size_t N, size_t dim, size_t Rep, T alpha) {
         GenRandVect(p, dim, T(RANGE_SMALL), T(1.0), true /* norm. for regular KL */);
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -1997,7 +2029,7 @@ void TestRenyiDivSlow(size_t N, size_t dim, size_t Rep, T alpha) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of slow Renyi-div. (alpha=" << alpha << ") per second: " << (1e6/tDiff) * N * Rep ;
@@ -2015,7 +2047,7 @@ void TestRenyiDivFast(size_t N, size_t dim, size_t Rep, T alpha) {
         GenRandVect(p, dim, T(RANGE_SMALL), T(1.0), true /* norm. for regular KL */);
     }
 
-    WallClockTimer  t;
+    BenchTimer      t;
 
     t.reset();
 
@@ -2035,7 +2067,7 @@ void TestRenyiDivFast(size_t N, size_t dim, size_t Rep, T alpha) {
         DiffSum *= fract;
     }
 
-    uint64_t tDiff = t.split();
+    uint64_t tDiff = t.split(N * Rep);
 
     LOG(LIB_INFO) << "Ignore: " << DiffSum;
     LOG(LIB_INFO) << typeid(T).name() << " " << "Elapsed: " << tDiff / 1e3 << " ms " << " # of fast Renyi-div. (alpha=" << alpha << ") per second: " << (1e6/tDiff) * N * Rep ;
@@ -2050,7 +2082,10 @@ using namespace similarity;
 
 int main(int argc, char* argv[]) {
     string LogFile;
-    if (argc == 2) LogFile = argv[1];
+    for (int i = 1; i < argc; ++i) {
+      if (string(argv[i]) == "--perfCounters") gUsePerfCounters = true;
+      else LogFile = argv[i];
+    }
     initLibrary(0, LogFile.empty() ? LIB_LOGSTDERR:LIB_LOGFILE, LogFile.c_str());
 
     int nTest  = 0;
@@ -0,0 +1,374 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+
+/*
+ * A reproducible micro-benchmark of distance kernels. Unlike bench_distfunc,
+ * which prints free-form text, this utility runs each kernel with a warm-up
+ * and several timed trials (optionally on a pinned CPU) and saves the
+ * throughput (with confidence intervals) in the JSON format.
+ */
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "init.h"
+#include "utils.h"
+#include "logging.h"
+#include "distcomp.h"
+#include "permutation_utils.h"
+#include "portable_align.h"
+#include "cmd_options.h"
+#include "bench_kernel.h"
+
+using namespace similarity;
+using namespace std;
+
+namespace similarity {
+    /*Functions from hnsw_distfunc_opt.cc:*/
+    float L2SqrSIMDExt(const float *pVect1, const float *pVect2, size_t &qty, float *TmpRes);
+    float L2SqrSIMD16Ext(const float *pVect1, const float *pVect2, size_t &qty, float *TmpRes);
+    float ScalarProductSIMD(const float *__restrict pVect1, const float *__restrict pVect2, size_t qty, float *__restrict TmpRes);
+    float NormScalarProductSIMD(const float *pVect1, const float *pVect2, size_t &qty, float *TmpRes);
+}
+
+const float  RANGE       = 8.0f;
+const float  RANGE_SMALL = 1e-6f;
+const double LP_POWER    = 0.5;
+
+template <class T> const char* GetTypeName();
+template <> const char* GetTypeName<float>()  { return "float"; }
+template <> const char* GetTypeName<double>() { return "double"; }
+
+/*
+ * A benchmark context: the settings, the list of results, and
+ * the kernel name filter (a kernel runs only if its name contains the filter).
+ */
+struct BenchContext {
+  KernelBenchConfig         conf;
+  string                    filter;
+  vector<KernelBenchResult> results;
+
+  bool Match(const string& name) const {
+    return filter.empty() || name.find(filter) != string::npos;
+  }
+
+  template <class DistFunc>
+  void Run(const string& name, const string& dataType,
+           size_t dim, size_t bytesPerVect, DistFunc distFunc) {
+    if (!Match(name)) return;
+    KernelBenchResult r = RunKernelBench(conf, name, dataType, dim, bytesPerVect, distFunc);
+    LOG(LIB_INFO) << name << " " << dataType << " dim=" << dim
+                  << " dist/sec: " << r.DistPerSecMean
+                  << " [" << r.DistPerSecConfMin << ", " << r.DistPerSecConfMax << "]"
+                  << " ns/dist: " << r.NanoSecPerDist
+                  << " GB/s: " << r.GBPerSecMean;
+    if (r.Perf.IsAnyValid()) {
+      LOG(LIB_INFO) << "HW counters per distance: " << r.Perf.ToString(r.PerfDistQty);
+    }
+    results.push_back(r);
+  }
+};
+
+template <class T>
+void GenRandVect(T* pVect, size_t qty, T MinElem, T MaxElem, bool DoNormalize = false) {
+  T sum = 0;
+  for (size_t i = 0; i < qty; ++i) {
+    pVect[i] = MinElem + (MaxElem - MinElem) * RandomReal<T>();
+    sum += fabs(pVect[i]);
+  }
+  if (DoNormalize && sum != 0) {
+    for (size_t i = 0; i < qty; ++i) pVect[i] /= sum;
+  }
+}
+
+/*
+ * Kernels defined for both float and double. Vectors of divergences
+ * are positive. For kernels with precomputed logarithms, each vector
+ * is followed by the logarithms of its elements (stride is 2*dim).
+ */
+#define BENCH_DENSE(name, func, arr, stride) \
+  ctx.Run(name, typeName, dim, dim * sizeof(T), \
+          [&](size_t i, size_t j) { return double(func(&arr[i * (stride)], &arr[j * (stride)], dim)); })
+
+template <class T>
+void BenchDense(BenchContext& ctx, size_t dim) {
+  const size_t  N = ctx.conf.VectQty;
+  const char*   typeName = GetTypeName<T>();
+
+  vector<T> arr(N * dim), arrPos(N * dim), arrPrecomp(N * dim * 2);
+
+  for (size_t i = 0; i < N; ++i) {
+    GenRandVect(&arr[i * dim], dim, -T(RANGE), T(RANGE));
+    GenRandVect(&arrPos[i * dim], dim, T(RANGE_SMALL), T(1), true);
+    GenRandVect(&arrPrecomp[i * dim * 2], dim, T(RANGE_SMALL), T(1), true);
+    PrecompLogarithms(&arrPrecomp[i * dim * 2], dim);
+  }
+
+  BENCH_DENSE("LInfNormStandard",       LInfNormStandard<T>,        arr, dim);
+  BENCH_DENSE("LInfNorm",               LInfNorm<T>,                arr, dim);
+  BENCH_DENSE("LInfNormSIMD",           LInfNormSIMD<T>,            arr, dim);
+  BENCH_DENSE("L1NormStandard",         L1NormStandard<T>,          arr, dim);
+  BENCH_DENSE("L1Norm",                 L1Norm<T>,                  arr, dim);
+  BENCH_DENSE("L1NormSIMD",             L1NormSIMD<T>,              arr, dim);
+  BENCH_DENSE("L2NormStandard",         L2NormStandard<T>,          arr, dim);
+  BENCH_DENSE("L2Norm",                 L2Norm<T>,                  arr, dim);
+  BENCH_DENSE("L2NormSIMD",             L2NormSIMD<T>,              arr, dim);
+  BENCH_DENSE("ScalarProduct",          ScalarProduct<T>,           arr, dim);
+  BENCH_DENSE("ScalarProductSIMD",      ScalarProductSIMD<T>,       arr, dim);
+  BENCH_DENSE("NormScalarProduct",      NormScalarProduct<T>,       arr, dim);
+  BENCH_DENSE("NormScalarProductSIMD",  NormScalarProductSIMD<T>,   arr, dim);
+  BENCH_DENSE("CosineSimilarity",       CosineSimilarity<T>,        arr, dim);
+  BENCH_DENSE("AngularDistance",        AngularDistance<T>,         arr, dim);
+
+  ctx.Run("LPGenericDistance", typeName, dim, dim * sizeof(T), [&](size_t i, size_t j) {
+    return double(LPGenericDistance(&arr[i * dim], &arr[j * dim], int(dim), T(LP_POWER)));
+  });
+  ctx.Run("LPGenericDistanceOptim", typeName, dim, dim * sizeof(T), [&](size_t i, size_t j) {
+    return double(LPGenericDistanceOptim(&arr[i * dim], &arr[j * dim], int(dim), T(LP_POWER)));
+  });
+
+  BENCH_DENSE("ItakuraSaito",           ItakuraSaito<T>,            arrPos, dim);
+  BENCH_DENSE("KLStandard",             KLStandard<T>,              arrPos, dim);
+  BENCH_DENSE("KLGeneralStandard",      KLGeneralStandard<T>,       arrPos, dim);
+  BENCH_DENSE("JSStandard",             JSStandard<T>,              arrPos, dim);
+
+  BENCH_DENSE("ItakuraSaitoPrecomp",    ItakuraSaitoPrecomp<T>,     arrPrecomp, 2 * dim);
+  BENCH_DENSE("ItakuraSaitoPrecompSIMD",ItakuraSaitoPrecompSIMD<T>, arrPrecomp, 2 * dim);
+  BENCH_DENSE("KLPrecomp",              KLPrecomp<T>,               arrPrecomp, 2 * dim);
+  BENCH_DENSE("KLPrecompSIMD",          KLPrecompSIMD<T>,           arrPrecomp, 2 * dim);
+  BENCH_DENSE("KLGeneralPrecomp",       KLGeneralPrecomp<T>,        arrPrecomp, 2 * dim);
+  BENCH_DENSE("KLGeneralPrecompSIMD",   KLGeneralPrecompSIMD<T>,    arrPrecomp, 2 * dim);
+  BENCH_DENSE("JSPrecomp",              JSPrecomp<T>,               arrPrecomp, 2 * dim);
+  BENCH_DENSE("JSPrecompApproxLog",     JSPrecompApproxLog<T>,      arrPrecomp, 2 * dim);
+  BENCH_DENSE("JSPrecompSIMDApproxLog", JSPrecompSIMDApproxLog<T>,  arrPrecomp, 2 * dim);
+}
+
+/*
+ * Single-precision kernels, including the ones used by HNSW.
+ */
+void BenchFloatOnly(BenchContext& ctx, size_t dim) {
+  const size_t  N = ctx.conf.VectQty;
+
+  vector<float> arr(N * dim);
+  for (size_t i = 0; i < N; ++i) GenRandVect(&arr[i * dim], dim, -RANGE, RANGE);
+
+  float PORTABLE_ALIGN32 TmpRes[8];
+
+  ctx.Run("L2SqrSIMD", "float", dim, dim * sizeof(float), [&](size_t i, size_t j) {
+    return double(L2SqrSIMD(&arr[i * dim], &arr[j * dim], dim));
+  });
+  // This kernel requires the dimensionality to be a multiple of 16
+  if (dim % 16 == 0) {
+    ctx.Run("hnsw.L2SqrSIMD16Ext", "float", dim, dim * sizeof(float), [&](size_t i, size_t j) {
+      size_t qty = dim;
+      return double(L2SqrSIMD16Ext(&arr[i * dim], &arr[j * dim], qty, TmpRes));
+    });
+  }
+  ctx.Run("hnsw.L2SqrSIMDExt", "float", dim, dim * sizeof(float), [&](size_t i, size_t j) {
+    size_t qty = dim;
+    return double(L2SqrSIMDExt(&arr[i * dim], &arr[j * dim], qty, TmpRes));
+  });
+  ctx.Run("hnsw.ScalarProductSIMD", "float", dim, dim * sizeof(float), [&](size_t i, size_t j) {
+    return double(ScalarProductSIMD(&arr[i * dim], &arr[j * dim], dim, TmpRes));
+  });
+  ctx.Run("hnsw.NormScalarProductSIMD", "float", dim, dim * sizeof(float), [&](size_t i, size_t j) {
+    size_t qty = dim;
+    return double(NormScalarProductSIMD(&arr[i * dim], &arr[j * dim], qty, TmpRes));
+  });
+}
+
+/*
+ * Kernels for permutations (integer vectors) and binarized permutations.
+ */
+void BenchPerm(BenchContext& ctx, size_t dim) {
+  const size_t  N = ctx.conf.VectQty;
+
+  vector<PivotIdType> arr(N * dim);
+  for (size_t i = 0; i < arr.size(); ++i) arr[i] = RandomInt();
+
+  ctx.Run("SpearmanRho", "int32", dim, dim * sizeof(PivotIdType), [&](size_t i, size_t j) {
+    return double(SpearmanRho(&arr[i * dim], &arr[j * dim], dim));
+  });
+  ctx.Run("SpearmanRhoSIMD", "int32", dim, dim * sizeof(PivotIdType), [&](size_t i, size_t j) {
+    return double(SpearmanRhoSIMD(&arr[i * dim], &arr[j * dim], dim));
+  });
+  ctx.Run("SpearmanFootrule", "int32", dim, dim * sizeof(PivotIdType), [&](size_t i, size_t j) {
+    return double(SpearmanFootrule(&arr[i * dim], &arr[j * dim], dim));
+  });
+  ctx.Run("SpearmanFootruleSIMD", "int32", dim, dim * sizeof(PivotIdType), [&](size_t i, size_t j) {
+    return double(SpearmanFootruleSIMD(&arr[i * dim], &arr[j * dim], dim));
+  });
+
+  // dim is the number of bits here
+  size_t wordQty = (dim + 31) / 32;
+  vector<uint32_t> bits(N * wordQty);
+  for (size_t i = 0; i < N; ++i) {
+    vector<PivotIdType> perm(&arr[i * dim], &arr[i * dim] + dim);
+    for (size_t k = 0; k < dim; ++k) perm[k] = perm[k] % 2;
+    vector<uint32_t> h;
+    Binarize(perm, 1, h);
+    copy(h.begin(), h.end(), bits.begin() + i * wordQty);
+  }
+  ctx.Run("BitHamming", "bit", dim, wordQty * sizeof(uint32_t), [&](size_t i, size_t j) {
+    return double(BitHamming(&bits[i * wordQty], &bits[j * wordQty], wordQty));
+  });
+}
+
+/*
+ * SIFT kernels have the fixed dimensionality; the precomputed
+ * squared norm follows the vector elements.
+ */
+void BenchSIFT(BenchContext& ctx) {
+  const size_t  N = ctx.conf.VectQty;
+  const size_t  stride = SIFT_DIM + sizeof(DistTypeSIFT);
+
+  vector<uint8_t> arr(N * stride);
+  for (size_t i = 0; i < N; ++i) {
+    uint8_t*      pVect = &arr[i * stride];
+    DistTypeSIFT  normSqr = 0;
+    for (size_t k = 0; k < SIFT_DIM; ++k) {
+      pVect[k] = static_cast<uint8_t>(RandomInt() % 256);
+      normSqr += DistTypeSIFT(pVect[k]) * pVect[k];
+    }
+    memcpy(pVect + SIFT_DIM, &normSqr, sizeof normSqr);
+  }
+
+  ctx.Run("l2SqrSIFTNaive", "uint8", SIFT_DIM, stride, [&](size_t i, size_t j) {
+    return double(l2SqrSIFTNaive(&arr[i * stride], &arr[j * stride]));
+  });
+  ctx.Run("l2SqrSIFTPrecomp", "uint8", SIFT_DIM, stride, [&](size_t i, size_t j) {
+    return double(l2SqrSIFTPrecomp(&arr[i * stride], &arr[j * stride]));
+  });
+  ctx.Run("l2SqrSIFTPrecompSSE2", "uint8", SIFT_DIM, stride, [&](size_t i, size_t j) {
+    return double(l2SqrSIFTPrecompSSE2(&arr[i * stride], &arr[j * stride]));
+  });
+  ctx.Run("l2SqrSIFTPrecompAVX", "uint8", SIFT_DIM, stride, [&](size_t i, size_t j) {
+    return double(l2SqrSIFTPrecompAVX(&arr[i * stride], &arr[j * stride]));
+  });
+}
+
+int main(int argc, char* argv[]) {
+  string          dimsArg, dataTypesArg, filter, jsonFile, label, logFile;
+  unsigned        vectQty, trialQty, warmupMs, trialMs;
+  int             cpuId;
+  bool            usePerfCounters;
+
+  CmdOptions cmd_options;
+
+  cmd_options.Add(new CmdParam("dims", "comma-separated dimensionalities",
+                               &dimsArg, false, string("8,16,32,64,128,256,512,1024")));
+  cmd_options.Add(new CmdParam("dataTypes", "comma-separated data types: float, double, int (permutations and bit vectors), sift",
+                               &dataTypesArg, false, string("float,double,int,sift")));
+  cmd_options.Add(new CmdParam("filter", "run only kernels whose names contain this string",
+                               &filter, false, string("")));
+  cmd_options.Add(new CmdParam("vectQty", "the number of vectors (a pass over vectors computes vectQty-1 distances)",
+                               &vectQty, false, 1000));
+  cmd_options.Add(new CmdParam("trialQty", "the number of timed trials",
+                               &trialQty, false, 10));
+  cmd_options.Add(new CmdParam("warmupMs", "the warm-up duration (ms)",
+                               &warmupMs, false, 100));
+  cmd_options.Add(new CmdParam("trialMs", "the approximate duration of one trial (ms)",
+                               &trialMs, false, 200));
+  cmd_options.Add(new CmdParam("cpu", "pin the benchmark thread to this CPU (Linux only, -1 means no pinning)",
+                               &cpuId, false, -1));
+  cmd_options.Add(new CmdParam("perfCounters", "collect hardware performance counters (Linux only)",
+                               &usePerfCounters, false, false));
+  cmd_options.Add(new CmdParam("label", "a label saved in the output (e.g., a commit hash)",
+                               &label, false, string("")));
+  cmd_options.Add(new CmdParam("outFile,o", "an output JSON file",
+                               &jsonFile, false, string("")));
+  cmd_options.Add(new CmdParam("logFile,l", "log file",
+                               &logFile, false, string("")));
+
+  try {
+    cmd_options.Parse(argc, argv);
+  } catch (const CmdParserException& e) {
+    cmd_options.ToString();
+    std::cout.flush();
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  initLibrary(0, logFile.empty() ? LIB_LOGSTDERR:LIB_LOGFILE, logFile.c_str());
+
+  try {
+    vector<size_t>  dims;
+    vector<string>  dataTypes;
+
+    if (!SplitStr(dimsArg, dims, ',') || dims.empty()) {
+      throw runtime_error("Wrong format of the dims argument: '" + dimsArg + "'");
+    }
+    if (!SplitStr(dataTypesArg, dataTypes, ',') || dataTypes.empty()) {
+      throw runtime_error("Wrong format of the dataTypes argument: '" + dataTypesArg + "'");
+    }
+    CHECK_MSG(vectQty > 1, "The number of vectors should be at least 2");
+    CHECK_MSG(trialQty > 0, "The number of trials should be positive");
+
+    if (cpuId >= 0) {
+      if (PinCurrentThread(cpuId)) {
+        LOG(LIB_INFO) << "The benchmark thread is pinned to CPU " << cpuId;
+      } else {
+        LOG(LIB_INFO) << "Failed to pin the benchmark thread to CPU " << cpuId;
+        cpuId = -1;
+      }
+    }
+
+    BenchContext ctx;
+
+    ctx.conf.VectQty          = vectQty;
+    ctx.conf.TrialQty         = trialQty;
+    ctx.conf.WarmupMicroSec   = uint64_t(warmupMs) * 1000;
+    ctx.conf.TrialMicroSec    = uint64_t(trialMs) * 1000;
+    ctx.conf.UsePerfCounters  = usePerfCounters;
+    ctx.filter                = filter;
+
+    LOG(LIB_INFO) << "CPU: " << GetCPUModelName() << " compiled SIMD: " << GetCompiledSIMD();
+
+    for (const string& dt : dataTypes) {
+      if (dt == "sift") {
+        BenchSIFT(ctx);
+        continue;
+      }
+      for (size_t dim : dims) {
+        if (dt == "float") {
+          BenchDense<float>(ctx, dim);
+          BenchFloatOnly(ctx, dim);
+        } else if (dt == "double") {
+          BenchDense<double>(ctx, dim);
+        } else if (dt == "int") {
+          BenchPerm(ctx, dim);
+        } else {
+          throw runtime_error("Unknown data type: '" + dt + "'");
+        }
+      }
+    }
+
+    if (!jsonFile.empty()) {
+      ofstream out(jsonFile.c_str());
+      CHECK_MSG(out, "Cannot create output file: '" + jsonFile + "'");
+      out.exceptions(std::ios::badbit);
+      WriteKernelBenchJSON(out, label, cpuId, ctx.conf, ctx.results);
+      out.close();
+      LOG(LIB_INFO) << "Saved " << ctx.results.size() << " results to " << jsonFile;
+    } else {
+      WriteKernelBenchJSON(cout, label, cpuId, ctx.conf, ctx.results);
+    }
+  } catch (const exception& e) {
+    LOG(LIB_FATAL) << "Exception: " << e.what();
+  }
+
+  return 0;
+}
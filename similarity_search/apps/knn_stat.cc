@@ -15,9 +15,8 @@
 #include <string>
 #include <fstream>
 #include <vector>
-#include <thread>
-#include <mutex>
-#include <queue>
+#include <algorithm>
+#include <utility>
 
 #include "knnquery.h"
 #include "knnqueue.h"
@@ -30,6 +29,9 @@
 #include "init.h"
 #include "cmd_options.h"
 #include "params_def.h"
+#include "sample_stat.h"
+#include "thread_pool.h"
+#include "ztimer.h"
 
 
 using namespace similarity;
@@ -87,7 +89,9 @@ void sampleDist(string spaceType,
                 string inFile, string pivotFile, unsigned maxNumPivots, string outFilePrefix,
                 unsigned knn, 
                 unsigned maxNumData,
-                unsigned knnQueryQty) {
+                unsigned dataSampleQty,
+                unsigned knnQueryQty,
+                unsigned threadQty) {
   ToLower(spaceType);
   vector<string> spaceDesc;
 
@@ -117,7 +121,14 @@ void sampleDist(string spaceType,
   ObjectVector      pivots;
 
   LOG(LIB_INFO) << "maxNumData=" << maxNumData;
-  {
+  if (dataSampleQty) {
+    // Neighbors are exact with respect to the sample rather than to the whole data set
+    uint64_t totalQty = 0;
+    unique_ptr<DataFileInputState> inpState(ReadDatasetSample(*space, data, inFile,
+                                                              dataSampleQty, RandomInt(), totalQty));
+    space->UpdateParamsFromFile(*inpState);
+    LOG(LIB_INFO) << "Sampled " << data.size() << " data points out of " << totalQty;
+  } else {
     vector<string>    tmp;
     unique_ptr<DataFileInputState> inpState(space->ReadDataset(data, tmp, inFile, maxNumData));
     space->UpdateParamsFromFile(*inpState);
@@ -174,42 +185,31 @@ void sampleDist(string spaceType,
   vector<vector<unsigned>> outPivOverlapQtyMatrix(pivotQty);
   vector<vector<float>>    outPivOverlapFracMatrix(pivotQty);
 
-  queue<size_t>   qidQueue; 
-  vector<thread>  qThreads; 
-  mutex         mQueue;
-  mutex         mOut;
+  WallClockTimer timer;
 
-  for (size_t qid = 0; qid < knnQueryQty; ++qid) {
-    qidQueue.push(qid);
-  }
+  // Exact neighbors of all queries are found using a blocked multi-threaded brute-force search
+  vector<vector<pair<dist_t, size_t>>> knnRes;
+  ComputeExactKNN(*space, data, queries, knn, threadQty, &isQuery, knnRes);
 
+  timer.split();
+  LOG(LIB_INFO) << "k-NN search time: " << timer.elapsed() / 1e6 << " sec";
+  timer.reset();
 
-  for (unsigned tid = 0; tid < thread::hardware_concurrency(); ++tid) 
-  qThreads.push_back(thread([&]() {
-    while (true) {
-      size_t qid = 0;
-      {
-        unique_lock<mutex> lock(mQueue);
-        if (qidQueue.empty()) return;
-        qid = qidQueue.front();
-        qidQueue.pop(); 
-        LOG(LIB_INFO) << "query index : " << qid << " id: " << queries[qid]->id();
-      }
-      KNNQuery<dist_t> query(*space, queries[qid], knn);
+  vector<vector<dist_t>>                    queryPivDist(knnQueryQty);
+  vector<vector<unsigned>>                  queryPivOverlap(knnQueryQty);
+  vector<float>                             queryElemQtyInv(knnQueryQty);
+  vector<vector<RichOverlapStat<dist_t>>>   queryKNNStat(knnQueryQty);
 
-      vector<dist_t> pivDist(pivotQty);
+  ParallelFor(0, knnQueryQty, threadQty, [&](size_t qid) {
+      vector<dist_t>& pivDist = queryPivDist[qid];
+      pivDist.resize(pivotQty);
       for (size_t pid = 0; pid < pivotQty; ++pid) {
         pivDist[pid]=space->IndexTimeDistance(pivots[pid], queries[qid]); // Pivot plays the role of an object => it's a left argument
       }
       sort(pivDist.begin(),pivDist.end());
-      {
-        unique_lock<mutex> lock(mOut);
-        for (size_t pid = 0; pid < pivotQty; ++pid) {
-         outPivDistMatrix[pid].push_back(pivDist[pid]);
-        }
-      }
       if (pJaccardSpace || pInterSpace) {
-        vector<unsigned> pivOverlap(pivotQty);
+        vector<unsigned>& pivOverlap = queryPivOverlap[qid];
+        pivOverlap.resize(pivotQty);
         for (size_t pid = 0; pid < pivotQty; ++pid) {
           pivOverlap[pid]=pJaccardSpace ? 
                             pJaccardSpace->ComputeOverlap(pivots[pid], queries[qid]):
@@ -218,50 +218,34 @@ void sampleDist(string spaceType,
         sort(pivOverlap.begin(),pivOverlap.end(), [](unsigned qty1, unsigned qty2)->bool{ return qty1 > qty2;});
         float elemQty = pJaccardSpace ? pJaccardSpace->GetElemQty(queries[qid]) : 
                                         pInterSpace->GetElemQty(queries[qid]);
-        float elemQtyInv = 1.0f/elemQty;
-        {
-          unique_lock<mutex> lock(mOut);
-          for (size_t pid = 0; pid < pivotQty; ++pid) {
-            outPivOverlapQtyMatrix[pid].push_back(pivOverlap[pid]);
-            outPivOverlapFracMatrix[pid].push_back(pivOverlap[pid]*elemQtyInv);
-          }
-        }
+        queryElemQtyInv[qid] = 1.0f/elemQty;
       }
 
-      // Brute force search
-      for (size_t k = 0; k < N; ++k) 
-      if (!isQuery[k]) {
-        query.CheckAndAddToResult(data[k]);
-      }
-
-      unique_ptr<KNNQueue<dist_t>> knnQ(query.Result()->Clone());
-
-
-      vector<RichOverlapStat<dist_t>> knn_overlap_stat;
+      vector<RichOverlapStat<dist_t>>& knn_overlap_stat = queryKNNStat[qid];
       knn_overlap_stat.reserve(knn);
 
-      // Extracting results
-      while (!knnQ->Empty()) {
+      // Neighbors are sorted in the order of increasing distance
+      for (const auto& neighb : knnRes[qid]) {
+        const Object* pNeighbObj = data[neighb.second];
         OverlapInfo oinfo;
 
         size_t best3way_overlap_qty = 0;
 
         if (pJaccardSpace || pInterSpace) {
           if (pJaccardSpace) 
-            oinfo.overlap_qty_ = pJaccardSpace->ComputeOverlap(knnQ->TopObject(), queries[qid]);
+            oinfo.overlap_qty_ = pJaccardSpace->ComputeOverlap(pNeighbObj, queries[qid]);
           if (pInterSpace) {
-            oinfo = pInterSpace->ComputeOverlapInfo(knnQ->TopObject(), queries[qid]); 
+            oinfo = pInterSpace->ComputeOverlapInfo(pNeighbObj, queries[qid]); 
           }
 
           for (size_t pid = 0; pid < pivotQty; ++pid) {
             uint32_t overlap3way_qty = pJaccardSpace ? 
-                            pJaccardSpace->ComputeOverlap(knnQ->TopObject(), queries[qid], pivots[pid]):
-                            pInterSpace->ComputeOverlap(knnQ->TopObject(), queries[qid], pivots[pid]); 
+                            pJaccardSpace->ComputeOverlap(pNeighbObj, queries[qid], pivots[pid]):
+                            pInterSpace->ComputeOverlap(pNeighbObj, queries[qid], pivots[pid]); 
             if (overlap3way_qty > best3way_overlap_qty) best3way_overlap_qty = overlap3way_qty;
           }
         }
-        knn_overlap_stat.insert(knn_overlap_stat.begin(),
-                                RichOverlapStat<dist_t>(knnQ->TopDistance(), 
+        knn_overlap_stat.push_back(RichOverlapStat<dist_t>(neighb.first, 
                                                         oinfo.overlap_qty_, best3way_overlap_qty,
                                                         oinfo.overlap_dotprod_norm_, 
                                                         oinfo.overlap_mean_left_,  oinfo.overlap_std_left_,  
@@ -269,12 +253,27 @@ void sampleDist(string spaceType,
                                                         oinfo.overlap_mean_right_, oinfo.overlap_std_right_, 
                                                         oinfo.diff_mean_right_, oinfo.diff_std_right_
         ));
-        knnQ->Pop();
       }
-      {
-        unique_lock<mutex> lock(mOut);
+  });
+
+  timer.split();
+  LOG(LIB_INFO) << "Statistics computation time: " << timer.elapsed() / 1e6 << " sec";
+
+  // Columns of output matrices follow the order of queries
+  for (size_t qid = 0; qid < knnQueryQty; ++qid) {
+      for (size_t pid = 0; pid < pivotQty; ++pid) {
+        outPivDistMatrix[pid].push_back(queryPivDist[qid][pid]);
+      }
+      if (pJaccardSpace || pInterSpace) {
+        for (size_t pid = 0; pid < pivotQty; ++pid) {
+          outPivOverlapQtyMatrix[pid].push_back(queryPivOverlap[qid][pid]);
+          outPivOverlapFracMatrix[pid].push_back(queryPivOverlap[qid][pid]*queryElemQtyInv[qid]);
+        }
+      }
+
+      const vector<RichOverlapStat<dist_t>>& knn_overlap_stat = queryKNNStat[qid];
 
-        for (size_t k = 0; k < min<size_t>(knn_overlap_stat.size(), knn); ++k) {
+      for (size_t k = 0; k < min<size_t>(knn_overlap_stat.size(), knn); ++k) {
           outNNDistMatrix[k].push_back(knn_overlap_stat[k].dist_);
           outNNOverlapQtyMatrix[k].push_back(knn_overlap_stat[k].overlap_qty_);
           outNN3WayOverlapQtyMatrix[k].push_back(knn_overlap_stat[k].overlap3way_qty_);
@@ -290,13 +289,7 @@ void sampleDist(string spaceType,
           outNNOverlapSTDRightMatrix[k].push_back(knn_overlap_stat[k].overlap_std_right_);
           outNNDiffMeanRightMatrix[k].push_back(knn_overlap_stat[k].diff_mean_right_);
           outNNDiffSTDRightMatrix[k].push_back(knn_overlap_stat[k].diff_std_right_);
-        }
       }
-    }
-  }));
-
-  for (auto& oneThread : qThreads) {
-    oneThread.join();
   }
 
   outputMatrix(outFilePrefix + "_dist_NN.tsv", outNNDistMatrix);
@@ -334,6 +327,8 @@ int main(int argc, char *argv[]) {
   unsigned    maxNumPivots = 0;
   unsigned    knnQueryQty = 0;
   unsigned    knn = 0;
+  unsigned    dataSampleQty = 0;
+  unsigned    threadQty = 0;
 
 
   CmdOptions cmd_options;
@@ -357,6 +352,10 @@ int main(int argc, char *argv[]) {
                                &knn, 0));
   cmd_options.Add(new CmdParam(MAX_NUM_DATA_PARAM_OPT, MAX_NUM_DATA_PARAM_MSG,
                                &maxNumData, false, 0));
+  cmd_options.Add(new CmdParam("dataSampleQty", "if non-zero, only a random sample of data points (of this size) is used",
+                               &dataSampleQty, false, 0));
+  cmd_options.Add(new CmdParam("threadQty", "a number of threads (0 means the number of hardware threads)",
+                               &threadQty, false, 0));
   cmd_options.Add(new CmdParam(LOG_FILE_PARAM_OPT, LOG_FILE_PARAM_MSG,
                                &logFile, false, ""));
 
@@ -392,13 +391,17 @@ int main(int argc, char *argv[]) {
                         inFile, pivotFile, maxNumPivots, outFilePrefix,
                         knn, 
                         maxNumData,
-                        knnQueryQty);
+                        dataSampleQty,
+                        knnQueryQty,
+                        threadQty);
     } else if (distType == DIST_TYPE_DOUBLE) {
       sampleDist<double>(spaceType, 
                         inFile, pivotFile, maxNumPivots, outFilePrefix,
                         knn, 
                         maxNumData,
-                        knnQueryQty);
+                        dataSampleQty,
+                        knnQueryQty,
+                        threadQty);
     } else {
       LOG(LIB_FATAL) << "Unsupported distance type: '" << distType << "'";
     }
@@ -40,6 +40,8 @@
 #include "meta_analysis.h"
 #include "params.h"
 #include "params_cmdline.h"
+#include "open_loop.h"
+#include "param_sweep.h"
 
 using namespace similarity;
 
@@ -81,6 +83,48 @@ void OutData(bool DoAppend, const string& FilePrefix,
   OutFileData.close();
 }
 
+/*
+ * Results of the open-loop test: one line per offered QPS.
+ */
+void OutOpenLoopData(bool DoAppend, const string& FilePrefix,
+                     const MetaAnalysis& ExpRes,
+                     const string& MethodName,
+                     const string& IndexParamStr,
+                     const string& QueryTimeParamStr) {
+  string FileNameData = FilePrefix + "_openloop.dat";
+
+  std::ofstream   OutFileData(FileNameData.c_str(),
+                              (DoAppend ? std::ios::app : (std::ios::trunc | std::ios::out)));
+
+  if (!OutFileData) {
+    LOG(LIB_FATAL) << "Cannot create output file: '" << FileNameData << "'";
+  }
+  OutFileData.exceptions(std::ios::badbit);
+
+  if (!DoAppend) {
+    OutFileData << "MethodName\tOfferedQPS\tAchievedQPS\tQueryTimeP50\tQueryTimeP90\tQueryTimeP99\tQueryTimeP999\tIsKnee\tIndexParams\tQueryTimeParams" << std::endl;
+  }
+
+  vector<OpenLoopStat> stat = ExpRes.GetOpenLoopAvg();
+  int knee = FindOpenLoopKnee(stat);
+
+  for (size_t i = 0; i < stat.size(); ++i) {
+    OutFileData << "\"" << MethodName << "\"\t";
+    OutFileData << stat[i].OfferedQPS << "\t";
+    OutFileData << stat[i].AchievedQPS << "\t";
+    OutFileData << stat[i].QueryTimeP50 << "\t";
+    OutFileData << stat[i].QueryTimeP90 << "\t";
+    OutFileData << stat[i].QueryTimeP99 << "\t";
+    OutFileData << stat[i].QueryTimeP999 << "\t";
+    OutFileData << (int(i) == knee ? 1 : 0) << "\t";
+    OutFileData << "\"" << IndexParamStr << "\"" << "\t";
+    OutFileData << "\"" << QueryTimeParamStr << "\"";
+    OutFileData << std::endl;
+  }
+
+  OutFileData.close();
+}
+
 template <typename dist_t>
 void ProcessResults(const ExperimentConfig<dist_t>& config,
                     MetaAnalysis& ExpRes,
@@ -94,7 +138,7 @@ void ProcessResults(const ExperimentConfig<dist_t>& config,
 
   ExpRes.ComputeAll();
 
-  Header << "MethodName\tRecall\tRecall@1\tPrecisionOfApprox\tRelPosError\tNumCloser\tClassAccuracy\tQueryTime\tDistComp\tImprEfficiency\tImprDistComp\tMem\tIndexTime\tIndexLoadTime\tIndexSaveTime\tQueryPerSec\tIndexParams\tQueryTimeParams\tNumData" << std::endl;
+  Header << "MethodName\tRecall\tRecall@1\tPrecisionOfApprox\tRelPosError\tNumCloser\tClassAccuracy\tQueryTime\tDistComp\tImprEfficiency\tImprDistComp\tMem\tIndexTime\tIndexLoadTime\tIndexSaveTime\tQueryPerSec\tIndexParams\tQueryTimeParams\tNumData\tQueryTimeP50\tQueryTimeP90\tQueryTimeP99\tQueryTimeP999" << std::endl;
 
   Data << "\"" << MethodName << "\"\t";
   Data << ExpRes.GetRecallAvg() << "\t";
@@ -114,7 +158,12 @@ void ProcessResults(const ExperimentConfig<dist_t>& config,
   Data << ExpRes.GetQueryPerSecAvg() << "\t";
   Data << "\"" << IndexParamStr << "\"" << "\t";
   Data << "\"" << QueryTimeParamStr << "\"" << "\t";
-  Data << config.GetDataObjects().size();
+  Data << config.GetDataObjects().size() << "\t";
+  // Latency percentiles go last to keep the column order expected by older scripts
+  Data << ExpRes.GetQueryTimeP50Avg() << "\t";
+  Data << ExpRes.GetQueryTimeP90Avg() << "\t";
+  Data << ExpRes.GetQueryTimeP99Avg() << "\t";
+  Data << ExpRes.GetQueryTimeP999Avg();
   Data << std::endl;
 
   PrintStr  = produceHumanReadableReport(config, ExpRes, MethodName, IndexParamStr, QueryTimeParamStr);
@@ -123,6 +172,144 @@ void ProcessResults(const ExperimentConfig<dist_t>& config,
   HeaderStr = Header.str();
 };
 
+/*
+ * Recall-vs-QPS points of the sweep over query-time parameters:
+ * the Pareto front is marked in the output, which is written
+ * in the tab-separated and JSON formats.
+ */
+void OutSweepData(const string& FilePrefix,
+                  const string& MethodName,
+                  vector<SweepPoint>& points,
+                  float TargetRecall) {
+  MarkParetoFront(points);
+
+  LOG(LIB_INFO) << "Recall-vs-QPS Pareto front:";
+  for (const SweepPoint& p : points) {
+    if (p.IsPareto) {
+      LOG(LIB_INFO) << "recall: " << p.Recall << " QPS: " << p.QueryPerSec
+                    << " P99 query time: " << p.QueryTimeP99 << " ms"
+                    << " query-time params: '" << p.QueryTimeParams << "'";
+    }
+  }
+  if (TargetRecall > 0) {
+    int best = FindCheapestSweepPoint(points, TargetRecall);
+    if (best >= 0) {
+      LOG(LIB_INFO) << "The cheapest setting reaching recall " << TargetRecall << ": '" 
+                    << points[best].QueryTimeParams << "' recall: " << points[best].Recall
+                    << " QPS: " << points[best].QueryPerSec;
+    } else {
+      LOG(LIB_INFO) << "None of the query-time parameter sets reaches recall " << TargetRecall;
+    }
+  }
+
+  if (FilePrefix.empty()) return;
+
+  string FileNameData = FilePrefix + "_pareto.dat";
+  string FileNameJSON = FilePrefix + "_pareto.json";
+
+  std::ofstream   OutFileData(FileNameData.c_str(), std::ios::trunc | std::ios::out);
+  if (!OutFileData) {
+    LOG(LIB_FATAL) << "Cannot create output file: '" << FileNameData << "'";
+  }
+  OutFileData.exceptions(std::ios::badbit);
+  WriteSweepPointsTSV(OutFileData, MethodName, points);
+  OutFileData.close();
+
+  std::ofstream   OutFileJSON(FileNameJSON.c_str(), std::ios::trunc | std::ios::out);
+  if (!OutFileJSON) {
+    LOG(LIB_FATAL) << "Cannot create output file: '" << FileNameJSON << "'";
+  }
+  OutFileJSON.exceptions(std::ios::badbit);
+  WriteSweepPointsJSON(OutFileJSON, MethodName, points);
+  OutFileJSON.close();
+}
+
+/*
+ * Saves build profiles (one JSON object per test set) as a JSON array.
+ */
+void OutBuildProfiles(const string& FilePrefix,
+                      const string& MethodName,
+                      const vector<string>& profiles) {
+  string FileName = FilePrefix + "_build.json";
+
+  std::ofstream   OutFile(FileName.c_str(), std::ios::trunc | std::ios::out);
+  if (!OutFile) {
+    LOG(LIB_FATAL) << "Cannot create output file: '" << FileName << "'";
+  }
+  OutFile.exceptions(std::ios::badbit);
+  OutFile << "[" << std::endl;
+  for (size_t i = 0; i < profiles.size(); ++i) {
+    OutFile << "  {\"method\": \"" << EscapeJSON(MethodName) << "\", \"testSetId\": " << i
+            << ", \"profile\": " << profiles[i] << "}"
+            << (i + 1 < profiles.size() ? "," : "") << std::endl;
+  }
+  OutFile << "]" << std::endl;
+  OutFile.close();
+}
+
+/*
+ * Finds the fastest query-time parameter set reaching the target recall
+ * using a binary search. Query-time parameter sets are assumed to be ordered
+ * from the fastest to the most accurate one, i.e., recall doesn't decrease
+ * along the list. Only visited parameter sets are evaluated (and marked
+ * in ParamEvaluated). The recall is taken from the first k-NN test 
+ * (or the first range test if there are no k-NN tests).
+ */
+template <typename dist_t>
+void SearchTargetRecall(float                                TargetRecall,
+                        bool                                 bPrintProgress,
+                        unsigned                             ThreadTestQty,
+                        size_t                               TestSetId,
+                        const GoldStandardManager<dist_t>&   managerGS,
+                        bool                                 recallOnly,
+                        vector<vector<MetaAnalysis*>>&       ExpResRange,
+                        vector<vector<MetaAnalysis*>>&       ExpResKNN,
+                        const ExperimentConfig<dist_t>&      config,
+                        Index<dist_t>&                       Method,
+                        const vector<shared_ptr<AnyParams>>& QueryTimeParams,
+                        const OpenLoopConfig&                OpenLoop,
+                        bool                                 UsePerfCounters,
+                        vector<bool>&                        ParamEvaluated) {
+  vector<vector<MetaAnalysis*>> ProbeRange(ExpResRange.size(), vector<MetaAnalysis*>(1));
+  vector<vector<MetaAnalysis*>> ProbeKNN(ExpResKNN.size(), vector<MetaAnalysis*>(1));
+
+  size_t lo = 0, hi = QueryTimeParams.size();
+
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+
+    for (size_t i = 0; i < ExpResRange.size(); ++i) ProbeRange[i][0] = ExpResRange[i][mid];
+    for (size_t i = 0; i < ExpResKNN.size(); ++i) ProbeKNN[i][0] = ExpResKNN[i][mid];
+
+    Experiments<dist_t>::RunAll(bPrintProgress,
+                                ThreadTestQty,
+                                TestSetId,
+                                managerGS,
+                                recallOnly,
+                                ProbeRange, ProbeKNN,
+                                config,
+                                Method,
+                                vector<shared_ptr<AnyParams>>(1, QueryTimeParams[mid]),
+                                OpenLoop,
+                                UsePerfCounters);
+    ParamEvaluated[mid] = true;
+
+    MetaAnalysis* res = !ProbeKNN.empty() ? ProbeKNN[0][0] : ProbeRange[0][0];
+    res->ComputeAll();
+
+    LOG(LIB_INFO) << ">>>> Target recall search, query-time params: '" << QueryTimeParams[mid]->ToString()
+                  << "' recall: " << res->GetRecallAvg() << " (target: " << TargetRecall << ")";
+
+    if (res->GetRecallAvg() >= TargetRecall) hi = mid; else lo = mid + 1;
+  }
+
+  if (lo < QueryTimeParams.size()) {
+    LOG(LIB_INFO) << ">>>> The first parameter set reaching the target recall: '" << QueryTimeParams[lo]->ToString() << "'";
+  } else {
+    LOG(LIB_INFO) << ">>>> No parameter set reaches the target recall " << TargetRecall;
+  }
+}
+
 template <typename dist_t>
 void RunExper(bool                                bPrintProgress,
              const string&                        LoadIndexLoc,
@@ -145,7 +332,10 @@ void RunExper(bool                                bPrintProgress,
              unsigned                             MaxNumQuery,
              const                                vector<unsigned>& knn,
              const                                float eps,
-             const string&                        RangeArg
+             const string&                        RangeArg,
+             const OpenLoopConfig&                OpenLoop,
+             bool                                 UsePerfCounters,
+             float                                TargetRecall
 )
 {
   LOG(LIB_INFO) << "### Append? : "       << DoAppend;
@@ -271,6 +461,18 @@ void RunExper(bool                                bPrintProgress,
 
   CHECK_MSG(!QueryTimeParams.empty(), "The array of query-time parameters shouldn't be empty!");
 
+  bool bSearchTargetRecall = TargetRecall > 0 && QueryTimeParams.size() > 1;
+
+  if (bSearchTargetRecall && config.GetTestSetToRunQty() != 1) {
+    throw runtime_error("The search for a target recall requires a single test set");
+  }
+  if (bSearchTargetRecall && config.GetRange().empty() && config.GetKNN().empty()) {
+    throw runtime_error("The search for a target recall requires either a k-NN or a range test");
+  }
+  // In the target-recall mode, only parameter sets visited by the binary search are evaluated
+  vector<bool>                  ParamEvaluated(QueryTimeParams.size(), !bSearchTargetRecall);
+  vector<string>                BuildProfiles;
+
   vector<vector<MetaAnalysis*>> ExpResRange(config.GetRange().size(),
                                                 vector<MetaAnalysis*>(QueryTimeParams.size()));
   vector<vector<MetaAnalysis*>> ExpResKNN(config.GetKNN().size(),
@@ -314,9 +516,11 @@ void RunExper(bool                                bPrintProgress,
             << "but obtained " << cacheTestId;
         throw runtime_error(err.str());
       }
-      CHECK_MSG(savedThreadQty == ThreadTestQty,
-                "Error: the gold standard was computed using " +ConvertToString(savedThreadQty) + " threads, but the current test will use "  +
-                ConvertToString(ThreadTestQty) + " threads. You have to use the same number of threads while computing gold standard data and testing!");
+      if (savedThreadQty != ThreadTestQty) {
+        LOG(LIB_INFO) << "The gold standard was computed using " << savedThreadQty << " threads, but the current test will use "
+                      << ThreadTestQty << " threads. Note that improvement in efficiency is computed relative to "
+                      << "the sequential search time obtained using " << savedThreadQty << " threads!";
+      }
     } else {
       managerGS.Compute(ThreadTestQty, maxCacheGSRelativeQty);
       if (bWriteGSCache) {
@@ -404,6 +608,12 @@ void RunExper(bool                                bPrintProgress,
         LOG(LIB_INFO) << ">>>> Index loading time:    " << LoadTime             << " sec";
         LOG(LIB_INFO) << ">>>> Index saving  time:    " << SaveTime             << " sec";
 
+        const BuildProfiler& BuildProfile = IndexPtr->GetBuildProfile();
+        if (bCreate && !BuildProfile.GetPhases().empty()) {
+          LOG(LIB_INFO) << ">>>> Build profile:         " << BuildProfile.ToString();
+          BuildProfiles.push_back(BuildProfile.ToJSON());
+        }
+
         for (size_t qtmParamId = 0; qtmParamId < QueryTimeParams.size(); ++qtmParamId) {
           for (size_t i = 0; i < config.GetRange().size(); ++i) {
             MetaAnalysis* res = ExpResRange[i][qtmParamId];
@@ -421,15 +631,33 @@ void RunExper(bool                                bPrintProgress,
           }
         }
 
-        Experiments<dist_t>::RunAll(bPrintProgress,
-                                    ThreadTestQty, 
-                                    TestSetId,
-                                    managerGS,
-                                    recallOnly,
-                                    ExpResRange, ExpResKNN,
-                                    config, 
-                                    *IndexPtr, 
-                                    QueryTimeParams);
+        if (bSearchTargetRecall) {
+          SearchTargetRecall(TargetRecall,
+                             bPrintProgress,
+                             ThreadTestQty,
+                             TestSetId,
+                             managerGS,
+                             recallOnly,
+                             ExpResRange, ExpResKNN,
+                             config,
+                             *IndexPtr,
+                             QueryTimeParams,
+                             OpenLoop,
+                             UsePerfCounters,
+                             ParamEvaluated);
+        } else {
+          Experiments<dist_t>::RunAll(bPrintProgress,
+                                      ThreadTestQty, 
+                                      TestSetId,
+                                      managerGS,
+                                      recallOnly,
+                                      ExpResRange, ExpResKNN,
+                                      config, 
+                                      *IndexPtr, 
+                                      QueryTimeParams,
+                                      OpenLoop,
+                                      UsePerfCounters);
+        }
 
 
       } catch (const std::exception& e) {
@@ -448,9 +676,19 @@ void RunExper(bool                                bPrintProgress,
 
   // Don't save results, if the method wasn't specified
   if (!MethodName.empty()) {
+    vector<vector<SweepPoint>> SweepRange(config.GetRange().size());
+    vector<vector<SweepPoint>> SweepKNN(config.GetKNN().size());
+
+    size_t OutQty = 0;
+
     for (size_t MethNum = 0; MethNum < QueryTimeParams.size(); ++MethNum) {
+      if (!ParamEvaluated[MethNum]) {
+        for (size_t i = 0; i < config.GetRange().size(); ++i) delete ExpResRange[i][MethNum];
+        for (size_t i = 0; i < config.GetKNN().size(); ++i) delete ExpResKNN[i][MethNum];
+        continue;
+      }
       // Don't overwrite file after we output data at least for one method!
-      bool DoAppendHere = DoAppend || MethNum;
+      bool DoAppendHere = DoAppend || OutQty++;
 
       string Print, Data, Header;
 
@@ -460,6 +698,10 @@ void RunExper(bool                                bPrintProgress,
         ProcessResults(config, *res, MethodDescStr,
                       IndexTimeParams->ToString(), QueryTimeParams[MethNum]->ToString(), 
                       Print, Header, Data);
+        SweepRange[i].push_back(SweepPoint(QueryTimeParams[MethNum]->ToString(),
+                                           res->GetRecallAvg(), res->GetQueryPerSecAvg(),
+                                           res->GetQueryTimeAvg(), res->GetQueryTimeP99Avg(),
+                                           res->GetDistCompAvg()));
         LOG(LIB_INFO) << "Range: " << config.GetRange()[i];
         LOG(LIB_INFO) << Print;
         LOG(LIB_INFO) << "Data: " << Header << Data;
@@ -468,6 +710,10 @@ void RunExper(bool                                bPrintProgress,
           stringstream str;
           str << ResFilePrefix << "_r=" << config.GetRange()[i];
           OutData(DoAppendHere, str.str(), Print, Header, Data);
+          if (OpenLoop.IsEnabled()) {
+            OutOpenLoopData(DoAppendHere, str.str(), *res, MethodDescStr,
+                            IndexTimeParams->ToString(), QueryTimeParams[MethNum]->ToString());
+          }
         }
 
         delete res;
@@ -479,6 +725,10 @@ void RunExper(bool                                bPrintProgress,
         ProcessResults(config, *res, MethodDescStr,
                       IndexTimeParams->ToString(), QueryTimeParams[MethNum]->ToString(), 
                       Print, Header, Data);
+        SweepKNN[i].push_back(SweepPoint(QueryTimeParams[MethNum]->ToString(),
+                                         res->GetRecallAvg(), res->GetQueryPerSecAvg(),
+                                         res->GetQueryTimeAvg(), res->GetQueryTimeP99Avg(),
+                                         res->GetDistCompAvg()));
         LOG(LIB_INFO) << "KNN: " << config.GetKNN()[i];
         LOG(LIB_INFO) << Print;
         LOG(LIB_INFO) << "Data: " << Header << Data;
@@ -487,11 +737,35 @@ void RunExper(bool                                bPrintProgress,
           stringstream str;
           str << ResFilePrefix << "_K=" << config.GetKNN()[i];
           OutData(DoAppendHere, str.str(), Print, Header, Data);
+          if (OpenLoop.IsEnabled()) {
+            OutOpenLoopData(DoAppendHere, str.str(), *res, MethodDescStr,
+                            IndexTimeParams->ToString(), QueryTimeParams[MethNum]->ToString());
+          }
         }
 
         delete res;
       }
     }
+
+    if (!ResFilePrefix.empty() && !BuildProfiles.empty()) {
+      OutBuildProfiles(ResFilePrefix, MethodDescStr, BuildProfiles);
+    }
+
+    // The sweep summary makes sense only if there are at least two query-time parameter sets
+    if (OutQty > 1) {
+      for (size_t i = 0; i < config.GetRange().size(); ++i) {
+        LOG(LIB_INFO) << "Range: " << config.GetRange()[i];
+        stringstream str;
+        if (!ResFilePrefix.empty()) str << ResFilePrefix << "_r=" << config.GetRange()[i];
+        OutSweepData(str.str(), MethodDescStr, SweepRange[i], TargetRecall);
+      }
+      for (size_t i = 0; i < config.GetKNN().size(); ++i) {
+        LOG(LIB_INFO) << "KNN: " << config.GetKNN()[i];
+        stringstream str;
+        if (!ResFilePrefix.empty()) str << ResFilePrefix << "_K=" << config.GetKNN()[i];
+        OutSweepData(str.str(), MethodDescStr, SweepKNN[i], TargetRecall);
+      }
+    }
   }
 }
 
@@ -523,6 +797,10 @@ int main(int ac, char* av[]) {
   string                RangeArg;
   float                 eps = 0.0;
   unsigned              ThreadTestQty;
+  vector<double>        ArrivalQPS;
+  string                ArrivalDist;
+  bool                  UsePerfCounters;
+  float                 TargetRecall;
 
   shared_ptr<AnyParams>           IndexTimeParams;
   vector<shared_ptr<AnyParams>>   QueryTimeParams;
@@ -553,7 +831,13 @@ int main(int ac, char* av[]) {
                          RangeArg,
                          MethodName,
                          IndexTimeParams,
-                         QueryTimeParams);
+                         QueryTimeParams,
+                         ArrivalQPS,
+                         ArrivalDist,
+                         UsePerfCounters,
+                         TargetRecall);
+
+    OpenLoopConfig OpenLoop(ArrivalQPS, ArrivalDist == ARRIVAL_DIST_POISSON);
 
     if ((!LoadIndexLoc.empty() || !SaveIndexLoc.empty()) &&
          CacheGSFilePrefix.empty() &&
@@ -592,7 +876,10 @@ int main(int ac, char* av[]) {
                     MaxNumQuery,
                     knn,
                     eps,
-                    RangeArg
+                    RangeArg,
+                    OpenLoop,
+                    UsePerfCounters,
+                    TargetRecall
                    );
     } else if (DIST_TYPE_FLOAT == DistType) {
       RunExper<float>(bPrintProgress,
@@ -616,7 +903,10 @@ int main(int ac, char* av[]) {
                     MaxNumQuery,
                     knn,
                     eps,
-                    RangeArg
+                    RangeArg,
+                    OpenLoop,
+                    UsePerfCounters,
+                    TargetRecall
                    );
     } else if (DIST_TYPE_DOUBLE == DistType) {
       RunExper<double>(bPrintProgress,
@@ -640,7 +930,10 @@ int main(int ac, char* av[]) {
                     MaxNumQuery,
                     knn,
                     eps,
-                    RangeArg
+                    RangeArg,
+                    OpenLoop,
+                    UsePerfCounters,
+                    TargetRecall
                    );
     } else {
       LOG(LIB_FATAL) << "Unknown distance value type: " << DistType;
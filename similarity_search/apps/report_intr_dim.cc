@@ -13,59 +13,72 @@
  *
  */
 #include <iostream>
+#include <fstream>
 #include <string>
 
 #include "space.h"
 #include "params.h"
 #include "init.h"
 #include "report_intr_dim.h"
+#include "sample_stat.h"
 #include "spacefactory.h"
 #include "cmd_options.h"
 #include "my_isnan_isinf.h"
+#include "ztimer.h"
 
 using namespace similarity;
 using namespace std;
 
 const unsigned defaultSampleQty = 1000000;
+const unsigned defaultBinQty = 100;
 
+/*
+ * Triples are sampled in chunks in parallel (see SampleRandomPairDistances).
+ */
 template <typename dist_t>
 void ComputeMuDeffect(const Space<dist_t>& space,
                     const ObjectVector& dataset,
                     double & dleft, double & dright,
-                    size_t SampleQty = 1000000) {
-  dleft = dright = -1;
-  for (size_t n = 0; n < SampleQty; ++n) {
-    size_t r1 = RandomInt() % dataset.size();
-    size_t r2 = RandomInt() % dataset.size();
-    size_t r3 = RandomInt() % dataset.size();
-    CHECK(r1 < dataset.size());
-    CHECK(r2 < dataset.size());
-    CHECK(r3 < dataset.size());
-    const Object* q = dataset[r1];
-    const Object* a = dataset[r2];
-    const Object* b = dataset[r3];
-    {
-      dist_t d1 = space.IndexTimeDistance(q, a);
-      dist_t d2 = space.IndexTimeDistance(q, b);
-      dist_t d3 = space.IndexTimeDistance(a, b);
-      if (my_isnan(d1) || my_isnan(d2) || my_isnan(d3)) {
-        throw runtime_error("!!! Bug: a distance returned NAN!");
-      }
-      if (d3 != 0) {
-        dright = max(dright, (double)fabs(double(d1)-double(d2))/double(d3));
-      }
-    }
-    {
-      dist_t d1 = space.IndexTimeDistance(a, q);
-      dist_t d2 = space.IndexTimeDistance(b, q);
-      dist_t d3 = space.IndexTimeDistance(b, a);
-      if (my_isnan(d1) || my_isnan(d2) || my_isnan(d3)) {
-        throw runtime_error("!!! Bug: a distance returned NAN!");
+                    size_t SampleQty,
+                    size_t ThreadQty,
+                    uint64_t Seed) {
+  size_t chunkQty = (SampleQty + SAMPLE_STAT_CHUNK_QTY - 1) / SAMPLE_STAT_CHUNK_QTY;
+  vector<double> chunkLeft(chunkQty, -1), chunkRight(chunkQty, -1);
+
+  ParallelFor(0, chunkQty, ThreadQty, [&](size_t chunkId) {
+    std::mt19937_64 randGen(Seed + 1 + chunkId);
+    std::uniform_int_distribution<size_t> randPos(0, dataset.size() - 1);
+    size_t qty = min(SAMPLE_STAT_CHUNK_QTY, SampleQty - chunkId * SAMPLE_STAT_CHUNK_QTY);
+    double& left  = chunkLeft[chunkId];
+    double& right = chunkRight[chunkId];
+
+    for (size_t n = 0; n < qty; ++n) {
+      const Object* q = dataset[randPos(randGen)];
+      const Object* a = dataset[randPos(randGen)];
+      const Object* b = dataset[randPos(randGen)];
+      {
+        double d1 = CheckedDist(space, q, a);
+        double d2 = CheckedDist(space, q, b);
+        double d3 = CheckedDist(space, a, b);
+        if (d3 != 0) {
+          right = max(right, fabs(d1 - d2) / d3);
+        }
       }
-      if (d3 != 0) {
-        dleft = max(dleft, (double)fabs(double(d1)-double(d2))/double(d3));
+      {
+        double d1 = CheckedDist(space, a, q);
+        double d2 = CheckedDist(space, b, q);
+        double d3 = CheckedDist(space, b, a);
+        if (d3 != 0) {
+          left = max(left, fabs(d1 - d2) / d3);
+        }
       }
     }
+  });
+
+  dleft = dright = -1;
+  for (size_t chunkId = 0; chunkId < chunkQty; ++chunkId) {
+    dleft  = max(dleft, chunkLeft[chunkId]);
+    dright = max(dright, chunkRight[chunkId]);
   }
 }
 
@@ -75,7 +88,11 @@ void TestSpace(
                 string dataFile,
                 bool compMuDeffect,
                 unsigned maxNumData,
-                unsigned sampleQty
+                unsigned dataSampleQty,
+                unsigned sampleQty,
+                unsigned threadQty,
+                string histFile,
+                unsigned binQty
                ) {
   string          spaceType;
   vector<string>  vSpaceArgs;
@@ -86,30 +103,74 @@ void TestSpace(
   unique_ptr<Space<dist_t>> space(SpaceFactoryRegistry<dist_t>::
                                 Instance().CreateSpace(spaceType, spaceParams));
 
+  WallClockTimer  timer;
   ObjectVector    data;
-  vector<string>  tmp;
-  unique_ptr<DataFileInputState> inpState(space->ReadDataset(data, tmp, dataFile, maxNumData));
-  space->UpdateParamsFromFile(*inpState);
+
+  if (dataSampleQty) {
+    uint64_t totalQty = 0;
+    unique_ptr<DataFileInputState> inpState(ReadDatasetSample(*space, data, dataFile,
+                                                              dataSampleQty, RandomInt(), totalQty));
+    space->UpdateParamsFromFile(*inpState);
+    LOG(LIB_INFO) << "Sampled " << data.size() << " data points out of " << totalQty;
+  } else {
+    vector<string>  tmp;
+    unique_ptr<DataFileInputState> inpState(space->ReadDataset(data, tmp, dataFile, maxNumData));
+    space->UpdateParamsFromFile(*inpState);
+    LOG(LIB_INFO) << "Read " << data.size() << " data points";
+  }
+  timer.split();
+  LOG(LIB_INFO) << "Data loading time: " << timer.elapsed() / 1e6 << " sec";
+
+  timer.reset();
+  RunningStat               distStat;
+  unique_ptr<DistHistogram> distHist;
+  SampleRandomPairDistances(*space, data, sampleQty, threadQty, RandomInt(), distStat,
+                            histFile.empty() ? nullptr : &distHist, binQty);
+  timer.split();
 
   // Prints the report
-  ReportIntrinsicDimensionality("********", *space, data, sampleQty);
+  LOG(LIB_INFO) << "### ********";
+  LOG(LIB_INFO) << "### intrinsic dim: " << IntrinsicDimensionality(distStat);
+  LOG(LIB_INFO) << "### distance mean: " << distStat.Mean;
+  LOG(LIB_INFO) << "### distance sigma: " << sqrt(distStat.Var());
+  LOG(LIB_INFO) << "### distance min: " << distStat.Min << " max: " << distStat.Max;
+  LOG(LIB_INFO) << "Distance sampling time: " << timer.elapsed() / 1e6 << " sec";
+
+  if (distHist) {
+    ofstream out(histFile);
+    if (!out) {
+      throw runtime_error("Cannot open the histogram file: '" + histFile + "'");
+    }
+    distHist->Write(out);
+    out.close();
+    LOG(LIB_INFO) << "The distance histogram is saved to '" << histFile << "'";
+  }
+
   if (compMuDeffect) {
     double    dleft, dright;
     ComputeMuDeffect<dist_t>(
                   *space,
                   data,
                   dleft, dright,
-                  sampleQty
+                  sampleQty,
+                  threadQty,
+                  RandomInt()
                  );
     LOG(LIB_INFO) << "### left mu-defect. : " << dleft << " right mu-defect. :" << dright;
   }
+
+  for (const Object* pObj : data) delete pObj;
 }
 
 int main(int argc, char* argv[]) {
   string    spaceDesc, distType;
   string    dataFile;
   unsigned  maxNumData;
+  unsigned  dataSampleQty;
   unsigned  sampleQty;
+  unsigned  threadQty;
+  string    histFile;
+  unsigned  binQty;
   bool      compMuDeffect;
 
   CmdOptions cmd_options;
@@ -122,8 +183,17 @@ int main(int argc, char* argv[]) {
                                &dataFile, true));
   cmd_options.Add(new CmdParam("maxNumData", "if non-zero, only the first maxNumData elements are used",
                                &maxNumData, false, 0));
+  cmd_options.Add(new CmdParam("dataSampleQty", "if non-zero, only a random sample of data points (of this size) is used, "
+                                                "the whole data file is never loaded into memory",
+                               &dataSampleQty, false, 0));
   cmd_options.Add(new CmdParam("sampleQty", "a number of samples (a sample is a pair of data points)",
                                &sampleQty, false, defaultSampleQty));
+  cmd_options.Add(new CmdParam("threadQty", "a number of threads (0 means the number of hardware threads)",
+                               &threadQty, false, 0));
+  cmd_options.Add(new CmdParam("histFile", "if specified, a histogram of sampled distances is saved to this file",
+                               &histFile, false, ""));
+  cmd_options.Add(new CmdParam("binQty", "a number of histogram bins",
+                               &binQty, false, defaultBinQty));
   cmd_options.Add(new CmdParam("muDeffect,m", "estimate the left and the right mu deffectiveness",
                                &compMuDeffect, false, false));
 
@@ -143,7 +213,11 @@ int main(int argc, char* argv[]) {
                   dataFile,
                   compMuDeffect,
                   maxNumData,
-                  sampleQty
+                  dataSampleQty,
+                  sampleQty,
+                  threadQty,
+                  histFile,
+                  binQty
                 );
     } else if (DIST_TYPE_FLOAT == distType) {
       TestSpace<float>(
@@ -151,7 +225,11 @@ int main(int argc, char* argv[]) {
                   dataFile,
                   compMuDeffect,
                   maxNumData,
-                  sampleQty
+                  dataSampleQty,
+                  sampleQty,
+                  threadQty,
+                  histFile,
+                  binQty
                  );
     } else if (DIST_TYPE_DOUBLE == distType) {
       TestSpace<double>(
@@ -159,7 +237,11 @@ int main(int argc, char* argv[]) {
                   dataFile,
                   compMuDeffect,
                   maxNumData,
-                  sampleQty
+                  dataSampleQty,
+                  sampleQty,
+                  threadQty,
+                  histFile,
+                  binQty
                  );
     }
 
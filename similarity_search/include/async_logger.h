@@ -0,0 +1,125 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#ifndef _ASYNC_LOGGER_H_
+#define _ASYNC_LOGGER_H_
+
+#include <cstdint>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "logging.h"
+
+// The default capacity of the message queue (rounded up to a power of two)
+const size_t ASYNC_LOG_QUEUE_SIZE = 8192;
+// The maximum time flush() waits for the queue to be drained
+const unsigned ASYNC_LOG_FLUSH_TIMEOUT_MS = 1000;
+
+/*
+ * A logger that passes messages to another (inner) logger in a background thread.
+ * Messages are stored in a bounded lock-free multi-producer queue
+ * (D. Vyukov's algorithm), so logging threads never wait for a lock, the disk,
+ * or (in the case of Python bindings) the GIL. If the queue is full,
+ * the message is dropped: the number of dropped messages is reported by
+ * the background thread as soon as the queue has some free space.
+ * Errors and fatal errors are never dropped: if they don't fit into the queue,
+ * the queue is flushed and they are written synchronously.
+ *
+ * After stop() is called (or if the background thread can't be started),
+ * messages are passed to the inner logger synchronously. The same happens
+ * in a child process after fork(), which doesn't have the background thread:
+ * messages queued by the parent are left to the parent.
+ */
+class AsyncLogger
+  : public Logger {
+ public:
+  // Takes the ownership of the inner logger
+  AsyncLogger(Logger * inner, size_t queueSize = ASYNC_LOG_QUEUE_SIZE);
+  ~AsyncLogger();
+
+  void log(LogSeverity severity,
+           const char * file,
+           int line,
+           const char * function,
+           const std::string & message);
+
+  /*
+   * Waits till all messages logged before the call are written,
+   * but no longer than ASYNC_LOG_FLUSH_TIMEOUT_MS. The limit
+   * prevents deadlocks if the inner logger needs a resource held
+   * by the flushing thread (e.g., the Python GIL).
+   */
+  void flush();
+
+  // Writes all queued messages and stops the background thread
+  void stop();
+
+  uint64_t getDroppedQty() const { return droppedQty_.load(); }
+
+ private:
+  struct Record {
+    LogSeverity   severity;
+    const char *  file;
+    int           line;
+    const char *  function;
+    std::string   message;
+  };
+
+  struct Cell {
+    std::atomic<size_t> seq;
+    Record              rec;
+  };
+
+  bool tryPush(LogSeverity severity, const char * file, int line,
+               const char * function, const std::string & message);
+  bool tryPop(Record & rec);
+  void drain();
+  void reportDropped();
+
+  // pthread_atfork handlers, they process all existing loggers
+  static void prepareFork();
+  static void parentAfterFork();
+  static void childAfterFork();
+
+  std::unique_ptr<Logger>   inner_;
+  // serializes the inner logger, it is replaced in a child process if the parent couldn't lock it
+  std::unique_ptr<std::timed_mutex> innerMutex_;
+  bool                      forkLocked_;  // innerMutex_ is locked by prepareFork
+
+  std::vector<Cell>         cells_;
+  size_t                    mask_;
+  std::atomic<size_t>       enqueuePos_;
+  size_t                    dequeuePos_;  // used only by the background thread
+
+  std::atomic<uint64_t>     pushedQty_;
+  std::atomic<uint64_t>     writtenQty_;
+  std::atomic<uint64_t>     droppedQty_;
+  uint64_t                  reportedDroppedQty_;
+
+  std::mutex                waitMutex_;
+  std::condition_variable   waitCond_;
+  std::atomic<bool>         sleeping_;
+  std::atomic<bool>         stop_;
+  std::atomic<bool>         running_;
+  // the number of log() calls in progress, stop() waits for them before the final drain
+  std::atomic<size_t>       activeProducerQty_;
+  std::unique_ptr<std::thread> thread_;
+};
+
+#endif     // _ASYNC_LOGGER_H_
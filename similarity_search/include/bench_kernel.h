@@ -0,0 +1,250 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#ifndef _BENCH_KERNEL_H_
+#define _BENCH_KERNEL_H_
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <memory>
+#include <ostream>
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "ztimer.h"
+#include "perf_counters.h"
+
+namespace similarity {
+
+using std::string;
+using std::vector;
+using std::unique_ptr;
+
+/*
+ * Settings of the distance-kernel benchmark. A kernel is first
+ * run for at least WarmupMicroSec microseconds. The number of passes
+ * over the data made during the warm-up is used to select the number
+ * of passes per trial so that each trial runs for approximately
+ * TrialMicroSec microseconds. Then, TrialQty trials are carried out.
+ */
+struct KernelBenchConfig {
+  KernelBenchConfig() : VectQty(1000), WarmupMicroSec(100000), TrialMicroSec(200000),
+                        TrialQty(10), UsePerfCounters(false) {}
+
+  size_t    VectQty;
+  uint64_t  WarmupMicroSec;
+  uint64_t  TrialMicroSec;
+  unsigned  TrialQty;
+  bool      UsePerfCounters;
+};
+
+/*
+ * Results of one kernel benchmark. Throughput values are computed
+ * from the per-trial distance computation rates; the confidence interval
+ * uses the normal approximation (as MetaAnalysis does). BytesPerDist is
+ * the size of two compared vectors: GB/s is the nominal amount of
+ * data processed by the kernel, the vectors are mostly in the cache.
+ */
+struct KernelBenchResult {
+  KernelBenchResult() : Dim(0), BytesPerDist(0), DistPerTrial(0),
+                        DistPerSecMean(0), DistPerSecConfMin(0), DistPerSecConfMax(0),
+                        GBPerSecMean(0), NanoSecPerDist(0), PerfDistQty(0) {}
+
+  string            Name;
+  string            DataType;
+  size_t            Dim;
+  size_t            BytesPerDist;
+  uint64_t          DistPerTrial;
+  vector<double>    TrialDistPerSec;
+  double            DistPerSecMean;
+  double            DistPerSecConfMin;
+  double            DistPerSecConfMax;
+  double            GBPerSecMean;
+  double            NanoSecPerDist;
+  // Hardware counters accumulated over all trials (if requested)
+  PerfCounterValues Perf;
+  uint64_t          PerfDistQty;
+};
+
+// A sink for benchmark results, which prevents the compiler from throwing away computation
+extern volatile double gKernelBenchSink;
+
+/*
+ * Computes the mean and the confidence interval (zVal * standard error).
+ */
+inline void ComputeMeanConfInterval(const vector<double>& vals, double zVal,
+                                    double& mean, double& confMin, double& confMax) {
+  mean = confMin = confMax = 0;
+  if (vals.empty()) return;
+
+  for (double v : vals) mean += v;
+  mean /= vals.size();
+
+  double sigma = 0;
+  if (vals.size() > 1) {
+    for (double v : vals) sigma += (v - mean) * (v - mean);
+    sigma = sqrt(sigma / (vals.size() - 1));
+  }
+  double delta = zVal * sigma / sqrt(double(vals.size()));
+
+  confMin = mean - delta;
+  confMax = mean + delta;
+}
+
+/*
+ * Pins the current thread to a given CPU (Linux only), returns false on failure.
+ */
+inline bool PinCurrentThread(int cpuId) {
+#ifdef __linux__
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  CPU_SET(cpuId, &cpuSet);
+  return sched_setaffinity(0, sizeof(cpuSet), &cpuSet) == 0;
+#else
+  (void)cpuId;
+  return false;
+#endif
+}
+
+/*
+ * The CPU model name (Linux only), which is saved along with benchmark results.
+ */
+inline string GetCPUModelName() {
+#ifdef __linux__
+  std::ifstream inp("/proc/cpuinfo");
+  string line;
+  while (std::getline(inp, line)) {
+    if (line.compare(0, 10, "model name") == 0) {
+      string::size_type p = line.find(':');
+      if (p != string::npos) {
+        string::size_type s = line.find_first_not_of(' ', p + 1);
+        return s == string::npos ? "" : line.substr(s);
+      }
+    }
+  }
+#endif
+  return "unknown";
+}
+
+/*
+ * Instruction set extensions enabled at compile time.
+ */
+inline string GetCompiledSIMD() {
+  std::stringstream res;
+#ifdef __SSE2__
+  res << "sse2 ";
+#endif
+#ifdef __SSE4_2__
+  res << "sse4.2 ";
+#endif
+#ifdef __AVX__
+  res << "avx ";
+#endif
+#ifdef __AVX2__
+  res << "avx2 ";
+#endif
+#ifdef __AVX512F__
+  res << "avx512f ";
+#endif
+  string s = res.str();
+  if (!s.empty()) s.erase(s.size() - 1);
+  return s;
+}
+
+/*
+ * Benchmarks a distance kernel: distFunc(i, j) should compute
+ * the distance between the i-th and the j-th vector (0 <= i, j < VectQty).
+ * A pass over the data computes distances between all neighboring vectors.
+ */
+template <class DistFunc>
+KernelBenchResult RunKernelBench(const KernelBenchConfig& conf,
+                                 const string& name, const string& dataType,
+                                 size_t dim, size_t bytesPerVect,
+                                 DistFunc distFunc) {
+  KernelBenchResult res;
+
+  res.Name         = name;
+  res.DataType     = dataType;
+  res.Dim          = dim;
+  res.BytesPerDist = 2 * bytesPerVect;
+
+  const size_t distPerPass = conf.VectQty - 1;
+
+  double sum = 0;
+
+  auto onePass = [&]() {
+    for (size_t j = 1; j < conf.VectQty; ++j) {
+      sum += distFunc(j, j - 1);
+    }
+  };
+
+  WallClockTimer timer;
+
+  timer.reset();
+  uint64_t warmupPassQty = 0;
+  do {
+    onePass();
+    ++warmupPassQty;
+  } while (timer.split() < conf.WarmupMicroSec);
+
+  uint64_t warmupTime = std::max<uint64_t>(1, timer.elapsed());
+  uint64_t passQty = std::max<uint64_t>(1, warmupPassQty * conf.TrialMicroSec / warmupTime);
+
+  res.DistPerTrial = passQty * distPerPass;
+
+  unique_ptr<PerfCounters> perf;
+  if (conf.UsePerfCounters) perf.reset(new PerfCounters());
+
+  for (unsigned t = 0; t < conf.TrialQty; ++t) {
+    if (perf) perf->Start();
+    timer.reset();
+    for (uint64_t p = 0; p < passQty; ++p) onePass();
+    uint64_t elapsed = std::max<uint64_t>(1, timer.split());
+    if (perf) {
+      perf->Stop();
+      res.Perf.Add(perf->Read());
+      res.PerfDistQty += res.DistPerTrial;
+    }
+    res.TrialDistPerSec.push_back(1e6 * res.DistPerTrial / elapsed);
+  }
+
+  gKernelBenchSink = gKernelBenchSink + sum;
+
+  ComputeMeanConfInterval(res.TrialDistPerSec, 1.96,
+                          res.DistPerSecMean, res.DistPerSecConfMin, res.DistPerSecConfMax);
+  res.GBPerSecMean   = res.DistPerSecMean * res.BytesPerDist / 1e9;
+  res.NanoSecPerDist = res.DistPerSecMean > 0 ? 1e9 / res.DistPerSecMean : 0;
+
+  return res;
+}
+
+/*
+ * Saves benchmark results in the JSON format. Run-level information
+ * (the label, the CPU, the compiler, etc) is saved as well, so that
+ * results obtained on different machines or commits can be compared.
+ */
+void WriteKernelBenchJSON(std::ostream& out, const string& label, int cpuId,
+                          const KernelBenchConfig& conf,
+                          const vector<KernelBenchResult>& results);
+
+}   // namespace similarity
+
+#endif      // _BENCH_KERNEL_H_
@@ -0,0 +1,209 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#ifndef _BUILD_PROFILE_H_
+#define _BUILD_PROFILE_H_
+
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ztimer.h"
+
+namespace similarity {
+
+using std::string;
+using std::vector;
+
+/*
+ * Statistics of one index-construction phase. Times are in seconds,
+ * memory sizes are in MB. CPUTime is the CPU time of the whole process,
+ * so for a multi-threaded phase it can exceed the wall time.
+ * PeakRSS is the RSS high-water mark of the process observed by the end
+ * of the phase, PeakRSSIncrease is how much it grew since the profiler was reset.
+ */
+struct BuildPhaseStat {
+  BuildPhaseStat() : WallTime(0), CPUTime(0), RSSStart(0), RSSEnd(0), PeakRSS(0), PeakRSSIncrease(0) {}
+
+  string  Name;
+  double  WallTime;
+  double  CPUTime;
+  double  RSSStart;
+  double  RSSEnd;
+  double  PeakRSS;
+  double  PeakRSSIncrease;
+};
+
+/*
+ * A sample of the insertion throughput: Time is the number of seconds
+ * since the start of the insertion, ItemsPerSec is the throughput
+ * since the previous sample.
+ */
+struct BuildProgressSample {
+  BuildProgressSample() : Time(0), DoneQty(0), ItemsPerSec(0), RSS(0) {}
+
+  double    Time;
+  uint64_t  DoneQty;
+  double    ItemsPerSec;
+  double    RSS;
+};
+
+/*
+ * Accumulated time of a step that is interleaved with other steps
+ * in many threads (e.g., neighbor pruning during HNSW insertion).
+ * ThreadTime is the sum of times over all threads in seconds.
+ */
+struct BuildSubPhaseStat {
+  BuildSubPhaseStat() : ThreadTime(0), CallQty(0) {}
+
+  string    Name;
+  double    ThreadTime;
+  uint64_t  CallQty;
+};
+
+// The maximum number of sub-phases that can be registered
+const unsigned BUILD_PROFILE_MAX_SUBPHASE = 8;
+// The default number of throughput samples per progress-tracked phase
+const unsigned BUILD_PROFILE_PROGRESS_SAMPLE_QTY = 100;
+
+/*
+ * Records phases of index construction. A method's CreateIndex calls
+ * StartPhase()/EndPhase() (or uses the BuildPhase scope helper below),
+ * calls StartProgress() before inserting data and AddProgress() after
+ * each insertion. StartPhase, EndPhase, StartProgress and RegisterSubPhase
+ * should be called from the thread that creates the index, whereas
+ * AddProgress and AddSubPhaseTime can be called from indexing threads.
+ * The profiler is cheap enough to be always on.
+ */
+class BuildProfiler {
+public:
+  BuildProfiler() { Clear(); }
+
+  /*
+   * Clears all statistics and records the current RSS high-water mark as a baseline.
+   * The high-water mark itself isn't reset, because it belongs to the whole process,
+   * which can build several indices at the same time (e.g., shards of a sharded index).
+   */
+  void Reset();
+
+  // Starts a new phase, the previous phase (if any) is ended
+  void StartPhase(const string& name);
+  void EndPhase();
+
+  /*
+   * Starts tracking the insertion progress: a throughput sample
+   * is taken each time approximately totalQty/sampleQty items are inserted.
+   */
+  void StartProgress(uint64_t totalQty, unsigned sampleQty = BUILD_PROFILE_PROGRESS_SAMPLE_QTY);
+
+  void AddProgress(uint64_t qty = 1) {
+    uint64_t prev = doneQty_.fetch_add(qty);
+    uint64_t curr = prev + qty;
+    if (sampleInterval_ && prev / sampleInterval_ != curr / sampleInterval_) {
+      TakeProgressSample();
+    }
+  }
+
+  // Returns the sub-phase id, which is passed to AddSubPhaseTime
+  unsigned RegisterSubPhase(const string& name);
+
+  void AddSubPhaseTime(unsigned id, uint64_t nanoSec) {
+    if (id < subPhaseQty_) {
+      subPhaseNanoSec_[id].fetch_add(nanoSec, std::memory_order_relaxed);
+      subPhaseCallQty_[id].fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  const vector<BuildPhaseStat>&       GetPhases() const { return phases_; }
+  const vector<BuildProgressSample>&  GetProgress() const { return progress_; }
+  vector<BuildSubPhaseStat>           GetSubPhases() const;
+  double                              GetPeakRSS() const { return peakRSS_; }
+  // The growth of the RSS high-water mark since the reset
+  double                              GetPeakRSSIncrease() const { return std::max(0.0, peakRSS_ - peakRSSBase_); }
+
+  // A single-line summary for the log
+  string ToString() const;
+  // A JSON object with all the statistics
+  string ToJSON() const;
+
+private:
+  void Clear();
+  void TakeProgressSample();
+
+  // The CPU time (in seconds) used by all threads of the process, including finished ones
+  static double GetCPUTime();
+
+  vector<BuildPhaseStat>        phases_;
+  bool                          inPhase_;
+  WallClockTimer                phaseTimer_;
+  double                        phaseCPUStart_;
+  double                        peakRSS_;
+  double                        peakRSSBase_;
+
+  std::mutex                    progressMutex_;
+  vector<BuildProgressSample>   progress_;
+  std::atomic<uint64_t>         doneQty_;
+  uint64_t                      sampleInterval_;
+  WallClockTimer                progressTimer_;
+
+  string                        subPhaseNames_[BUILD_PROFILE_MAX_SUBPHASE];
+  std::atomic<uint64_t>         subPhaseNanoSec_[BUILD_PROFILE_MAX_SUBPHASE];
+  std::atomic<uint64_t>         subPhaseCallQty_[BUILD_PROFILE_MAX_SUBPHASE];
+  unsigned                      subPhaseQty_;
+};
+
+/*
+ * Starts a phase in the constructor and ends it in the destructor.
+ */
+class BuildPhase {
+public:
+  BuildPhase(BuildProfiler& profiler, const string& name) : profiler_(profiler) {
+    profiler_.StartPhase(name);
+  }
+  ~BuildPhase() { profiler_.EndPhase(); }
+private:
+  BuildProfiler& profiler_;
+};
+
+/*
+ * Adds the time between the construction and the first call
+ * to Stop() (or the destruction) to the sub-phase time.
+ */
+class BuildSubPhaseTimer {
+public:
+  BuildSubPhaseTimer(BuildProfiler& profiler, unsigned id) :
+    profiler_(profiler), id_(id), stopped_(false), start_(std::chrono::steady_clock::now()) {}
+  ~BuildSubPhaseTimer() { Stop(); }
+
+  void Stop() {
+    if (stopped_) return;
+    stopped_ = true;
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - start_).count();
+    profiler_.AddSubPhaseTime(id_, static_cast<uint64_t>(ns));
+  }
+private:
+  BuildProfiler&                          profiler_;
+  unsigned                                id_;
+  bool                                    stopped_;
+  std::chrono::steady_clock::time_point   start_;
+};
+
+}   // namespace similarity
+
+#endif      // _BUILD_PROFILE_H_
@@ -0,0 +1,130 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#ifndef _EXACT_KNN_H_
+#define _EXACT_KNN_H_
+
+#include <algorithm>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "object.h"
+#include "space.h"
+#include "logging.h"
+#include "thread_pool.h"
+
+namespace similarity {
+
+using std::pair;
+using std::vector;
+
+/*
+ * The exact k-NN search processes queries in blocks of EXACT_KNN_QUERY_BLOCK_QTY
+ * queries: a chunk of EXACT_KNN_DATA_BLOCK_QTY data points is compared against
+ * all queries of the block while the chunk is still in the cache.
+ */
+const size_t EXACT_KNN_QUERY_BLOCK_QTY = 16;
+const size_t EXACT_KNN_DATA_BLOCK_QTY  = 4096;
+
+/*
+ * Finds keepQty nearest data points for each query with indices from queryStart
+ * to queryEnd. The query is the right argument of the distance function (as in KNNQuery).
+ * Data points marked in pExclude (if specified) are ignored. An entry is created
+ * by makeEntry(data point index, distance): entries are compared using their operator<,
+ * each query keeps keepQty smallest ones in a bounded max-heap.
+ * res[qi] receives entries of the query queryStart + qi sorted in the increasing order.
+ */
+template <class dist_t, class Entry, class MakeEntry>
+void ComputeExactKNNBlock(const Space<dist_t>&    space,
+                          const ObjectVector&     dataset,
+                          const ObjectVector&     queries,
+                          size_t                  queryStart,
+                          size_t                  queryEnd,
+                          size_t                  keepQty,
+                          const vector<char>*     pExclude,
+                          MakeEntry               makeEntry,
+                          vector<vector<Entry>>&  res) {
+  CHECK(queryStart <= queryEnd && queryEnd <= queries.size());
+
+  vector<std::priority_queue<Entry>> heaps(queryEnd - queryStart);
+
+  if (keepQty > 0) {
+    for (size_t dataStart = 0; dataStart < dataset.size(); dataStart += EXACT_KNN_DATA_BLOCK_QTY) {
+      size_t dataEnd = std::min(dataset.size(), dataStart + EXACT_KNN_DATA_BLOCK_QTY);
+      for (size_t qi = 0; qi < heaps.size(); ++qi) {
+        const Object*                 pQuery = queries[queryStart + qi];
+        std::priority_queue<Entry>&   heap = heaps[qi];
+        for (size_t i = dataStart; i < dataEnd; ++i) {
+          if (pExclude != nullptr && (*pExclude)[i]) continue;
+          Entry e = makeEntry(i, space.IndexTimeDistance(dataset[i], pQuery));
+          if (heap.size() < keepQty) {
+            heap.push(e);
+          } else if (e < heap.top()) {
+            heap.pop();
+            heap.push(e);
+          }
+        }
+      }
+    }
+  }
+
+  res.resize(heaps.size());
+  for (size_t qi = 0; qi < heaps.size(); ++qi) {
+    vector<Entry>& out = res[qi];
+    out.resize(heaps[qi].size());
+    for (size_t i = out.size(); i > 0; --i) {
+      out[i - 1] = heaps[qi].top();
+      heaps[qi].pop();
+    }
+  }
+}
+
+/*
+ * Finds k exact nearest neighbors of each query among data points using
+ * threadQty threads (see ComputeExactKNNBlock). For each query, the result
+ * contains pairs (distance, data point index) sorted in the order of increasing distance.
+ */
+template <typename dist_t>
+void ComputeExactKNN(const Space<dist_t>& space,
+                     const ObjectVector& dataset,
+                     const ObjectVector& queries,
+                     size_t k,
+                     size_t threadQty,
+                     const vector<char>* pExclude,
+                     vector<vector<pair<dist_t, size_t>>>& res) {
+  typedef pair<dist_t, size_t> DistPos;
+
+  res.clear();
+  res.resize(queries.size());
+  if (k == 0) return;
+
+  size_t blockQty = (queries.size() + EXACT_KNN_QUERY_BLOCK_QTY - 1) / EXACT_KNN_QUERY_BLOCK_QTY;
+
+  ParallelFor(0, blockQty, threadQty, [&](size_t blockId) {
+    size_t queryStart = blockId * EXACT_KNN_QUERY_BLOCK_QTY;
+    size_t queryEnd   = std::min(queries.size(), queryStart + EXACT_KNN_QUERY_BLOCK_QTY);
+
+    vector<vector<DistPos>> blockRes;
+    ComputeExactKNNBlock(space, dataset, queries, queryStart, queryEnd, k, pExclude,
+                         [](size_t i, dist_t dist) { return DistPos(dist, i); }, blockRes);
+    for (size_t qi = 0; qi < blockRes.size(); ++qi) {
+      res[queryStart + qi].swap(blockRes[qi]);
+    }
+  });
+}
+
+}   // namespace similarity
+
+#endif      // _EXACT_KNN_H_
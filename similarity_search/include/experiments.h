@@ -42,6 +42,10 @@
 #include "meta_analysis.h"
 #include "query_creator.h"
 #include "thread_pool.h"
+#include "latency_histogram.h"
+#include "open_loop.h"
+#include "perf_counters.h"
+#include "search_stat.h"
 
 namespace similarity {
 
@@ -60,6 +64,25 @@ class Experiments {
 public:
   typedef Index<dist_t> IndexType;
 
+  /*
+   * Per-thread statistics collected in the efficiency loop.
+   */
+  struct ThreadStat {
+    ThreadStat() : DistCompQty(0), ResultSizeSum(0), MaxResultSize(0), SlowestQueryTime(0) {}
+
+    vector<double>    DistComp;
+    vector<double>    QueryTime;
+    LatencyHistogram  Latency;
+    uint64_t          DistCompQty;
+    double            ResultSizeSum;
+    unsigned          MaxResultSize;
+    PerfCounterValues Perf;
+    SearchStat        Search;
+    // Traversal statistics of the slowest query (query time is in microseconds)
+    SearchStat        SlowestQuerySearch;
+    uint64_t          SlowestQueryTime;
+  };
+
   static void RunAll(bool                                 LogInfo, 
                      unsigned                             ThreadTestQty,
                      size_t                               TestSetId,
@@ -69,7 +92,9 @@ public:
                      vector<vector<MetaAnalysis*>>&       ExpResKNN,
                      const ExperimentConfig<dist_t>&      config,
                      IndexType&                           Method,
-                     const vector<shared_ptr<AnyParams>>& QueryTimeParams) {
+                     const vector<shared_ptr<AnyParams>>& QueryTimeParams,
+                     const OpenLoopConfig&                OpenLoop = OpenLoopConfig(),
+                     bool                                 UsePerfCounters = false) {
 
     if (LogInfo) LOG(LIB_INFO) << ">>>> TestSetId: " << TestSetId;
     if (LogInfo) LOG(LIB_INFO) << ">>>> Will use: "  << ThreadTestQty << " threads in efficiency testing";
@@ -84,7 +109,8 @@ public:
                                                   managerGS.GetRangeGS(i),
                                                   recallOnly,
                                                   ExpResRange[i], config, cr, 
-                                                  Method, QueryTimeParams);
+                                                  Method, QueryTimeParams, OpenLoop,
+                                              UsePerfCounters);
       }
     }
 
@@ -97,7 +123,8 @@ public:
                                               managerGS.GetKNNGS(i),
                                               recallOnly,
                                               ExpResKNN[i], config, cr, 
-                                              Method, QueryTimeParams);
+                                              Method, QueryTimeParams, OpenLoop,
+                                              UsePerfCounters);
       }
     }
     if (LogInfo) LOG(LIB_INFO) << "experiment done at " << LibGetCurrentTime();
@@ -112,7 +139,9 @@ public:
                      const ExperimentConfig<dist_t>&                config,
                      const QueryCreatorType&                        QueryCreator,
                      IndexType&                                     Method,
-                     const vector<shared_ptr<AnyParams>>&           QueryTimeParams) {
+                     const vector<shared_ptr<AnyParams>>&           QueryTimeParams,
+                     const OpenLoopConfig&                          OpenLoop = OpenLoopConfig(),
+                     bool                                           UsePerfCounters = false) {
     size_t numquery = config.GetQueryObjects().size();
     unsigned MethQty = QueryTimeParams.size();
 
@@ -139,7 +168,15 @@ public:
     vector<double>    avg_result_size(MethQty);
     vector<uint64_t>  DistCompQty(MethQty);
 
-    mutex             UpdateStat;
+    vector<double>    QueryTimeP50(MethQty);
+    vector<double>    QueryTimeP90(MethQty);
+    vector<double>    QueryTimeP99(MethQty);
+    vector<double>    QueryTimeP999(MethQty);
+
+    vector<PerfCounterValues> Perf(MethQty);
+    vector<SearchStat>        SearchStats(MethQty);
+    vector<SearchStat>        SlowestQuerySearch(MethQty);
+    vector<uint64_t>          SlowestQueryTime(MethQty);
 
     config.GetSpace().SetQueryPhase();
 
@@ -164,9 +201,16 @@ public:
 
       vector<vector<size_t>>                  QueryIds;
       vector<vector<unique_ptr<QueryType>>>   Queries; // queries with results
+      /*
+       * Each thread collects statistics in its own buffer, which
+       * are merged only after all threads finish. Thus, there's no
+       * synchronization in the search loop that could distort timings.
+       */
+      vector<ThreadStat>                      ThreadStats;
 
       QueryIds.resize(ThreadTestQty);
       Queries.resize(ThreadTestQty);
+      ThreadStats.resize(ThreadTestQty);
 
       /*
        * Because each thread uses its own parameter set, we must use
@@ -175,6 +219,26 @@ public:
       ParallelFor(0, ThreadTestQty, ThreadTestQty, [&](unsigned QueryPart) {
         size_t numquery = config.GetQueryObjects().size();
 
+        // A thread-local copy avoids false sharing with other threads' stats
+        ThreadStat stat;
+
+        size_t expQty = numquery / ThreadTestQty + 1;
+        QueryIds[QueryPart].reserve(expQty);
+        Queries[QueryPart].reserve(expQty);
+        stat.DistComp.reserve(expQty);
+        stat.QueryTime.reserve(expQty);
+
+        /*
+         * Hardware counters are per thread. They are read only once
+         * per thread, b/c reading them for every query is too expensive.
+         * Thus, counts include a small overhead of creating queries.
+         */
+        unique_ptr<PerfCounters> perf;
+        if (UsePerfCounters) {
+          perf.reset(new PerfCounters());
+          perf->Start();
+        }
+
         WallClockTimer wtm;
 
         wtm.reset();
@@ -187,31 +251,66 @@ public:
             Method.Search(query.get());
             uint64_t  t2 = wtm.split();
 
-            {
-              lock_guard<mutex> g(UpdateStat);
-
-              ExpRes[MethNum]->AddDistComp(TestSetId, query->DistanceComputations());
-              ExpRes[MethNum]->AddQueryTime(TestSetId, (1.0*t2 - t1)/1e3);
-
-
-              DistCompQty[MethNum] += query->DistanceComputations();
-              avg_result_size[MethNum] += query->ResultSize();
-
-              if (query->ResultSize() > max_result_size[MethNum]) {
-                max_result_size[MethNum] = query->ResultSize();
-              }
-
-              QueryIds[QueryPart].push_back(q);
-              Queries[QueryPart].push_back(std::move(query));
+            stat.DistComp.push_back(query->DistanceComputations());
+            stat.QueryTime.push_back((1.0*t2 - t1)/1e3);
+            stat.Latency.Add(t2 - t1);
+
+            stat.DistCompQty += query->DistanceComputations();
+            stat.ResultSizeSum += query->ResultSize();
+            stat.MaxResultSize = std::max<unsigned>(stat.MaxResultSize, query->ResultSize());
+            stat.Search.Add(query->GetSearchStat());
+            if (t2 - t1 >= stat.SlowestQueryTime) {
+              stat.SlowestQueryTime = t2 - t1;
+              stat.SlowestQuerySearch = query->GetSearchStat();
             }
+
+            QueryIds[QueryPart].push_back(q);
+            Queries[QueryPart].push_back(std::move(query));
           }
         }
+
+        if (perf) {
+          perf->Stop();
+          stat.Perf = perf->Read();
+        }
+
+        ThreadStats[QueryPart] = std::move(stat);
       });
 
       wtm.split();
 
       SearchTime[MethNum] = wtm.elapsed();
 
+      LatencyHistogram latency;
+
+      for (const ThreadStat& stat : ThreadStats) {
+        for (size_t i = 0; i < stat.DistComp.size(); ++i) {
+          ExpRes[MethNum]->AddDistComp(TestSetId, stat.DistComp[i]);
+          ExpRes[MethNum]->AddQueryTime(TestSetId, stat.QueryTime[i]);
+        }
+        DistCompQty[MethNum]     += stat.DistCompQty;
+        avg_result_size[MethNum] += stat.ResultSizeSum;
+        max_result_size[MethNum] = std::max(max_result_size[MethNum], stat.MaxResultSize);
+        latency.Merge(stat.Latency);
+        Perf[MethNum].Add(stat.Perf);
+        SearchStats[MethNum].Add(stat.Search);
+        if (stat.SlowestQueryTime >= SlowestQueryTime[MethNum]) {
+          SlowestQueryTime[MethNum] = stat.SlowestQueryTime;
+          SlowestQuerySearch[MethNum] = stat.SlowestQuerySearch;
+        }
+      }
+
+      // The histogram keeps microseconds, but query times are reported in msec
+      QueryTimeP50[MethNum]  = latency.GetPercentile(50)/1e3;
+      QueryTimeP90[MethNum]  = latency.GetPercentile(90)/1e3;
+      QueryTimeP99[MethNum]  = latency.GetPercentile(99)/1e3;
+      QueryTimeP999[MethNum] = latency.GetPercentile(99.9)/1e3;
+
+      ExpRes[MethNum]->SetQueryTimeP50(TestSetId, QueryTimeP50[MethNum]);
+      ExpRes[MethNum]->SetQueryTimeP90(TestSetId, QueryTimeP90[MethNum]);
+      ExpRes[MethNum]->SetQueryTimeP99(TestSetId, QueryTimeP99[MethNum]);
+      ExpRes[MethNum]->SetQueryTimeP999(TestSetId, QueryTimeP999[MethNum]);
+
       AvgNumDistComp[MethNum] = static_cast<double>(DistCompQty[MethNum])/numquery;
       ImprDistComp[MethNum]   = config.GetDataObjects().size() / AvgNumDistComp[MethNum];
 
@@ -249,6 +348,12 @@ public:
 
         }
       }
+
+      if (OpenLoop.IsEnabled()) {
+        ExecuteOpenLoop<QueryType, QueryCreatorType>(LogInfo, ThreadTestQty, TestSetId,
+                                                     *ExpRes[MethNum], config, QueryCreator,
+                                                     Method, OpenLoop);
+      }
     }
 
     config.GetSpace().SetIndexPhase();
@@ -277,8 +382,30 @@ public:
         LOG(LIB_INFO) << ">>>> Time elapsed:           " << timeSec << " sec";
         LOG(LIB_INFO) << ">>>> # of queries per sec: : " << queryPerSec;
         LOG(LIB_INFO) << ">>>> Avg time per query:     " << (timeSec/1e3/numquery) << " msec";
+        LOG(LIB_INFO) << ">>>> Query time p50:         " << QueryTimeP50[MethNum] << " msec";
+        LOG(LIB_INFO) << ">>>> Query time p90:         " << QueryTimeP90[MethNum] << " msec";
+        LOG(LIB_INFO) << ">>>> Query time p99:         " << QueryTimeP99[MethNum] << " msec";
+        LOG(LIB_INFO) << ">>>> Query time p99.9:       " << QueryTimeP999[MethNum] << " msec";
         LOG(LIB_INFO) << ">>>> System time elapsed:    " << (SystemTimeElapsed[MethNum]/double(1e6)) << " sec";
         LOG(LIB_INFO) << "=========================================";
+        if (UsePerfCounters) {
+          if (Perf[MethNum].IsAnyValid()) {
+            LOG(LIB_INFO) << ">>>> HW counters per query:      " << Perf[MethNum].ToString(numquery);
+            if (DistCompQty[MethNum]) {
+              LOG(LIB_INFO) << ">>>> HW counters per dist. comp: " << Perf[MethNum].ToString(DistCompQty[MethNum]);
+            }
+          } else {
+            LOG(LIB_INFO) << ">>>> HW counters are not available (check /proc/sys/kernel/perf_event_paranoid)";
+          }
+          LOG(LIB_INFO) << "=========================================";
+        }
+        // Not all methods collect traversal statistics
+        if (IsSearchStatEnabled() && !SearchStats[MethNum].GetNamedValues().empty()) {
+          LOG(LIB_INFO) << ">>>> Traversal stat. per query:  " << SearchStats[MethNum].ToString(numquery);
+          LOG(LIB_INFO) << ">>>> Traversal stat. of the slowest query (" << SlowestQueryTime[MethNum]/1e3 << " msec): "
+                        << SlowestQuerySearch[MethNum].ToString(1);
+          LOG(LIB_INFO) << "=========================================";
+        }
       }
 
       // This number is adjusted for the number of threads!
@@ -311,6 +438,61 @@ public:
 
     if (LogInfo) LOG(LIB_INFO) << "#### Finished " << QueryType::Type() << " " << LibGetCurrentTime();
   }
+
+  /*
+   * Open-loop efficiency test: queries arrive according to a schedule
+   * with a given rate. It should be called after query-time parameters are set.
+   */
+  template <typename QueryType, typename QueryCreatorType>
+  static void ExecuteOpenLoop(bool LogInfo, unsigned ThreadTestQty, size_t TestSetId,
+                             MetaAnalysis&                                  ExpRes,
+                             const ExperimentConfig<dist_t>&                config,
+                             const QueryCreatorType&                        QueryCreator,
+                             IndexType&                                     Method,
+                             const OpenLoopConfig&                          OpenLoop) {
+    size_t numquery = config.GetQueryObjects().size();
+
+    vector<OpenLoopStat> stat;
+
+    for (double qps : OpenLoop.ArrivalQPS) {
+      if (LogInfo) LOG(LIB_INFO) << ">>>> Open-loop test, offered QPS: " << qps
+                                 << " arrival: " << (OpenLoop.PoissonArrival ? ARRIVAL_DIST_POISSON : ARRIVAL_DIST_FIXED);
+      /*
+       * Queries are created in advance, b/c we don't want
+       * to include the creation time into the latency.
+       */
+      vector<unique_ptr<QueryType>> Queries(numquery);
+      for (size_t q = 0; q < numquery; ++q) {
+        Queries[q].reset(QueryCreator(config.GetSpace(), config.GetQueryObjects()[q]));
+      }
+
+      vector<uint64_t> arrivalNanoSec;
+      GenArrivalSchedule(numquery, qps, OpenLoop.PoissonArrival, arrivalNanoSec);
+
+      stat.push_back(RunOpenLoop(ThreadTestQty, qps, arrivalNanoSec,
+                                 [&](size_t q) { Method.Search(Queries[q].get()); }));
+
+      const OpenLoopStat& res = stat.back();
+      ExpRes.AddOpenLoopStat(TestSetId, res);
+
+      if (LogInfo) {
+        LOG(LIB_INFO) << ">>>> Achieved QPS:           " << res.AchievedQPS;
+        LOG(LIB_INFO) << ">>>> Query time p50:         " << res.QueryTimeP50 << " msec";
+        LOG(LIB_INFO) << ">>>> Query time p90:         " << res.QueryTimeP90 << " msec";
+        LOG(LIB_INFO) << ">>>> Query time p99:         " << res.QueryTimeP99 << " msec";
+        LOG(LIB_INFO) << ">>>> Query time p99.9:       " << res.QueryTimeP999 << " msec";
+      }
+    }
+
+    int knee = FindOpenLoopKnee(stat);
+    if (LogInfo) {
+      if (knee >= 0) {
+        LOG(LIB_INFO) << ">>>> The largest sustained offered QPS: " << stat[knee].OfferedQPS;
+      } else {
+        LOG(LIB_INFO) << ">>>> None of the offered QPS values is sustained";
+      }
+    }
+  }
 };
 
 }   // namespace similarity
@@ -30,6 +30,7 @@
 #include "factory/method/list_clusters.h"
 #include "factory/method/nonmetr_list_clust.h"
 #include "factory/method/multi_index.h"
+#include "factory/method/sharded_index.h"
 #include "factory/method/multi_vantage_point_tree.h"
 #include "factory/method/perm_bin_vptree.h"
 #include "factory/method/perm_index_incr_bin.h"
@@ -171,6 +172,11 @@ inline void initMethods() {
   REGISTER_METHOD_CREATOR(double, METH_MULT_INDEX, CreateMultiIndex)
   REGISTER_METHOD_CREATOR(int,    METH_MULT_INDEX, CreateMultiIndex)
 
+  // Disjoint shards searched in parallel
+  REGISTER_METHOD_CREATOR(float,  METH_SHARDED_INDEX, CreateShardedIndex)
+  REGISTER_METHOD_CREATOR(double, METH_SHARDED_INDEX, CreateShardedIndex)
+  REGISTER_METHOD_CREATOR(int,    METH_SHARDED_INDEX, CreateShardedIndex)
+
   // Non-metric clustering
   REGISTER_METHOD_CREATOR(float,  METH_NON_METR_LISTCLUST, CreateNonMetrListClust)
   REGISTER_METHOD_CREATOR(double, METH_NON_METR_LISTCLUST, CreateNonMetrListClust)
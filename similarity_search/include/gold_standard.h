@@ -20,19 +20,24 @@
 #include <iostream>
 #include <memory>
 #include <cmath>
+#include <cstring>
 #include <thread>
+#include <queue>
 
+#include "exact_knn.h"
 #include "object.h"
 #include "query_creator.h"
 #include "space.h"
 #include "utils.h"
 #include "ztimer.h"
+#include "thread_pool.h"
 
 #define SEQ_SEARCH_TIME        "SeqSearchTime"
 #define SEQ_GS_QTY             "GoldStandQty"
 #define GS_NOTE_FIELD          "Note"
 #define GS_TEST_SET_ID         "TestSetId"
 #define GS_THREAD_TEST_QTY     "ThreadTestQty"
+#define GS_FORMAT_VERSION      "GoldStandFormat"
 
 namespace similarity {
 
@@ -42,6 +47,14 @@ using std::istream;
 using std::unique_ptr;
 using std::thread;
 using std::ref;
+using std::priority_queue;
+
+/*
+ * Version 1 of the cache keeps per-query fields in the text control file,
+ * version 2 (the compact one) keeps everything except notes in the binary file.
+ * Version 1 caches can still be read.
+ */
+const unsigned GS_CURR_FORMAT_VERSION = 2;
 
 
 template <class dist_t>
@@ -70,6 +83,19 @@ struct ResultEntry {
     out.write(reinterpret_cast<const char*>(&mLabel), sizeof mLabel);
     out.write(reinterpret_cast<const char*>(&mDist),  sizeof mDist);
   }
+  // The size of the entry in the binary format (without any padding)
+  static constexpr size_t binarySize() { return sizeof(IdType) + sizeof(LabelType) + sizeof(dist_t); }
+  // Packs the entry into a buffer of size binarySize()
+  void packBinary(char* buf) const {
+    memcpy(buf, &mId, sizeof mId);              buf += sizeof mId;
+    memcpy(buf, &mLabel, sizeof mLabel);        buf += sizeof mLabel;
+    memcpy(buf, &mDist, sizeof mDist);
+  }
+  void unpackBinary(const char* buf) {
+    memcpy(&mId, buf, sizeof mId);              buf += sizeof mId;
+    memcpy(&mLabel, buf, sizeof mLabel);        buf += sizeof mLabel;
+    memcpy(&mDist, buf, sizeof mDist);
+  }
   bool operator<(const ResultEntry& o) const {
     if (mDist != o.mDist) return mDist < o.mDist;
     return mId < o.mId;
@@ -96,40 +122,64 @@ template <class dist_t>
 class GoldStandard {
 public:
   GoldStandard(){}
+  /*
+   * If maxKeepEntryCoeff is non-zero, we keep only round(maxKeepEntryCoeff * result set size)
+   * closest entries: they are selected via nth_element, so that only the selected entries
+   * need to be sorted.
+   */
   GoldStandard(const typename similarity::Space<dist_t>& space,
               const ObjectVector& datapoints,
               typename similarity::Query<dist_t>* query,
               float maxKeepEntryCoeff
               ) {
-    DoSeqSearch(space, datapoints, query);
-    size_t maxKeepEntryQty =
-        std::min((size_t)std::round(query->ResultSize()*maxKeepEntryCoeff),
-                 SortedAllEntries_.size());
-
-    if (maxKeepEntryQty != 0) {
-      CHECK(maxKeepEntryQty <= SortedAllEntries_.size())
-      vector<ResultEntry<dist_t>>         tmp(SortedAllEntries_.begin(),
-                                              SortedAllEntries_.begin() + maxKeepEntryQty);
-      /* 
-       * The swap trick actually leads to memory being freed.
-       * If we simply erase the extra entries, vector still keeps the memory!
-       */
-      SortedAllEntries_.swap(tmp);
-    }
+    DoSeqSearch(space, datapoints, query, maxKeepEntryCoeff);
   }
   /*
-   * See the endianness comment.
+   * Creates a gold standard entry from already sorted entries,
+   * the vector sortedEntries is swapped with the internal one.
    */
-  void Write(ostream& controlStream, ostream& binaryStream) const {
+  GoldStandard(uint64_t seqSearchTime, vector<ResultEntry<dist_t>>& sortedEntries) : 
+              SeqSearchTime_(seqSearchTime) {
+    SortedAllEntries_.swap(sortedEntries);
+  }
+  /*
+   * Writes the data in the compact format, see the endianness comment.
+   */
+  void Write(ostream& binaryStream) const {
+    const size_t entrySize = ResultEntry<dist_t>::binarySize();
 
-    WriteField(controlStream, SEQ_SEARCH_TIME, ConvertToString(SeqSearchTime_));
-    WriteField(controlStream, SEQ_GS_QTY, ConvertToString(SortedAllEntries_.size()));
+    writeBinaryPOD(binaryStream, SeqSearchTime_);
+    writeBinaryPOD(binaryStream, static_cast<uint64_t>(SortedAllEntries_.size()));
+
+    vector<char> buf(entrySize * SortedAllEntries_.size());
     for (size_t i = 0; i < SortedAllEntries_.size(); ++i) {
-      SortedAllEntries_[i].writeBinary(binaryStream);
+      SortedAllEntries_[i].packBinary(&buf[i * entrySize]);
     }
+    if (!buf.empty()) binaryStream.write(&buf[0], buf.size());
   }
 
-  void Read(istream& controlStream, istream& binaryStream) {
+  void Read(istream& binaryStream) {
+    const size_t entrySize = ResultEntry<dist_t>::binarySize();
+
+    uint64_t qty = 0;
+    readBinaryPOD(binaryStream, SeqSearchTime_);
+    readBinaryPOD(binaryStream, qty);
+
+    vector<char> buf(entrySize * qty);
+    if (!buf.empty() && !binaryStream.read(&buf[0], buf.size())) {
+      throw runtime_error("Error reading gold standard entries, perhaps, the cache file is truncated");
+    }
+    SortedAllEntries_.resize(qty);
+    for (size_t i = 0; i < qty; ++i) {
+      SortedAllEntries_[i].unpackBinary(&buf[i * entrySize]);
+    }
+  }
+
+  /*
+   * Reads the data in the old format (version 1), where per-query
+   * fields are stored in the control file.
+   */
+  void ReadV1(istream& controlStream, istream& binaryStream) {
     string s;
     ReadField(controlStream, SEQ_SEARCH_TIME, s);
     ConvertFromString(s, SeqSearchTime_);
@@ -143,14 +193,15 @@ public:
   uint64_t GetSeqSearchTime()     const { return SeqSearchTime_; }
 
   /*
-   * SortedAllEntries_ include all database entries sorted in the order
-   * of increasing distance from the query.
+   * SortedAllEntries_ include all (or maxKeepEntryCoeff * result set size)
+   * database entries sorted in the order of increasing distance from the query.
    */
   const vector<ResultEntry<dist_t>>&   GetSortedEntries() const { return  SortedAllEntries_;}
 private:
   void DoSeqSearch(const Space<dist_t>& space,
                    const ObjectVector&  datapoints,
-                   typename similarity::Query<dist_t>* pQuery) {
+                   typename similarity::Query<dist_t>* pQuery,
+                   float maxKeepEntryCoeff) {
     WallClockTimer  wtm;
 
     wtm.reset();
@@ -170,7 +221,25 @@ private:
 
     SeqSearchTime_ = wtm.elapsed();
 
-    std::sort(SortedAllEntries_.begin(), SortedAllEntries_.end());
+    size_t maxKeepEntryQty =
+        std::min((size_t)std::round(pQuery->ResultSize()*maxKeepEntryCoeff),
+                 SortedAllEntries_.size());
+
+    if (maxKeepEntryQty != 0) {
+      // Entries are compared by the distance and the id, so the set of selected entries is the same as after a full sort
+      std::nth_element(SortedAllEntries_.begin(), SortedAllEntries_.begin() + maxKeepEntryQty - 1,
+                       SortedAllEntries_.end());
+      std::sort(SortedAllEntries_.begin(), SortedAllEntries_.begin() + maxKeepEntryQty);
+      vector<ResultEntry<dist_t>>         tmp(SortedAllEntries_.begin(),
+                                              SortedAllEntries_.begin() + maxKeepEntryQty);
+      /* 
+       * The swap trick actually leads to memory being freed.
+       * If we simply erase the extra entries, vector still keeps the memory!
+       */
+      SortedAllEntries_.swap(tmp);
+    } else {
+      std::sort(SortedAllEntries_.begin(), SortedAllEntries_.end());
+    }
   }
 
   uint64_t                            SeqSearchTime_;
@@ -178,48 +247,43 @@ private:
   vector<ResultEntry<dist_t>>         SortedAllEntries_;
 };
 
-template <typename dist_t, typename QueryCreatorType>
-struct GoldStandardThreadParams {
-  const ExperimentConfig<dist_t>&             config_;
-  const QueryCreatorType&                     QueryCreator_;
-  float                                       maxKeepEntryCoeff_;
-  const unsigned                              ThreadQty_;
-  const unsigned                              GoldStandPart_;
-  vector<unique_ptr<GoldStandard<dist_t>>>&   vGoldStand_;
-  GoldStandardThreadParams(const ExperimentConfig<dist_t>& config,
-                           const QueryCreatorType& QueryCreator,
-                           float maxKeepEntryCoeff,
-                           unsigned ThreadQty,
-                           unsigned GoldStandPart,
-                           vector<unique_ptr<GoldStandard<dist_t>>>& vGoldStand) : config_(config),
-                                                                                   QueryCreator_(QueryCreator),
-                                                                                   maxKeepEntryCoeff_(maxKeepEntryCoeff),
-                                                                                   ThreadQty_(ThreadQty),
-                                                                                   GoldStandPart_(GoldStandPart),
-                                                                                   vGoldStand_(vGoldStand) {}
-};
-
-template <typename dist_t, typename QueryCreatorType>
-struct GoldStandardThread {
-  void operator ()(GoldStandardThreadParams<dist_t,QueryCreatorType>& prm) {
-    size_t numquery = prm.config_.GetQueryObjects().size();
-
-    unsigned GoldStandPart = prm.GoldStandPart_;
-    unsigned ThreadQty = prm.ThreadQty_;
-
-    for (size_t q = 0; q < numquery; ++q) {
-      if ((q % ThreadQty) == GoldStandPart) {
-        unique_ptr<Query<dist_t>> query(prm.QueryCreator_(prm.config_.GetSpace(),
-                                                          prm.config_.GetQueryObjects()[q]));
-
-        prm.vGoldStand_[q].reset(new GoldStandard<dist_t>(prm.config_.GetSpace(),
-                                                          prm.config_.GetDataObjects(),
-                                                          query.get(),
-                                                          prm.maxKeepEntryCoeff_));
-      }
-    }
+/*
+ * Computes gold standard entries for a block of queries (with indices
+ * from queryStart to queryEnd) keeping only keepQty closest entries 
+ * per query (see ComputeExactKNNBlock). Ties are broken using object ids.
+ * Note that the sequential search time is amortized over the block.
+ */
+template <class dist_t>
+void ComputeGoldStandardBlock(const Space<dist_t>&                      space,
+                              const ObjectVector&                       datapoints,
+                              const ObjectVector&                       queries,
+                              size_t                                    queryStart,
+                              size_t                                    queryEnd,
+                              size_t                                    keepQty,
+                              vector<unique_ptr<GoldStandard<dist_t>>>& vGoldStand) {
+  CHECK(keepQty > 0);
+  CHECK(queryStart < queryEnd && queryEnd <= queries.size());
+
+  WallClockTimer  wtm;
+
+  wtm.reset();
+
+  size_t blockQty = queryEnd - queryStart;
+  vector<vector<ResultEntry<dist_t>>> blockEntries;
+  ComputeExactKNNBlock(space, datapoints, queries, queryStart, queryEnd, keepQty, nullptr,
+                       [&](size_t i, dist_t dist) {
+                         const Object* pObj = datapoints[i];
+                         return ResultEntry<dist_t>(pObj->id(), pObj->label(), dist);
+                       }, blockEntries);
+
+  wtm.split();
+
+  uint64_t seqSearchTime = wtm.elapsed() / blockQty;
+
+  for (size_t qi = 0; qi < blockQty; ++qi) {
+    vGoldStand[queryStart + qi].reset(new GoldStandard<dist_t>(seqSearchTime, blockEntries[qi]));
   }
-};
+}
 
 template <class dist_t>
 class GoldStandardManager {
@@ -233,6 +297,8 @@ public:
   void Compute(size_t threadQty, float maxKeepEntryCoeff) {
     threadQty = std::max(size_t(1), threadQty);
     LOG(LIB_INFO) << "Computing gold standard data using " << threadQty << " threads, keeping " << maxKeepEntryCoeff<< "x entries compared to the result set size";;
+    WallClockTimer wtm;
+    wtm.reset();
     for (size_t i = 0; i < config_.GetRange().size(); ++i) {
       vvGoldStandardRange_[i].clear();
       const dist_t radius = config_.GetRange()[i];
@@ -245,6 +311,8 @@ public:
       KNNCreator<dist_t>  cr(K, config_.GetEPS());
       procOneSet(cr, vvGoldStandardKNN_[i], threadQty, maxKeepEntryCoeff);
     }
+    wtm.split();
+    LOG(LIB_INFO) << "Gold standard data is computed in " << wtm.elapsed()/1e6 << " sec";
   }
   void Read(istream& controlStream, istream& binaryStream,
             size_t queryQty,
@@ -252,38 +320,62 @@ public:
             size_t& savedThreadQty) {
     LOG(LIB_INFO) << "Reading gold standard data from cache";
     string s;
-    ReadField(controlStream, GS_TEST_SET_ID, s);
-    ConvertFromString(s, testSetId);
+    /*
+     * Old caches (format version 1) don't have the version field 
+     * and start with the test set id.
+     */
+    unsigned formatVersion = 1;
+    {
+      if (!getline(controlStream, s)) throw runtime_error("Error reading a field value");
+      string::size_type p = s.find(FIELD_DELIMITER);
+      if (string::npos == p)
+        throw runtime_error("Wrong field format, no delimiter: '" + s + "'");
+      string fieldName = s.substr(0, p);
+      if (fieldName == GS_FORMAT_VERSION) {
+        ConvertFromString(s.substr(p + 1), formatVersion);
+        if (formatVersion > GS_CURR_FORMAT_VERSION) {
+          throw runtime_error("Unsupported version of the gold standard cache: " + ConvertToString(formatVersion));
+        }
+        ReadField(controlStream, GS_TEST_SET_ID, s);
+        ConvertFromString(s, testSetId);
+      } else if (fieldName == GS_TEST_SET_ID) {
+        ConvertFromString(s.substr(p + 1), testSetId);
+      } else {
+        throw runtime_error("Expected field '" + string(GS_FORMAT_VERSION) + "' or '" + GS_TEST_SET_ID + 
+                            "' but got: '" + fieldName + "'");
+      }
+    }
     ReadField(controlStream, GS_THREAD_TEST_QTY, savedThreadQty);
     for (size_t i = 0; i < vvGoldStandardRange_.size(); ++i) {
       ReadField(controlStream, GS_NOTE_FIELD, s);
       vvGoldStandardRange_[i].clear();
-      readOneGS(controlStream, binaryStream,
+      readOneGS(controlStream, binaryStream, formatVersion,
                 queryQty, vvGoldStandardRange_[i]);
     }
     for (size_t i = 0; i < vvGoldStandardKNN_.size(); ++i) {
       ReadField(controlStream, GS_NOTE_FIELD, s);
       vvGoldStandardKNN_[i].clear();
-      readOneGS(controlStream, binaryStream,
+      readOneGS(controlStream, binaryStream, formatVersion,
                 queryQty, vvGoldStandardKNN_[i]);
     }
   }
   void Write(ostream& controlStream, ostream& binaryStream,
              size_t testSetId, size_t threadTestQty) {
+    WriteField(controlStream, GS_FORMAT_VERSION, GS_CURR_FORMAT_VERSION);
     WriteField(controlStream, GS_TEST_SET_ID, ConvertToString(testSetId));
     WriteField(controlStream,GS_THREAD_TEST_QTY, threadTestQty);
     // GS_NOTE_FIELD & GS_TEST_SET_ID are for informational purposes only
     for (size_t i = 0; i < vvGoldStandardRange_.size(); ++i) {
       WriteField(controlStream, GS_NOTE_FIELD,
                 "range radius=" + ConvertToString(config_.GetRange()[i]));
-      writeOneGS(controlStream, binaryStream,
+      writeOneGS(binaryStream,
                  vvGoldStandardRange_[i]);
     }
     for (size_t i = 0; i < vvGoldStandardKNN_.size(); ++i) {
       WriteField(controlStream, GS_NOTE_FIELD,
                 "k=" + ConvertToString(config_.GetKNN()[i]) +
                 "eps=" + ConvertToString(config_.GetEPS()));
-      writeOneGS(controlStream, binaryStream,
+      writeOneGS(binaryStream,
                  vvGoldStandardKNN_[i]);
     }
   }
@@ -298,56 +390,66 @@ private:
   vector<vector<unique_ptr<GoldStandard<dist_t>>>>    vvGoldStandardRange_;
   vector<vector<unique_ptr<GoldStandard<dist_t>>>>    vvGoldStandardKNN_;
 
-  void writeOneGS(ostream& controlStream, ostream& binaryStream,
+  void writeOneGS(ostream& binaryStream,
                   const vector<unique_ptr<GoldStandard<dist_t>>>& oneGS) {
     for(const unique_ptr<GoldStandard<dist_t>>& obj : oneGS) {
-      obj->Write(controlStream, binaryStream);
+      obj->Write(binaryStream);
     }
   }
 
   void readOneGS(istream& controlStream, istream& binaryStream,
+                 unsigned formatVersion,
                  size_t queryQty,
                  vector<unique_ptr<GoldStandard<dist_t>>>& oneGS) {
     oneGS.resize(queryQty);
     for (size_t k = 0; k < queryQty; ++k) {
       unique_ptr<GoldStandard<dist_t>>  gs(new GoldStandard<dist_t>());
-      gs->Read(controlStream, binaryStream);
+      if (formatVersion == 1) {
+        gs->ReadV1(controlStream, binaryStream);
+      } else {
+        gs->Read(binaryStream);
+      }
       oneGS[k].reset(gs.release());
     }
   }
 
+  /*
+   * Queries (or blocks of queries) are assigned to threads dynamically.
+   * If only a limited number of entries is kept and this number is known
+   * in advance (k-NN search), we use a cache-friendly blocked computation
+   * with bounded heaps. Otherwise, all distances for a query are computed and
+   * the closest entries are selected afterwards.
+   */
   template <typename QueryCreatorType>
   void procOneSet(const QueryCreatorType&                   QueryCreator,
                   vector<unique_ptr<GoldStandard<dist_t>>>& vGoldStand,
                   size_t                                    threadQty,
                   float                                     maxKeepEntryCoeff) {
-    size_t queryQty = config_.GetQueryObjects().size();
+    const ObjectVector& queries    = config_.GetQueryObjects();
+    const ObjectVector& datapoints = config_.GetDataObjects();
+    size_t queryQty = queries.size();
     vGoldStand.resize(queryQty);
 
-    vector<unique_ptr<GoldStandardThreadParams<dist_t,QueryCreatorType>>> GoldStandParams(threadQty);
-
-    for (unsigned GoldPart = 0; GoldPart < threadQty; ++GoldPart) {
-      GoldStandParams[GoldPart].reset(
-          new GoldStandardThreadParams<dist_t, QueryCreatorType>(config_,
-                                                                 QueryCreator,
-                                                                 maxKeepEntryCoeff,
-                                                                 threadQty,
-                                                                 GoldPart,
-                                                                 vGoldStand));
-    }
-
-    if (threadQty == 1) {
-      GoldStandardThread<dist_t, QueryCreatorType>()(*GoldStandParams[0]);
+    size_t maxResultQty = std::min(QueryCreator.MaxResultQty(), datapoints.size());
+    size_t keepQty = std::min((size_t)std::round(maxResultQty * maxKeepEntryCoeff), datapoints.size());
+
+    if (keepQty > 0) {
+      size_t blockQty = (queryQty + EXACT_KNN_QUERY_BLOCK_QTY - 1) / EXACT_KNN_QUERY_BLOCK_QTY;
+      ParallelFor(0, blockQty, threadQty, [&](size_t blockId) {
+        size_t queryStart = blockId * EXACT_KNN_QUERY_BLOCK_QTY;
+        size_t queryEnd   = std::min(queryQty, queryStart + EXACT_KNN_QUERY_BLOCK_QTY);
+        ComputeGoldStandardBlock(config_.GetSpace(), datapoints, queries,
+                                 queryStart, queryEnd, keepQty, vGoldStand);
+      });
     } else {
-      vector<thread> Threads(threadQty);
-
-      for (unsigned GoldPart = 0; GoldPart < threadQty; ++GoldPart) {
-        Threads[GoldPart] = thread(GoldStandardThread<dist_t,QueryCreatorType>(),ref(*GoldStandParams[GoldPart]));
-      }
-
-      for (unsigned GoldPart = 0; GoldPart < threadQty; ++GoldPart) {
-        Threads[GoldPart].join();
-      }
+      ParallelFor(0, queryQty, threadQty, [&](size_t q) {
+        unique_ptr<Query<dist_t>> query(QueryCreator(config_.GetSpace(), queries[q]));
+
+        vGoldStand[q].reset(new GoldStandard<dist_t>(config_.GetSpace(),
+                                                     datapoints,
+                                                     query.get(),
+                                                     maxKeepEntryCoeff));
+      });
     }
   }
 };
@@ -21,6 +21,7 @@
 
 #include "params.h"
 #include "object.h"
+#include "build_profile.h"
 
 namespace similarity {
 
@@ -61,6 +62,13 @@ public:
   virtual void LoadIndex(const string& location) {
     throw runtime_error("LoadIndex is not implemented for method: " + StrDesc());
   }
+  /*
+   * Loads the index memory mapping read-only parts of the file where the method
+   * supports this, so that processes loading the same file share one physical copy.
+   * The file must not be modified while the index is used (but it can be deleted).
+   * By default, this is the same as LoadIndex.
+   */
+  virtual void LoadIndexMapped(const string& location) { LoadIndex(location); }
   virtual ~Index() {}
   /*
    * There are two type of search methods: a range search and a k-Nearest Neighbor search.
@@ -99,8 +107,16 @@ public:
   }
 
   virtual size_t GetSize() const { return data_.size(); }
+
+  /*
+   * Phase timings, memory usage, and insertion throughput
+   * recorded by the last CreateIndex call (only some methods
+   * record phases, for the remaining ones the profile is empty).
+   */
+  const BuildProfiler& GetBuildProfile() const { return buildProfiler_; }
 protected:
   const ObjectVector& data_;
+  BuildProfiler       buildProfiler_;
 
 private:
   template <typename QueryType>
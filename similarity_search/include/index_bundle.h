@@ -0,0 +1,140 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#ifndef _INDEX_BUNDLE_H_
+#define _INDEX_BUNDLE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "global.h"
+#include "index.h"
+#include "methodfactory.h"
+#include "mmap_file.h"
+#include "params.h"
+#include "spacefactory.h"
+
+namespace similarity {
+
+using std::string;
+using std::vector;
+
+/*
+ * A self-contained index: a bundle file keeps everything that is needed to
+ * bring the index up without re-reading the data set, namely, the space description,
+ * the method name, the data points, and their external IDs. The index itself
+ * is saved by the method to the file GetIndexFileName(location).
+ *
+ * The bundle file is memory mapped and loaded objects point to the mapped
+ * data (nothing is parsed or copied). The file has a header, which is followed
+ * by sections starting at 16-byte boundaries:
+ * 1) the description: the distance type, the space type, the method name, and
+ *    space parameters (one name=value per line);
+ * 2) qty+1 64-bit offsets of objects in the object arena;
+ * 3) the object arena: buffers of objects, each one is 16-byte aligned;
+ * 4) qty+1 64-bit offsets of external IDs followed by their characters.
+ */
+struct IndexBundleFileHeader {
+  char      magic[8];
+  uint32_t  version;
+  uint32_t  idSize;
+  uint64_t  objQty;
+  uint64_t  descSize;
+  uint64_t  arenaSize;
+  uint64_t  externIdSize;
+};
+
+class IndexBundle {
+public:
+  // Saves the bundle and the index, externIds should have an entry for each data point
+  template <typename dist_t>
+  static void Save(const string& location,
+                   const string& spaceType, const AnyParams& spaceParams,
+                   const string& methodName,
+                   const ObjectVector& data, const vector<string>& externIds,
+                   Index<dist_t>& index) {
+    // the index is replaced atomically, because other processes can have the old one mapped
+    string tmpIndexLocation = GetTempFileNameForAtomicWrite(GetIndexFileName(location));
+    index.SaveIndex(tmpIndexLocation);
+    CommitAtomicWrite(tmpIndexLocation, GetIndexFileName(location));
+    SaveData(location, DistTypeName<dist_t>(), spaceType, spaceParams, methodName, data, externIds);
+  }
+  // Saves everything except the index
+  static void SaveData(const string& location,
+                       const string& distType,
+                       const string& spaceType, const AnyParams& spaceParams,
+                       const string& methodName,
+                       const ObjectVector& data, const vector<string>& externIds);
+
+  static string GetIndexFileName(const string& location) { return location + ".index"; }
+  // Checks the magic number only
+  static bool IsBundle(const string& location);
+
+  // Maps the file, it should not be modified while the bundle (or objects it created) are used
+  explicit IndexBundle(const string& location);
+
+  const string&     GetDistType() const { return distType_; }
+  const string&     GetSpaceType() const { return spaceType_; }
+  const AnyParams&  GetSpaceParams() const { return spaceParams_; }
+  const string&     GetMethodName() const { return methodName_; }
+  size_t            size() const { return qty_; }
+
+  /*
+   * Creates objects pointing to the mapped file: the caller deletes them,
+   * but the bundle should outlive them.
+   */
+  void ReadData(ObjectVector& data, vector<string>& externIds) const;
+
+  template <typename dist_t>
+  Space<dist_t>* CreateSpace() const {
+    checkDistType(DistTypeName<dist_t>());
+    return SpaceFactoryRegistry<dist_t>::Instance().CreateSpace(spaceType_, spaceParams_);
+  }
+  /*
+   * Creates the method for the data obtained via ReadData and loads its index.
+   * Methods that support it (e.g., HNSW with the optimized index) map the index file,
+   * so processes loading the same bundle share the data and the index.
+   */
+  template <typename dist_t>
+  Index<dist_t>* LoadIndex(bool printProgress, Space<dist_t>& space, const ObjectVector& data) const {
+    checkDistType(DistTypeName<dist_t>());
+    std::unique_ptr<Index<dist_t>> index(MethodFactoryRegistry<dist_t>::Instance().
+                                         CreateMethod(printProgress, methodName_, spaceType_, space, data));
+    index->LoadIndexMapped(GetIndexFileName(location_));
+    return index.release();
+  }
+
+private:
+  void checkDistType(const string& distType) const;
+
+  string            location_;
+  MappedFile        file_;
+  size_t            qty_;
+  string            distType_;
+  string            spaceType_;
+  AnyParams         spaceParams_;
+  string            methodName_;
+  const uint64_t*   objOffsets_;
+  const char*       arena_;
+  const uint64_t*   externIdOffsets_;
+  const char*       externIdChars_;
+
+  DISABLE_COPY_AND_ASSIGN(IndexBundle);
+};
+
+}   // namespace similarity
+
+#endif      // _INDEX_BUNDLE_H_
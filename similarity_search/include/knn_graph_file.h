@@ -0,0 +1,69 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#ifndef _KNN_GRAPH_FILE_H_
+#define _KNN_GRAPH_FILE_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "object.h"
+
+namespace similarity {
+
+/*
+ * A binary file with an (approximate) k-NN graph. Such files are created by NN-descent
+ * and can be used to bootstrap other graph-based indices. The file starts with this
+ * header, which is followed by nodeQty node records. Each record contains the object id
+ * and NN neighbors, which are (node index, distance) pairs. Node indices refer to record
+ * numbers in the file and are KNN_GRAPH_EMPTY_KEY for empty slots.
+ */
+struct KNNGraphFileHeader {
+  char      magic[8];
+  uint32_t  version;
+  uint32_t  idSize;
+  uint64_t  nodeQty;
+  uint64_t  NN;
+};
+
+struct KNNGraphEntry {
+  int32_t   key;
+  float     dist;
+};
+
+const int32_t KNN_GRAPH_EMPTY_KEY = -1;
+
+/*
+ * Writes the graph whose nodes are data points. getNeighbors(i, entries) fills
+ * NN entries with neighbors of the i-th data point (keys are indices in data).
+ */
+void WriteKNNGraph(const std::string& location, const ObjectVector& data, size_t NN,
+                   const std::function<void(size_t, KNNGraphEntry*)>& getNeighbors);
+
+/*
+ * Reads the graph and maps its nodes to data points: graph[i] receives neighbors
+ * of the i-th data point (keys are indices in data, empty slots are skipped).
+ * Typically, the i-th node represents the i-th data point, otherwise, data points
+ * are found by object ids. Nodes missing from the data set and links to them are dropped.
+ * In the strict mode, the graph must have exactly the same points as the data set.
+ * Returns the maximum number of neighbors per node (NN).
+ */
+size_t ReadKNNGraph(const std::string& location, const ObjectVector& data, bool strict,
+                    std::vector<std::vector<KNNGraphEntry>>& graph);
+
+}   // namespace similarity
+
+#endif      // _KNN_GRAPH_FILE_H_
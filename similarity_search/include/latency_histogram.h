@@ -0,0 +1,134 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#ifndef _LATENCY_HISTOGRAM_H
+#define _LATENCY_HISTOGRAM_H
+
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+namespace similarity {
+
+using std::vector;
+
+/*
+ * A compact HDR-style (high dynamic range) histogram of integer values,
+ * e.g., query latencies in microseconds.
+ *
+ * Values below 2*kSubBucketHalf are recorded exactly. Larger values
+ * are recorded in log-linear buckets: each power-of-two range is split
+ * into kSubBucketHalf equal sub-buckets. With kSubBucketHalf=1024
+ * the relative error of a reported value is less than 0.1%
+ * (i.e., three significant decimal digits are preserved).
+ *
+ * Recording a value is O(1), the memory footprint grows only with
+ * the logarithm of the largest recorded value. Histograms collected
+ * by different threads can be merged without any loss of precision.
+ * The class itself is NOT thread-safe.
+ */
+class LatencyHistogram {
+public:
+  LatencyHistogram() : totalQty_(0), sum_(0),
+                       minVal_(std::numeric_limits<uint64_t>::max()), maxVal_(0) {}
+
+  void Add(uint64_t val) {
+    size_t indx = ValToIndex(val);
+    if (indx >= counts_.size()) counts_.resize(indx + 1);
+    counts_[indx]++;
+    totalQty_++;
+    sum_ += val;
+    minVal_ = std::min(minVal_, val);
+    maxVal_ = std::max(maxVal_, val);
+  }
+
+  void Merge(const LatencyHistogram& other) {
+    if (other.counts_.size() > counts_.size()) counts_.resize(other.counts_.size());
+    for (size_t i = 0; i < other.counts_.size(); ++i) {
+      counts_[i] += other.counts_[i];
+    }
+    totalQty_ += other.totalQty_;
+    sum_      += other.sum_;
+    minVal_ = std::min(minVal_, other.minVal_);
+    maxVal_ = std::max(maxVal_, other.maxVal_);
+  }
+
+  void Reset() {
+    counts_.clear();
+    totalQty_ = 0;
+    sum_      = 0;
+    minVal_   = std::numeric_limits<uint64_t>::max();
+    maxVal_   = 0;
+  }
+
+  uint64_t GetQty() const { return totalQty_; }
+  uint64_t GetMin() const { return totalQty_ ? minVal_ : 0; }
+  uint64_t GetMax() const { return maxVal_; }
+  double   GetMean() const { return totalQty_ ? double(sum_) / totalQty_ : 0; }
+
+  /*
+   * Returns the smallest recorded value v (up to the bucket precision)
+   * such that at least perc percent of all values are <= v.
+   * The percentile should be in the range [0, 100].
+   */
+  uint64_t GetPercentile(double perc) const {
+    if (!totalQty_) return 0;
+    perc = std::min(100.0, std::max(0.0, perc));
+    // A small epsilon prevents, e.g., 99.9% of 1000 from being rounded up to 1000
+    uint64_t target = static_cast<uint64_t>(std::ceil(perc * totalQty_ / 100.0 - 1e-9));
+    if (target == 0) target = 1;
+
+    uint64_t cumQty = 0;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+      cumQty += counts_[i];
+      if (cumQty >= target) {
+        // Don't report values beyond the actual maximum
+        return std::min(maxVal_, HighestEquivVal(i));
+      }
+    }
+    return maxVal_;
+  }
+
+private:
+  static const unsigned kSubBucketHalfBits = 10;
+  static const uint64_t kSubBucketHalf = uint64_t(1) << kSubBucketHalfBits;
+
+  static size_t ValToIndex(uint64_t val) {
+    if (val < 2 * kSubBucketHalf) return static_cast<size_t>(val);
+    unsigned msb = 0;
+    for (uint64_t tmp = val; tmp >>= 1;) ++msb;
+    // After the shift the value is in the range [kSubBucketHalf, 2*kSubBucketHalf)
+    unsigned shift = msb - kSubBucketHalfBits;
+    return static_cast<size_t>(shift * kSubBucketHalf + (val >> shift));
+  }
+
+  static uint64_t HighestEquivVal(size_t indx) {
+    if (indx < 2 * kSubBucketHalf) return indx;
+    unsigned shift = static_cast<unsigned>(indx / kSubBucketHalf) - 1;
+    uint64_t sub = indx - shift * kSubBucketHalf;
+    return ((sub + 1) << shift) - 1;
+  }
+
+  vector<uint64_t>  counts_;
+  uint64_t          totalQty_;
+  uint64_t          sum_;
+  uint64_t          minVal_;
+  uint64_t          maxVal_;
+};
+
+}   // namespace similarity
+
+#endif
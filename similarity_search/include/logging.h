@@ -15,6 +15,7 @@
 #ifndef _LOGGING_H_
 #define _LOGGING_H_
 
+#include <atomic>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -45,11 +46,34 @@ class Logger {
                    int line,
                    const char * function,
                    const std::string & message) = 0;
+  // Waits till all previously logged messages are written (used by buffering loggers)
+  virtual void flush() {}
 };
 
 void setGlobalLogger(Logger * logger);
 Logger * getGlobalLogger();
 
+/*
+ * Messages with severity below the threshold are discarded before
+ * they are formatted (fatal messages are never discarded).
+ * The default threshold is LIB_DEBUG, i.e., everything is logged.
+ */
+void setLogSeverityThreshold(LogSeverity severity);
+
+extern std::atomic<int> gLogSeverityThreshold;
+
+inline bool IsLogEnabled(LogSeverity severity) {
+  return severity == LIB_FATAL ||
+         (severity >= gLogSeverityThreshold.load(std::memory_order_relaxed) &&
+          getGlobalLogger() != NULL);
+}
+
+/*
+ * Wraps the current global logger into an AsyncLogger (see async_logger.h),
+ * so that logging threads never wait for the output to be written.
+ */
+void EnableAsyncLogging();
+
 class StdErrLogger
   : public Logger {
  public:
@@ -94,6 +118,7 @@ class LogItem {
     // TODO: probably better to throw an exception here rather than die outright
     // but this matches previous behaviour
     if (severity == LIB_FATAL) {
+      if (logger) logger->flush();
       exit(1);
     }
   }
@@ -116,9 +141,19 @@ class RuntimeErrorWrapper {
   stringstream currstrm_;
 };
 
-// TODO: zero cost log abstraction
+// Turns the LOG expression into void, so that it can be used in the conditional operator
+class LogVoidify {
+ public:
+  void operator&(const LogItem&) {}
+};
+
+/*
+ * If the message is filtered out (or there's no logger), the LogItem is
+ * never created, so the arguments of operator<< aren't even evaluated.
+ */
 #define LOG(severity) \
-  LogItem(severity, __FILE__, __LINE__, __FUNCTION__, getGlobalLogger())
+  !IsLogEnabled(severity) ? (void)0 : \
+  LogVoidify() & LogItem(severity, __FILE__, __LINE__, __FUNCTION__, getGlobalLogger())
 
 #define CHECK(condition) \
   if (!(condition)) {\
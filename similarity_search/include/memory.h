@@ -25,9 +25,19 @@ class MemUsage {
       the process with pid in MB **/
   double get_vmsize();
 
+  /** returns the current resident set size of
+      the process in MB **/
+  double get_rss();
+
+  /** returns the peak resident set size (the high-water mark)
+      of the process in MB **/
+  double get_peak_rss();
+
  private:
 #ifdef __linux
   char status_file_[50];
+
+  double read_status_field(const char* fieldName);
 #endif
 };
 
@@ -19,6 +19,7 @@
 #include <string>
 
 #include "utils.h"
+#include "open_loop.h"
 
 namespace similarity {
 
@@ -46,6 +47,11 @@ public:
     LoadTime_       .resize(TestSetQty);
     SaveTime_       .resize(TestSetQty);
     QueryPerSec_    .resize(TestSetQty);
+    QueryTimeP50_   .resize(TestSetQty);
+    QueryTimeP90_   .resize(TestSetQty);
+    QueryTimeP99_   .resize(TestSetQty);
+    QueryTimeP999_  .resize(TestSetQty);
+    OpenLoop_       .resize(TestSetQty);
   }
 
   // Let's protect Add* functions, b/c them can be called from different threads  
@@ -94,6 +100,23 @@ public:
   void SetImprDistComp(size_t SetId, double ImprDistComp) {
     ImprDistComp_[SetId] = ImprDistComp;
   }
+  // Query time percentiles (in msec) are computed over all queries of a test set
+  void SetQueryTimeP50(size_t SetId, double QueryTimeP50) {
+    QueryTimeP50_[SetId] = QueryTimeP50;
+  }
+  void SetQueryTimeP90(size_t SetId, double QueryTimeP90) {
+    QueryTimeP90_[SetId] = QueryTimeP90;
+  }
+  void SetQueryTimeP99(size_t SetId, double QueryTimeP99) {
+    QueryTimeP99_[SetId] = QueryTimeP99;
+  }
+  void SetQueryTimeP999(size_t SetId, double QueryTimeP999) {
+    QueryTimeP999_[SetId] = QueryTimeP999;
+  }
+  // Open-loop stats should be added in the order of increasing offered QPS
+  void AddOpenLoopStat(size_t SetId, const OpenLoopStat& stat) {
+    OpenLoop_[SetId].push_back(stat);
+  }
 
   void ComputeAll() {
     ComputeOneSimple("Recall", Recall_, RecallAvg, RecallConfMin, RecallConfMax);
@@ -112,6 +135,10 @@ public:
     ComputeOneSimple("LoadTime", LoadTime_, LoadTimeAvg, LoadTimeConfMin, LoadTimeConfMax);
     ComputeOneSimple("SaveTime", SaveTime_, SaveTimeAvg, SaveTimeConfMin, SaveTimeConfMax);
     ComputeOneSimple("QueryPerSec", QueryPerSec_, QueryPerSecAvg, QueryPerSecConfMin, QueryPerSecConfMax);
+    ComputeOneSimple("QueryTimeP50", QueryTimeP50_, QueryTimeP50Avg, QueryTimeP50ConfMin, QueryTimeP50ConfMax);
+    ComputeOneSimple("QueryTimeP90", QueryTimeP90_, QueryTimeP90Avg, QueryTimeP90ConfMin, QueryTimeP90ConfMax);
+    ComputeOneSimple("QueryTimeP99", QueryTimeP99_, QueryTimeP99Avg, QueryTimeP99ConfMin, QueryTimeP99ConfMax);
+    ComputeOneSimple("QueryTimeP999", QueryTimeP999_, QueryTimeP999Avg, QueryTimeP999ConfMin, QueryTimeP999ConfMax);
   }
 
   double GetRecallAvg() const { return RecallAvg;} 
@@ -173,6 +200,49 @@ public:
   double GetDistCompAvg() const { return DistCompAvg;} 
   double GetDistCompConfMin() const{return DistCompConfMin;}; 
   double GetDistCompConfMax() const { return DistCompConfMax;}
+
+  double GetQueryTimeP50Avg() const { return QueryTimeP50Avg;} 
+  double GetQueryTimeP50ConfMin() const{return QueryTimeP50ConfMin;}; 
+  double GetQueryTimeP50ConfMax() const { return QueryTimeP50ConfMax;}
+
+  double GetQueryTimeP90Avg() const { return QueryTimeP90Avg;} 
+  double GetQueryTimeP90ConfMin() const{return QueryTimeP90ConfMin;}; 
+  double GetQueryTimeP90ConfMax() const { return QueryTimeP90ConfMax;}
+
+  double GetQueryTimeP99Avg() const { return QueryTimeP99Avg;} 
+  double GetQueryTimeP99ConfMin() const{return QueryTimeP99ConfMin;}; 
+  double GetQueryTimeP99ConfMax() const { return QueryTimeP99ConfMax;}
+
+  double GetQueryTimeP999Avg() const { return QueryTimeP999Avg;} 
+  double GetQueryTimeP999ConfMin() const{return QueryTimeP999ConfMin;}; 
+  double GetQueryTimeP999ConfMax() const { return QueryTimeP999ConfMax;}
+
+  /*
+   * Open-loop stats averaged over test sets (one entry per offered QPS).
+   */
+  vector<OpenLoopStat> GetOpenLoopAvg() const {
+    vector<OpenLoopStat> res;
+    if (OpenLoop_.empty()) return res;
+    res.resize(OpenLoop_[0].size());
+    for (size_t i = 0; i < res.size(); ++i) {
+      for (const vector<OpenLoopStat>& setStat : OpenLoop_) {
+        CHECK(setStat.size() == res.size());
+        res[i].OfferedQPS     = setStat[i].OfferedQPS;
+        res[i].AchievedQPS   += setStat[i].AchievedQPS;
+        res[i].QueryTimeP50  += setStat[i].QueryTimeP50;
+        res[i].QueryTimeP90  += setStat[i].QueryTimeP90;
+        res[i].QueryTimeP99  += setStat[i].QueryTimeP99;
+        res[i].QueryTimeP999 += setStat[i].QueryTimeP999;
+      }
+      double setQty = OpenLoop_.size();
+      res[i].AchievedQPS   /= setQty;
+      res[i].QueryTimeP50  /= setQty;
+      res[i].QueryTimeP90  /= setQty;
+      res[i].QueryTimeP99  /= setQty;
+      res[i].QueryTimeP999 /= setQty;
+    }
+    return res;
+  }
 private:
 double RecallAvg, RecallConfMin, RecallConfMax;
 double PrecisionOfApproxAvg, PrecisionOfApproxConfMin, PrecisionOfApproxConfMax;
@@ -189,6 +259,10 @@ double IndexTimeAvg, IndexTimeConfMin, IndexTimeConfMax;
 double LoadTimeAvg, LoadTimeConfMin, LoadTimeConfMax;
 double SaveTimeAvg, SaveTimeConfMin, SaveTimeConfMax;
 double QueryPerSecAvg, QueryPerSecConfMin, QueryPerSecConfMax;
+double QueryTimeP50Avg, QueryTimeP50ConfMin, QueryTimeP50ConfMax;
+double QueryTimeP90Avg, QueryTimeP90ConfMin, QueryTimeP90ConfMax;
+double QueryTimeP99Avg, QueryTimeP99ConfMin, QueryTimeP99ConfMax;
+double QueryTimeP999Avg, QueryTimeP999ConfMin, QueryTimeP999ConfMax;
 double zVal_;
 
 vector<vector<double>>   Recall_; 
@@ -206,6 +280,11 @@ vector<double>           IndexTime_;
 vector<double>           LoadTime_; 
 vector<double>           SaveTime_; 
 vector<double>           QueryPerSec_; 
+vector<double>           QueryTimeP50_; 
+vector<double>           QueryTimeP90_; 
+vector<double>           QueryTimeP99_; 
+vector<double>           QueryTimeP999_; 
+vector<vector<OpenLoopStat>> OpenLoop_;
 
 MetaAnalysis(){} // be private!
 
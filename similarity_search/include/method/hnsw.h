@@ -26,6 +26,7 @@
 #pragma once
 
 #include "index.h"
+#include "mmap_file.h"
 #include "params.h"
 
 #include <condition_variable>
@@ -457,6 +458,8 @@ namespace similarity {
 
         virtual void LoadIndex(const string &location) override;
 
+        virtual void LoadIndexMapped(const string &location) override;
+
         Hnsw(bool PrintProgress, const Space<dist_t> &space, const ObjectVector &data);
         void CreateIndex(const AnyParams &IndexParams) override;
 
@@ -510,6 +513,9 @@ namespace similarity {
             second->addFriendlevel(level, first, space, delaunay_type);
         }
 
+        // True if the index was loaded by LoadIndexMapped and points to the mapped file
+        bool IsIndexMapped() const { return mappedIndex_ != nullptr; }
+
         //
     private:
         size_t M_;
@@ -527,6 +533,11 @@ namespace similarity {
         unsigned int enterpointId_;
         unsigned int totalElementsStored_;
 
+        // Sub-phases of the insertion recorded by the build profiler
+        unsigned subPhaseSearchId_;
+        unsigned subPhasePruneId_;
+        unsigned subPhaseLinkId_;
+
         ObjectVector data_rearranged_;
 
         VisitedListPool *visitedlistpool;
@@ -542,6 +553,8 @@ namespace similarity {
         size_t offsetData_, offsetLevel0_;
         char *data_level0_memory_;
         char **linkLists_;
+        // If the optimized index is mapped, data_level0_memory_ and link lists point to the file
+        std::unique_ptr<MappedFile> mappedIndex_;
         size_t memoryPerObject_;
         float (*fstdistfunc_)(const float *pVect1, const float *pVect2, size_t &qty, float *TmpRes);
 
@@ -38,6 +38,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include <sstream>
 #include <memory>
 
+#include "portable_simd.h"
 #include "index.h"
 #include "space.h"
 
@@ -59,6 +60,10 @@ class NNDescentMethod : public Index<dist_t> {
   void CreateIndex(const AnyParams& IndexParams) override;
   ~NNDescentMethod(){};
 
+  // The k-NN graph is saved in a binary format, where points are identified by object ids
+  void SaveIndex(const string &location) override;
+  void LoadIndex(const string &location) override;
+
   /* 
    * Just the name of the method, consider printing crucial parameter values
    */
@@ -78,7 +83,17 @@ class NNDescentMethod : public Index<dist_t> {
     SpaceOracle(const Space<dist_t>& space, const ObjectVector& data) :
                 space_(space), data_(data) {}
     inline dist_t operator()(IdType id1, IdType id2) const {
-      return space_.IndexTimeDistance(data_.at(id1), data_.at(id2));
+      return space_.IndexTimeDistance(data_[id1], data_[id2]);
+    }
+    // Computes distances from the object id to qty objects (a row of the local join)
+    inline void operator()(IdType id, const int* ids, size_t qty, float* dists) const {
+      const Object* pObj = data_[id];
+      for (size_t k = 0; k < qty; ++k) {
+        _mm_prefetch(data_[ids[k]]->data(), _MM_HINT_T0);
+      }
+      for (size_t k = 0; k < qty; ++k) {
+        dists[k] = space_.IndexTimeDistance(pObj, data_[ids[k]]);
+      }
     }
   private:
     const Space<dist_t>&    space_;
@@ -90,6 +105,14 @@ class NNDescentMethod : public Index<dist_t> {
 
   typedef pair<dist_t, IdType>      EvaluatedNode;
 
+  /*
+   * Reads a graph saved by SaveIndex, nodes are mapped to data points using object ids.
+   * If strict is true, the file must contain all the data points and nothing else.
+   * Otherwise, nodes (and links to nodes) missing from the data set are dropped.
+   * Returns the value of NN used to build the graph.
+   */
+  size_t ReadGraph(const string &location, bool strict, vector<vector<KNNEntry>>& graph) const;
+
 
   const Space<dist_t>&    space_;
   bool                    PrintProgress_;
@@ -100,6 +123,8 @@ class NNDescentMethod : public Index<dist_t> {
   size_t                  iterationQty_; // iteration in the original Wei Dong's code nndes.cpp
   float                   rho_;
   float                   delta_;
+  size_t                  indexThreadQty_;
+  string                  warmStartFile_;
 
   SpaceOracle                        nndesOracle_;
   unique_ptr<NNDescent<SpaceOracle>> nndesObj_;
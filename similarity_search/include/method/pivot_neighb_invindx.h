@@ -104,6 +104,10 @@ class PivotNeighbInvertedIndex : public Index<dist_t> {
 
   unique_ptr<PivotIndex<dist_t>> pivot_index_;
 
+  // Sub-phases of the indexing recorded by the build profiler
+  unsigned subPhasePivotDistId_ = BUILD_PROFILE_MAX_SUBPHASE;
+  unsigned subPhaseSortId_      = BUILD_PROFILE_MAX_SUBPHASE;
+
   enum eAlgProctype {
     kScan,
     kMap,
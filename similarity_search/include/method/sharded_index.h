@@ -0,0 +1,117 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#ifndef _SHARDED_INDEX_H_
+#define _SHARDED_INDEX_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "index.h"
+#include "params.h"
+#include "thread_pool.h"
+
+#define METH_SHARDED_INDEX     "sharded"
+
+namespace similarity {
+
+using std::string;
+using std::vector;
+using std::unique_ptr;
+
+/*
+ * A generic method that splits the data set into shards and creates
+ * a separate index (using any other method) for each shard. Unlike MultiIndex,
+ * which creates several copies of the index for the same data, each data point
+ * belongs to exactly one shard. Shards are indexed in parallel.
+ *
+ * Shards are searched in parallel by a pool of worker threads and per-shard
+ * results are merged. Because shards are disjoint, there are no duplicates.
+ *
+ * Partitioning is either random (shards have equal sizes and all of them are searched)
+ * or clustered: data points are assigned to the closest of shardQty randomly
+ * selected centers. In the latter case, a query can be sent only to probeQty shards
+ * whose centers are the closest to the query.
+ *
+ * SaveIndex writes a small text file with the partitioning and saves each
+ * shard to a separate file <location>.shard<i>. A shard file is a regular
+ * index of the underlying method, which can be loaded on its own
+ * (for the subset of data points listed in the main file).
+ */
+
+template <typename dist_t> class Space;
+
+template <typename dist_t>
+class ShardedIndex : public Index<dist_t> {
+ public:
+  ShardedIndex(bool PrintProgress,
+               const string& SpaceType,
+               Space<dist_t>& space,
+               const ObjectVector& data);
+
+  void CreateIndex(const AnyParams& IndexParams) override;
+  void SaveIndex(const string& location) override;
+  void LoadIndex(const string& location) override;
+
+  ~ShardedIndex();
+
+  const std::string StrDesc() const override;
+
+  void Search(RangeQuery<dist_t>* query, IdType) const override;
+  void Search(KNNQuery<dist_t>* query, IdType) const override;
+
+  virtual void SetQueryTimeParams(const AnyParams& QueryTimeParams) override;
+
+  size_t GetShardQty() const { return shards_.size(); }
+  // Data points of the i-th shard
+  const ObjectVector& GetShardData(size_t i) const { return shardData_[i]; }
+  // The name of the file where SaveIndex(location) saves the i-th shard
+  static string GetShardFileName(const string& location, size_t i);
+
+  enum PartitionType { kRandom, kCluster };
+ protected:
+  void partitionRandom();
+  void partitionCluster();
+  // Creates (but doesn't build) shard indices for shardData_
+  void createShards();
+  // Selects shards to search: probeQty_ shards with the closest centers or all shards
+  template <typename QueryType>
+  void selectShards(QueryType* query, vector<size_t>& shardIds) const;
+  template <typename QueryType>
+  void searchShards(QueryType* query) const;
+
+  Space<dist_t>&                space_;
+  string                        SpaceType_;
+  bool                          PrintProgress_;
+  string                        MethodName_;
+  PartitionType                 partitionType_ = kRandom;
+  size_t                        shardThreadQty_ = 0;
+  size_t                        probeQty_ = 0;
+  size_t                        searchThreadQty_ = 0;
+
+  /*
+   * Shard indices keep references to their data, so shardData_ is never
+   * resized while shards_ exist. Empty shards have no index.
+   */
+  vector<ObjectVector>          shardData_;
+  vector<unique_ptr<Index<dist_t>>> shards_;
+  // Centers of clustered shards
+  ObjectVector                  centers_;
+  unique_ptr<ThreadPool>        searchPool_;
+};
+
+}   // namespace similarity
+
+#endif
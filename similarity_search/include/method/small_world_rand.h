@@ -18,6 +18,7 @@
 #include "index.h"
 #include "params.h"
 #include <set>
+#include <cstring>
 #include <limits>
 #include <iostream>
 #include <map>
@@ -26,6 +27,7 @@
 #include <thread>
 #include <memory>
 #include <mutex>
+#include <atomic>
 #include <condition_variable>
 #include <queue>
 
@@ -43,6 +45,8 @@ using std::mutex;
 using std::unique_lock;
 using std::condition_variable;
 using std::ref;
+using std::atomic;
+using std::shared_ptr;
 
 template <typename dist_t>
 class Space;
@@ -58,162 +62,28 @@ class Space;
  *
  */
 
-//----------------------------------
-class MSWNode{
-public:
-  MSWNode(const Object *Obj, size_t id) {
-    nodeObj_ = Obj;
-    id_ = id;
-  }
-  ~MSWNode(){};
-  void removeAllFriends(){
-    friends_.clear();
-  }
-
-  static void link(MSWNode* first, MSWNode* second){
-    // addFriend checks for duplicates if the second argument is true
-    first->addFriend(second, true);
-    second->addFriend(first, true);
-  }
-
-  // Removes only friends from a given set
-  void removeGivenFriends(const vector<bool>& delNodes) {
-    size_t newQty = 0;
-    /*
-     * This in-place one-iteration deletion of elements in delNodes
-     * Invariant in the beginning of each loop iteration:
-     * i >= newQty
-     * Furthermore:
-     * i - newQty == the number of entries deleted in previous iterations
-     */
-    for (size_t i = 0; i < friends_.size(); ++i) {
-      IdType id = friends_[i]->getId();
-      if (!delNodes.at(id)) {
-        friends_[newQty] = friends_[i];
-        ++newQty;
-      }
-    }
-    friends_.resize(newQty);
-  }
-
-  // Removes friends from a given set and attempts to replace them with friends' closest neighbors
-  // cacheDelNode should be thread-specific (or else calling this function isn't thread-safe)
-  template <class dist_t>
-  void removeGivenFriendsPatchWithClosestNeighbor(const Space<dist_t>& space, bool use_proxy_dist,
-                                                  const vector<bool>& delNodes, vector<MSWNode*>& cacheDelNode) {
-    /*
-     * This in-place one-iteration deletion of elements in delNodes
-     * Loop invariants:
-     * 1) i >= newQty
-     * 2) i - newQty = delQty 
-     * Hence, when the loop terminates delQty + newQty == friends_.size()
-     */
-    size_t newQty = 0, delQty = 0;
-
-    for (size_t i = 0; i < friends_.size(); ++i) {
-      MSWNode* oneFriend = friends_[i];
-      IdType id = oneFriend->getId();
-      if (!delNodes.at(id)) {
-        friends_[newQty] = friends_[i];
-        ++newQty;
-      } else {
-        if (cacheDelNode.size() <= delQty) cacheDelNode.resize(2*delQty + 1);
-        cacheDelNode[delQty] = oneFriend;
-        ++delQty;
-      }
-    }
-    CHECK_MSG((delQty + newQty) == friends_.size(), 
-              "Seems like a bug, delQty:" + ConvertToString(delQty) + 
-              " newQty: " + ConvertToString(newQty) + 
-              " friends_.size()=" + ConvertToString(friends_.size()));
-    friends_.resize(newQty);
-    // When patching use the function link()
-    for (size_t i = 0; i < delQty; ++i) {
-      MSWNode *toDelFriend = cacheDelNode[i];
-      MSWNode *friendReplacement = nullptr;
-      dist_t  dmin = numeric_limits<dist_t>::max();
-      const Object* queryObj = this->getData();
-      for (MSWNode* neighb : toDelFriend->getAllFriends()) {
-        IdType neighbId = neighb->getId();
-        if (!delNodes.at(neighbId)) {
-          const MSWNode* provider = neighb;
-          dist_t d = use_proxy_dist ?  space.ProxyDistance(provider->getData(), queryObj) : 
-                                        space.IndexTimeDistance(provider->getData(), queryObj); 
-          if (d < dmin) {
-            dmin = d;
-            friendReplacement = neighb;
-          }
-        }
-      }
-      if (friendReplacement != nullptr) {
-        link(this, friendReplacement);
-      }
-    }
-  }
-  /* 
-   * 1. The list of friend pointers is sorted.
-   * 2. If bCheckForDup == true addFriend checks for
-   *    duplicates using binary searching (via pointer comparison).
-   */
-  void addFriend(MSWNode* element, bool bCheckForDup) {
-    unique_lock<mutex> lock(accessGuard_);
-
-    if (bCheckForDup) {
-      auto it = lower_bound(friends_.begin(), friends_.end(), element);
-      if (it == friends_.end() || (*it) != element) {
-        friends_.insert(it, element);
-      }
-    } else {
-      friends_.push_back(element);
-    }
-  }
-  const Object* getData() const {
-    return nodeObj_;
-  }
-  size_t getId() const { return id_; }
-  void setId(IdType id) { id_ = id; }
-  /* 
-   * THIS NOTE APPLIES ONLY TO THE INDEXING PHASE:
-   *
-   * Before getting access to the friends,
-   * one needs to lock the mutex accessGuard_
-   * The mutex can be released ONLY when
-   * we exit the scope that has access to
-   * the reference returned by getAllFriends()
-   */
-  const vector<MSWNode*>& getAllFriends() const {
-    return friends_;
-  }
-
-  mutex accessGuard_;
-
-private:
-  const Object*       nodeObj_;
-  size_t              id_;
-  vector<MSWNode*>    friends_;
-};
 //----------------------------------
 template <typename dist_t>
 class EvaluatedMSWNodeReverse{
 public:
   EvaluatedMSWNodeReverse() {
       distance = 0;
-      element = NULL;
+      nodeId = 0;
   }
-  EvaluatedMSWNodeReverse(dist_t di, MSWNode* node) {
+  EvaluatedMSWNodeReverse(dist_t di, IdType id) {
     distance = di;
-    element = node;
+    nodeId = id;
   }
   ~EvaluatedMSWNodeReverse(){}
   dist_t getDistance() const {return distance;}
-  MSWNode* getMSWNode() const {return element;}
+  IdType getNodeId() const {return nodeId;}
   bool operator< (const EvaluatedMSWNodeReverse &obj1) const {
     return (distance > obj1.getDistance());
   }
 
 private:
   dist_t distance;
-  MSWNode* element;
+  IdType nodeId;
 };
 
 template <typename dist_t>
@@ -221,24 +91,105 @@ class EvaluatedMSWNodeDirect{
 public:
   EvaluatedMSWNodeDirect() {
       distance = 0;
-      element = NULL;
+      nodeId = 0;
   }
-  EvaluatedMSWNodeDirect(dist_t di, MSWNode* node) {
+  EvaluatedMSWNodeDirect(dist_t di, IdType id) {
     distance = di;
-    element = node;
+    nodeId = id;
   }
   ~EvaluatedMSWNodeDirect(){}
   dist_t getDistance() const {return distance;}
-  MSWNode* getMSWNode() const {return element;}
+  IdType getNodeId() const {return nodeId;}
   bool operator< (const EvaluatedMSWNodeDirect &obj1) const {
     return (distance < obj1.getDistance());
   }
 
 private:
   dist_t distance;
-  MSWNode* element;
+  IdType nodeId;
 };
 
+/*
+ * Nodes of the graph are kept in one flat array indexed by internal node ids.
+ * Each node occupies a block of blockSize bytes: the pointer to the data object
+ * is followed by the number of neighbors and by maxNN slots for internal ids of
+ * neighbors. Thus, a search step reads one contiguous block instead of chasing
+ * pointers through hash-table buckets and separately allocated neighbor lists.
+ *
+ * A deleted node has the NULL object pointer (a tombstone). Searches skip such nodes,
+ * but the neighbor list of a deleted node is kept until the node is removed by compaction.
+ *
+ * Fields are accessed atomically, because neighbor lists can be modified
+ * (by insertions or by the background repair) while searches are running.
+ * Memory is allocated for capacity nodes, so new nodes are added in place
+ * without moving existing ones. Node ids never change within one SWGraph:
+ * compaction and growth beyond the capacity create a new copy instead.
+ * Searches never see links to nodes with ids >= capacity.
+ */
+struct SWGraph {
+  SWGraph(size_t maxNNParam, IdType nodeQtyParam, IdType capacityParam) :
+          maxNN(maxNNParam),
+          // Keep object pointers aligned
+          blockSize((sizeof(const Object*) + sizeof(IdType) * (1 + maxNNParam) + sizeof(const Object*) - 1) /
+                    sizeof(const Object*) * sizeof(const Object*)),
+          capacity(capacityParam),
+          nodeQty(nodeQtyParam),
+          entryPointId(-1),
+          memory(static_cast<size_t>(capacityParam) * blockSize) {}
+  SWGraph(size_t maxNNParam, IdType nodeQtyParam) : SWGraph(maxNNParam, nodeQtyParam, nodeQtyParam) {}
+  // Copies nodes of another graph, the new capacity can't be smaller
+  SWGraph(const SWGraph& src, IdType capacityParam) : SWGraph(src.maxNN, src.nodeQty, capacityParam) {
+    memcpy(memory.data(), src.memory.data(), static_cast<size_t>(src.nodeQty) * blockSize);
+    entryPointId = src.entryPointId.load();
+  }
+  // Copies nodes of another graph into larger blocks, maxNN can't be smaller
+  SWGraph(const SWGraph& src, size_t maxNNParam, IdType capacityParam) : SWGraph(maxNNParam, src.nodeQty, capacityParam) {
+    for (IdType nodeId = 0; nodeId < nodeQty; ++nodeId) {
+      memcpy(getNodeBlock(nodeId), src.getNodeBlock(nodeId),
+             sizeof(const Object*) + sizeof(IdType) * (1 + src.getNodeDegree(nodeId)));
+    }
+    entryPointId = src.entryPointId.load();
+  }
+
+  const size_t    maxNN;
+  const size_t    blockSize;
+  const IdType    capacity;
+  // The number of nodes (including deleted ones), it can grow up to capacity
+  atomic<IdType>  nodeQty;
+  atomic<IdType>  entryPointId;
+  vector<char>    memory;
+
+  char* getNodeBlock(IdType nodeId) {
+    return &memory[static_cast<size_t>(nodeId) * blockSize];
+  }
+  const char* getNodeBlock(IdType nodeId) const {
+    return &memory[static_cast<size_t>(nodeId) * blockSize];
+  }
+  const Object* getNodeData(IdType nodeId) const {
+    return reinterpret_cast<const atomic<const Object*>*>(getNodeBlock(nodeId))->load(std::memory_order_acquire);
+  }
+  void setNodeData(IdType nodeId, const Object* pObj) {
+    reinterpret_cast<atomic<const Object*>*>(getNodeBlock(nodeId))->store(pObj, std::memory_order_release);
+  }
+  IdType getNodeDegree(IdType nodeId) const {
+    return reinterpret_cast<const atomic<IdType>*>(getNodeBlock(nodeId) + sizeof(const Object*))->load(std::memory_order_acquire);
+  }
+  void setNodeDegree(IdType nodeId, IdType qty) {
+    reinterpret_cast<atomic<IdType>*>(getNodeBlock(nodeId) + sizeof(const Object*))->store(qty, std::memory_order_release);
+  }
+  const atomic<IdType>* getNodeLinks(IdType nodeId) const {
+    return reinterpret_cast<const atomic<IdType>*>(getNodeBlock(nodeId) + sizeof(const Object*) + sizeof(IdType));
+  }
+  atomic<IdType>* getNodeLinks(IdType nodeId) {
+    return reinterpret_cast<atomic<IdType>*>(getNodeBlock(nodeId) + sizeof(const Object*) + sizeof(IdType));
+  }
+
+  DISABLE_COPY_AND_ASSIGN(SWGraph);
+};
+
+static_assert(sizeof(atomic<IdType>) == sizeof(IdType) && sizeof(atomic<const Object*>) == sizeof(const Object*),
+              "Atomic fields of SW-graph node blocks must have the size of plain ones");
+
 //----------------------------------
 template <typename dist_t>
 class SmallWorldRand : public Index<dist_t> {
@@ -259,8 +210,6 @@ public:
                            bool checkIDs = false/* this is a debug flag only, turning it on may affect performance */) override;
   ~SmallWorldRand();
 
-  typedef unordered_map<IdType,MSWNode*> ElementMap;
-
   const std::string StrDesc() const override;
   void Search(RangeQuery<dist_t>* query, IdType) const override;
   void Search(KNNQuery<dist_t>* query, IdType) const override;
@@ -268,18 +217,22 @@ public:
   void searchForIndexing(const Object *queryObj,
                          std::priority_queue<EvaluatedMSWNodeDirect<dist_t>> &resultSet,
                          IdType maxInternalId) const;
-  void add(MSWNode *newElement, IdType maxInternalId);
-  void addCriticalSection(MSWNode *newElement);
+  void add(IdType nodeId, IdType maxInternalId);
+  // True if a neighbor list is full, indexing threads then stop to let growBlocks() run
+  bool isGrowRequested() const { return growRequested_.load(std::memory_order_acquire); }
 
   void SetQueryTimeParams(const AnyParams& ) override;
 
+  // Blocks until the background repair has processed all deleted nodes
+  void WaitForRepair();
+
   enum PatchingStrategy { kNone = 0, kNeighborsOnly = 1 };
 private:
 
   size_t                NN_;
   size_t                efConstruction_;
   size_t                efSearch_;
-  size_t                indexThreadQty_;
+  size_t                indexThreadQty_ = 0;
   string                pivotFile_;
   ObjectVector          pivots_;
 
@@ -287,19 +240,111 @@ private:
   bool                  PrintProgress_;
   bool                  use_proxy_dist_;
 
-  mutable mutex   ElListGuard_;
-  ElementMap      ElList_;
-  IdType          NextNodeId_ = 0; // This is internal node id
-  bool            changedAfterCreateIndex_ = false;
-  MSWNode*        pEntryPoint_ = nullptr;
+  /*
+   * Searches take a reference to the current graph, hence, the graph can be
+   * replaced (when it outgrows its capacity or is compacted) while searches are running.
+   * Only the thread holding updateMutex_ (and the indexing threads it starts)
+   * modifies or replaces the graph. Searches don't lock anything, so they
+   * can run concurrently with AddBatch and DeleteBatch.
+   */
+  shared_ptr<SWGraph>             graph_;
+  // Maps object ids to internal node ids (needed only for deletion)
+  unordered_map<IdType, IdType>   objIdToNodeId_;
+  // Neighbor lists are modified under striped locks
+  mutable vector<mutex>           linkLocks_;
+  /*
+   * Links that didn't fit into full neighbor lists. They are added by growBlocks(),
+   * which replaces the graph with a copy having larger blocks. Thus, links are
+   * never dropped and neighbor lists aren't limited by the initial maxNN.
+   */
+  mutex                               overflowMutex_;
+  vector<std::pair<IdType, IdType>>   overflowLinks_;
+  atomic<bool>                        growRequested_{false};
 
+  /*
+   * Serializes modifications of the graph (AddBatch, DeleteBatch, repair steps, loading)
+   * and taking snapshots for SaveIndex. Searches don't acquire this mutex.
+   */
+  mutable mutex   updateMutex_;
+
+  struct DeletedNode {
+    IdType            nodeId;
+    PatchingStrategy  patchStrat;
+  };
+  /*
+   * Deleted nodes whose incoming links aren't repaired yet. Until they are repaired,
+   * ids aren't compacted. If backgroundRepair_ is true, the repair is carried
+   * out by repairThread_ in steps, each of which processes at most repairBudget_ nodes.
+   * Between steps, updateMutex_ is released.
+   */
+  vector<DeletedNode>   pendingRepair_;
+  bool                  repairInProgress_ = false;
+  bool                  backgroundRepair_ = false;
+  size_t                repairBudget_ = 0;
+  bool                  stopRepair_ = false;
+  thread                repairThread_;
+  condition_variable    repairCond_;
+  condition_variable    repairDoneCond_;
+
+  // Sub-phases of the insertion recorded by the build profiler
+  unsigned        subPhaseSearchId_ = BUILD_PROFILE_MAX_SUBPHASE;
+  unsigned        subPhaseLinkId_   = BUILD_PROFILE_MAX_SUBPHASE;
+
+  mutex& getLinkLock(IdType nodeId) const {
+    return linkLocks_[static_cast<size_t>(nodeId) % linkLocks_.size()];
+  }
 
-  void SearchOld(KNNQuery<dist_t>* query) const;
-  void SearchV1Merge(KNNQuery<dist_t>* query) const;
+  dist_t nodeDist(IdType nodeId, const Object* queryObj) const {
+    const Object* pObj = graph_->getNodeData(nodeId);
+    return use_proxy_dist_ ? space_.ProxyDistance(pObj, queryObj) :
+                             space_.IndexTimeDistance(pObj, queryObj);
+  }
 
-  void UpdateNextNodeId(size_t newNextNodeId);
+  void initGraphMemory(size_t maxNN);
+  // Makes room for nodes with ids < nodeQty and publishes them
+  void resizeGraph(IdType nodeQty);
+  void addLink(IdType nodeId, IdType neighbId);
+  // Enlarges blocks to fit overflowing links, indexing threads must not be running
+  void growBlocks();
+  void link(IdType nodeId1, IdType nodeId2) {
+    addLink(nodeId1, nodeId2);
+    addLink(nodeId2, nodeId1);
+  }
+  bool removeGivenNeighbors(IdType nodeId, const vector<char>& delNodes, vector<IdType>& delNeighbors);
+  void repairNode(IdType nodeId, const vector<char>& delNodes);
+  // Repairs links to pending deleted nodes, the lock is released between steps
+  void repairDeleted(unique_lock<mutex>& updateLock, size_t budget, size_t threadQty);
+  void repairThreadMain();
+  void stopRepairThread();
+  void waitForRepair(unique_lock<mutex>& updateLock);
+
+  // Returns a live node to start the search from or -1 if there are no live nodes
+  IdType getLiveEntryPoint(const SWGraph& graph) const;
+  IdType copyNeighbors(const SWGraph& graph, IdType nodeId, vector<IdType>& neighbors) const;
+  void SearchOld(KNNQuery<dist_t>* query, const SWGraph& graph) const;
+  void SearchV1Merge(KNNQuery<dist_t>* query, const SWGraph& graph) const;
+
+  // Maps ids of live nodes to consecutive ids (-1 for deleted nodes), returns the number of live nodes
+  IdType GetCompactNodeIds(vector<IdType>& newNodeIds) const;
   void CompactIdsIfNeeded();
 
+  void LoadIndexText(const string &location);
+
+  /*
+   * Builds the graph from a k-NN graph file (e.g., saved by NN-descent) instead of
+   * inserting points one by one. Neighbors are selected using the HNSW heuristic
+   * and reverse links are added. Both steps are carried out in parallel.
+   */
+  void CreateFromKNNGraph(const string &location);
+  /*
+   * The neighbor selection heuristic of HNSW (getNeighborsByHeuristic1): candidates
+   * are visited in the order of increasing distance, a candidate that is closer
+   * to an already selected neighbor than to the node is skipped. Skipped candidates
+   * fill the remaining slots. If there are at most maxQty candidates, all are selected.
+   */
+  void selectNeighborsByHeuristic(vector<EvaluatedMSWNodeDirect<dist_t>>& candidates,
+                                  size_t maxQty, vector<EvaluatedMSWNodeDirect<dist_t>>& neighbors) const;
+
   void CheckIDs() const;
   
   enum AlgoType { kOld, kV1Merge };
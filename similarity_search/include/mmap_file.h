@@ -0,0 +1,62 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#ifndef _MMAP_FILE_H_
+#define _MMAP_FILE_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "global.h"
+
+namespace similarity {
+
+/*
+ * A read-only view of a whole file. On POSIX systems the file is memory
+ * mapped, so the data is paged in on demand and isn't copied
+ * (unless the caller copies it). On other systems the file is read into memory.
+ * Throws an exception if the file cannot be opened or mapped.
+ */
+class MappedFile {
+public:
+  explicit MappedFile(const std::string& fileName);
+  ~MappedFile();
+
+  const char* data() const { return data_; }
+  size_t      size() const { return size_; }
+
+  // A hint that the file is going to be read sequentially
+  void AdviseSequential() const;
+
+private:
+  const char*         data_;
+  size_t              size_;
+  bool                mapped_;
+  std::vector<char>   buffer_; // used only if the file isn't mapped
+
+  DISABLE_COPY_AND_ASSIGN(MappedFile);
+};
+
+/*
+ * Writes a file via a temporary file that is renamed only after
+ * all the data is written. Hence, a reader never sees a partially written file
+ * and an old copy survives if the writing fails.
+ */
+std::string GetTempFileNameForAtomicWrite(const std::string& fileName);
+void        CommitAtomicWrite(const std::string& tmpFileName, const std::string& fileName);
+
+}   // namespace similarity
+
+#endif      // _MMAP_FILE_H_
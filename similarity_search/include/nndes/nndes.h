@@ -12,8 +12,13 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #ifndef WDONG_NNDESCENT
 #define WDONG_NNDESCENT
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+
 #include "nndes-common.h"
 #include "ported_boost_progress.h"
+#include "thread_pool.h"
 
 namespace similarity {
 
@@ -26,6 +31,13 @@ namespace similarity {
 #define NNDES_SHOW_PROGRESS 1
 #endif
 
+// The number of points a thread takes at once in the local join
+#define NNDES_JOIN_CHUNK_SIZE       64
+// A thread inserts buffered candidates when the buffer has this many of them
+#define NNDES_UPDATE_BUFFER_SIZE    (1 << 16)
+// The number of striped locks that protect neighbor lists
+#define NNDES_LOCK_QTY              4096
+
     // Normally one would use GRAPH_BOTH,
     // GRAPH_KNN & GRAPH_RNN are for experiments only.
     static const int GRAPH_NONE = 0, GRAPH_KNN = 1, GRAPH_RNN = 2, GRAPH_BOTH = 4;
@@ -63,21 +75,107 @@ namespace similarity {
         // Another potential usage of this function is to record all
         // pairs that have already be compared, so that when seen in the future,
         // then same pair doesn't have be compared again.
-        bool mark (int p1, int p2) {
+        bool mark (int p1, int p2) const {
             return p1 == p2;
         }
 
-        // Compare two points and update their KNN list of necessary.
-        // Return the number of comparisons done (0 or 1).
-        int update (int p1, int p2) {
-            if (mark(p1, p2)) return 0;
-            // KNN::update is synchronized by a lock
-            // keep an order is necessary to avoid deadlock.
-            if (p1 > p2) swap(p1, p2);
-            float dist =  oracle(p1, p2);
-            nn[p1].update(KNN::Element(p2, dist, true));
-            nn[p2].update(KNN::Element(p1, dist, true));
-            return 1;
+        // A candidate neighbor found by the local join
+        struct Update {
+            int     point;
+            int     neighbor;
+            float   dist;
+            bool operator < (const Update &u) const { return point < u.point; }
+        };
+
+        // Per-thread buffers of the local join
+        struct JoinBuffers {
+            vector<int>     newIds;
+            vector<int>     oldIds;
+            vector<int>     row;
+            vector<float>   dists;
+            vector<Update>  updates;
+        };
+
+        int threadQty;
+        // A copy of the distance to the farthest neighbor of each point:
+        // candidates that are farther are not buffered.
+        unique_ptr<std::atomic<float>[]> worst;
+        // Neighbor lists are updated under striped locks
+        vector<std::mutex> locks;
+
+        void addUpdate (int p1, int p2, float dist, vector<Update> &updates) const {
+            if (dist < worst[p1].load(std::memory_order_relaxed)) {
+                updates.push_back(Update{p1, p2, dist});
+            }
+        }
+
+        // The local join of the i-th point: new neighbors (direct and reverse
+        // ones) are compared with each other and with old neighbors. Points
+        // are merged into two de-duplicated lists, so that each pair is compared
+        // once, and distances for a row of the pair matrix are computed in one
+        // oracle call. Returns the number of comparisons done.
+        int join (int i, JoinBuffers &buf) const {
+            vector<int> &newIds = buf.newIds;
+            vector<int> &oldIds = buf.oldIds;
+            newIds.clear();
+            oldIds.clear();
+            if (option & (GRAPH_KNN | GRAPH_BOTH)) {
+                newIds.insert(newIds.end(), nn_new[i].begin(), nn_new[i].end());
+                oldIds.insert(oldIds.end(), nn_old[i].begin(), nn_old[i].end());
+            }
+            if (option & (GRAPH_RNN | GRAPH_BOTH)) {
+                newIds.insert(newIds.end(), rnn_new[i].begin(), rnn_new[i].end());
+                oldIds.insert(oldIds.end(), rnn_old[i].begin(), rnn_old[i].end());
+            }
+            std::sort(newIds.begin(), newIds.end());
+            newIds.erase(std::unique(newIds.begin(), newIds.end()), newIds.end());
+            std::sort(oldIds.begin(), oldIds.end());
+            oldIds.erase(std::unique(oldIds.begin(), oldIds.end()), oldIds.end());
+            // a point that is both new and old is treated as new
+            int oldQty = 0;
+            BOOST_FOREACH(int k, oldIds) {
+                if (!std::binary_search(newIds.begin(), newIds.end(), k)) oldIds[oldQty++] = k;
+            }
+            oldIds.resize(oldQty);
+
+            int cc = 0;
+            for (size_t a = 0; a < newIds.size(); ++a) {
+                int p1 = newIds[a];
+                buf.row.clear();
+                for (size_t b = a + 1; b < newIds.size(); ++b) {
+                    if (!mark(p1, newIds[b])) buf.row.push_back(newIds[b]);
+                }
+                BOOST_FOREACH(int k, oldIds) {
+                    if (!mark(p1, k)) buf.row.push_back(k);
+                }
+                if (buf.row.empty()) continue;
+                buf.dists.resize(buf.row.size());
+                oracle(p1, &buf.row[0], buf.row.size(), &buf.dists[0]);
+                for (size_t b = 0; b < buf.row.size(); ++b) {
+                    addUpdate(p1, buf.row[b], buf.dists[b], buf.updates);
+                    addUpdate(buf.row[b], p1, buf.dists[b], buf.updates);
+                }
+                cc += buf.row.size();
+            }
+            return cc;
+        }
+
+        // Inserts buffered candidates into neighbor lists. Candidates are
+        // grouped by point, so a lock is acquired once per point.
+        void flush (vector<Update> &updates) {
+            std::sort(updates.begin(), updates.end());
+            size_t start = 0;
+            while (start < updates.size()) {
+                int    p = updates[start].point;
+                size_t end = start;
+                std::unique_lock<std::mutex> lock(locks[p % locks.size()]);
+                for (; end < updates.size() && updates[end].point == p; ++end) {
+                    nn[p].update_unsafe(KNN::Element(updates[end].neighbor, updates[end].dist, true));
+                }
+                worst[p].store(nn[p].back().dist, std::memory_order_relaxed);
+                start = end;
+            }
+            updates.clear();
         }
 
     public:
@@ -89,10 +187,17 @@ namespace similarity {
             return cost;
         }
 
+        // The number of threads used by the local join
+        void setThreadQty (int qty) {
+            threadQty = qty > 0 ? qty : std::thread::hardware_concurrency();
+        }
+
         NNDescent (int N_, int K_, float S_, const ORACLE &oracle_,
                 GraphOption opt = GRAPH_BOTH)
             : oracle(oracle_), N(N_), K(K_), S(K * S_), option(opt), nn(N_),
-              nn_old(N_), nn_new(N_), rnn_old(N_), rnn_new(N_), cost(0)
+              nn_old(N_), nn_new(N_), rnn_old(N_), rnn_new(N_), cost(0),
+              threadQty(std::thread::hardware_concurrency()),
+              worst(new std::atomic<float>[N_]), locks(NNDES_LOCK_QTY)
         {
             for (int i = 0; i < N; ++i) {
                 nn[i].init(K);
@@ -112,6 +217,68 @@ namespace similarity {
             }
         }
 
+        // Warm start from a previously computed graph: initNN[i] contains
+        // neighbors of the i-th point (with distances). Neighbors of a point
+        // were already compared with each other, so they are marked as old.
+        // Points without neighbors (e.g., new ones) start from random points
+        // and neighbors of points that lost some neighbors are joined again.
+        // Then, a few iterations are usually enough.
+        NNDescent (int N_, int K_, float S_, const ORACLE &oracle_,
+                const vector<vector<KNNEntry> > &initNN,
+                GraphOption opt = GRAPH_BOTH)
+            : oracle(oracle_), N(N_), K(K_), S(K * S_), option(opt), nn(N_),
+              nn_old(N_), nn_new(N_), rnn_old(N_), rnn_new(N_), cost(0),
+              threadQty(std::thread::hardware_concurrency()),
+              worst(new std::atomic<float>[N_]), locks(NNDES_LOCK_QTY)
+        {
+            BOOST_ASSERT(initNN.size() == unsigned(N));
+            for (int i = 0; i < N; ++i) {
+                nn[i].init(K);
+                BOOST_FOREACH(const KNNEntry &e, initNN[i]) {
+                    if (e.key != KNNEntry::BAD && e.key != i) {
+                        nn[i].update_unsafe(KNN::Element(e.key, e.dist, false));
+                    }
+                }
+                for (int j = 0; j < K; ++j) {
+                    if (nn[i][j].key != KNN::Element::BAD) nn_old[i].push_back(nn[i][j].key);
+                }
+                if (nn_old[i].empty()) {
+                    nn_new[i].resize(S);
+                    BOOST_FOREACH(int &u, nn_new[i]) {
+                        u = RandomInt() % N;
+                    }
+                } else if (nn_old[i].size() < unsigned(K)) {
+                    // Some neighbors were removed: remaining ones are joined again
+                    nn_new[i].swap(nn_old[i]);
+                    if (nn_new[i].size() > unsigned(S)) {
+                        random_shuffle(nn_new[i].begin(), nn_new[i].end());
+                        nn_new[i].resize(S);
+                    }
+                }
+            }
+            // symmetrize, new points are joined with neighbors of their random neighbors
+            if ((option & GRAPH_RNN) || (option & GRAPH_BOTH)) {
+                for (int i = 0; i < N; ++i) {
+                    BOOST_FOREACH(int e, nn_old[i]) {
+                        rnn_old[e].push_back(i);
+                    }
+                    BOOST_FOREACH(int e, nn_new[i]) {
+                        rnn_new[e].push_back(i);
+                    }
+                }
+                for (int i = 0; i < N; ++i) {
+                    if (rnn_old[i].size() > unsigned(S)) {
+                        random_shuffle(rnn_old[i].begin(), rnn_old[i].end());
+                        rnn_old[i].resize(S);
+                    }
+                    if (rnn_new[i].size() > unsigned(S)) {
+                        random_shuffle(rnn_new[i].begin(), rnn_new[i].end());
+                        rnn_new[i].resize(S);
+                    }
+                }
+            }
+        }
+
         // An iteration contains two parts:
         //      local join
         //      identify the newly detected NNs.
@@ -120,59 +287,37 @@ namespace similarity {
 #if NNDES_SHOW_PROGRESS
             unique_ptr<ProgressDisplay>  progress(
                     PrintProgress? new ProgressDisplay(N, cerr): NULL);
+            std::mutex                   progressMutex;
 #endif
-
-            long long int cc = 0;
-            // local joins
-#pragma omp parallel for default(shared) reduction(+:cc)
+            // Thresholds are taken from the lists and then refreshed by each flush
             for (int i = 0; i < N; ++i) {
+                worst[i].store(nn[i].back().dist, std::memory_order_relaxed);
+            }
 
-                // The following loops are bloated to deal with all
-                // the experimental setups.  Otherwise they should
-                // be really simple.
-                if (option & (GRAPH_KNN | GRAPH_BOTH)) {
-                    BOOST_FOREACH(int j, nn_new[i]) {
-                        BOOST_FOREACH(int k, nn_new[i]) {
-                            if (j >= k) continue;
-                            cc += update(j, k);
-                        }
-                        BOOST_FOREACH(int k, nn_old[i]) {
-                            cc += update(j, k);
-                        }
-                    }
-                }
-                if (option & (GRAPH_RNN | GRAPH_BOTH)) {
-                    BOOST_FOREACH(int j, rnn_new[i]) {
-                        BOOST_FOREACH(int k, rnn_new[i]) {
-                            if (j >= k) continue;
-                            cc += update(j, k);
-                        }
-                        BOOST_FOREACH(int k, rnn_old[i]) {
-                            cc += update(j, k);
-                        }
-                    }
-                }
-                if (option & GRAPH_BOTH) {
-                    BOOST_FOREACH(int j, nn_new[i]) {
-                        BOOST_FOREACH(int k, rnn_old[i]) {
-                            cc += update(j, k);
-                        }
-                        BOOST_FOREACH(int k, rnn_new[i]) {
-                            cc += update(j, k);
-                        }
-                    }
-                    BOOST_FOREACH(int j, nn_old[i]) {
-                        BOOST_FOREACH(int k, rnn_new[i]) {
-                            cc += update(j, k);
-                        }
+            std::atomic<long long int>  cc(0);
+            std::atomic<int>            nextPoint(0);
+            // local joins
+            ParallelFor(0, threadQty, threadQty, [&](size_t) {
+                JoinBuffers     buf;
+                long long int   localCost = 0;
+                while (true) {
+                    int start = nextPoint.fetch_add(NNDES_JOIN_CHUNK_SIZE);
+                    if (start >= N) break;
+                    int end = std::min(N, start + NNDES_JOIN_CHUNK_SIZE);
+                    for (int i = start; i < end; ++i) {
+                        localCost += join(i, buf);
                     }
-                }
-
+                    if (buf.updates.size() >= NNDES_UPDATE_BUFFER_SIZE) flush(buf.updates);
 #if NNDES_SHOW_PROGRESS
-#pragma omp critical 
-                if (progress) ++(*progress);
+                    if (progress) {
+                        std::unique_lock<std::mutex> lock(progressMutex);
+                        (*progress) += end - start;
+                    }
 #endif
-            }
+                }
+                flush(buf.updates);
+                cc += localCost;
+            });
 
             cost += cc;
 
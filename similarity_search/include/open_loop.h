@@ -0,0 +1,202 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#ifndef _OPEN_LOOP_H
+#define _OPEN_LOOP_H
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <random>
+#include <algorithm>
+
+#include "utils.h"
+#include "logging.h"
+#include "thread_pool.h"
+#include "latency_histogram.h"
+
+namespace similarity {
+
+using std::vector;
+using std::string;
+
+const string ARRIVAL_DIST_POISSON = "poisson";
+const string ARRIVAL_DIST_FIXED   = "fixed";
+
+/*
+ * Parameters of the open-loop efficiency test. In this test,
+ * queries arrive according to a schedule with a given rate (QPS)
+ * regardless of whether previous queries are finished. If all
+ * search threads are busy, a query waits in the queue.
+ */
+struct OpenLoopConfig {
+  OpenLoopConfig() : PoissonArrival(true) {}
+  OpenLoopConfig(const vector<double>& arrivalQPS, bool poissonArrival) :
+                  ArrivalQPS(arrivalQPS), PoissonArrival(poissonArrival) {}
+
+  bool IsEnabled() const { return !ArrivalQPS.empty(); }
+
+  // Target arrival rates: if there's more than one, we sweep over all of them
+  vector<double>  ArrivalQPS;
+  // Poisson (exponential inter-arrival times) or fixed-rate schedule
+  bool            PoissonArrival;
+};
+
+/*
+ * Results of the open-loop test for one arrival rate.
+ * Query times are in msec.
+ */
+struct OpenLoopStat {
+  OpenLoopStat() : OfferedQPS(0), AchievedQPS(0),
+                   QueryTimeP50(0), QueryTimeP90(0), QueryTimeP99(0), QueryTimeP999(0) {}
+
+  double OfferedQPS;
+  double AchievedQPS;
+  double QueryTimeP50;
+  double QueryTimeP90;
+  double QueryTimeP99;
+  double QueryTimeP999;
+};
+
+/*
+ * The offered rate is considered to be sustained if the achieved throughput
+ * is at least OPEN_LOOP_MIN_THROUGHPUT_FRAC of the offered one, and the 99th
+ * percentile latency is at most OPEN_LOOP_MAX_P99_GROWTH times larger than
+ * the smallest 99th percentile latency observed under lighter loads.
+ * The knee of the latency curve is the largest sustained rate.
+ * Note that the throughput threshold leaves room for the randomness of 
+ * Poisson arrivals.
+ */
+const double OPEN_LOOP_MIN_THROUGHPUT_FRAC = 0.9;
+const double OPEN_LOOP_MAX_P99_GROWTH      = 2.0;
+
+/*
+ * Returns the index of the knee in the array of open-loop stats,
+ * sorted in the order of increasing offered QPS, or -1 if no
+ * rate is sustained.
+ */
+inline int FindOpenLoopKnee(const vector<OpenLoopStat>& stat) {
+  if (stat.empty()) return -1;
+  double baseP99 = stat[0].QueryTimeP99;
+  int res = -1;
+  for (size_t i = 0; i < stat.size(); ++i) {
+    baseP99 = std::min(baseP99, stat[i].QueryTimeP99);
+    if (stat[i].AchievedQPS >= OPEN_LOOP_MIN_THROUGHPUT_FRAC * stat[i].OfferedQPS &&
+        stat[i].QueryTimeP99 <= OPEN_LOOP_MAX_P99_GROWTH * baseP99) {
+      res = static_cast<int>(i);
+    } else break;
+  }
+  return res;
+}
+
+/*
+ * Generates arrival times (in nanoseconds, relative to the start of the test).
+ */
+inline void GenArrivalSchedule(size_t qty, double qps, bool poissonArrival,
+                               vector<uint64_t>& arrivalNanoSec) {
+  CHECK_MSG(qps > 0, "The arrival rate should be positive!");
+  arrivalNanoSec.resize(qty);
+
+  std::exponential_distribution<double> expDistr(qps);
+  double t = 0;
+
+  for (size_t i = 0; i < qty; ++i) {
+    arrivalNanoSec[i] = static_cast<uint64_t>(t * 1e9);
+    t += poissonArrival ? expDistr(getThreadLocalRandomGenerator()) : 1.0 / qps;
+  }
+}
+
+/*
+ * Executes qty queries in the open-loop fashion using threadQty threads.
+ * The function searchFunc(q) should execute the q-th query.
+ * Queries are dispatched in the order of arrival. Latency is measured from the
+ * scheduled arrival time rather than from the actual start of the search.
+ * Thus, the time a query spends waiting for a free thread is accounted
+ * for (i.e., there's no coordinated omission).
+ */
+template <class SearchFunc>
+inline OpenLoopStat RunOpenLoop(unsigned threadQty, double qps,
+                                const vector<uint64_t>& arrivalNanoSec,
+                                SearchFunc searchFunc) {
+  using namespace std::chrono;
+
+  size_t qty = arrivalNanoSec.size();
+
+  if (!threadQty) threadQty = 1;
+
+  vector<LatencyHistogram>  threadLatency(threadQty);
+  vector<uint64_t>          threadLastDone(threadQty);
+  std::atomic<size_t>       nextQuery(0);
+
+  const steady_clock::time_point start = steady_clock::now();
+
+  ParallelFor(0, threadQty, threadQty, [&](unsigned threadId) {
+    LatencyHistogram latency;
+    uint64_t         lastDone = 0;
+
+    size_t q;
+    while ((q = nextQuery.fetch_add(1)) < qty) {
+      const steady_clock::time_point arrival = start + nanoseconds(arrivalNanoSec[q]);
+
+      steady_clock::time_point now = steady_clock::now();
+      // A coarse sleep followed by a short busy wait, b/c sleep_until isn't precise
+      while (now < arrival) {
+        if (arrival - now > microseconds(200)) {
+          std::this_thread::sleep_until(arrival - microseconds(100));
+        } else {
+          std::this_thread::yield();
+        }
+        now = steady_clock::now();
+      }
+
+      searchFunc(q);
+
+      const steady_clock::time_point done = steady_clock::now();
+
+      latency.Add(duration_cast<microseconds>(done - arrival).count());
+      // Nanoseconds: the last query can't finish before its arrival even if it takes no time
+      lastDone = std::max<uint64_t>(lastDone, duration_cast<nanoseconds>(done - start).count());
+    }
+
+    threadLatency[threadId] = std::move(latency);
+    threadLastDone[threadId] = lastDone;
+  });
+
+  LatencyHistogram latency;
+  uint64_t         totalTime = 0;
+
+  for (unsigned i = 0; i < threadQty; ++i) {
+    latency.Merge(threadLatency[i]);
+    totalTime = std::max(totalTime, threadLastDone[i]);
+  }
+
+  OpenLoopStat res;
+
+  res.OfferedQPS    = qps;
+  res.AchievedQPS   = totalTime ? qty / (totalTime / 1e9) : 0;
+  // The histogram keeps microseconds, but query times are reported in msec
+  res.QueryTimeP50  = latency.GetPercentile(50)/1e3;
+  res.QueryTimeP90  = latency.GetPercentile(90)/1e3;
+  res.QueryTimeP99  = latency.GetPercentile(99)/1e3;
+  res.QueryTimeP999 = latency.GetPercentile(99.9)/1e3;
+
+  return res;
+}
+
+}   // namespace similarity
+
+#endif
@@ -0,0 +1,89 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#ifndef _PARAM_SWEEP_H
+#define _PARAM_SWEEP_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+namespace similarity {
+
+using std::string;
+using std::vector;
+
+// Separates alternative values of one parameter in the grid specification
+const char QUERY_TIME_GRID_VALUE_SEP = ':';
+
+/*
+ * Expands the grid of query-time parameters, e.g.,
+ *
+ *    ef=10:20:40,algoType=v1merge
+ *
+ * into the list of parameter strings (one per combination):
+ *
+ *    ef=10,algoType=v1merge
+ *    ef=20,algoType=v1merge
+ *    ef=40,algoType=v1merge
+ *
+ * The last parameter varies the fastest. The number of parameters
+ * having more than one value is returned in varyingParamQty.
+ * An empty specification produces a single empty string.
+ */
+void ExpandQueryTimeGrid(const string& gridSpec,
+                         vector<string>& res,
+                         size_t& varyingParamQty);
+
+/*
+ * One point of the recall-vs-QPS sweep. Query times are in msec.
+ */
+struct SweepPoint {
+  SweepPoint() : Recall(0), QueryPerSec(0), QueryTime(0), QueryTimeP99(0), DistComp(0), IsPareto(false) {}
+  SweepPoint(const string& queryTimeParams, double recall, double queryPerSec,
+             double queryTime, double queryTimeP99, double distComp) :
+             QueryTimeParams(queryTimeParams), Recall(recall), QueryPerSec(queryPerSec),
+             QueryTime(queryTime), QueryTimeP99(queryTimeP99), DistComp(distComp), IsPareto(false) {}
+
+  string  QueryTimeParams;
+  double  Recall;
+  double  QueryPerSec;
+  double  QueryTime;
+  double  QueryTimeP99;
+  double  DistComp;
+  bool    IsPareto;
+};
+
+/*
+ * Sets IsPareto for points that aren't dominated in terms of recall and QPS,
+ * i.e., there's no other point that has both a higher (or equal) recall and
+ * a higher (or equal) QPS with at least one of the two being strictly higher.
+ */
+void MarkParetoFront(vector<SweepPoint>& points);
+
+/*
+ * Returns the index of the point with the highest QPS among the points
+ * whose recall is at least targetRecall, or -1 if there's no such point.
+ */
+int FindCheapestSweepPoint(const vector<SweepPoint>& points, double targetRecall);
+
+/*
+ * Write sweep points (sorted by recall) as a tab-separated table or a JSON array.
+ */
+void WriteSweepPointsTSV(std::ostream& out, const string& methodName, const vector<SweepPoint>& points);
+void WriteSweepPointsJSON(std::ostream& out, const string& methodName, const vector<SweepPoint>& points);
+
+}   // namespace similarity
+
+#endif
@@ -54,7 +54,11 @@ void ParseCommandLine(int argc, char *argv[], bool& bPrintProgress,
                       string&                         RangeArg,
                       string&                         MethodName,
                       shared_ptr<AnyParams>&          IndexTimeParams,
-                      vector<shared_ptr<AnyParams>>&  QueryTimeParams);
+                      vector<shared_ptr<AnyParams>>&  QueryTimeParams,
+                      vector<double>&                 ArrivalQPS,
+                      string&                         ArrivalDist,
+                      bool&                           UsePerfCounters,
+                      float&                          TargetRecall);
 };
 
 #endif
@@ -104,6 +104,23 @@ const std::string APPEND_TO_RES_FILE_PARAM_MSG   = "do not override information
 const std::string NO_PROGRESS_PARAM_OPT          = "noProgressBar";
 const std::string NO_PROGRESS_PARAM_MSG          = "suppress displaying (mostly indexing) progress bars (for some methods)";
 
+const std::string ARRIVAL_QPS_PARAM_OPT          = "arrivalQPS";
+const std::string ARRIVAL_QPS_PARAM_MSG          = "comma-separated query arrival rates (queries per sec.) for the open-loop efficiency test; if not specified, the open-loop test is not carried out";
+
+const std::string ARRIVAL_DIST_PARAM_OPT         = "arrivalDist";
+const std::string ARRIVAL_DIST_PARAM_MSG         = "a distribution of query inter-arrival times in the open-loop test: poisson or fixed";
+const std::string ARRIVAL_DIST_PARAM_DEFAULT     = "poisson";
+
+const std::string PERF_COUNTERS_PARAM_OPT        = "perfCounters";
+const std::string PERF_COUNTERS_PARAM_MSG        = "collect hardware performance counters (Linux only) during the efficiency test";
+
+const std::string QUERY_TIME_GRID_PARAM_OPT      = "queryTimeGrid";
+const std::string QUERY_TIME_GRID_PARAM_MSG      = "a grid of query-time parameters, where values are separated by colons, e.g., ef=10:20:40,algoType=v1merge (can't be combined with -t)";
+
+const std::string TARGET_RECALL_PARAM_OPT        = "targetRecall";
+const std::string TARGET_RECALL_PARAM_MSG        = "if positive, find the cheapest query-time parameters reaching this recall using a binary search over query-time parameter sets ordered from the fastest to the most accurate";
+const float       TARGET_RECALL_PARAM_DEFAULT    = 0;
+
 // Server/client parameters
 
 const std::string DEBUG_PARAM_OPT                = "debug,D";
@@ -118,6 +135,43 @@ const std::string ADDR_PARAM_MSG                 = "TCP/IP server address";
 const std::string THREAD_PARAM_OPT               = "threadQty";
 const std::string THREAD_PARAM_MSG               = "A number of server threads";
 
+const std::string SEARCH_STAT_SAMPLE_PARAM_OPT   = "searchStatSample";
+const std::string SEARCH_STAT_SAMPLE_PARAM_MSG   = "Log traversal statistics of every N-th k-NN query (0 means never)";
+const unsigned    SEARCH_STAT_SAMPLE_PARAM_DEFAULT = 0;
+
+const std::string BACKENDS_PARAM_OPT             = "backends";
+const std::string BACKENDS_PARAM_MSG             = "Run as a router: a comma-separated list of backend query servers host:port[:idOffset]. "
+                                                   "Queries are sent to all backends and results are merged. "
+                                                   "Object IDs returned by a backend are increased by its idOffset";
+
+const std::string SHARD_TIMEOUT_PARAM_OPT        = "shardTimeout";
+const std::string SHARD_TIMEOUT_PARAM_MSG        = "Router: a timeout (in ms) for connecting to, sending to, and receiving from a backend";
+const unsigned    SHARD_TIMEOUT_PARAM_DEFAULT    = 1000;
+
+const std::string PARTIAL_RESULTS_PARAM_OPT      = "partialResults";
+const std::string PARTIAL_RESULTS_PARAM_MSG      = "Router: backends that fail or time out are skipped (otherwise, the query fails)";
+
+const std::string BATCH_THREAD_QTY_PARAM_OPT     = "batchThreadQty";
+const std::string BATCH_THREAD_QTY_PARAM_MSG     = "A number of threads executing queries of one batch (0 means the number of cores)";
+const unsigned    BATCH_THREAD_QTY_PARAM_DEFAULT = 0;
+
+const std::string CACHE_REPLY_STR_PARAM_OPT      = "cacheReplyStr";
+const std::string CACHE_REPLY_STR_PARAM_MSG      = "Precompute external IDs and string representations of all data points at startup, so that replies require no formatting";
+
+const std::string REPLY_STR_FILE_PARAM_OPT       = "replyStrFile";
+const std::string REPLY_STR_FILE_PARAM_MSG       = "A file with precomputed strings (implies --cacheReplyStr): if the file exists, it is memory mapped, otherwise, it is created";
+
+const std::string INDEX_BUNDLE_PARAM_OPT         = "indexBundle";
+const std::string INDEX_BUNDLE_PARAM_MSG         = "A self-contained index file (the space, data points, and external IDs; the method saves the index to <file>.index): "
+                                                   "if the file exists, the server is started from it alone (no data file, space, or method is needed), "
+                                                   "otherwise, the index is created as usual and saved to this file";
+
+const std::string BATCH_PARAM_OPT                = "batch,b";
+const std::string BATCH_PARAM_MSG                = "Each input line is a separate k-NN query, all queries are sent in one batch";
+
+const std::string BINARY_PARAM_OPT               = "binary";
+const std::string BINARY_PARAM_MSG               = "Send batch queries in the binary format: each input line is either a dense vector (space-separated numbers) or a sparse vector (space-separated dim:value pairs)";
+
 const std::string RET_EXT_ID_PARAM_OPT           = "retExternId,e";
 const std::string RET_EXT_ID_PARAM_MSG           = "Return external IDs?";
 
@@ -0,0 +1,104 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#ifndef _PERF_COUNTERS_H_
+#define _PERF_COUNTERS_H_
+
+#include <cstdint>
+#include <string>
+
+namespace similarity {
+
+using std::string;
+
+enum PerfEventType {
+  kPerfCycles       = 0,
+  kPerfInstructions = 1,
+  kPerfLLCMisses    = 2,
+  kPerfDTLBMisses   = 3,
+  kPerfBranchMisses = 4,
+  kPerfEventQty     = 5
+};
+
+const char* GetPerfEventName(unsigned eventId);
+
+/*
+ * Values of hardware performance counters. If an event isn't
+ * supported by the hardware (or the kernel), it is marked as invalid.
+ */
+struct PerfCounterValues {
+  PerfCounterValues() {
+    for (unsigned i = 0; i < kPerfEventQty; ++i) {
+      Counts_[i] = 0;
+      Valid_[i]  = false;
+    }
+  }
+
+  void Add(const PerfCounterValues& other) {
+    for (unsigned i = 0; i < kPerfEventQty; ++i) {
+      Counts_[i] += other.Counts_[i];
+      Valid_[i]  = Valid_[i] || other.Valid_[i];
+    }
+  }
+
+  bool IsAnyValid() const {
+    for (unsigned i = 0; i < kPerfEventQty; ++i) if (Valid_[i]) return true;
+    return false;
+  }
+
+  /*
+   * Prints counter values divided by qty, e.g., the number of queries
+   * or the number of distance computations.
+   */
+  string ToString(double qty) const;
+
+  uint64_t  Counts_[kPerfEventQty];
+  bool      Valid_[kPerfEventQty];
+};
+
+/*
+ * Hardware performance counters (cycles, instructions, LLC misses,
+ * dTLB misses, branch misses) of the CALLING thread. Only user-space
+ * events are counted. The implementation relies on the Linux perf_event_open
+ * system call. On other platforms, or if the access to performance
+ * counters isn't permitted (see /proc/sys/kernel/perf_event_paranoid),
+ * the object is created, but IsAvailable() returns false and all
+ * counter values are invalid.
+ *
+ * An object should be created, used, and destroyed in the same thread.
+ */
+class PerfCounters {
+public:
+  PerfCounters();
+  ~PerfCounters();
+
+  bool IsAvailable() const;
+
+  // Reset and start counting
+  void Start();
+  // Stop counting
+  void Stop();
+  // Values accumulated between Start() and Stop()
+  PerfCounterValues Read() const;
+private:
+  int fd_[kPerfEventQty];
+
+  // disable copying
+  PerfCounters(const PerfCounters&);
+  PerfCounters& operator=(const PerfCounters&);
+};
+
+}   // namespace similarity
+
+#endif      // _PERF_COUNTERS_H_
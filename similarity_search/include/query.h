@@ -16,6 +16,7 @@
 #define _QUERY_H_
 
 #include "object.h"
+#include "search_stat.h"
 
 namespace similarity {
 
@@ -31,6 +32,9 @@ class Query {
   const Object* QueryObject() const;
   uint64_t DistanceComputations() const;
   void AddDistanceComputations(uint64_t DistComp) { distance_computations_ += DistComp; }
+  // Traversal statistics, which are collected only if WITH_SEARCH_STAT is defined
+  const SearchStat& GetSearchStat() const { return search_stat_; }
+  SearchStat& GetSearchStat() { return search_stat_; }
 
   void ResetStats();
   virtual dist_t Distance(const Object* object1, const Object* object2) const;
@@ -48,6 +52,7 @@ class Query {
   const Space<dist_t>& space_;
   const Object* query_object_;
   mutable uint64_t distance_computations_;
+  SearchStat       search_stat_;
 
   // disable copy and assign
   DISABLE_COPY_AND_ASSIGN(Query);
@@ -34,6 +34,8 @@ public:
     str << "Radius = " << radius_;
     return str.str();
   }
+  // The number of results isn't known in advance
+  size_t MaxResultQty() const { return 0; }
   dist_t radius_;
 };
 
@@ -51,6 +53,7 @@ public:
     str << "K = " << K_ << " Epsilon = " << eps_;
     return str.str();
   }
+  size_t MaxResultQty() const { return static_cast<size_t>(K_); }
   dist_t K_;
   float  eps_;
 };
@@ -54,6 +54,10 @@ namespace similarity {
     Print << "NumCloser:         " << round2(ExpRes.GetNumCloserAvg())    << " -> " << "[" << round2(ExpRes.GetNumCloserConfMin()) << " \t" << round2(ExpRes.GetNumCloserConfMax()) << "]" << std::endl;
     Print << "------------------------------------" << std::endl;
     Print << "QueryTime:         " << round2(ExpRes.GetQueryTimeAvg())    << " -> " << "[" << round2(ExpRes.GetQueryTimeConfMin()) << " \t" << round2(ExpRes.GetQueryTimeConfMax()) << "]" << std::endl;
+    Print << "QueryTime p50:     " << round2(ExpRes.GetQueryTimeP50Avg())  << " -> " << "[" << round2(ExpRes.GetQueryTimeP50ConfMin()) << " \t" << round2(ExpRes.GetQueryTimeP50ConfMax()) << "]" << std::endl;
+    Print << "QueryTime p90:     " << round2(ExpRes.GetQueryTimeP90Avg())  << " -> " << "[" << round2(ExpRes.GetQueryTimeP90ConfMin()) << " \t" << round2(ExpRes.GetQueryTimeP90ConfMax()) << "]" << std::endl;
+    Print << "QueryTime p99:     " << round2(ExpRes.GetQueryTimeP99Avg())  << " -> " << "[" << round2(ExpRes.GetQueryTimeP99ConfMin()) << " \t" << round2(ExpRes.GetQueryTimeP99ConfMax()) << "]" << std::endl;
+    Print << "QueryTime p99.9:   " << round2(ExpRes.GetQueryTimeP999Avg()) << " -> " << "[" << round2(ExpRes.GetQueryTimeP999ConfMin()) << " \t" << round2(ExpRes.GetQueryTimeP999ConfMax()) << "]" << std::endl;
     Print << "QueryPerSec:       " << round2(ExpRes.GetQueryPerSecAvg())    << " -> " << "[" << round2(ExpRes.GetQueryPerSecConfMin()) << " \t" << round2(ExpRes.GetQueryPerSecConfMax()) << "]" << std::endl;
     Print << "DistComp:          " << round2(ExpRes.GetDistCompAvg())     << " -> " << "[" << round2(ExpRes.GetDistCompConfMin()) << " \t" << round2(ExpRes.GetDistCompConfMax()) << "]" << std::endl;
     Print << "------------------------------------" << std::endl;
@@ -17,7 +17,7 @@
 
 #include <string>
 #include "object.h"
-#include "my_isnan_isinf.h"
+#include "sample_stat.h"
 
 namespace similarity {
 
@@ -27,57 +27,44 @@ namespace similarity {
  *
  * Note that this measure may be irrelevant in non-metric spaces.
  */
+inline double IntrinsicDimensionality(const RunningStat& distStat) {
+  return distStat.Mean * distStat.Mean / (2 * distStat.Var());
+}
+
+/*
+ * Distances are computed for SampleQty random pairs using ThreadQty threads
+ * (0 means the number of hardware threads), see SampleRandomPairDistances.
+ */
 template <typename dist_t>
 void ComputeIntrinsicDimensionality(const Space<dist_t>& space, 
                                const ObjectVector& dataset,
                                double& IntrDim,
                                double& DistMean,
                                double& DistSigma,
-                               size_t SampleQty = 1000000) {
-  std::vector<double> dist;
-  DistMean = 0;
-  for (size_t n = 0; n < SampleQty; ++n) {
-    size_t r1 = RandomInt() % dataset.size();
-    size_t r2 = RandomInt() % dataset.size();
-    CHECK(r1 < dataset.size());
-    CHECK(r2 < dataset.size());
-    const Object* obj1 = dataset[r1];
-    const Object* obj2 = dataset[r2];
-    dist_t d = space.IndexTimeDistance(obj1, obj2);
-    dist.push_back(d);
-    if (my_isnan(d)) {
-      /* 
-       * TODO: @leo Dump object contents here. To this end,
-       *            we need to subclass objects, so that sparse
-       *            vectors, dense vectors and other objects
-       *            can implement their own dump function.
-       */
-      throw runtime_error("!!! Bug: a distance returned NAN!");
-    }
-    DistMean += d;
-  }
-  DistMean /= double(SampleQty);
-  DistSigma = 0;
-  for (size_t i = 0; i < SampleQty; ++i) {
-    DistSigma += (dist[i] - DistMean) * (dist[i] - DistMean);
-  }
-  DistSigma /= double(SampleQty);
-  IntrDim = DistMean * DistMean / (2 * DistSigma);
-  DistSigma = sqrt(DistSigma);
+                               size_t SampleQty = 1000000,
+                               size_t ThreadQty = 0) {
+  RunningStat distStat;
+  SampleRandomPairDistances(space, dataset, SampleQty, ThreadQty, RandomInt(), distStat);
+
+  DistMean  = distStat.Mean;
+  IntrDim   = IntrinsicDimensionality(distStat);
+  DistSigma = sqrt(distStat.Var());
 }
 
 template <typename dist_t>
 void ReportIntrinsicDimensionality(const string& reportName,
                                    const Space<dist_t>& space, 
                                    const ObjectVector& dataset,
-                                   size_t SampleQty = 1000000) {
+                                   size_t SampleQty = 1000000,
+                                   size_t ThreadQty = 0) {
     double DistMean, DistSigma, IntrDim;
 
     ComputeIntrinsicDimensionality(space, dataset,
                                   IntrDim,
                                   DistMean,
                                   DistSigma,
-                                  SampleQty);
+                                  SampleQty,
+                                  ThreadQty);
 
     LOG(LIB_INFO) << "### " << reportName;
     LOG(LIB_INFO) << "### intrinsic dim: " << IntrDim;
@@ -0,0 +1,246 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#ifndef _SAMPLE_STAT_H_
+#define _SAMPLE_STAT_H_
+
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <queue>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "exact_knn.h"
+#include "object.h"
+#include "space.h"
+#include "logging.h"
+#include "my_isnan_isinf.h"
+#include "thread_pool.h"
+
+namespace similarity {
+
+using std::pair;
+using std::string;
+using std::vector;
+using std::unique_ptr;
+
+/*
+ * Random pairs (triples) are sampled in chunks. Each chunk has its own
+ * random generator seeded using the chunk number. Chunk results are
+ * merged in the order of chunks. Hence, the outcome doesn't depend on
+ * the number of threads.
+ */
+const size_t SAMPLE_STAT_CHUNK_QTY        = 65536;
+// The number of pairs used to determine the range of the histogram
+const size_t SAMPLE_STAT_HIST_PILOT_QTY   = 10000;
+
+/*
+ * The mean, the variance (a population one), the minimum and the maximum
+ * computed in one pass (B. P. Welford's method). Two objects are
+ * merged using the formula of T. F. Chan, G. H. Golub, and R. J. LeVeque.
+ */
+struct RunningStat {
+  RunningStat() : Qty(0), Mean(0), M2(0),
+                  Min(std::numeric_limits<double>::max()),
+                  Max(-std::numeric_limits<double>::max()) {}
+
+  void Add(double x) {
+    ++Qty;
+    double delta = x - Mean;
+    Mean += delta / Qty;
+    M2 += delta * (x - Mean);
+    Min = std::min(Min, x);
+    Max = std::max(Max, x);
+  }
+
+  void Merge(const RunningStat& other);
+
+  double Var() const { return Qty ? M2 / Qty : 0; }
+
+  uint64_t  Qty;
+  double    Mean;
+  double    M2;
+  double    Min;
+  double    Max;
+};
+
+/*
+ * A histogram with equal-width bins: values outside of [MinVal, MaxVal)
+ * are counted in the underflow and overflow bins.
+ */
+class DistHistogram {
+public:
+  DistHistogram(double minVal, double maxVal, size_t binQty);
+
+  void Add(double x) {
+    if (x < minVal_) ++underflowQty_;
+    else {
+      size_t bin = static_cast<size_t>((x - minVal_) / binWidth_);
+      if (bin < counts_.size()) ++counts_[bin];
+      else ++overflowQty_;
+    }
+  }
+
+  void Merge(const DistHistogram& other);
+
+  /*
+   * Writes a tab-separated table, where each line has the left and
+   * the right bin boundaries, the number of values in the bin, and
+   * the cumulative fraction of values.
+   */
+  void Write(std::ostream& out) const;
+
+  uint64_t GetTotalQty() const;
+
+private:
+  double            minVal_;
+  double            binWidth_;
+  vector<uint64_t>  counts_;
+  uint64_t          underflowQty_;
+  uint64_t          overflowQty_;
+};
+
+/*
+ * Selects a uniform random sample of a stream using
+ * the reservoir sampling (J. S. Vitter's algorithm R). Offer() returns
+ * the position in the sample where the current stream element should be
+ * stored, or -1 if the element is skipped.
+ */
+class ReservoirSampler {
+public:
+  ReservoirSampler(size_t sampleQty, uint64_t seed) :
+                  sampleQty_(sampleQty), seenQty_(0), randGen_(seed) {}
+
+  int64_t Offer() {
+    uint64_t pos = seenQty_++;
+    if (pos < sampleQty_) return static_cast<int64_t>(pos);
+    uint64_t r = std::uniform_int_distribution<uint64_t>(0, pos)(randGen_);
+    return r < sampleQty_ ? static_cast<int64_t>(r) : -1;
+  }
+
+  uint64_t GetSeenQty() const { return seenQty_; }
+
+private:
+  size_t          sampleQty_;
+  uint64_t        seenQty_;
+  std::mt19937_64 randGen_;
+};
+
+/*
+ * Reads a reservoir sample of at most sampleQty objects from a data file.
+ * Only sampled objects are parsed, so the whole file is never kept in memory.
+ * Object ids are positions in the file. The order of objects in the sample
+ * is random. The input state is returned so that the caller can update the
+ * space parameters (see Space::UpdateParamsFromFile).
+ */
+template <typename dist_t>
+unique_ptr<DataFileInputState> ReadDatasetSample(const Space<dist_t>& space,
+                                                 ObjectVector& dataset,
+                                                 const string& inputFile,
+                                                 size_t sampleQty,
+                                                 uint64_t seed,
+                                                 uint64_t& totalQty) {
+  CHECK_MSG(sampleQty > 0, "The sample size should be positive");
+  unique_ptr<DataFileInputState> inpState(space.OpenReadFileHeader(inputFile));
+  ReservoirSampler sampler(sampleQty, seed);
+
+  dataset.clear();
+  string    line;
+  LabelType label;
+  string    externId;
+  while (space.ReadNextObjStr(*inpState, line, label, externId)) {
+    IdType  id  = static_cast<IdType>(sampler.GetSeenQty());
+    int64_t pos = sampler.Offer();
+    if (pos < 0) continue;
+    Object* pObj = space.CreateObjFromStr(id, label, line, inpState.get()).release();
+    if (static_cast<size_t>(pos) == dataset.size()) {
+      dataset.push_back(pObj);
+    } else {
+      delete dataset[pos];
+      dataset[pos] = pObj;
+    }
+  }
+  inpState->Close();
+  totalQty = sampler.GetSeenQty();
+  return inpState;
+}
+
+template <typename dist_t>
+inline double CheckedDist(const Space<dist_t>& space, const Object* pObj1, const Object* pObj2) {
+  dist_t d = space.IndexTimeDistance(pObj1, pObj2);
+  if (my_isnan(d)) {
+    throw runtime_error("!!! Bug: a distance returned NAN!");
+  }
+  return double(d);
+}
+
+/*
+ * Computes statistics (and, optionally, a histogram) of distances
+ * between pairQty random pairs of data points using threadQty threads.
+ * The histogram range is determined from a small pilot sample.
+ */
+template <typename dist_t>
+void SampleRandomPairDistances(const Space<dist_t>& space,
+                               const ObjectVector& dataset,
+                               size_t pairQty,
+                               size_t threadQty,
+                               uint64_t seed,
+                               RunningStat& stat,
+                               unique_ptr<DistHistogram>* pHist = nullptr,
+                               size_t binQty = 0) {
+  CHECK_MSG(!dataset.empty(), "The data set is empty");
+  CHECK_MSG(pairQty > 0, "The number of sampled pairs should be positive");
+  std::uniform_int_distribution<size_t> randPos(0, dataset.size() - 1);
+
+  if (pHist != nullptr) {
+    std::mt19937_64 randGen(seed);
+    RunningStat pilot;
+    for (size_t i = 0; i < std::min(pairQty, SAMPLE_STAT_HIST_PILOT_QTY); ++i) {
+      pilot.Add(CheckedDist(space, dataset[randPos(randGen)], dataset[randPos(randGen)]));
+    }
+    double maxVal = pilot.Max > pilot.Min ? pilot.Max : pilot.Min + 1;
+    pHist->reset(new DistHistogram(pilot.Min, maxVal, binQty));
+  }
+
+  size_t chunkQty = (pairQty + SAMPLE_STAT_CHUNK_QTY - 1) / SAMPLE_STAT_CHUNK_QTY;
+  vector<RunningStat>               chunkStat(chunkQty);
+  vector<unique_ptr<DistHistogram>> chunkHist(chunkQty);
+
+  ParallelFor(0, chunkQty, threadQty, [&](size_t chunkId) {
+    std::mt19937_64 randGen(seed + 1 + chunkId);
+    std::uniform_int_distribution<size_t> randPos(0, dataset.size() - 1);
+    size_t qty = std::min(SAMPLE_STAT_CHUNK_QTY, pairQty - chunkId * SAMPLE_STAT_CHUNK_QTY);
+    if (pHist != nullptr) chunkHist[chunkId].reset(new DistHistogram(**pHist));
+    for (size_t i = 0; i < qty; ++i) {
+      double d = CheckedDist(space, dataset[randPos(randGen)], dataset[randPos(randGen)]);
+      chunkStat[chunkId].Add(d);
+      if (pHist != nullptr) chunkHist[chunkId]->Add(d);
+    }
+  });
+
+  stat = RunningStat();
+  for (size_t chunkId = 0; chunkId < chunkQty; ++chunkId) {
+    stat.Merge(chunkStat[chunkId]);
+    if (pHist != nullptr) (*pHist)->Merge(*chunkHist[chunkId]);
+  }
+}
+
+}   // namespace similarity
+
+#endif      // _SAMPLE_STAT_H_
@@ -0,0 +1,116 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#ifndef _SEARCH_STAT_H_
+#define _SEARCH_STAT_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace similarity {
+
+using std::string;
+using std::vector;
+using std::pair;
+
+/*
+ * Search methods update traversal statistics only if the library
+ * is compiled with WITH_SEARCH_STAT (see the CMake option with
+ * the same name). Otherwise, the statement is compiled out
+ * and all statistics remain zero. Note that the layout of
+ * the SearchStat object doesn't depend on this flag.
+ */
+#ifdef WITH_SEARCH_STAT
+#define SEARCH_STAT(stmt) do { stmt; } while (0)
+#else
+#define SEARCH_STAT(stmt) do { } while (0)
+#endif
+
+inline bool IsSearchStatEnabled() {
+#ifdef WITH_SEARCH_STAT
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Hops at layers >= SEARCH_STAT_MAX_LAYER are counted at the last layer
+const unsigned SEARCH_STAT_MAX_LAYER = 16;
+
+/*
+ * Per-query statistics of graph and tree traversals:
+ *
+ * HopQty_       the number of expanded nodes (per layer for hierarchical graphs)
+ * VisitedQty_   the number of entries marked in the visited list
+ * HeapOpQty_    the number of insertions into and extractions from the candidate queues
+ * LeafQty_      the number of visited tree leaves (buckets)
+ * LeafLimit_    the maximum number of leaves a search is allowed to visit (0 means no limit)
+ * CandQty_      the number of scanned candidate records (e.g., from inverted files)
+ * CandLimit_    the maximum number of candidates to scan (0 means no limit)
+ *
+ * The object is updated by the search thread only, so there's no synchronization.
+ */
+struct SearchStat {
+  SearchStat() { Reset(); }
+
+  void Reset() {
+    for (unsigned i = 0; i < SEARCH_STAT_MAX_LAYER; ++i) HopQty_[i] = 0;
+    VisitedQty_ = HeapOpQty_ = LeafQty_ = LeafLimit_ = CandQty_ = CandLimit_ = 0;
+  }
+
+  void AddHop(unsigned layer, uint64_t qty = 1) {
+    HopQty_[layer < SEARCH_STAT_MAX_LAYER ? layer : SEARCH_STAT_MAX_LAYER - 1] += qty;
+  }
+
+  void Add(const SearchStat& other) {
+    for (unsigned i = 0; i < SEARCH_STAT_MAX_LAYER; ++i) HopQty_[i] += other.HopQty_[i];
+    VisitedQty_ += other.VisitedQty_;
+    HeapOpQty_  += other.HeapOpQty_;
+    LeafQty_    += other.LeafQty_;
+    LeafLimit_  += other.LeafLimit_;
+    CandQty_    += other.CandQty_;
+    CandLimit_  += other.CandLimit_;
+  }
+
+  uint64_t GetHopQty() const {
+    uint64_t res = 0;
+    for (unsigned i = 0; i < SEARCH_STAT_MAX_LAYER; ++i) res += HopQty_[i];
+    return res;
+  }
+
+  /*
+   * Named non-zero values (hops are listed as hops_l0, hops_l1, ...),
+   * which is convenient for exporting the statistics, e.g., to Python.
+   */
+  vector<pair<string, uint64_t>> GetNamedValues() const;
+
+  /*
+   * Prints non-zero values divided by qty, e.g., by the number of queries.
+   */
+  string ToString(double qty) const;
+
+  uint64_t  HopQty_[SEARCH_STAT_MAX_LAYER];
+  uint64_t  VisitedQty_;
+  uint64_t  HeapOpQty_;
+  uint64_t  LeafQty_;
+  uint64_t  LeafLimit_;
+  uint64_t  CandQty_;
+  uint64_t  CandLimit_;
+};
+
+}   // namespace similarity
+
+#endif      // _SEARCH_STAT_H_
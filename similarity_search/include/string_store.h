@@ -0,0 +1,84 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#ifndef _STRING_STORE_H_
+#define _STRING_STORE_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "global.h"
+#include "mmap_file.h"
+
+namespace similarity {
+
+/*
+ * An immutable array of strings kept in one contiguous buffer, so that
+ * retrieving a string requires neither allocation nor formatting. The i-th string
+ * occupies bytes [offsets[i], offsets[i+1]) of the buffer.
+ *
+ * The store can be saved to a binary file and memory mapped later: the file has
+ * a header, which is followed by qty+1 64-bit offsets and the string buffer.
+ * The header keeps a fingerprint of the data the strings were created from,
+ * so that a file created for different data can be detected.
+ */
+struct StringStoreFileHeader {
+  char      magic[8];
+  uint32_t  version;
+  uint32_t  reserved;
+  uint64_t  qty;
+  uint64_t  fingerprint;
+};
+
+class StringStore {
+public:
+  StringStore() : qty_(0), fingerprint_(0), offsetBuf_(1, 0) {
+    offsets_ = &offsetBuf_[0];
+    chars_   = charBuf_.data();
+  }
+
+  // getStr(i) returns the i-th string
+  void Build(size_t qty, const std::function<std::string(size_t)>& getStr);
+  void Save(const std::string& location) const;
+  // Maps the file created by Save, the file should not be modified while the store is used
+  void Load(const std::string& location);
+
+  size_t      size() const { return qty_; }
+  const char* data(size_t i) const { return chars_ + offsets_[i]; }
+  size_t      length(size_t i) const { return offsets_[i + 1] - offsets_[i]; }
+  std::string str(size_t i) const { return std::string(data(i), length(i)); }
+
+  // The fingerprint is set by the creator (e.g., a checksum of the source data) and saved with strings
+  void        SetFingerprint(uint64_t fingerprint) { fingerprint_ = fingerprint; }
+  uint64_t    GetFingerprint() const { return fingerprint_; }
+
+private:
+  size_t                      qty_;
+  uint64_t                    fingerprint_;
+  const uint64_t*             offsets_;
+  const char*                 chars_;
+  // Either the in-memory buffers or the mapped file holds the data
+  std::vector<uint64_t>       offsetBuf_;
+  std::string                 charBuf_;
+  std::unique_ptr<MappedFile> file_;
+
+  DISABLE_COPY_AND_ASSIGN(StringStore);
+};
+
+}   // namespace similarity
+
+#endif      // _STRING_STORE_H_
@@ -12,10 +12,19 @@
  * Apache License Version 2.0 http://www.apache.org/licenses/.
  *
  */
+#ifndef _THREAD_POOL_H
+#define _THREAD_POOL_H
+
+#include <algorithm>
 #include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
 #include <thread>
 #include <queue>
 #include <mutex>
+#include <vector>
 
 namespace similarity {
 
@@ -105,4 +114,126 @@ namespace similarity {
       std::rethrow_exception(lastException);
     }
   }
+
+  /*
+   * A pool of persistent worker threads. Unlike the function ParallelFor,
+   * the method ParallelFor doesn't start new threads, so it is cheap enough
+   * to be called for every query. It can be called from several threads
+   * concurrently: jobs of different calls are queued and served by the same workers.
+   * The calling thread processes ids too, so a call never waits for a busy pool to
+   * start its jobs, and a pool with zero workers runs everything in the calling thread.
+   */
+  class ThreadPool {
+  public:
+    explicit ThreadPool(size_t workerQty) {
+      for (size_t i = 0; i < workerQty; ++i) {
+        workers_.emplace_back([this] { workerMain(); });
+      }
+    }
+    ~ThreadPool() {
+      {
+        std::unique_lock<std::mutex> lock(mtx_);
+        stop_ = true;
+      }
+      cond_.notify_all();
+      for (auto& thread : workers_) thread.join();
+    }
+
+    size_t GetWorkerQty() const { return workers_.size(); }
+
+    // Processes ids from start (inclusive) to end (EXCLUSIVE), exceptions are re-thrown in the calling thread
+    template <class Function>
+    void ParallelFor(size_t start, size_t end, Function fn) {
+      if (start >= end) return;
+      std::shared_ptr<Batch> batch = std::make_shared<Batch>(start, end);
+      std::function<void(size_t)> func(fn);
+      // Workers may dequeue jobs after the call returns: such jobs don't touch func
+      auto job = [batch, &func]() {
+        if (batch->enter()) {
+          batch->run(func);
+          batch->leave();
+        }
+      };
+      size_t jobQty = std::min(workers_.size(), end - start - 1);
+      if (jobQty) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        for (size_t i = 0; i < jobQty; ++i) jobs_.push(job);
+      }
+      if (jobQty == 1) cond_.notify_one();
+      else if (jobQty > 1) cond_.notify_all();
+
+      batch->run(func);
+      batch->close();
+      if (batch->lastException) {
+        std::rethrow_exception(batch->lastException);
+      }
+    }
+
+  private:
+    struct Batch {
+      Batch(size_t start, size_t endParam) : current(start), end(endParam) {}
+
+      std::atomic<size_t>       current;
+      const size_t              end;
+      std::mutex                mtx;
+      std::condition_variable   doneCond;
+      size_t                    activeQty = 0;
+      bool                      closed = false;
+      std::exception_ptr        lastException = nullptr;
+
+      // Returns false if the call has already returned
+      bool enter() {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (closed) return false;
+        ++activeQty;
+        return true;
+      }
+      void run(const std::function<void(size_t)>& fn) {
+        while (true) {
+          size_t id = current.fetch_add(1);
+          if (id >= end) break;
+          try {
+            fn(id);
+          } catch (...) {
+            std::unique_lock<std::mutex> lock(mtx);
+            lastException = std::current_exception();
+            current = end;
+            break;
+          }
+        }
+      }
+      // Called by the calling thread: waits for the workers that entered the batch
+      void close() {
+        std::unique_lock<std::mutex> lock(mtx);
+        closed = true;
+        doneCond.wait(lock, [this] { return activeQty == 0; });
+      }
+      void leave() {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (--activeQty == 0) doneCond.notify_all();
+      }
+    };
+
+    void workerMain() {
+      while (true) {
+        std::function<void()> job;
+        {
+          std::unique_lock<std::mutex> lock(mtx_);
+          cond_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+          if (jobs_.empty()) return;
+          job = std::move(jobs_.front());
+          jobs_.pop();
+        }
+        job();
+      }
+    }
+
+    std::vector<std::thread>            workers_;
+    std::queue<std::function<void()>>   jobs_;
+    std::mutex                          mtx_;
+    std::condition_variable             cond_;
+    bool                                stop_ = false;
+  };
 };
+
+#endif
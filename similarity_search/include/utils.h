@@ -334,6 +334,9 @@ inline void ReplaceSomePunct(string &s) {
     if (s[i] == ',' || s[i] == FIELD_DELIMITER) s[i] = ' ';
 }
 
+// Escapes a string to be written between double quotes in a JSON file
+string EscapeJSON(const string& s);
+
 template <class T>
 T getRelDiff(T val1, T val2) {
   T diff = std::fabs(val1 - val2);
@@ -0,0 +1,267 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <system_error>
+
+#ifndef _MSC_VER
+#include <pthread.h>
+#endif
+
+#include "async_logger.h"
+
+using namespace std;
+
+namespace {
+
+// Existing loggers, their state is made consistent in a child process by fork handlers
+mutex                 gLoggersMutex;
+vector<AsyncLogger*>  gLoggers;
+
+}
+
+AsyncLogger::AsyncLogger(Logger * inner, size_t queueSize)
+  : inner_(inner), innerMutex_(new timed_mutex()), forkLocked_(false),
+    enqueuePos_(0), dequeuePos_(0),
+    pushedQty_(0), writtenQty_(0), droppedQty_(0), reportedDroppedQty_(0),
+    sleeping_(false), stop_(false), running_(false), activeProducerQty_(0) {
+  size_t cellQty = 2;
+  while (cellQty < queueSize) cellQty *= 2;
+
+  cells_ = vector<Cell>(cellQty);
+  for (size_t i = 0; i < cellQty; ++i) {
+    cells_[i].seq.store(i, memory_order_relaxed);
+  }
+  mask_ = cellQty - 1;
+
+#ifndef _MSC_VER
+  static once_flag atForkOnce;
+  call_once(atForkOnce, []() {
+    pthread_atfork(&AsyncLogger::prepareFork, &AsyncLogger::parentAfterFork, &AsyncLogger::childAfterFork);
+  });
+#endif
+  {
+    lock_guard<mutex> lock(gLoggersMutex);
+    gLoggers.push_back(this);
+  }
+
+  try {
+    thread_.reset(new thread(&AsyncLogger::drain, this));
+    running_ = true;
+  } catch (const system_error&) {
+    // Messages will be written synchronously
+  }
+}
+
+AsyncLogger::~AsyncLogger() {
+  stop();
+  lock_guard<mutex> lock(gLoggersMutex);
+  gLoggers.erase(find(gLoggers.begin(), gLoggers.end(), this));
+}
+
+void AsyncLogger::prepareFork() {
+  gLoggersMutex.lock();
+  for (AsyncLogger * logger : gLoggers) {
+    /*
+     * The wait is bounded, because the background thread can hold the lock
+     * while waiting for a resource held by the forking thread (e.g., the Python GIL).
+     */
+    logger->forkLocked_ =
+      logger->innerMutex_->try_lock_for(chrono::milliseconds(ASYNC_LOG_FLUSH_TIMEOUT_MS));
+  }
+}
+
+void AsyncLogger::parentAfterFork() {
+  for (AsyncLogger * logger : gLoggers) {
+    if (logger->forkLocked_) logger->innerMutex_->unlock();
+  }
+  gLoggersMutex.unlock();
+}
+
+void AsyncLogger::childAfterFork() {
+  for (AsyncLogger * logger : gLoggers) {
+    if (logger->forkLocked_) {
+      logger->innerMutex_->unlock();
+    } else {
+      // The owner doesn't exist in the child, so the mutex can be neither unlocked nor destroyed
+      logger->innerMutex_.release();
+      logger->innerMutex_.reset(new timed_mutex());
+    }
+    // The background thread doesn't exist either: it can't be joined, and the handle isn't destroyed
+    logger->thread_.release();
+    logger->running_ = false;
+    logger->sleeping_ = false;
+    for (size_t i = 0; i < logger->cells_.size(); ++i) {
+      logger->cells_[i].seq.store(i, memory_order_relaxed);
+    }
+    logger->enqueuePos_ = 0;
+    logger->dequeuePos_ = 0;
+    logger->pushedQty_ = 0;
+    logger->writtenQty_ = 0;
+    // Producers other than the forking thread don't exist in the child
+    logger->activeProducerQty_ = 0;
+  }
+  gLoggersMutex.unlock();
+}
+
+bool AsyncLogger::tryPush(LogSeverity severity, const char * file, int line,
+                          const char * function, const string & message) {
+  size_t pos = enqueuePos_.load(memory_order_relaxed);
+  Cell * cell;
+  while (true) {
+    cell = &cells_[pos & mask_];
+    size_t seq = cell->seq.load(memory_order_acquire);
+    intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+    if (dif == 0) {
+      if (enqueuePos_.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) break;
+    } else if (dif < 0) {
+      return false; // the queue is full
+    } else {
+      pos = enqueuePos_.load(memory_order_relaxed);
+    }
+  }
+  cell->rec.severity = severity;
+  cell->rec.file     = file;
+  cell->rec.line     = line;
+  cell->rec.function = function;
+  cell->rec.message  = message;
+  cell->seq.store(pos + 1, memory_order_release);
+  return true;
+}
+
+bool AsyncLogger::tryPop(Record & rec) {
+  Cell & cell = cells_[dequeuePos_ & mask_];
+  size_t seq = cell.seq.load(memory_order_acquire);
+  if (seq != dequeuePos_ + 1) return false;
+  rec = std::move(cell.rec);
+  cell.seq.store(dequeuePos_ + mask_ + 1, memory_order_release);
+  ++dequeuePos_;
+  return true;
+}
+
+void AsyncLogger::log(LogSeverity severity,
+                      const char * file,
+                      int line,
+                      const char * function,
+                      const string & message) {
+  /*
+   * The counter is increased before running_ is checked (both are sequentially
+   * consistent), so stop() either sees this producer or makes it write synchronously.
+   */
+  activeProducerQty_.fetch_add(1);
+  struct ProducerGuard {
+    atomic<size_t>& qty_;
+    ~ProducerGuard() { qty_.fetch_sub(1); }
+  } guard{activeProducerQty_};
+
+  if (!running_.load()) {
+    lock_guard<timed_mutex> lock(*innerMutex_);
+    inner_->log(severity, file, line, function, message);
+    return;
+  }
+  if (!tryPush(severity, file, line, function, message)) {
+    if (severity >= LIB_ERROR) {
+      // Errors are not dropped: queued messages are written first to preserve the order
+      flush();
+      lock_guard<timed_mutex> lock(*innerMutex_);
+      inner_->log(severity, file, line, function, message);
+      return;
+    }
+    droppedQty_.fetch_add(1, memory_order_relaxed);
+    return;
+  }
+  pushedQty_.fetch_add(1, memory_order_release);
+  if (sleeping_.load(memory_order_acquire)) waitCond_.notify_one();
+}
+
+void AsyncLogger::reportDropped() {
+  uint64_t droppedQty = droppedQty_.load(memory_order_relaxed);
+  if (droppedQty != reportedDroppedQty_) {
+    stringstream msg;
+    msg << (droppedQty - reportedDroppedQty_) << " log messages were dropped, because the queue was full";
+    reportedDroppedQty_ = droppedQty;
+    lock_guard<timed_mutex> lock(*innerMutex_);
+    inner_->log(LIB_WARNING, __FILE__, __LINE__, __FUNCTION__, msg.str());
+  }
+}
+
+void AsyncLogger::drain() {
+  Record rec;
+  while (true) {
+    while (tryPop(rec)) {
+      {
+        lock_guard<timed_mutex> lock(*innerMutex_);
+        inner_->log(rec.severity, rec.file, rec.line, rec.function, rec.message);
+      }
+      writtenQty_.fetch_add(1, memory_order_release);
+    }
+    reportDropped();
+    if (stop_.load(memory_order_acquire)) break;
+
+    unique_lock<mutex> lock(waitMutex_);
+    sleeping_.store(true, memory_order_release);
+    /*
+     * A notification can be missed, because producers don't lock the mutex.
+     * Hence, the wait time is bounded: in the worst case, a message is
+     * written with a small delay.
+     */
+    waitCond_.wait_for(lock, chrono::milliseconds(10));
+    sleeping_.store(false, memory_order_release);
+  }
+}
+
+void AsyncLogger::flush() {
+  if (!running_.load(memory_order_acquire)) return;
+  if (this_thread::get_id() == thread_->get_id()) return;
+
+  uint64_t target = pushedQty_.load(memory_order_acquire);
+  auto deadline = chrono::steady_clock::now() + chrono::milliseconds(ASYNC_LOG_FLUSH_TIMEOUT_MS);
+  while (writtenQty_.load(memory_order_acquire) < target &&
+         chrono::steady_clock::now() < deadline) {
+    waitCond_.notify_one();
+    this_thread::sleep_for(chrono::milliseconds(1));
+  }
+  lock_guard<timed_mutex> lock(*innerMutex_);
+  inner_->flush();
+}
+
+void AsyncLogger::stop() {
+  if (!running_.exchange(false)) return;
+
+  stop_ = true;
+  waitCond_.notify_one();
+  thread_->join();
+
+  /*
+   * Producers that saw running_ == true can still be pushing messages.
+   * The wait is bounded for the same reason as in flush().
+   */
+  auto deadline = chrono::steady_clock::now() + chrono::milliseconds(ASYNC_LOG_FLUSH_TIMEOUT_MS);
+  while (activeProducerQty_.load() != 0 && chrono::steady_clock::now() < deadline) {
+    this_thread::yield();
+  }
+
+  // Messages pushed by producers while the thread was finishing
+  Record rec;
+  while (tryPop(rec)) {
+    lock_guard<timed_mutex> lock(*innerMutex_);
+    inner_->log(rec.severity, rec.file, rec.line, rec.function, rec.message);
+  }
+  reportDropped();
+
+  lock_guard<timed_mutex> lock(*innerMutex_);
+  inner_->flush();
+}
@@ -0,0 +1,90 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include "bench_kernel.h"
+#include "logging.h"
+#include "utils.h"
+
+namespace similarity {
+
+volatile double gKernelBenchSink = 0;
+
+namespace {
+
+string GetCompilerName() {
+#if defined(__clang__)
+  return string("clang ") + __clang_version__;
+#elif defined(__INTEL_COMPILER)
+  return "icc " + ConvertToString(__INTEL_COMPILER);
+#elif defined(__GNUC__)
+  return string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+  return "msvc " + ConvertToString(_MSC_VER);
+#else
+  return "unknown";
+#endif
+}
+
+}
+
+void WriteKernelBenchJSON(std::ostream& out, const string& label, int cpuId,
+                          const KernelBenchConfig& conf,
+                          const vector<KernelBenchResult>& results) {
+  out << "{" << std::endl;
+  out << "  \"label\": \"" << EscapeJSON(label) << "\"," << std::endl;
+  out << "  \"time\": \"" << EscapeJSON(LibGetCurrentTime()) << "\"," << std::endl;
+  out << "  \"cpu\": \"" << EscapeJSON(GetCPUModelName()) << "\"," << std::endl;
+  out << "  \"pinnedCpu\": " << cpuId << "," << std::endl;
+  out << "  \"compiler\": \"" << EscapeJSON(GetCompilerName()) << "\"," << std::endl;
+  out << "  \"simd\": \"" << GetCompiledSIMD() << "\"," << std::endl;
+  out << "  \"vectQty\": " << conf.VectQty << "," << std::endl;
+  out << "  \"warmupMicroSec\": " << conf.WarmupMicroSec << "," << std::endl;
+  out << "  \"trialMicroSec\": " << conf.TrialMicroSec << "," << std::endl;
+  out << "  \"trialQty\": " << conf.TrialQty << "," << std::endl;
+  out << "  \"results\": [" << std::endl;
+  for (size_t i = 0; i < results.size(); ++i) {
+    const KernelBenchResult& r = results[i];
+    out << "    {\"name\": \"" << EscapeJSON(r.Name) << "\", "
+        << "\"dtype\": \"" << r.DataType << "\", "
+        << "\"dim\": " << r.Dim << ", "
+        << "\"bytesPerDist\": " << r.BytesPerDist << ", "
+        << "\"distPerTrial\": " << r.DistPerTrial << ", "
+        << "\"distPerSec\": " << r.DistPerSecMean << ", "
+        << "\"distPerSecConfMin\": " << r.DistPerSecConfMin << ", "
+        << "\"distPerSecConfMax\": " << r.DistPerSecConfMax << ", "
+        << "\"nsPerDist\": " << r.NanoSecPerDist << ", "
+        << "\"GBPerSec\": " << r.GBPerSecMean << ", "
+        << "\"trials\": [";
+    for (size_t k = 0; k < r.TrialDistPerSec.size(); ++k) {
+      out << (k ? ", " : "") << r.TrialDistPerSec[k];
+    }
+    out << "]";
+    if (r.Perf.IsAnyValid() && r.PerfDistQty) {
+      out << ", \"perfPerDist\": {";
+      bool bFirst = true;
+      for (unsigned e = 0; e < kPerfEventQty; ++e) {
+        if (!r.Perf.Valid_[e]) continue;
+        out << (bFirst ? "" : ", ") << "\"" << GetPerfEventName(e) << "\": " 
+            << double(r.Perf.Counts_[e]) / r.PerfDistQty;
+        bFirst = false;
+      }
+      out << "}";
+    }
+    out << "}" << (i + 1 < results.size() ? "," : "") << std::endl;
+  }
+  out << "  ]" << std::endl;
+  out << "}" << std::endl;
+}
+
+}   // namespace similarity
@@ -0,0 +1,208 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef _MSC_VER
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "build_profile.h"
+#include "memory.h"
+#include "utils.h"
+
+namespace similarity {
+
+using std::runtime_error;
+using std::stringstream;
+
+double BuildProfiler::GetCPUTime() {
+#ifdef _MSC_VER
+  FILETIME creationTime, exitTime, kernelTime, userTime;
+  if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime)) return 0;
+  ULARGE_INTEGER kernel, user;
+  kernel.LowPart = kernelTime.dwLowDateTime;
+  kernel.HighPart = kernelTime.dwHighDateTime;
+  user.LowPart = userTime.dwLowDateTime;
+  user.HighPart = userTime.dwHighDateTime;
+  // FILETIME is measured in 100-nanosecond intervals
+  return (kernel.QuadPart + user.QuadPart) / 1e7;
+#else
+  struct timespec ts;
+  if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0) return 0;
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+void BuildProfiler::Reset() {
+  Clear();
+  peakRSSBase_ = peakRSS_ = MemUsage().get_peak_rss();
+}
+
+void BuildProfiler::Clear() {
+  phases_.clear();
+  inPhase_ = false;
+  phaseCPUStart_ = 0;
+
+  {
+    std::unique_lock<std::mutex> lock(progressMutex_);
+    progress_.clear();
+  }
+  doneQty_ = 0;
+  sampleInterval_ = 0;
+
+  for (unsigned i = 0; i < BUILD_PROFILE_MAX_SUBPHASE; ++i) {
+    subPhaseNames_[i].clear();
+    subPhaseNanoSec_[i] = 0;
+    subPhaseCallQty_[i] = 0;
+  }
+  subPhaseQty_ = 0;
+  peakRSS_ = 0;
+  peakRSSBase_ = 0;
+}
+
+void BuildProfiler::StartPhase(const string& name) {
+  EndPhase();
+
+  BuildPhaseStat stat;
+  stat.Name     = name;
+  stat.RSSStart = MemUsage().get_rss();
+  phases_.push_back(stat);
+
+  inPhase_ = true;
+  phaseCPUStart_ = GetCPUTime();
+  phaseTimer_.reset();
+}
+
+void BuildProfiler::EndPhase() {
+  if (!inPhase_) return;
+  inPhase_ = false;
+
+  BuildPhaseStat& stat = phases_.back();
+  phaseTimer_.split();
+  stat.WallTime = phaseTimer_.elapsed() / 1e6;
+  stat.CPUTime  = GetCPUTime() - phaseCPUStart_;
+
+  MemUsage mem;
+  stat.RSSEnd   = mem.get_rss();
+  stat.PeakRSS  = mem.get_peak_rss();
+  stat.PeakRSSIncrease = std::max(0.0, stat.PeakRSS - peakRSSBase_);
+  peakRSS_ = std::max(peakRSS_, stat.PeakRSS);
+}
+
+void BuildProfiler::StartProgress(uint64_t totalQty, unsigned sampleQty) {
+  std::unique_lock<std::mutex> lock(progressMutex_);
+  progress_.clear();
+  doneQty_ = 0;
+  sampleInterval_ = std::max<uint64_t>(1, totalQty / std::max(1u, sampleQty));
+  progressTimer_.reset();
+}
+
+void BuildProfiler::TakeProgressSample() {
+  std::unique_lock<std::mutex> lock(progressMutex_);
+
+  BuildProgressSample sample;
+  progressTimer_.split();
+  sample.Time    = progressTimer_.elapsed() / 1e6;
+  sample.DoneQty = doneQty_.load();
+  sample.RSS     = MemUsage().get_rss();
+
+  double   prevTime = progress_.empty() ? 0 : progress_.back().Time;
+  uint64_t prevQty  = progress_.empty() ? 0 : progress_.back().DoneQty;
+  // Samples can be taken out of order by different threads
+  if (sample.DoneQty <= prevQty) return;
+  if (sample.Time > prevTime) {
+    sample.ItemsPerSec = (sample.DoneQty - prevQty) / (sample.Time - prevTime);
+  }
+  progress_.push_back(sample);
+}
+
+unsigned BuildProfiler::RegisterSubPhase(const string& name) {
+  for (unsigned i = 0; i < subPhaseQty_; ++i) {
+    if (subPhaseNames_[i] == name) return i;
+  }
+  if (subPhaseQty_ >= BUILD_PROFILE_MAX_SUBPHASE) {
+    throw runtime_error("Too many build sub-phases, the maximum is " +
+                        std::to_string(BUILD_PROFILE_MAX_SUBPHASE));
+  }
+  subPhaseNames_[subPhaseQty_] = name;
+  return subPhaseQty_++;
+}
+
+vector<BuildSubPhaseStat> BuildProfiler::GetSubPhases() const {
+  vector<BuildSubPhaseStat> res(subPhaseQty_);
+  for (unsigned i = 0; i < subPhaseQty_; ++i) {
+    res[i].Name       = subPhaseNames_[i];
+    res[i].ThreadTime = subPhaseNanoSec_[i].load() / 1e9;
+    res[i].CallQty    = subPhaseCallQty_[i].load();
+  }
+  return res;
+}
+
+string BuildProfiler::ToString() const {
+  stringstream res;
+  for (const BuildPhaseStat& p : phases_) {
+    res << p.Name << ": " << p.WallTime << " sec (CPU " << p.CPUTime << " sec) ";
+  }
+  for (const BuildSubPhaseStat& s : GetSubPhases()) {
+    res << "[" << s.Name << ": " << s.ThreadTime << " thread-sec] ";
+  }
+  res << "peak RSS: " << peakRSS_ << " MB (+" << GetPeakRSSIncrease() << " MB)";
+  return res.str();
+}
+
+string BuildProfiler::ToJSON() const {
+  stringstream res;
+
+  res << "{\"peakRssMB\": " << peakRSS_ << ", "
+      << "\"peakRssIncreaseMB\": " << GetPeakRSSIncrease() << ", \"phases\": [";
+  for (size_t i = 0; i < phases_.size(); ++i) {
+    const BuildPhaseStat& p = phases_[i];
+    res << (i ? ", " : "")
+        << "{\"name\": \"" << EscapeJSON(p.Name) << "\", "
+        << "\"wallSec\": " << p.WallTime << ", "
+        << "\"cpuSec\": " << p.CPUTime << ", "
+        << "\"rssStartMB\": " << p.RSSStart << ", "
+        << "\"rssEndMB\": " << p.RSSEnd << ", "
+        << "\"peakRssMB\": " << p.PeakRSS << ", "
+        << "\"peakRssIncreaseMB\": " << p.PeakRSSIncrease << "}";
+  }
+  res << "], \"subPhases\": [";
+  vector<BuildSubPhaseStat> subPhases = GetSubPhases();
+  for (size_t i = 0; i < subPhases.size(); ++i) {
+    const BuildSubPhaseStat& s = subPhases[i];
+    res << (i ? ", " : "")
+        << "{\"name\": \"" << EscapeJSON(s.Name) << "\", "
+        << "\"threadSec\": " << s.ThreadTime << ", "
+        << "\"callQty\": " << s.CallQty << "}";
+  }
+  res << "], \"progress\": [";
+  for (size_t i = 0; i < progress_.size(); ++i) {
+    const BuildProgressSample& s = progress_[i];
+    res << (i ? ", " : "")
+        << "{\"sec\": " << s.Time << ", "
+        << "\"done\": " << s.DoneQty << ", "
+        << "\"itemsPerSec\": " << s.ItemsPerSec << ", "
+        << "\"rssMB\": " << s.RSS << "}";
+  }
+  res << "]}";
+
+  return res.str();
+}
+
+}   // namespace similarity
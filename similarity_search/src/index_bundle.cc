@@ -0,0 +1,186 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include <cstring>
+#include <fstream>
+
+#include "index_bundle.h"
+#include "logging.h"
+#include "utils.h"
+
+#define INDEX_BUNDLE_FILE_VERSION 1
+#define INDEX_BUNDLE_ALIGN        16
+
+namespace similarity {
+
+using namespace std;
+
+const char INDEX_BUNDLE_FILE_MAGIC[8] = {'N', 'M', 'S', 'L', 'I', 'B', 'I', 'B'};
+
+namespace {
+
+inline uint64_t AlignSize(uint64_t size) {
+  return (size + INDEX_BUNDLE_ALIGN - 1) / INDEX_BUNDLE_ALIGN * INDEX_BUNDLE_ALIGN;
+}
+
+void WritePadding(ostream& out, uint64_t size) {
+  static const char zeros[INDEX_BUNDLE_ALIGN] = {0};
+  out.write(zeros, AlignSize(size) - size);
+}
+
+/*
+ * Positions of sections in the file: each section starts at a 16-byte boundary,
+ * the header size is a multiple of 16.
+ */
+struct SectionPos {
+  SectionPos(const IndexBundleFileHeader& header) {
+    desc        = sizeof(header);
+    objOffsets  = desc + AlignSize(header.descSize);
+    arena       = objOffsets + AlignSize(sizeof(uint64_t) * (header.objQty + 1));
+    externIds   = arena + header.arenaSize;
+    end         = externIds + sizeof(uint64_t) * (header.objQty + 1) + header.externIdSize;
+  }
+  uint64_t desc, objOffsets, arena, externIds, end;
+};
+
+}
+
+void IndexBundle::SaveData(const string& location,
+                           const string& distType,
+                           const string& spaceType, const AnyParams& spaceParams,
+                           const string& methodName,
+                           const ObjectVector& data, const vector<string>& externIds) {
+  CHECK_MSG(data.size() == externIds.size(),
+            "Bug: the number of external IDs (" + ConvertToString(externIds.size()) +
+            ") doesn't match the number of data points (" + ConvertToString(data.size()) + ")");
+  string desc = distType + "\n" + spaceType + "\n" + methodName + "\n";
+  for (size_t i = 0; i < spaceParams.ParamNames.size(); ++i) {
+    desc += spaceParams.ParamNames[i] + "=" + spaceParams.ParamValues[i] + "\n";
+  }
+
+  vector<uint64_t> objOffsets(1, 0), externIdOffsets(1, 0);
+  for (const Object* pObj : data) objOffsets.push_back(objOffsets.back() + AlignSize(pObj->bufferlength()));
+  for (const string& id : externIds) externIdOffsets.push_back(externIdOffsets.back() + id.size());
+
+  IndexBundleFileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, INDEX_BUNDLE_FILE_MAGIC, sizeof(header.magic));
+  header.version      = INDEX_BUNDLE_FILE_VERSION;
+  header.idSize       = sizeof(IdType);
+  header.objQty       = data.size();
+  header.descSize     = desc.size();
+  header.arenaSize    = objOffsets.back();
+  header.externIdSize = externIdOffsets.back();
+
+  string tmpLocation = GetTempFileNameForAtomicWrite(location);
+  ofstream outFile(tmpLocation, std::ios::binary);
+  CHECK_MSG(outFile, "Cannot open file '" + tmpLocation + "' for writing");
+  outFile.exceptions(std::ios::badbit | std::ios::failbit);
+
+  writeBinaryPOD(outFile, header);
+  outFile.write(desc.data(), desc.size());
+  WritePadding(outFile, desc.size());
+  outFile.write(reinterpret_cast<const char*>(&objOffsets[0]), sizeof(objOffsets[0]) * objOffsets.size());
+  WritePadding(outFile, sizeof(objOffsets[0]) * objOffsets.size());
+  for (const Object* pObj : data) {
+    outFile.write(pObj->buffer(), pObj->bufferlength());
+    WritePadding(outFile, pObj->bufferlength());
+  }
+  outFile.write(reinterpret_cast<const char*>(&externIdOffsets[0]), sizeof(externIdOffsets[0]) * externIdOffsets.size());
+  for (const string& id : externIds) outFile.write(id.data(), id.size());
+  outFile.close();
+
+  CommitAtomicWrite(tmpLocation, location);
+  LOG(LIB_INFO) << "Saved the index bundle with " << data.size() << " data points to " << location;
+}
+
+bool IndexBundle::IsBundle(const string& location) {
+  ifstream inFile(location, std::ios::binary);
+  char magic[sizeof(INDEX_BUNDLE_FILE_MAGIC)];
+  return inFile.read(magic, sizeof(magic)) && memcmp(magic, INDEX_BUNDLE_FILE_MAGIC, sizeof(magic)) == 0;
+}
+
+IndexBundle::IndexBundle(const string& location) : location_(location), file_(location) {
+  IndexBundleFileHeader header;
+
+  CHECK_MSG(file_.size() >= sizeof(header) &&
+            memcmp(file_.data(), INDEX_BUNDLE_FILE_MAGIC, sizeof(header.magic)) == 0,
+            "The file '" + location + "' isn't an index bundle");
+  memcpy(&header, file_.data(), sizeof(header));
+  CHECK_MSG(header.version == INDEX_BUNDLE_FILE_VERSION,
+            "Unsupported version of the index bundle file: " + ConvertToString(header.version));
+  CHECK_MSG(header.idSize == sizeof(IdType),
+            "The index bundle '" + location + "' was created on an incompatible platform");
+  CHECK_MSG(header.objQty < file_.size() && header.descSize < file_.size() &&
+            header.arenaSize < file_.size() && header.externIdSize < file_.size() &&
+            SectionPos(header).end <= file_.size(),
+            "The index bundle '" + location + "' is truncated");
+
+  SectionPos pos(header);
+  qty_             = header.objQty;
+  objOffsets_      = reinterpret_cast<const uint64_t*>(file_.data() + pos.objOffsets);
+  arena_           = file_.data() + pos.arena;
+  externIdOffsets_ = reinterpret_cast<const uint64_t*>(file_.data() + pos.externIds);
+  externIdChars_   = reinterpret_cast<const char*>(externIdOffsets_ + qty_ + 1);
+  CHECK_MSG(objOffsets_[qty_] == header.arenaSize && externIdOffsets_[qty_] == header.externIdSize,
+            "Bug or inconsistent data: invalid offsets in the index bundle '" + location + "'");
+
+  vector<string> lines;
+  string         desc(file_.data() + pos.desc, header.descSize);
+  for (size_t start = 0, end; start < desc.size(); start = end + 1) {
+    end = desc.find('\n', start);
+    if (end == string::npos) end = desc.size();
+    lines.push_back(desc.substr(start, end - start));
+  }
+  CHECK_MSG(lines.size() >= 3,
+            "Bug or inconsistent data: invalid description in the index bundle '" + location + "'");
+  distType_   = lines[0];
+  spaceType_  = lines[1];
+  methodName_ = lines[2];
+  vector<string> paramNames, paramValues;
+  for (size_t i = 3; i < lines.size(); ++i) {
+    size_t eqPos = lines[i].find('=');
+    CHECK_MSG(eqPos != string::npos,
+              "Bug or inconsistent data: invalid space parameter '" + lines[i] + "' in the index bundle");
+    paramNames.push_back(lines[i].substr(0, eqPos));
+    paramValues.push_back(lines[i].substr(eqPos + 1));
+  }
+  spaceParams_ = AnyParams(paramNames, paramValues);
+
+  LOG(LIB_INFO) << "Mapped the index bundle with " << qty_ << " data points, space: " << spaceType_
+                << " method: " << methodName_ << " distance type: " << distType_;
+}
+
+void IndexBundle::ReadData(ObjectVector& data, vector<string>& externIds) const {
+  data.reserve(data.size() + qty_);
+  externIds.reserve(externIds.size() + qty_);
+  for (size_t i = 0; i < qty_; ++i) {
+    CHECK_MSG(objOffsets_[i] <= objOffsets_[i + 1] && externIdOffsets_[i] <= externIdOffsets_[i + 1],
+              "Bug or inconsistent data: invalid offsets in the index bundle '" + location_ + "'");
+    unique_ptr<Object> obj(new Object(const_cast<char*>(arena_ + objOffsets_[i])));
+    CHECK_MSG(objOffsets_[i + 1] - objOffsets_[i] >= ID_SIZE + LABEL_SIZE + DATALENGTH_SIZE &&
+              obj->bufferlength() <= objOffsets_[i + 1] - objOffsets_[i],
+              "Bug or inconsistent data: invalid object in the index bundle '" + location_ + "'");
+    data.push_back(obj.release());
+    externIds.push_back(string(externIdChars_ + externIdOffsets_[i], externIdOffsets_[i + 1] - externIdOffsets_[i]));
+  }
+}
+
+void IndexBundle::checkDistType(const string& distType) const {
+  CHECK_MSG(distType == distType_,
+            "The index bundle '" + location_ + "' was created for the distance type " + distType_ +
+            ", but the distance type " + distType + " is requested");
+}
+
+}   // namespace similarity
@@ -0,0 +1,132 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <unordered_map>
+
+#include "knn_graph_file.h"
+#include "index.h"
+#include "logging.h"
+#include "mmap_file.h"
+#include "utils.h"
+
+#define KNN_GRAPH_FILE_VERSION 1
+
+namespace similarity {
+
+using namespace std;
+
+const char KNN_GRAPH_FILE_MAGIC[8] = {'N', 'M', 'S', 'L', 'I', 'B', 'N', 'N'};
+
+void WriteKNNGraph(const string& location, const ObjectVector& data, size_t NN,
+                   const function<void(size_t, KNNGraphEntry*)>& getNeighbors) {
+  CHECK_MSG(NN > 0 && NN <= static_cast<size_t>(numeric_limits<int32_t>::max()),
+            "Invalid number of neighbors in the k-NN graph: " + ConvertToString(NN));
+  KNNGraphFileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, KNN_GRAPH_FILE_MAGIC, sizeof(header.magic));
+  header.version = KNN_GRAPH_FILE_VERSION;
+  header.idSize  = sizeof(IdType);
+  header.nodeQty = data.size();
+  header.NN      = NN;
+
+  string tmpLocation = GetTempFileNameForAtomicWrite(location);
+  ofstream outFile(tmpLocation, std::ios::binary);
+  CHECK_MSG(outFile, "Cannot open file '" + tmpLocation + "' for writing");
+  outFile.exceptions(std::ios::badbit | std::ios::failbit);
+
+  writeBinaryPOD(outFile, header);
+  vector<KNNGraphEntry> entries(NN);
+  for (size_t i = 0; i < data.size(); ++i) {
+    for (KNNGraphEntry& e : entries) {
+      e.key  = KNN_GRAPH_EMPTY_KEY;
+      e.dist = numeric_limits<float>::max();
+    }
+    getNeighbors(i, &entries[0]);
+    writeBinaryPOD(outFile, data[i]->id());
+    outFile.write(reinterpret_cast<const char*>(&entries[0]), sizeof(entries[0]) * NN);
+  }
+  outFile.close();
+
+  CommitAtomicWrite(tmpLocation, location);
+  LOG(LIB_INFO) << "Saved the k-NN graph with " << data.size() << " nodes to " << location;
+}
+
+size_t ReadKNNGraph(const string& location, const ObjectVector& data, bool strict,
+                    vector<vector<KNNGraphEntry>>& graph) {
+  MappedFile          file(location);
+  KNNGraphFileHeader  header;
+
+  CHECK_MSG(file.size() >= sizeof(header) &&
+            memcmp(file.data(), KNN_GRAPH_FILE_MAGIC, sizeof(header.magic)) == 0,
+            "The file '" + location + "' isn't a k-NN graph");
+  memcpy(&header, file.data(), sizeof(header));
+  CHECK_MSG(header.version == KNN_GRAPH_FILE_VERSION,
+            "Unsupported version of the k-NN graph file: " + ConvertToString(header.version));
+  CHECK_MSG(header.idSize == sizeof(IdType),
+            "The graph file '" + location + "' was created on an incompatible platform");
+  CHECK_MSG(header.NN > 0 && header.NN <= static_cast<uint64_t>(numeric_limits<int32_t>::max()),
+            "Bug or inconsistent data: invalid NN in the graph file '" + location + "'");
+  const size_t recSize = sizeof(IdType) + header.NN * sizeof(KNNGraphEntry);
+  CHECK_MSG((file.size() - sizeof(header)) / recSize >= header.nodeQty,
+            "The graph file '" + location + "' is truncated");
+  file.AdviseSequential();
+
+  const char*     pRecs = file.data() + sizeof(header);
+  vector<IdType>  dataIndex(header.nodeQty, -1);
+  unordered_map<IdType, IdType> dataIndexById;
+  size_t          foundQty = 0;
+  for (size_t nodeId = 0; nodeId < header.nodeQty; ++nodeId) {
+    IdType objId;
+    memcpy(&objId, pRecs + nodeId * recSize, sizeof(objId));
+    if (nodeId < data.size() && data[nodeId]->id() == objId) {
+      dataIndex[nodeId] = nodeId;
+    } else {
+      if (dataIndexById.empty()) {
+        for (size_t i = 0; i < data.size(); ++i) dataIndexById.emplace(data[i]->id(), i);
+      }
+      auto it = dataIndexById.find(objId);
+      if (it != dataIndexById.end()) dataIndex[nodeId] = it->second;
+    }
+    CHECK_MSG(!strict || dataIndex[nodeId] >= 0,
+              DATA_MUTATION_ERROR_MSG + " (the data set has no object with ID " + ConvertToString(objId) + ")");
+    if (dataIndex[nodeId] >= 0) ++foundQty;
+  }
+  CHECK_MSG(!strict || foundQty == data.size(),
+            DATA_MUTATION_ERROR_MSG + " (the graph has " + ConvertToString(foundQty) +
+            " nodes, but the data set has " + ConvertToString(data.size()) + " points)");
+
+  graph.assign(data.size(), vector<KNNGraphEntry>());
+  for (size_t nodeId = 0; nodeId < header.nodeQty; ++nodeId) {
+    IdType dataId = dataIndex[nodeId];
+    if (dataId < 0) continue;
+    const char* pEntries = pRecs + nodeId * recSize + sizeof(IdType);
+    for (size_t j = 0; j < header.NN; ++j) {
+      KNNGraphEntry e;
+      memcpy(&e, pEntries + j * sizeof(e), sizeof(e));
+      if (e.key == KNN_GRAPH_EMPTY_KEY) continue;
+      CHECK_MSG(e.key >= 0 && static_cast<uint64_t>(e.key) < header.nodeQty,
+                "Bug or inconsistent data: invalid neighbor ID " + ConvertToString(e.key) +
+                " for node ID " + ConvertToString(nodeId));
+      if (dataIndex[e.key] >= 0) graph[dataId].push_back(KNNGraphEntry{dataIndex[e.key], e.dist});
+    }
+  }
+  LOG(LIB_INFO) << "Read the k-NN graph with " << header.nodeQty << " nodes, "
+                << foundQty << " of them are in the data set";
+  return header.NN;
+}
+
+}   // namespace similarity
@@ -26,6 +26,7 @@
 #include <string>
 
 #include "logging.h"
+#include "async_logger.h"
 
 const char* log_severity[] = {"DEBUG", "INFO", "WARNING", "ERROR", "FATAL"};
 
@@ -43,6 +44,19 @@ Logger * getGlobalLogger() {
   return global_log.get();
 }
 
+std::atomic<int> gLogSeverityThreshold(LIB_DEBUG);
+
+void setLogSeverityThreshold(LogSeverity severity) {
+  gLogSeverityThreshold.store(severity);
+}
+
+void EnableAsyncLogging() {
+  Logger * inner = global_log.get();
+  if (inner == NULL || dynamic_cast<AsyncLogger*>(inner) != NULL) return;
+  global_log.release();
+  global_log.reset(new AsyncLogger(inner));
+}
+
 Logger::~Logger() {
 }
 
@@ -42,23 +42,31 @@ MemUsage::MemUsage() {
 #endif
 }
 
-double 
-MemUsage::get_vmsize() {
 #ifdef __linux
+double
+MemUsage::read_status_field(const char* fieldName) {
     FILE* f = fopen(status_file_, "rt");
     if (!f) {
         return -1.0;
     }
+    size_t fieldLen = strlen(fieldName);
     char buf[100];
-    int vmsize = -1024;
+    int val = -1024;
     while (fgets(buf, sizeof(buf), f)) {
-        if (strncmp(buf, "VmSize:", 7) == 0) {
-            sscanf(buf + 7, "%d", &vmsize);
+        if (strncmp(buf, fieldName, fieldLen) == 0) {
+            sscanf(buf + fieldLen, "%d", &val);
             break;
         }
     }
     fclose(f);
-    return vmsize / 1024.0;
+    return val / 1024.0;
+}
+#endif
+
+double 
+MemUsage::get_vmsize() {
+#ifdef __linux
+    return read_status_field("VmSize:");
 #endif
 #ifdef _MSC_VER
     PROCESS_MEMORY_COUNTERS memCounter;
@@ -76,6 +84,32 @@ MemUsage::get_vmsize() {
     return -1.0;
 }
 
+double 
+MemUsage::get_rss() {
+#ifdef __linux
+    return read_status_field("VmRSS:");
+#endif
+#ifdef _MSC_VER
+    PROCESS_MEMORY_COUNTERS memCounter;
+    GetProcessMemoryInfo(GetCurrentProcess(), &memCounter, sizeof(memCounter));
+    return memCounter.WorkingSetSize / 1024.0 / 1024.0;
+#endif
+    return -1.0;
+}
+
+double 
+MemUsage::get_peak_rss() {
+#ifdef __linux
+    return read_status_field("VmHWM:");
+#endif
+#ifdef _MSC_VER
+    PROCESS_MEMORY_COUNTERS memCounter;
+    GetProcessMemoryInfo(GetCurrentProcess(), &memCounter, sizeof(memCounter));
+    return memCounter.PeakWorkingSetSize / 1024.0 / 1024.0;
+#endif
+    return -1.0;
+}
+
 
 
 }
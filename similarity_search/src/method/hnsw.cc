@@ -85,6 +85,9 @@ namespace similarity {
         : Index<dist_t>(data)
         , space_(space)
         , PrintProgress_(PrintProgress)
+        , subPhaseSearchId_(BUILD_PROFILE_MAX_SUBPHASE)
+        , subPhasePruneId_(BUILD_PROFILE_MAX_SUBPHASE)
+        , subPhaseLinkId_(BUILD_PROFILE_MAX_SUBPHASE)
         , visitedlistpool(nullptr)
         , enterpoint_(nullptr)
         , data_level0_memory_(nullptr)
@@ -189,10 +192,19 @@ namespace similarity {
 
         SetQueryTimeParams(getEmptyParams());
 
+        BuildProfiler &profiler = this->buildProfiler_;
+        profiler.Reset();
+        subPhaseSearchId_ = profiler.RegisterSubPhase("candidate search");
+        subPhasePruneId_  = profiler.RegisterSubPhase("heuristic pruning");
+        subPhaseLinkId_   = profiler.RegisterSubPhase("linking");
+
         if (this->data_.empty()) {
             pmgr.CheckUnused();
             return;
         }
+        profiler.StartPhase("insertion");
+        profiler.StartProgress(this->data_.size());
+
         ElList_.resize(this->data_.size());
         // One entry should be added before all the threads are started, or else add() will not work properly
         HnswNode *first = new HnswNode(this->data_[0], 0 /* id == 0 */);
@@ -214,11 +226,13 @@ namespace similarity {
                 if (progress_bar)
                   ++(*progress_bar);
             }
+            profiler.AddProgress();
         });
         if (progress_bar)
           progress_bar->finish();
 
         if (post_ == 1 || post_ == 2) {
+            profiler.StartPhase("post-processing");
             vector<HnswNode *> temp;
             temp.swap(ElList_);
             ElList_.resize(this->data_.size());
@@ -314,12 +328,16 @@ namespace similarity {
 
         enterpointId_ = enterpoint_->getId();
 
+        profiler.EndPhase();
+
         if (skip_optimized_index) {
             LOG(LIB_INFO) << "searchMethod			  = " << searchMethod_;
             pmgr.CheckUnused();
             return;
         }
 
+        BuildPhase layoutPhase(profiler, "optimized layout");
+
         int friendsSectionSize = (maxM0_ + 1) * sizeof(int);
 
         // Checking for maximum size of the datasection:
@@ -482,10 +500,10 @@ namespace similarity {
     template <typename dist_t> Hnsw<dist_t>::~Hnsw()
     {
         delete visitedlistpool;
-        if (data_level0_memory_)
+        if (data_level0_memory_ && !mappedIndex_)
             free(data_level0_memory_);
         if (linkLists_) {
-            for (int i = 0; i < data_rearranged_.size(); i++) {
+            for (int i = 0; i < data_rearranged_.size() && !mappedIndex_; i++) {
                 if (linkLists_[i])
                     free(linkLists_[i]);
             }
@@ -543,8 +561,12 @@ namespace similarity {
 
         for (int level = min(curlevel, maxlevelcopy); level >= 0; level--) {
             priority_queue<HnswNodeDistCloser<dist_t>> resultSet;
-            kSearchElementsWithAttemptsLevel(space, NewElement->getData(), efConstruction_, resultSet, ep, level);
+            {
+                BuildSubPhaseTimer timer(this->buildProfiler_, subPhaseSearchId_);
+                kSearchElementsWithAttemptsLevel(space, NewElement->getData(), efConstruction_, resultSet, ep, level);
+            }
 
+            BuildSubPhaseTimer pruneTimer(this->buildProfiler_, subPhasePruneId_);
             switch (delaunay_type_) {
             case 0:
                 while (resultSet.size() > M_)
@@ -560,6 +582,9 @@ namespace similarity {
                 NewElement->getNeighborsByHeuristic3(resultSet, M_, space, level);
                 break;
             }
+            pruneTimer.Stop();
+
+            BuildSubPhaseTimer linkTimer(this->buildProfiler_, subPhaseLinkId_);
             while (!resultSet.empty()) {
                 ep = resultSet.top().getMSWNodeHier(); // memorizing the closest
                 link(resultSet.top().getMSWNodeHier(), NewElement, level, space, delaunay_type_);
@@ -989,6 +1014,15 @@ namespace similarity {
 
     }
 
+    template <typename dist_t>
+    void
+    Hnsw<dist_t>::LoadIndexMapped(const string &location) {
+        mappedIndex_.reset(new MappedFile(location));
+        LoadIndex(location);
+        // The regular index is converted to in-memory data structures, it doesn't need the file
+        if (data_level0_memory_ == nullptr) mappedIndex_.reset();
+    }
+
 
     template <typename dist_t>
     void
@@ -1018,9 +1052,21 @@ namespace similarity {
         //        LOG(LIB_INFO) << input.tellg();
         LOG(LIB_INFO) << "Total: " << totalElementsStored_ << ", Memory per object: " << memoryPerObject_;
         size_t data_plus_links0_size = memoryPerObject_ * totalElementsStored_;
-        data_level0_memory_ = (char *)malloc(data_plus_links0_size);
-        CHECK(data_level0_memory_);
-        input.read(data_level0_memory_, data_plus_links0_size);
+        // With a mapped file, the stream only parses sizes, while the data and links are not copied
+        auto mapData = [&](size_t size) -> char * {
+            size_t pos = input.tellg();
+            CHECK_MSG(pos <= mappedIndex_->size() && size <= mappedIndex_->size() - pos,
+                      "The index file is truncated");
+            input.seekg(size, std::ios::cur);
+            return const_cast<char *>(mappedIndex_->data() + pos);
+        };
+        if (mappedIndex_) {
+            data_level0_memory_ = mapData(data_plus_links0_size);
+        } else {
+            data_level0_memory_ = (char *)malloc(data_plus_links0_size);
+            CHECK(data_level0_memory_);
+            input.read(data_level0_memory_, data_plus_links0_size);
+        }
         linkLists_ = (char **)malloc(sizeof(void *) * totalElementsStored_);
         CHECK(linkLists_);
 
@@ -1032,6 +1078,8 @@ namespace similarity {
 
             if (linkListSize == 0) {
                 linkLists_[i] = nullptr;
+            } else if (mappedIndex_) {
+                linkLists_[i] = mapData(linkListSize);
             } else {
                 linkLists_[i] = (char *)malloc(linkListSize);
                 CHECK(linkLists_[i]);
@@ -1063,6 +1111,7 @@ namespace similarity {
             bool changed = true;
             while (changed) {
                 changed = false;
+                SEARCH_STAT(query->GetSearchStat().AddHop(i));
 
                 const vector<HnswNode *> &neighbor = curNode->getAllFriends(i);
                 for (auto iter = neighbor.begin(); iter != neighbor.end(); ++iter) {
@@ -1085,10 +1134,13 @@ namespace similarity {
 
         HnswNodeDistFarther<dist_t> ev(curdist, curNode);
         candidateQueue.emplace(curdist, curNode);
+        SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
         closestDistQueue1.emplace(curdist, curNode);
+        SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
 
         query->CheckAndAddToResult(curdist, curNode->getData());
         massVisited[curNode->getId()] = currentV;
+        SEARCH_STAT(query->GetSearchStat().VisitedQty_++);
         // visitedQueue.insert(curNode->getId());
 
         ////////////////////////////////////////////////////////////////////////////////
@@ -1107,6 +1159,8 @@ namespace similarity {
 
             HnswNode *initNode = currEv.getMSWNodeHier();
             candidateQueue.pop();
+            SEARCH_STAT(query->GetSearchStat().AddHop(0));
+            SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
 
             const vector<HnswNode *> &neighbor = (initNode)->getAllFriends(0);
 
@@ -1122,15 +1176,19 @@ namespace similarity {
 
                 if (!(massVisited[curId] == currentV)) {
                     massVisited[curId] = currentV;
+                    SEARCH_STAT(query->GetSearchStat().VisitedQty_++);
                     currObj = (*iter)->getData();
                     d = query->DistanceObjLeft(currObj);
                     if (closestDistQueue1.top().getDistance() > d || closestDistQueue1.size() < ef_) {
                         {
                             query->CheckAndAddToResult(d, currObj);
                             candidateQueue.emplace(d, *iter);
+                            SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
                             closestDistQueue1.emplace(d, *iter);
+                            SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
                             if (closestDistQueue1.size() > ef_) {
                                 closestDistQueue1.pop();
+                                SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
                             }
                         }
                     }
@@ -1161,6 +1219,7 @@ namespace similarity {
             bool changed = true;
             while (changed) {
                 changed = false;
+                SEARCH_STAT(query->GetSearchStat().AddHop(i));
 
                 const vector<HnswNode *> &neighbor = curNode->getAllFriends(i);
                 for (auto iter = neighbor.begin(); iter != neighbor.end(); ++iter) {
@@ -1188,6 +1247,7 @@ namespace similarity {
         vector<QueueItem> itemBuff(1 + max(maxM_, maxM0_));
 
         massVisited[curNode->getId()] = currentV;
+        SEARCH_STAT(query->GetSearchStat().VisitedQty_++);
         // visitedQueue.insert(curNode->getId());
 
         ////////////////////////////////////////////////////////////////////////////////
@@ -1201,6 +1261,7 @@ namespace similarity {
             e.used = true;
             HnswNode *initNode = e.data;
             ++currElem;
+            SEARCH_STAT(query->GetSearchStat().AddHop(0));
 
             size_t itemQty = 0;
             dist_t topKey = sortedArr.top_key();
@@ -1221,6 +1282,7 @@ namespace similarity {
 
                 if (!(massVisited[curId] == currentV)) {
                     massVisited[curId] = currentV;
+                    SEARCH_STAT(query->GetSearchStat().VisitedQty_++);
                     currObj = (*iter)->getData();
                     d = query->DistanceObjLeft(currObj);
 
@@ -1236,6 +1298,7 @@ namespace similarity {
             if (itemQty) {
                 _mm_prefetch(const_cast<const char *>(reinterpret_cast<char *>(&itemBuff[0])), _MM_HINT_T0);
                 std::sort(itemBuff.begin(), itemBuff.begin() + itemQty);
+                SEARCH_STAT(query->GetSearchStat().HeapOpQty_ += itemQty);
 
                 size_t insIndex = 0;
                 if (itemQty > MERGE_BUFFER_ALGO_SWITCH_THRESHOLD) {
@@ -1294,9 +1357,12 @@ namespace similarity {
 
         HnswNodeDistFarther<dist_t> ev(curdist, curNode);
         candidateQueue.emplace(curdist, curNode);
+        SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
         closestDistQueue.emplace(curdist, curNode);
+        SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
 
         massVisited[curNode->getId()] = currentV;
+        SEARCH_STAT(query->GetSearchStat().VisitedQty_++);
 
         for (int i = maxlevel1; i > 0; i--) {
             while (!candidateQueue.empty()) {
@@ -1310,6 +1376,8 @@ namespace similarity {
 
                 HnswNode *initNode = currEv.getMSWNodeHier();
                 candidateQueue.pop();
+                SEARCH_STAT(query->GetSearchStat().AddHop(i));
+                SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
 
                 const vector<HnswNode *> &neighbor = (initNode)->getAllFriends(i);
 
@@ -1324,13 +1392,17 @@ namespace similarity {
                     curId = (*iter)->getId();
                     if (!(massVisited[curId] == currentV)) {
                         massVisited[curId] = currentV;
+                        SEARCH_STAT(query->GetSearchStat().VisitedQty_++);
                         currObj = (*iter)->getData();
                         d = query->DistanceObjLeft(currObj);
                         if (closestDistQueue.top().getDistance() > d || closestDistQueue.size() < efSearchL) {
                             candidateQueue.emplace(d, *iter);
+                            SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
                             closestDistQueue.emplace(d, *iter);
+                            SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
                             if (closestDistQueue.size() > efSearchL) {
                                 closestDistQueue.pop();
+                                SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
                             }
                         }
                     }
@@ -1350,12 +1422,14 @@ namespace similarity {
                 while (closestDistQueueCpy.size() > 0) {
                     massVisited[closestDistQueueCpy.top().getMSWNodeHier()->getId()] = currentV;
                     candidateQueue.emplace(closestDistQueueCpy.top().getDistance(), closestDistQueueCpy.top().getMSWNodeHier());
+                    SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
                     closestDistQueueCpy.pop();
                 }
             } else { // Passing the closest neighbors to the 0 zero layer(one has to add also to query):
                 while (closestDistQueueCpy.size() > 0) {
                     massVisited[closestDistQueueCpy.top().getMSWNodeHier()->getId()] = currentV;
                     candidateQueue.emplace(closestDistQueueCpy.top().getDistance(), closestDistQueueCpy.top().getMSWNodeHier());
+                    SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
                     query->CheckAndAddToResult(closestDistQueueCpy.top().getDistance(),
                                                closestDistQueueCpy.top().getMSWNodeHier()->getData());
                     closestDistQueueCpy.pop();
@@ -1379,6 +1453,8 @@ namespace similarity {
 
             HnswNode *initNode = currEv.getMSWNodeHier();
             candidateQueue.pop();
+            SEARCH_STAT(query->GetSearchStat().AddHop(0));
+            SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
 
             const vector<HnswNode *> &neighbor = (initNode)->getAllFriends(0);
 
@@ -1393,15 +1469,19 @@ namespace similarity {
                 curId = (*iter)->getId();
                 if (!(massVisited[curId] == currentV)) {
                     massVisited[curId] = currentV;
+                    SEARCH_STAT(query->GetSearchStat().VisitedQty_++);
                     currObj = (*iter)->getData();
                     d = query->DistanceObjLeft(currObj);
                     if (closestDistQueue.top().getDistance() > d || closestDistQueue.size() < ef_) {
                         {
                             query->CheckAndAddToResult(d, currObj);
                             candidateQueue.emplace(d, *iter);
+                            SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
                             closestDistQueue.emplace(d, *iter);
+                            SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
                             if (closestDistQueue.size() > ef_) {
                                 closestDistQueue.pop();
+                                SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
                             }
                         }
                     }
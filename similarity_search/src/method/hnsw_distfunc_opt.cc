@@ -398,6 +398,7 @@ namespace similarity {
             bool changed = true;
             while (changed) {
                 changed = false;
+                SEARCH_STAT(query->GetSearchStat().AddHop(i));
                 int *data = (int *)(linkLists_[curNodeNum] + (maxM_ + 1) * (i - 1) * sizeof(int));
                 int size = *data;
                 for (int j = 1; j <= size; j++) {
@@ -426,12 +427,15 @@ namespace similarity {
         priority_queue<EvaluatedMSWNodeInt<dist_t>> closestDistQueuei; // The set of closest found elements
         // EvaluatedMSWNodeInt<dist_t> evi(curdist, curNodeNum);
         candidateQueuei.emplace(-curdist, curNodeNum);
+        SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
 
         closestDistQueuei.emplace(curdist, curNodeNum);
+        SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
 
         // query->CheckAndAddToResult(curdist, new Object(data_level0_memory_ + (curNodeNum)*memoryPerObject_ + offsetData_));
         query->CheckAndAddToResult(curdist, data_rearranged_[curNodeNum]);
         massVisited[curNodeNum] = currentV;
+        SEARCH_STAT(query->GetSearchStat().VisitedQty_++);
 
         while (!candidateQueuei.empty()) {
             EvaluatedMSWNodeInt<dist_t> currEv = candidateQueuei.top(); // This one was already compared to the query
@@ -442,6 +446,8 @@ namespace similarity {
             }
 
             candidateQueuei.pop();
+            SEARCH_STAT(query->GetSearchStat().AddHop(0));
+            SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
             curNodeNum = currEv.element;
             int *data = (int *)(data_level0_memory_ + curNodeNum * memoryPerObject_ + offsetLevel0_);
             int size = *data;
@@ -459,18 +465,22 @@ namespace similarity {
                     query->distance_computations_++;
 #endif
                     massVisited[tnum] = currentV;
+                    SEARCH_STAT(query->GetSearchStat().VisitedQty_++);
                     char *currObj1 = (data_level0_memory_ + tnum * memoryPerObject_ + offsetData_);
                     dist_t d = (fstdistfunc_(pVectq, (float *)(currObj1 + 16), qty, TmpRes));
                     if (closestDistQueuei.top().getDistance() > d || closestDistQueuei.size() < ef_) {
                         candidateQueuei.emplace(-d, tnum);
+                        SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
                         _mm_prefetch(data_level0_memory_ + candidateQueuei.top().element * memoryPerObject_ + offsetLevel0_,
                                      _MM_HINT_T0);
                         // query->CheckAndAddToResult(d, new Object(currObj1));
                         query->CheckAndAddToResult(d, data_rearranged_[tnum]);
                         closestDistQueuei.emplace(d, tnum);
+                        SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
 
                         if (closestDistQueuei.size() > ef_) {
                             closestDistQueuei.pop();
+                            SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
                         }
                     }
                 }
@@ -500,6 +510,7 @@ namespace similarity {
             bool changed = true;
             while (changed) {
                 changed = false;
+                SEARCH_STAT(query->GetSearchStat().AddHop(i));
                 int *data = (int *)(linkLists_[curNodeNum] + (maxM_ + 1) * (i - 1) * sizeof(int));
                 int size = *data;
                 for (int j = 1; j <= size; j++) {
@@ -533,6 +544,7 @@ namespace similarity {
         vector<QueueItem> itemBuff(1 + max(maxM_, maxM0_));
 
         massVisited[curNodeNum] = currentV;
+        SEARCH_STAT(query->GetSearchStat().VisitedQty_++);
 
         while (currElem < min(sortedArr.size(), ef_)) {
             auto &e = queueData[currElem];
@@ -540,6 +552,7 @@ namespace similarity {
             e.used = true;
             curNodeNum = e.data;
             ++currElem;
+            SEARCH_STAT(query->GetSearchStat().AddHop(0));
 
             size_t itemQty = 0;
             dist_t topKey = sortedArr.top_key();
@@ -560,6 +573,7 @@ namespace similarity {
                     query->distance_computations_++;
 #endif
                     massVisited[tnum] = currentV;
+                    SEARCH_STAT(query->GetSearchStat().VisitedQty_++);
                     char *currObj1 = (data_level0_memory_ + tnum * memoryPerObject_ + offsetData_);
                     dist_t d = (fstdistfunc_(pVectq, (float *)(currObj1 + 16), qty, TmpRes));
 
@@ -574,6 +588,7 @@ namespace similarity {
             if (itemQty) {
                 _mm_prefetch(const_cast<const char *>(reinterpret_cast<char *>(&itemBuff[0])), _MM_HINT_T0);
                 std::sort(itemBuff.begin(), itemBuff.begin() + itemQty);
+                SEARCH_STAT(query->GetSearchStat().HeapOpQty_ += itemQty);
 
                 size_t insIndex = 0;
                 if (itemQty > MERGE_BUFFER_ALGO_SWITCH_THRESHOLD) {
@@ -645,6 +660,7 @@ namespace similarity {
             bool changed = true;
             while (changed) {
                 changed = false;
+                SEARCH_STAT(query->GetSearchStat().AddHop(i));
                 int *data = (int *)(linkLists_[curNodeNum] + (maxM_ + 1) * (i - 1) * sizeof(int));
                 int size = *data;
                 for (int j = 1; j <= size; j++) {
@@ -673,12 +689,15 @@ namespace similarity {
         priority_queue<EvaluatedMSWNodeInt<dist_t>> closestDistQueuei; // The set of closest found elements
         // EvaluatedMSWNodeInt<dist_t> evi(curdist, curNodeNum);
         candidateQueuei.emplace(-curdist, curNodeNum);
+        SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
 
         closestDistQueuei.emplace(curdist, curNodeNum);
+        SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
 
         // query->CheckAndAddToResult(curdist, new Object(data_level0_memory_ + (curNodeNum)*memoryPerObject_ + offsetData_));
         query->CheckAndAddToResult(curdist, data_rearranged_[curNodeNum]);
         massVisited[curNodeNum] = currentV;
+        SEARCH_STAT(query->GetSearchStat().VisitedQty_++);
 
         while (!candidateQueuei.empty()) {
             EvaluatedMSWNodeInt<dist_t> currEv = candidateQueuei.top(); // This one was already compared to the query
@@ -689,6 +708,8 @@ namespace similarity {
             }
 
             candidateQueuei.pop();
+            SEARCH_STAT(query->GetSearchStat().AddHop(0));
+            SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
             curNodeNum = currEv.element;
             int *data = (int *)(data_level0_memory_ + curNodeNum * memoryPerObject_ + offsetLevel0_);
             int size = *data;
@@ -706,18 +727,22 @@ namespace similarity {
                     query->distance_computations_++;
 #endif
                     massVisited[tnum] = currentV;
+                    SEARCH_STAT(query->GetSearchStat().VisitedQty_++);
                     char *currObj1 = (data_level0_memory_ + tnum * memoryPerObject_ + offsetData_);
                     dist_t d = (ScalarProductSIMD(pVectq, (float *)(currObj1 + 16), qty, TmpRes));
                     if (closestDistQueuei.top().getDistance() > d || closestDistQueuei.size() < ef_) {
                         candidateQueuei.emplace(-d, tnum);
+                        SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
                         _mm_prefetch(data_level0_memory_ + candidateQueuei.top().element * memoryPerObject_ + offsetLevel0_,
                                      _MM_HINT_T0);
                         // query->CheckAndAddToResult(d, new Object(currObj1));
                         query->CheckAndAddToResult(d, data_rearranged_[tnum]);
                         closestDistQueuei.emplace(d, tnum);
+                        SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
 
                         if (closestDistQueuei.size() > ef_) {
                             closestDistQueuei.pop();
+                            SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
                         }
                     }
                 }
@@ -759,6 +784,7 @@ namespace similarity {
             bool changed = true;
             while (changed) {
                 changed = false;
+                SEARCH_STAT(query->GetSearchStat().AddHop(i));
                 int *data = (int *)(linkLists_[curNodeNum] + (maxM_ + 1) * (i - 1) * sizeof(int));
                 int size = *data;
                 for (int j = 1; j <= size; j++) {
@@ -792,6 +818,7 @@ namespace similarity {
         vector<QueueItem> itemBuff(1 + max(maxM_, maxM0_));
 
         massVisited[curNodeNum] = currentV;
+        SEARCH_STAT(query->GetSearchStat().VisitedQty_++);
 
         while (currElem < min(sortedArr.size(), ef_)) {
             auto &e = queueData[currElem];
@@ -799,6 +826,7 @@ namespace similarity {
             e.used = true;
             curNodeNum = e.data;
             ++currElem;
+            SEARCH_STAT(query->GetSearchStat().AddHop(0));
 
             size_t itemQty = 0;
             dist_t topKey = sortedArr.top_key();
@@ -819,6 +847,7 @@ namespace similarity {
                     query->distance_computations_++;
 #endif
                     massVisited[tnum] = currentV;
+                    SEARCH_STAT(query->GetSearchStat().VisitedQty_++);
                     char *currObj1 = (data_level0_memory_ + tnum * memoryPerObject_ + offsetData_);
                     dist_t d = (ScalarProductSIMD(pVectq, (float *)(currObj1 + 16), qty, TmpRes));
 
@@ -834,6 +863,7 @@ namespace similarity {
             if (itemQty) {
                 _mm_prefetch(const_cast<const char *>(reinterpret_cast<char *>(&itemBuff[0])), _MM_HINT_T0);
                 std::sort(itemBuff.begin(), itemBuff.begin() + itemQty);
+                SEARCH_STAT(query->GetSearchStat().HeapOpQty_ += itemQty);
 
                 size_t insIndex = 0;
                 if (itemQty > MERGE_BUFFER_ALGO_SWITCH_THRESHOLD) {
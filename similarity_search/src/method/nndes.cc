@@ -70,6 +70,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "rangequery.h"
 #include "knnquery.h"
 #include "method/nndes.h"
+#include "knn_graph_file.h"
 
 #define USE_BITSET_FOR_SEARCHING 1
 
@@ -94,22 +95,47 @@ void NNDescentMethod<dist_t>::CreateIndex(const AnyParams& IndexParams) {
   pmgr.GetParamOptional("iterationQty", iterationQty_, 100); // default value from Wei Dong's code
 
   pmgr.GetParamOptional("rho",          rho_,          1.0); // Fast rho is 0.5, 1.0 is from Wei Dong's code
-  pmgr.GetParamOptional("delta",        delta_,        0.001), // default value from Wei Dong's code
+  pmgr.GetParamOptional("delta",        delta_,        0.001); // default value from Wei Dong's code
+  pmgr.GetParamOptional("warmStartFile", warmStartFile_, "");
+  pmgr.GetParamOptional("indexThreadQty", indexThreadQty_, thread::hardware_concurrency());
 
   LOG(LIB_INFO) <<  "NN           = " << NN_;
   LOG(LIB_INFO) <<  "iterationQty = " << iterationQty_;
   LOG(LIB_INFO) <<  "rho          = " << rho_;
   LOG(LIB_INFO) <<  "delta        = " << delta_;
+  LOG(LIB_INFO) <<  "warmStartFile= " << warmStartFile_;
+  LOG(LIB_INFO) <<  "indexThreadQty=" << indexThreadQty_;
+
+  pmgr.CheckUnused();
 
   SetQueryTimeParams(getEmptyParams()); // reset query-time parameter
 
 
   LOG(LIB_INFO) << "Starting NN-Descent...";
 
-  nndesObj_.reset(new NNDescent<SpaceOracle>(this->data_.size(), // N
-                                             NN_, //K 
-                                             rho_, //S, 
-                                             nndesOracle_, GRAPH_BOTH));
+  if (warmStartFile_.empty()) {
+    nndesObj_.reset(new NNDescent<SpaceOracle>(this->data_.size(), // N
+                                               NN_, //K 
+                                               rho_, //S, 
+                                               nndesOracle_, GRAPH_BOTH));
+  } else {
+    /*
+     * The descent starts from a saved graph. The data set may contain new points
+     * and miss some old ones. Distances are recomputed, because the graph
+     * could have been built using a different space.
+     */
+    vector<vector<KNNEntry>> initNN;
+    ReadGraph(warmStartFile_, false, initNN);
+    for (size_t i = 0; i < initNN.size(); ++i) {
+      for (KNNEntry& e : initNN[i]) e.dist = nndesOracle_(i, e.key);
+    }
+    LOG(LIB_INFO) << "Warm start from the graph in " << warmStartFile_;
+    nndesObj_.reset(new NNDescent<SpaceOracle>(this->data_.size(), // N
+                                               NN_, //K 
+                                               rho_, //S, 
+                                               nndesOracle_, initNN, GRAPH_BOTH));
+  }
+  nndesObj_->setThreadQty(indexThreadQty_);
 
     float total = float(this->data_.size()) * (this->data_.size() - 1) / 2;
     cout.precision(5);
@@ -139,6 +165,42 @@ void NNDescentMethod<dist_t>::CreateIndex(const AnyParams& IndexParams) {
   LOG(LIB_INFO) << "NN-Descent finished!";
 }
 
+template <typename dist_t>
+void NNDescentMethod<dist_t>::SaveIndex(const string &location) {
+  CHECK_MSG(nndesObj_, "The index isn't created");
+  const vector<KNN> &nn = nndesObj_->getNN();
+
+  WriteKNNGraph(location, this->data_, NN_, [&](size_t i, KNNGraphEntry* entries) {
+    for (size_t j = 0; j < NN_; ++j) {
+      entries[j].key  = nn[i][j].key;
+      entries[j].dist = nn[i][j].dist;
+    }
+  });
+}
+
+template <typename dist_t>
+size_t NNDescentMethod<dist_t>::ReadGraph(const string &location, bool strict,
+                                          vector<vector<KNNEntry>>& graph) const {
+  vector<vector<KNNGraphEntry>> fileGraph;
+  size_t NN = ReadKNNGraph(location, this->data_, strict, fileGraph);
+
+  graph.assign(fileGraph.size(), vector<KNNEntry>());
+  for (size_t i = 0; i < fileGraph.size(); ++i) {
+    for (const KNNGraphEntry& e : fileGraph[i]) graph[i].push_back(KNNEntry(e.key, e.dist, false));
+    vector<KNNGraphEntry>().swap(fileGraph[i]);
+  }
+  return NN;
+}
+
+template <typename dist_t>
+void NNDescentMethod<dist_t>::LoadIndex(const string &location) {
+  vector<vector<KNNEntry>> graph;
+  NN_ = ReadGraph(location, true, graph);
+  // Stored distances are used as is, no distance is computed
+  nndesObj_.reset(new NNDescent<SpaceOracle>(this->data_.size(), NN_, 1.0, nndesOracle_, graph, GRAPH_NONE));
+  SetQueryTimeParams(getEmptyParams());
+}
+
 template <typename dist_t>
 void NNDescentMethod<dist_t>::Search(RangeQuery<dist_t>* query, IdType) const {
   throw runtime_error("Range search is not supported!");
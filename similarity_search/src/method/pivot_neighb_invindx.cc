@@ -133,6 +133,12 @@ void PivotNeighbInvertedIndex<dist_t>::CreateIndex(const AnyParams& IndexParams)
   LOG(LIB_INFO) << "# hash trick dimensionionality= " << hash_trick_dim_;
   LOG(LIB_INFO) << "Do we recreate points during indexing when computing distances to pivots?  = " << recreate_points_;
 
+  BuildProfiler& profiler = this->buildProfiler_;
+  profiler.Reset();
+  subPhasePivotDistId_ = profiler.RegisterSubPhase("pivot distances");
+  subPhaseSortId_      = profiler.RegisterSubPhase("posting list sorting");
+
+  profiler.StartPhase("pivot selection");
   if (pivot_file_.empty())
     GetPermutationPivot(this->data_, space_, num_pivot_, &pivot_, &pivot_pos_);
   else {
@@ -144,8 +150,12 @@ void PivotNeighbInvertedIndex<dist_t>::CreateIndex(const AnyParams& IndexParams)
     genPivot_ = pivot_;
   }
   // Attempt to create an efficient pivot index, after pivots are loaded/created
+  profiler.StartPhase("pivot index");
   initPivotIndex();
 
+  profiler.StartPhase("inverted index");
+  profiler.StartProgress(this->data_.size());
+
   posting_lists_.resize(indexQty);
 
   /*
@@ -200,6 +210,7 @@ void PivotNeighbInvertedIndex<dist_t>::CreateIndex(const AnyParams& IndexParams)
       (*progress_bar) += (progress_bar->expected_count() - progress_bar->count());
     }
   }
+  profiler.EndPhase();
 
   // Let's collect pivot occurrence statistics
 #ifdef PRINT_PIVOT_OCCURR_STAT
@@ -271,10 +282,14 @@ PivotNeighbInvertedIndex<dist_t>::IndexChunk(size_t chunkId, ProgressDisplay* pr
       pObj=extObj.get();
     }
 
-    GetPermutationPPIndexEfficiently(pObj, perm);
+    {
+      BuildSubPhaseTimer timer(this->buildProfiler_, subPhasePivotDistId_);
+      GetPermutationPPIndexEfficiently(pObj, perm);
+    }
     for (size_t j = 0; j < num_prefix_; ++j) {
       chunkPostLists[perm[j]].push_back(id);
     }
+    this->buildProfiler_.AddProgress();
         
     if (id % 1000) {
       unique_lock<mutex> lock(display_mutex);
@@ -283,6 +298,7 @@ PivotNeighbInvertedIndex<dist_t>::IndexChunk(size_t chunkId, ProgressDisplay* pr
   }
 
   // Sorting is essential for merging algos
+  BuildSubPhaseTimer timer(this->buildProfiler_, subPhaseSortId_);
   for (auto & p:chunkPostLists) {
     sort(p.begin(), p.end());
   }
@@ -604,12 +620,14 @@ void PivotNeighbInvertedIndex<dist_t>::GenSearch(QueryType* query, size_t K) con
       IncrementalQuickSelect<IntInt> quick_select(candidates);
 
       size_t scan_qty = min(db_scan, candidates.size());
+      SEARCH_STAT(query->GetSearchStat().CandLimit_ += db_scan);
 
       for (size_t i = 0; i < scan_qty; ++i) {
         auto z = quick_select.GetNext();
         if (static_cast<size_t>(-z.first) >= min_times_) {
           const size_t idx = z.second;
           quick_select.Next();
+          SEARCH_STAT(query->GetSearchStat().CandQty_++);
           if (!skip_checking_) query->CheckAndAddToResult(data_start[idx]);
         } else {
           break;
@@ -626,6 +644,7 @@ void PivotNeighbInvertedIndex<dist_t>::GenSearch(QueryType* query, size_t K) con
         for (auto& it : map_counter) {
           if (it.second >= min_times_) {
             const size_t idx = it.first;
+            SEARCH_STAT(query->GetSearchStat().CandQty_++);
             if (!skip_checking_) query->CheckAndAddToResult(data_start[idx]);
           }
         }
@@ -644,6 +663,7 @@ void PivotNeighbInvertedIndex<dist_t>::GenSearch(QueryType* query, size_t K) con
             tmp_cand[cand_tmp_qty++]=data_start[i];
           }
         }
+        SEARCH_STAT(query->GetSearchStat().CandQty_ += cand_tmp_qty);
         if (!skip_checking_) {
           for (size_t i = 0; i < cand_tmp_qty; ++i) {
             query->CheckAndAddToResult(tmp_cand[i]);
@@ -702,6 +722,7 @@ void PivotNeighbInvertedIndex<dist_t>::GenSearch(QueryType* query, size_t K) con
           }
         }
 
+        SEARCH_STAT(query->GetSearchStat().CandQty_ += cand_tmp_qty);
         if (!skip_checking_) {
           for (size_t i = 0; i < cand_tmp_qty; ++i) {
             query->CheckAndAddToResult(tmp_cand[i]);
@@ -749,6 +770,7 @@ void PivotNeighbInvertedIndex<dist_t>::GenSearch(QueryType* query, size_t K) con
           accum = 0;
         }
 
+        SEARCH_STAT(query->GetSearchStat().CandQty_ += cand_tmp_qty);
         if (!skip_checking_) {
           for (size_t i = 0; i < cand_tmp_qty; ++i) {
             query->CheckAndAddToResult(tmp_cand[i]);
@@ -770,6 +792,7 @@ void PivotNeighbInvertedIndex<dist_t>::GenSearch(QueryType* query, size_t K) con
 
         for (const auto& it: tmpRes[1-prevRes]) {
           if (it.qty >= min_times_) {
+            SEARCH_STAT(query->GetSearchStat().CandQty_++);
             if (!skip_checking_) query->CheckAndAddToResult(data_start[it.id]);
           }
         }
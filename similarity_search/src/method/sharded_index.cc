@@ -0,0 +1,366 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "space.h"
+#include "knnqueue.h"
+#include "knnquery.h"
+#include "rangequery.h"
+#include "methodfactory.h"
+#include "method/sharded_index.h"
+
+namespace similarity {
+
+using namespace std;
+
+namespace {
+
+template <typename dist_t>
+unique_ptr<KNNQuery<dist_t>> CreateShardQuery(const Space<dist_t>& space, const KNNQuery<dist_t>* query) {
+  return unique_ptr<KNNQuery<dist_t>>(new KNNQuery<dist_t>(space, query->QueryObject(), query->GetK(), query->GetEPS()));
+}
+
+template <typename dist_t>
+unique_ptr<RangeQuery<dist_t>> CreateShardQuery(const Space<dist_t>& space, const RangeQuery<dist_t>* query) {
+  return unique_ptr<RangeQuery<dist_t>>(new RangeQuery<dist_t>(space, query->QueryObject(), query->Radius()));
+}
+
+template <typename dist_t>
+void MergeShardResult(const KNNQuery<dist_t>& shardQuery, KNNQuery<dist_t>* query) {
+  unique_ptr<KNNQueue<dist_t>> resQ(shardQuery.Result()->Clone());
+  while (!resQ->Empty()) {
+    query->CheckAndAddToResult(resQ->TopDistance(), reinterpret_cast<const Object*>(resQ->TopObject()));
+    resQ->Pop();
+  }
+}
+
+template <typename dist_t>
+void MergeShardResult(const RangeQuery<dist_t>& shardQuery, RangeQuery<dist_t>* query) {
+  const ObjectVector&     res = *shardQuery.Result();
+  const vector<dist_t>&   dists = *shardQuery.ResultDists();
+  for (size_t i = 0; i < res.size(); ++i) query->CheckAndAddToResult(dists[i], res[i]);
+}
+
+}
+
+template <typename dist_t>
+ShardedIndex<dist_t>::ShardedIndex(
+         bool PrintProgress,
+         const string& SpaceType,
+         Space<dist_t>& space,
+         const ObjectVector& data) : Index<dist_t>(data), space_(space), SpaceType_(SpaceType), PrintProgress_(PrintProgress) {}
+
+template <typename dist_t>
+string ShardedIndex<dist_t>::GetShardFileName(const string& location, size_t i) {
+  return location + ".shard" + ConvertToString(i);
+}
+
+template <typename dist_t>
+void ShardedIndex<dist_t>::CreateIndex(const AnyParams& IndexParams) {
+  AnyParamManager pmgr(IndexParams);
+
+  size_t shardQty;
+  string partitionType;
+  pmgr.GetParamRequired("shardQty", shardQty);
+  pmgr.GetParamRequired("methodName", MethodName_);
+  pmgr.GetParamOptional("partition", partitionType, "random");
+  pmgr.GetParamOptional("shardThreadQty", shardThreadQty_,
+                        min<size_t>(shardQty, max(thread::hardware_concurrency(), 1u)));
+
+  AnyParams RemainParams = pmgr.ExtractParametersExcept({"shardQty", "methodName", "partition", "shardThreadQty"});
+
+  LOG(LIB_INFO) << "shardQty        = " << shardQty;
+  LOG(LIB_INFO) << "methodName      = " << MethodName_;
+  LOG(LIB_INFO) << "partition       = " << partitionType;
+  LOG(LIB_INFO) << "shardThreadQty  = " << shardThreadQty_;
+
+  CHECK_MSG(shardQty > 0, "shardQty should be > 0");
+  ToLower(partitionType);
+  if (partitionType == "random") partitionType_ = kRandom;
+  else if (partitionType == "cluster") partitionType_ = kCluster;
+  else throw runtime_error("partition should be one of the following: random, cluster");
+
+  shards_.clear();
+  centers_.clear();
+  shardData_.assign(shardQty, ObjectVector());
+  if (partitionType_ == kRandom) partitionRandom();
+  else partitionCluster();
+  createShards();
+
+  ParallelFor(0, shards_.size(), shardThreadQty_, [&](size_t i) {
+    if (!shards_[i]) return;
+    LOG(LIB_INFO) << "Method: " << MethodName_ << " shard # " << (i+1) << " out of " << shards_.size()
+                  << " (" << shardData_[i].size() << " points)";
+    AnyParams ParamCopy(RemainParams);
+    shards_[i]->CreateIndex(ParamCopy);
+  });
+
+  this->ResetQueryTimeParams(); // reset query time parameters
+}
+
+template <typename dist_t>
+void ShardedIndex<dist_t>::partitionRandom() {
+  vector<size_t> perm(this->data_.size());
+  for (size_t i = 0; i < perm.size(); ++i) perm[i] = i;
+  shuffle(perm.begin(), perm.end(), getThreadLocalRandomGenerator());
+  for (size_t i = 0; i < perm.size(); ++i) {
+    shardData_[i % shardData_.size()].push_back(this->data_[perm[i]]);
+  }
+}
+
+template <typename dist_t>
+void ShardedIndex<dist_t>::partitionCluster() {
+  const ObjectVector& data = this->data_;
+  size_t              centerQty = min(shardData_.size(), data.size());
+  vector<size_t>      perm(data.size());
+  for (size_t i = 0; i < perm.size(); ++i) perm[i] = i;
+  shuffle(perm.begin(), perm.end(), getThreadLocalRandomGenerator());
+  for (size_t i = 0; i < centerQty; ++i) centers_.push_back(data[perm[i]]);
+  shardData_.resize(centerQty);
+
+  // Each point goes to the shard with the closest center
+  vector<size_t> shardIds(data.size());
+  ParallelFor(0, data.size(), shardThreadQty_, [&](size_t i) {
+    dist_t minDist = numeric_limits<dist_t>::max();
+    for (size_t k = 0; k < centers_.size(); ++k) {
+      dist_t d = space_.IndexTimeDistance(centers_[k], data[i]);
+      if (d < minDist || k == 0) {
+        minDist = d;
+        shardIds[i] = k;
+      }
+    }
+  });
+  for (size_t i = 0; i < data.size(); ++i) shardData_[shardIds[i]].push_back(data[i]);
+}
+
+template <typename dist_t>
+void ShardedIndex<dist_t>::createShards() {
+  shards_.clear();
+  shards_.resize(shardData_.size());
+  for (size_t i = 0; i < shardData_.size(); ++i) {
+    if (shardData_[i].empty()) continue;
+    // Progress bars of concurrently built shards would be garbled
+    shards_[i].reset(MethodFactoryRegistry<dist_t>::Instance().CreateMethod(PrintProgress_ && shardThreadQty_ <= 1,
+                                                                           MethodName_,
+                                                                           SpaceType_,
+                                                                           space_,
+                                                                           shardData_[i]));
+  }
+}
+
+template <typename dist_t>
+void ShardedIndex<dist_t>::SaveIndex(const string& location) {
+  ofstream outFile(location);
+  CHECK_MSG(outFile, "Cannot open file '" + location + "' for writing");
+  outFile.exceptions(std::ios::badbit);
+
+  size_t lineNum = 0;
+  WriteField(outFile, METHOD_DESC, string(METH_SHARDED_INDEX)); lineNum++;
+  WriteField(outFile, "methodName", MethodName_); lineNum++;
+  WriteField(outFile, "partition", string(partitionType_ == kRandom ? "random" : "cluster")); lineNum++;
+  WriteField(outFile, "shardQty", shards_.size()); lineNum++;
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    WriteField(outFile, "shardId", i); lineNum++;
+    if (partitionType_ == kCluster) {
+      WriteField(outFile, "centerId", centers_[i]->id()); lineNum++;
+    }
+    WriteField(outFile, "objQty", shardData_[i].size()); lineNum++;
+    vector<IdType> oIDs;
+    for (const Object* pObj : shardData_[i]) oIDs.push_back(pObj->id());
+    outFile << MergeIntoStr(oIDs, ' ') << endl; lineNum++;
+  }
+  WriteField(outFile, LINE_QTY, lineNum + 1 /* including this line */);
+  outFile.close();
+
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    if (shards_[i]) shards_[i]->SaveIndex(GetShardFileName(location, i));
+  }
+}
+
+template <typename dist_t>
+void ShardedIndex<dist_t>::LoadIndex(const string& location) {
+  ifstream inFile(location);
+  CHECK_MSG(inFile, "Cannot open file '" + location + "' for reading");
+  inFile.exceptions(std::ios::badbit);
+
+  size_t lineNum = 1;
+  string methDesc, partitionType;
+  size_t shardQty;
+  ReadField(inFile, METHOD_DESC, methDesc); lineNum++;
+  CHECK_MSG(methDesc == METH_SHARDED_INDEX,
+            "Looks like you try to use an index created by a different method: " + methDesc);
+  ReadField(inFile, "methodName", MethodName_); lineNum++;
+  ReadField(inFile, "partition", partitionType); lineNum++;
+  CHECK_MSG(partitionType == "random" || partitionType == "cluster",
+            "Invalid partition type '" + partitionType + "' in " + location);
+  partitionType_ = partitionType == "random" ? kRandom : kCluster;
+  ReadField(inFile, "shardQty", shardQty); lineNum++;
+
+  unordered_map<IdType, const Object*> objById;
+  for (const Object* pObj : this->data_) objById.emplace(pObj->id(), pObj);
+  auto findObj = [&](IdType id) {
+    auto it = objById.find(id);
+    CHECK_MSG(it != objById.end(),
+              DATA_MUTATION_ERROR_MSG + " (the data set has no object with ID " + ConvertToString(id) + ")");
+    return it->second;
+  };
+
+  shards_.clear();
+  centers_.clear();
+  shardData_.assign(shardQty, ObjectVector());
+  size_t totalQty = 0;
+  string line;
+  for (size_t i = 0; i < shardQty; ++i) {
+    size_t shardId, objQty;
+    ReadField(inFile, "shardId", shardId); lineNum++;
+    CHECK_MSG(shardId == i, "Expected shard #" + ConvertToString(i) + " in line #" + ConvertToString(lineNum - 1) +
+                            " of " + location);
+    if (partitionType_ == kCluster) {
+      IdType centerId;
+      ReadField(inFile, "centerId", centerId); lineNum++;
+      centers_.push_back(findObj(centerId));
+    }
+    ReadField(inFile, "objQty", objQty); lineNum++;
+    vector<IdType> oIDs;
+    CHECK_MSG(getline(inFile, line),
+              "Failed to read line #" + ConvertToString(lineNum) + " from " + location);
+    CHECK_MSG(SplitStr(line, oIDs, ' ') && oIDs.size() == objQty,
+              "Failed to extract " + ConvertToString(objQty) + " object IDs from line #" +
+              ConvertToString(lineNum) + " of " + location);
+    lineNum++;
+    for (IdType id : oIDs) shardData_[i].push_back(findObj(id));
+    totalQty += objQty;
+  }
+  size_t ExpLineNum;
+  ReadField(inFile, LINE_QTY, ExpLineNum);
+  CHECK_MSG(lineNum == ExpLineNum,
+            DATA_MUTATION_ERROR_MSG + " (expected number of lines " + ConvertToString(ExpLineNum) +
+            " read so far doesn't match the number of read lines: " + ConvertToString(lineNum) + ")");
+  CHECK_MSG(totalQty == this->data_.size(),
+            DATA_MUTATION_ERROR_MSG + " (shards have " + ConvertToString(totalQty) +
+            " points, but the data set has " + ConvertToString(this->data_.size()) + " points)");
+  inFile.close();
+
+  if (!shardThreadQty_) shardThreadQty_ = min<size_t>(shardQty, max(thread::hardware_concurrency(), 1u));
+  createShards();
+  ParallelFor(0, shards_.size(), shardThreadQty_, [&](size_t i) {
+    if (shards_[i]) shards_[i]->LoadIndex(GetShardFileName(location, i));
+  });
+
+  this->ResetQueryTimeParams();
+}
+
+template <typename dist_t>
+void ShardedIndex<dist_t>::SetQueryTimeParams(const AnyParams& QueryTimeParams) {
+  AnyParamManager pmgr(QueryTimeParams);
+  pmgr.GetParamOptional("probeQty", probeQty_, shards_.size());
+  pmgr.GetParamOptional("searchThreadQty", searchThreadQty_, max(thread::hardware_concurrency(), 1u));
+  AnyParams RemainParams = pmgr.ExtractParametersExcept({"probeQty", "searchThreadQty"});
+
+  CHECK_MSG(probeQty_ > 0 || shards_.empty(), "probeQty should be > 0");
+  CHECK_MSG(partitionType_ == kCluster || probeQty_ >= shards_.size(),
+            "probeQty can be smaller than the number of shards only for clustered partitioning");
+  LOG(LIB_INFO) << "Set sharded index query-time parameters:";
+  LOG(LIB_INFO) << "probeQty           =" << probeQty_;
+  LOG(LIB_INFO) << "searchThreadQty    =" << searchThreadQty_;
+
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    if (!shards_[i]) continue;
+    AnyParams ParamCopy(RemainParams);
+    shards_[i]->SetQueryTimeParams(ParamCopy);
+  }
+  // The calling thread searches shards too
+  size_t workerQty = min(searchThreadQty_, min(probeQty_, shards_.size()));
+  workerQty = workerQty > 0 ? workerQty - 1 : 0;
+  if (!searchPool_ || searchPool_->GetWorkerQty() != workerQty) searchPool_.reset(new ThreadPool(workerQty));
+}
+
+template <typename dist_t>
+ShardedIndex<dist_t>::~ShardedIndex() {}
+
+template <typename dist_t>
+const std::string ShardedIndex<dist_t>::StrDesc() const {
+  std::stringstream str;
+  str << "" << shards_.size() << " shards of " << MethodName_
+      << (partitionType_ == kRandom ? " (random partitioning)" : " (clustered partitioning)");
+  return str.str();
+}
+
+template <typename dist_t>
+template <typename QueryType>
+void ShardedIndex<dist_t>::selectShards(QueryType* query, vector<size_t>& shardIds) const {
+  shardIds.clear();
+  if (partitionType_ == kRandom || probeQty_ >= shards_.size()) {
+    for (size_t i = 0; i < shards_.size(); ++i) {
+      if (shards_[i]) shardIds.push_back(i);
+    }
+    return;
+  }
+  vector<pair<dist_t, size_t>> centerDists;
+  for (size_t i = 0; i < centers_.size(); ++i) {
+    if (shards_[i]) centerDists.emplace_back(query->DistanceObjLeft(centers_[i]), i);
+  }
+  size_t qty = min(probeQty_, centerDists.size());
+  partial_sort(centerDists.begin(), centerDists.begin() + qty, centerDists.end());
+  for (size_t i = 0; i < qty; ++i) shardIds.push_back(centerDists[i].second);
+}
+
+template <typename dist_t>
+template <typename QueryType>
+void ShardedIndex<dist_t>::searchShards(QueryType* query) const {
+  vector<size_t> shardIds;
+  selectShards(query, shardIds);
+
+  vector<unique_ptr<QueryType>> shardQueries(shardIds.size());
+  auto searchShard = [&](size_t k) {
+    shardQueries[k] = CreateShardQuery(space_, query);
+    shards_[shardIds[k]]->Search(shardQueries[k].get());
+  };
+  if (searchPool_ && shardIds.size() > 1) {
+    searchPool_->ParallelFor(0, shardIds.size(), searchShard);
+  } else {
+    for (size_t k = 0; k < shardIds.size(); ++k) searchShard(k);
+  }
+
+  // Shards are disjoint, so merged results have no duplicates
+  for (const auto& shardQuery : shardQueries) {
+    query->AddDistanceComputations(shardQuery->DistanceComputations());
+    query->GetSearchStat().Add(shardQuery->GetSearchStat());
+    MergeShardResult(*shardQuery, query);
+  }
+}
+
+template <typename dist_t>
+void ShardedIndex<dist_t>::Search(RangeQuery<dist_t>* query, IdType) const {
+  searchShards(query);
+}
+
+template <typename dist_t>
+void ShardedIndex<dist_t>::Search(KNNQuery<dist_t>* query, IdType) const {
+  searchShards(query);
+}
+
+template class ShardedIndex<float>;
+template class ShardedIndex<double>;
+template class ShardedIndex<int>;
+
+}   // namespace similarity
@@ -13,6 +13,7 @@
  *
  */
 #include <cmath>
+#include <cstring>
 #include <memory>
 #include <iostream>
 // This is only for _mm_prefetch
@@ -27,7 +28,10 @@
 #include "method/small_world_rand.h"
 #include "sort_arr_bi.h"
 #include "thread_pool.h"
+#include "mmap_file.h"
+#include "knn_graph_file.h"
 
+#include <algorithm>
 #include <vector>
 #include <set>
 #include <map>
@@ -36,27 +40,64 @@
 
 #define MERGE_BUFFER_ALGO_SWITCH_THRESHOLD 100
 #define MAX_ID_TO_SIZE_RATIO               1.5
+// The default initial size of neighbor lists is NN times this value
+#define SW_GRAPH_MAX_NN_MULT               8
+// The number of striped locks that protect neighbor lists during indexing
+#define SW_GRAPH_LINK_LOCK_QTY             4096
+// When the graph outgrows its capacity, the capacity is multiplied by this value
+#define SW_GRAPH_GROWTH_FACTOR             1.5
+// The default number of nodes processed in one step of the background repair
+#define SW_GRAPH_REPAIR_BUDGET             1000
+#define SW_GRAPH_FILE_VERSION              1
+// Node blocks in index files are aligned, so that they can be mapped to memory
+#define SW_GRAPH_FILE_ALIGN                4096
 
 namespace similarity {
 
 using namespace std;
 
+const char SW_GRAPH_FILE_MAGIC[8] = {'N', 'M', 'S', 'L', 'I', 'B', 'S', 'W'};
+
+/*
+ * The binary index file starts with this header. It is followed (at the offset blockOffset)
+ * by nodeQty node blocks, which have the same layout as in memory, except that
+ * object pointers are replaced with object ids.
+ */
+struct SWGraphFileHeader {
+  char      magic[8];
+  uint32_t  version;
+  uint32_t  idSize;
+  uint32_t  pointerSize;
+  uint32_t  useProxyDist;
+  uint64_t  nodeQty;
+  uint64_t  NN;
+  uint64_t  maxNN;
+  uint64_t  efConstruction;
+  uint64_t  blockSize;
+  uint64_t  blockOffset;
+  int64_t   entryPointId;
+};
+
 template <typename dist_t>
 struct IndexThreadParamsSW {
   const Space<dist_t>&                        space_;
   SmallWorldRand<dist_t>&                     index_;
   IdType                                      startNodeId_;
+  size_t                                      firstId_;
   const ObjectVector&                         batchData_;
   size_t                                      index_every_;
   size_t                                      out_of_;
   ProgressDisplay*                            progress_bar_;
   mutex&                                      display_mutex_;
   size_t                                      progress_update_qty_;
+  // The batch position where the thread continues after the blocks are grown
+  size_t                                      nextId_;
   
   IndexThreadParamsSW(
                      const Space<dist_t>&             space,
                      SmallWorldRand<dist_t>&          index, 
                      IdType                           startNodeId,
+                     size_t                           firstId,
                      const ObjectVector&              batchData,
                      size_t                           index_every,
                      size_t                           out_of,
@@ -67,12 +108,14 @@ struct IndexThreadParamsSW {
                      space_(space),
                      index_(index), 
                      startNodeId_(startNodeId),
+                     firstId_(firstId),
                      batchData_(batchData),
                      index_every_(index_every),
                      out_of_(out_of),
                      progress_bar_(progress_bar),
                      display_mutex_(display_mutex),
-                     progress_update_qty_(progress_update_qty)
+                     progress_update_qty_(progress_update_qty),
+                     nextId_(firstId)
                      { }
 };
 
@@ -82,15 +125,17 @@ struct IndexThreadSW {
     ProgressDisplay*  progress_bar = prm.progress_bar_;
     mutex&            display_mutex(prm.display_mutex_); 
     /* 
-     * Skip the first element, it was added already in the AddBatch
+     * If the graph was empty, skip the first element: it became the entry point in AddBatch
      */
     size_t futureNextNodeId = prm.startNodeId_ + prm.batchData_.size();
 
-    size_t nextQty = prm.progress_update_qty_;
-    for (size_t id = 1; id < prm.batchData_.size(); ++id) {
+    size_t nextQty = prm.progress_update_qty_ * (prm.nextId_ / prm.progress_update_qty_ + 1);
+    for (; prm.nextId_ < prm.batchData_.size(); ++prm.nextId_) {
+      size_t id = prm.nextId_;
       if (prm.index_every_ == id % prm.out_of_) {
-        MSWNode* node = new MSWNode(prm.batchData_[id], id + prm.startNodeId_);
-        prm.index_.add(node, futureNextNodeId);
+        // A neighbor list is full: the thread stops and is restarted once the blocks are grown
+        if (prm.index_.isGrowRequested()) return;
+        prm.index_.add(id + prm.startNodeId_, futureNextNodeId);
       
         if ((id + 1 >= min(prm.batchData_.size(), nextQty)) && progress_bar) {
           unique_lock<mutex> lock(display_mutex);
@@ -110,27 +155,82 @@ template <typename dist_t>
 SmallWorldRand<dist_t>::SmallWorldRand(bool PrintProgress,
                                        const Space<dist_t>& space,
                                        const ObjectVector& data) : 
-                                       Index<dist_t>(data), space_(space), PrintProgress_(PrintProgress), use_proxy_dist_(false) {}
+                                       Index<dist_t>(data), space_(space), PrintProgress_(PrintProgress), use_proxy_dist_(false),
+                                       linkLocks_(SW_GRAPH_LINK_LOCK_QTY) {}
+
+template <typename dist_t>
+void SmallWorldRand<dist_t>::initGraphMemory(size_t maxNN) {
+  CHECK_MSG(maxNN > 0 && maxNN <= static_cast<size_t>(numeric_limits<IdType>::max()),
+            "Invalid maximum number of neighbors: " + ConvertToString(maxNN));
+  atomic_store(&graph_, make_shared<SWGraph>(maxNN, 0));
+  objIdToNodeId_.clear();
+  pendingRepair_.clear();
+}
 
 template <typename dist_t>
-void SmallWorldRand<dist_t>::UpdateNextNodeId(size_t newNextNodeId)
+void SmallWorldRand<dist_t>::resizeGraph(IdType nodeQty) {
+  const SWGraph& graph = *graph_;
+  if (nodeQty > graph.capacity) {
+    /*
+     * The graph is copied rather than reallocated in place, so that searches using
+     * the old copy aren't affected. Because the capacity grows geometrically,
+     * a stream of small batches causes only a logarithmic number of copies.
+     */
+    size_t capacity = max<size_t>(nodeQty, graph.capacity * SW_GRAPH_GROWTH_FACTOR);
+    capacity = min<size_t>(capacity, numeric_limits<IdType>::max());
+    atomic_store(&graph_, make_shared<SWGraph>(graph, capacity));
+  }
+  graph_->nodeQty = nodeQty;
+}
+
+template <typename dist_t>
+IdType SmallWorldRand<dist_t>::GetCompactNodeIds(vector<IdType>& newNodeIds) const
 {
-  NextNodeId_ = newNextNodeId;
+  const SWGraph& graph = *graph_;
+  newNodeIds.assign(graph.nodeQty, -1);
+  IdType newNextNodeId = 0;
+  for (IdType nodeId = 0; nodeId < graph.nodeQty; ++nodeId) {
+    if (graph.getNodeData(nodeId) != nullptr) newNodeIds[nodeId] = newNextNodeId++;
+  }
+  return newNextNodeId;
 }
 
 template <typename dist_t>
 void SmallWorldRand<dist_t>::CompactIdsIfNeeded()
 {
-  if (ElList_.size() * MAX_ID_TO_SIZE_RATIO < NextNodeId_) {
-    LOG(LIB_INFO) << "ID compactification started";
-    NextNodeId_ = 0;
-    for (auto it : ElList_) {
-      MSWNode* node = it.second;
-      node->setId(NextNodeId_);
-      ++NextNodeId_;
+  const SWGraph& graph = *graph_;
+  // Deleted nodes can be removed only after links to them are repaired
+  if (!pendingRepair_.empty() || repairInProgress_ ||
+      objIdToNodeId_.size() * MAX_ID_TO_SIZE_RATIO >= graph.nodeQty) return;
+
+  LOG(LIB_INFO) << "ID compactification started";
+  /*
+   * Live nodes are copied to a new graph, where they have consecutive ids.
+   * The new graph replaces the current one, but searches that have already
+   * started keep using the old one.
+   */
+  vector<IdType>      newNodeIds;
+  IdType              newNextNodeId = GetCompactNodeIds(newNodeIds);
+  shared_ptr<SWGraph> newGraph = make_shared<SWGraph>(graph.maxNN, newNextNodeId);
+  for (IdType nodeId = 0; nodeId < graph.nodeQty; ++nodeId) {
+    IdType newNodeId = newNodeIds[nodeId];
+    if (newNodeId < 0) continue;
+    newGraph->setNodeData(newNodeId, graph.getNodeData(nodeId));
+    const atomic<IdType>* links = graph.getNodeLinks(nodeId);
+    atomic<IdType>*       newLinks = newGraph->getNodeLinks(newNodeId);
+    IdType                qty = graph.getNodeDegree(nodeId);
+    for (IdType i = 0; i < qty; ++i) {
+      IdType neighbId = links[i].load(memory_order_relaxed);
+      CHECK_MSG(newNodeIds[neighbId] >= 0, "Bug: a deleted node is still linked to node " + ConvertToString(nodeId));
+      newLinks[i].store(newNodeIds[neighbId], memory_order_relaxed);
     }
-    LOG(LIB_INFO) << "ID compactification ended";
+    newGraph->setNodeDegree(newNodeId, qty);
   }
+  for (auto& e : objIdToNodeId_) e.second = newNodeIds[e.second];
+  IdType entryPointId = graph.entryPointId;
+  newGraph->entryPointId = entryPointId >= 0 ? newNodeIds[entryPointId] : -1;
+  atomic_store(&graph_, newGraph);
+  LOG(LIB_INFO) << "ID compactification ended";
 }
 
 template <typename dist_t>
@@ -139,26 +239,47 @@ void SmallWorldRand<dist_t>::AddBatch(const ObjectVector& batchData,
                                       bool bCheckIDs /* this is a debug flag only, turning it on may affect performance */)
 {
   if (batchData.empty()) return;
-  changedAfterCreateIndex_ = true;
+  unique_lock<mutex> updateLock(updateMutex_);
 
-  size_t futureNextNodeId = NextNodeId_ + batchData.size();
+  IdType startNodeId = graph_->nodeQty;
+  size_t futureNextNodeId = startNodeId + batchData.size();
+  CHECK_MSG(futureNextNodeId <= static_cast<size_t>(numeric_limits<IdType>::max()),
+            "The number of nodes exceeds the maximum internal node id");
 
-  LOG(LIB_INFO) << "Current nextNodeId: " << NextNodeId_ 
+  LOG(LIB_INFO) << "Current nextNodeId: " << startNodeId
                 << " futureNextNodeId + 1 after batch addition: " << futureNextNodeId;
 
-  // 2) One entry should be added before all the threads are started, or else add() will not work properly  
-  addCriticalSection(new MSWNode(batchData[0], NextNodeId_));
+  /*
+   * 1) Blocks of all new nodes are allocated before the threads are started,
+   *    hence, the graph memory is never reallocated during insertion.
+   *    Searches can't reach new nodes until they are linked.
+   */
+  resizeGraph(futureNextNodeId);
+  SWGraph& graph = *graph_;
+  for (size_t id = 0; id < batchData.size(); ++id) {
+    IdType nodeId = startNodeId + id;
+    graph.setNodeData(nodeId, batchData[id]);
+    // If ids are duplicated, only the first object can be deleted
+    objIdToNodeId_.emplace(batchData[id]->id(), nodeId);
+  }
+
+  // 2) If the graph is empty, the first node becomes the entry point, or else add() will not work properly
+  size_t firstId = 0;
+  if (graph.entryPointId < 0) {
+    graph.entryPointId = startNodeId;
+    firstId = 1;
+    this->buildProfiler_.AddProgress();
+  }
 
   unique_ptr<ProgressDisplay> progress_bar(bPrintProgress ?
                                 new ProgressDisplay(batchData.size(), cerr)
                                 :NULL);
 
   if (indexThreadQty_ <= 1) {
-    // Skip the first element, one element is already added
-    if (progress_bar) ++(*progress_bar);
-    for (size_t id = 1; id < batchData.size(); ++id) {
-      MSWNode* node = new MSWNode(batchData[id], id + NextNodeId_);
-      add(node, futureNextNodeId);
+    if (progress_bar) (*progress_bar) += firstId;
+    for (size_t id = firstId; id < batchData.size(); ++id) {
+      add(id + startNodeId, futureNextNodeId);
+      growBlocks();
       if (progress_bar) ++(*progress_bar);
     }
   } else {
@@ -168,23 +289,34 @@ void SmallWorldRand<dist_t>::AddBatch(const ObjectVector& batchData,
 
     for (size_t i = 0; i < indexThreadQty_; ++i) {
       threadParams.push_back(shared_ptr<IndexThreadParamsSW<dist_t>>(
-                              new IndexThreadParamsSW<dist_t>(space_, *this, NextNodeId_, 
+                              new IndexThreadParamsSW<dist_t>(space_, *this, startNodeId, firstId,
                                                               batchData, 
                                                               i, indexThreadQty_,
                                                               progress_bar.get(), progressBarMutex, 200)));
     }
-    for (size_t i = 0; i < indexThreadQty_; ++i) {
-      threads[i] = thread(IndexThreadSW<dist_t>(), ref(*threadParams[i]));
-    }
-    for (size_t i = 0; i < indexThreadQty_; ++i) {
-      threads[i].join();
+    /*
+     * Blocks are grown only when no thread is indexing, so threads are restarted
+     * each time they stop because of a full neighbor list. Because the block size grows
+     * geometrically, this happens only a few times.
+     */
+    bool finished = false;
+    while (!finished) {
+      for (size_t i = 0; i < indexThreadQty_; ++i) {
+        threads[i] = thread(IndexThreadSW<dist_t>(), ref(*threadParams[i]));
+      }
+      for (size_t i = 0; i < indexThreadQty_; ++i) {
+        threads[i].join();
+      }
+      growBlocks();
+      finished = true;
+      for (const auto& prm : threadParams) finished = finished && prm->nextId_ >= batchData.size();
     }
     LOG(LIB_INFO) << indexThreadQty_ << " indexing threads have finished";
   }
-  UpdateNextNodeId(futureNextNodeId);
   CompactIdsIfNeeded();
   if (bCheckIDs) CheckIDs();
-  LOG(LIB_INFO) << "The number of data points: " << ElList_.size() << " NextNodeId_ = " << NextNodeId_;
+  LOG(LIB_INFO) << "The number of data points: " << objIdToNodeId_.size() << " NextNodeId_ = " << graph_->nodeQty.load()
+                << " graph memory: " << graph_->memory.size() / 1024 / 1024 << " MB";
 }
 
 template <typename dist_t>
@@ -194,143 +326,257 @@ void SmallWorldRand<dist_t>::DeleteBatch(const ObjectVector& batchData, int delS
   DeleteBatch(batchIds, delStrategy, checkIDs);
 }
 
+/*
+ * In all the repair functions, delNodes[nodeId] is zero for nodes that aren't
+ * being repaired and 1 + the patching strategy for deleted nodes that are.
+ */
 template <typename dist_t>
-void SmallWorldRand<dist_t>::DeleteBatch(const vector<IdType>& batchData, int delStrategyCode, bool checkIDs) {
-  if (batchData.empty() ||  // 1. batch is empty
-      0 == NextNodeId_      // 2. no data is indexed
-      ) return;
-  changedAfterCreateIndex_ = true;
-  /* 
-   * Done in several stages.
-   * 1) Identifying entries to be deleted & deleting nodes from ElList_.
-   * 2) Removing neighbors with subsequent patching
-   * 3) Actually removing nodes from ElList_ and freeing memory.
+bool SmallWorldRand<dist_t>::removeGivenNeighbors(IdType nodeId, const vector<char>& delNodes,
+                                                  vector<IdType>& delNeighbors) {
+  SWGraph&        graph = *graph_;
+  atomic<IdType>* links = graph.getNodeLinks(nodeId);
+  IdType          delNodeQty = delNodes.size();
+  /*
+   * Links to deleted nodes are never added, so most nodes can be skipped without locking.
+   * Nodes with ids >= delNodeQty were added during the repair.
    */
-  // Stage 1. Identifying entries to be deleted.
-  vector<MSWNode*>        vToPatchNodes;
-  vector<MSWNode*>        vToDelNodes;
-  vector<bool>            delNodesBitset(NextNodeId_);
+  bool   found = false;
+  IdType qty = graph.getNodeDegree(nodeId);
+  for (IdType i = 0; i < qty && !found; ++i) {
+    IdType neighbId = links[i].load(memory_order_relaxed);
+    found = neighbId < delNodeQty && delNodes[neighbId];
+  }
+  if (!found) return false;
+
+  unique_lock<mutex> lock(getLinkLock(nodeId));
+  /*
+   * This in-place one-iteration deletion of elements in delNodes
+   * Invariant in the beginning of each loop iteration:
+   * i >= newQty
+   * Furthermore:
+   * i - newQty == the number of entries deleted in previous iterations
+   */
+  qty = graph.getNodeDegree(nodeId);
+  IdType newQty = 0;
+  delNeighbors.clear();
+  for (IdType i = 0; i < qty; ++i) {
+    IdType neighbId = links[i].load(memory_order_relaxed);
+    if (neighbId < delNodeQty && delNodes[neighbId]) delNeighbors.push_back(neighbId);
+    else links[newQty++].store(neighbId, memory_order_relaxed);
+  }
+  graph.setNodeDegree(nodeId, newQty);
+  return true;
+}
 
-  for (IdType objId : batchData) {
-    const auto it = ElList_.find(objId);
-    CHECK_MSG(it != ElList_.end(), "An attempt to delete a non-existing object with id=" + ConvertToString(objId));
-    MSWNode* delNode=it->second;
-    IdType   delNodeId = delNode->getId();
-    CHECK(delNodeId < (ssize_t)delNodesBitset.size());
-    delNodesBitset[delNodeId]=true;
-    vToDelNodes.push_back(delNode);
-    ElList_.erase(it);
-  }
-  for (MSWNode* node: vToDelNodes) {
-    for (MSWNode* pNeighbor : node->getAllFriends()) {
-      IdType neighbNodeId = pNeighbor->getId();
-      CHECK(neighbNodeId < (ssize_t)delNodesBitset.size());
-      if (!delNodesBitset.at(neighbNodeId))
-        vToPatchNodes.push_back(pNeighbor);
-    }
-  }
-
-  // vToPatchNodes can have duplicates, but we must process one node exactly ones
-  sort(vToPatchNodes.begin(), vToPatchNodes.end());
-  auto it = unique(vToPatchNodes.begin(), vToPatchNodes.end()); 
-  vToPatchNodes.resize(distance(vToPatchNodes.begin(), it));
-
-  LOG(LIB_INFO) << "The number of nodes that need patching: " << vToPatchNodes.size();
-  // Stage 2. Removing neighbors & possibly patching
+template <typename dist_t>
+void SmallWorldRand<dist_t>::repairNode(IdType nodeId, const vector<char>& delNodes) {
+  const SWGraph&  graph = *graph_;
+  const Object*   queryObj = graph.getNodeData(nodeId);
+  vector<IdType>  delNeighbors;
+  // Nodes deleted during the repair are repaired later
+  if (queryObj == nullptr || !removeGivenNeighbors(nodeId, delNodes, delNeighbors)) return;
+  /*
+   * Attempt to replace each deleted neighbor with its closest live neighbor.
+   * Neighbor lists of deleted nodes aren't modified.
+   */
+  for (IdType toDelNodeId : delNeighbors) {
+    if (delNodes[toDelNodeId] != 1 + kNeighborsOnly) continue;
+    IdType                replacementId = -1;
+    dist_t                dmin = numeric_limits<dist_t>::max();
+    const atomic<IdType>* links = graph.getNodeLinks(toDelNodeId);
+    IdType                qty = graph.getNodeDegree(toDelNodeId);
+    for (IdType k = 0; k < qty; ++k) {
+      IdType neighbId = links[k].load(memory_order_relaxed);
+      if (neighbId != nodeId && graph.getNodeData(neighbId) != nullptr) {
+        dist_t d = nodeDist(neighbId, queryObj);
+        if (d < dmin) {
+          dmin = d;
+          replacementId = neighbId;
+        }
+      }
+    }
+    if (replacementId >= 0) link(nodeId, replacementId);
+  }
+}
+
+template <typename dist_t>
+void SmallWorldRand<dist_t>::repairDeleted(unique_lock<mutex>& updateLock, size_t budget, size_t threadQty) {
+  if (pendingRepair_.empty()) return;
+  CHECK(budget > 0);
+  vector<DeletedNode> deleted;
+  deleted.swap(pendingRepair_);
+  repairInProgress_ = true;
+
+  /*
+   * Links aren't necessarily reciprocal (e.g., neighbor lists of a graph created
+   * from a k-NN graph are pruned). Hence, nodes linked to deleted ones are found by scanning all
+   * neighbor lists rather than neighbor lists of deleted nodes.
+   * The scan is split into steps of budget nodes. Between steps, the lock
+   * is released: node ids don't change, because ids aren't compacted during the repair.
+   */
+  size_t       nodeQty = graph_->nodeQty;
+  vector<char> delNodes(nodeQty);
+  for (const DeletedNode& e : deleted) delNodes[e.nodeId] = 1 + e.patchStrat;
+
+  for (size_t start = 0; start < nodeQty; start += budget) {
+    if (start > 0) {
+      updateLock.unlock();
+      this_thread::yield();
+      updateLock.lock();
+      if (stopRepair_) break;
+    }
+    size_t end = min(nodeQty, start + budget);
+    if (threadQty == 1) {
+      for (size_t nodeId = start; nodeId < end; ++nodeId) repairNode(nodeId, delNodes);
+    } else {
+      ParallelFor(start, end, threadQty, [&](IdType nodeId) {
+        repairNode(nodeId, delNodes);
+      });
+    }
+    growBlocks();
+  }
+  repairInProgress_ = false;
+  LOG(LIB_INFO) << "Repaired links to " << deleted.size() << " deleted nodes";
+  repairDoneCond_.notify_all();
+}
+
+template <typename dist_t>
+void SmallWorldRand<dist_t>::repairThreadMain() {
+  unique_lock<mutex> updateLock(updateMutex_);
+  while (true) {
+    repairCond_.wait(updateLock, [this] { return stopRepair_ || !pendingRepair_.empty(); });
+    if (stopRepair_) break;
+    try {
+      repairDeleted(updateLock, repairBudget_, 1);
+      CompactIdsIfNeeded();
+    } catch (const exception& e) {
+      repairInProgress_ = false;
+      repairDoneCond_.notify_all();
+      LOG(LIB_ERROR) << "The background repair failed: " << e.what();
+    }
+  }
+}
+
+template <typename dist_t>
+void SmallWorldRand<dist_t>::stopRepairThread() {
+  if (!repairThread_.joinable()) return;
+  {
+    unique_lock<mutex> updateLock(updateMutex_);
+    stopRepair_ = true;
+  }
+  repairCond_.notify_all();
+  repairThread_.join();
+  stopRepair_ = false;
+}
+
+template <typename dist_t>
+void SmallWorldRand<dist_t>::waitForRepair(unique_lock<mutex>& updateLock) {
+  repairDoneCond_.wait(updateLock, [this] { return pendingRepair_.empty() && !repairInProgress_; });
+}
+
+template <typename dist_t>
+void SmallWorldRand<dist_t>::WaitForRepair() {
+  unique_lock<mutex> updateLock(updateMutex_);
+  waitForRepair(updateLock);
+}
+
+template <typename dist_t>
+void SmallWorldRand<dist_t>::DeleteBatch(const vector<IdType>& batchData, int delStrategyCode, bool checkIDs) {
+  if (batchData.empty()) return;
   PatchingStrategy patchStrat = static_cast<PatchingStrategy>(delStrategyCode);
   CHECK_MSG(patchStrat == kNone || patchStrat == kNeighborsOnly,
             "Unsupported patching strategy code: " + ConvertToString(delStrategyCode));
 
-  queue<MSWNode*> toPatchQueue;
-  for (MSWNode* node : vToPatchNodes) toPatchQueue.push(node);
-  mutex mtx;
-  vector<thread> threads;
-
-  for (size_t i = 0; i < indexThreadQty_; ++i) {
-    threads.push_back(thread(
-      [&]() {
-        MSWNode* node = nullptr;
-        vector<MSWNode*> cacheDelNode;
-        while(GetNextQueueObj(mtx, toPatchQueue, node)) {
-          if (kNone == patchStrat) node->removeGivenFriends(delNodesBitset);
-          else node->removeGivenFriendsPatchWithClosestNeighbor<dist_t>(space_, use_proxy_dist_, 
-                                                                        delNodesBitset, cacheDelNode);
-        }
-      }
-    ));
-  }
-  for (auto& thread : threads) thread.join();
-
-
-  if (checkIDs) {
-    for (auto it : ElList_) {
-      MSWNode* node = it.second;
-      IdType   nodeId = node->getId();
-      CHECK(nodeId < (ssize_t)delNodesBitset.size());
-      CHECK(!delNodesBitset.at(nodeId));
-      for (MSWNode* neighb : node->getAllFriends()) {
-        IdType   neighNodeId = neighb->getId();
-        CHECK(neighNodeId < (ssize_t)delNodesBitset.size());
-        if (delNodesBitset.at(neighNodeId)) {
-        /* 
-         * Two things to check here:
-         *  1) Was the node with to-be-deleted neighbor in the list of nodes that need patching?
-         *  2) Was the deleted node in the list of to-be-deleted nodes?
-         *  3) Do we have a reciprocal neighbor situation here?
-         */
-          LOG(LIB_INFO) << "Bug: a to-be-deleted node is still found among neighbors!";
-          LOG(LIB_INFO) << "Is this neighbor in the list of to-be-deleted nodes (as expected)? " << (find(vToDelNodes.begin(),vToDelNodes.end(),neighb)!=vToDelNodes.end());
-          LOG(LIB_INFO) << "Is the connected node in the list of to-be-patched nodes (as expected)? " << (find(vToPatchNodes.begin(), vToPatchNodes.end(), node) != vToPatchNodes.end());
-          bool isRecipNeighb = false;
-          for (MSWNode* nn : neighb->getAllFriends()) {
-            if (nn == neighb) {
-              isRecipNeighb = true;
-              break;
-            }
-          }
-          LOG(LIB_INFO) << "Do we have a reciprocal neighbor situation here (as expected)? " << isRecipNeighb;
-        }
-        CHECK(!delNodesBitset.at(neighNodeId));
+  unique_lock<mutex> updateLock(updateMutex_);
+  if (!graph_ || 0 == graph_->nodeQty) return; // no data is indexed
+  SWGraph& graph = *graph_;
+  /* 
+   * Done in several stages.
+   * 1) Deleting entries from objIdToNodeId_ and turning nodes into tombstones,
+   *    which are skipped by searches from now on.
+   * 2) Choosing a new entry point if needed.
+   * 3) Removing links to deleted nodes with subsequent patching.
+   *    This is done either right away or by the background repair thread.
+   */
+  // Stage 1
+  for (IdType objId : batchData) {
+    const auto it = objIdToNodeId_.find(objId);
+    CHECK_MSG(it != objIdToNodeId_.end(), "An attempt to delete a non-existing object with id=" + ConvertToString(objId));
+    IdType delNodeId = it->second;
+    graph.setNodeData(delNodeId, nullptr);
+    pendingRepair_.push_back(DeletedNode{delNodeId, patchStrat});
+    objIdToNodeId_.erase(it);
+  }
+  LOG(LIB_INFO) << "The number of deleted nodes waiting for repair: " << pendingRepair_.size();
+
+  // Stage 2
+  IdType entryPointId = graph.entryPointId;
+  if (entryPointId >= 0 && graph.getNodeData(entryPointId) == nullptr) {
+    entryPointId = -1;
+    for (IdType nodeId = 0; nodeId < graph.nodeQty; ++nodeId) {
+      if (graph.getNodeData(nodeId) != nullptr) {
+        entryPointId = nodeId;
+        break;
       }
     }
+    graph.entryPointId = entryPointId;
   }
+  CHECK(graph.entryPointId >= 0 || objIdToNodeId_.empty());
 
-  // Stage 4. Clean-up and ID update
-  for (MSWNode* node : vToDelNodes) {
-    delete node;
+  // Stage 3
+  if (backgroundRepair_) {
+    repairCond_.notify_one();
+  } else {
+    repairDeleted(updateLock, graph.nodeQty, indexThreadQty_);
+    CompactIdsIfNeeded();
   }
-
-  pEntryPoint_ = ElList_.empty() ? nullptr : ElList_.begin()->second; 
-  CHECK(pEntryPoint_ != nullptr || ElList_.empty());
-  
-  CompactIdsIfNeeded();
   if (checkIDs) CheckIDs();
 }
 
 template <typename dist_t>
 void SmallWorldRand<dist_t>::CheckIDs() const
 {
-  // ElList_.size() can be smaller though
-  CHECK_MSG(NextNodeId_ >= (ssize_t)ElList_.size(), 
-            "Bug NextNodeId_ = " + ConvertToString(NextNodeId_) + 
-            " is < ElList_.size() = " + ConvertToString(ElList_.size()));
-  vector<bool>  visitedBitset(NextNodeId_);
+  const SWGraph& graph = *graph_;
+  // objIdToNodeId_.size() can be smaller though
+  CHECK_MSG(graph.nodeQty >= (ssize_t)objIdToNodeId_.size(), 
+            "Bug NextNodeId_ = " + ConvertToString(graph.nodeQty) + 
+            " is < objIdToNodeId_.size() = " + ConvertToString(objIdToNodeId_.size()));
+  CHECK_MSG(graph.nodeQty <= graph.capacity &&
+            graph.memory.size() == static_cast<size_t>(graph.capacity) * graph.blockSize,
+            "Bug: the size of the graph memory doesn't match the capacity " + ConvertToString(graph.capacity));
+  vector<bool>  visitedBitset(graph.nodeQty);
 
   LOG(LIB_INFO) << "Checking validity of node IDs asslignment";
   
-  //We check that each ID is unique and is within the range [0, NextNodeId_)
-  for(ElementMap::const_iterator it = ElList_.begin(); it != ElList_.end(); ++it) {
-    MSWNode* pNode = it->second;
-    IdType nodeID = pNode->getId();
-    CHECK_MSG(nodeID >= 0 && nodeID < NextNodeId_,
+  //We check that each ID is unique, is within the range [0, NextNodeId_), and points to the right object
+  for (const auto& e : objIdToNodeId_) {
+    IdType nodeID = e.second;
+    CHECK_MSG(nodeID >= 0 && nodeID < graph.nodeQty,
             "Bug: unexpected node ID " + ConvertToString(nodeID) +
-            " for object ID " + ConvertToString(pNode->getData()->id()) +
-            "NextNodeId_ = " + ConvertToString(NextNodeId_));
+            " for object ID " + ConvertToString(e.first) +
+            "NextNodeId_ = " + ConvertToString(graph.nodeQty));
+    CHECK_MSG(graph.getNodeData(nodeID) != nullptr && graph.getNodeData(nodeID)->id() == e.first,
+            "Bug: node ID " + ConvertToString(nodeID) +
+            " doesn't point to the object with ID " + ConvertToString(e.first));
     CHECK_MSG(visitedBitset[nodeID]==false,
             "Bug: duplicating node ID " + ConvertToString(nodeID) +
-            " encountered which check object ID " + ConvertToString(pNode->getData()->id()));
+            " encountered which check object ID " + ConvertToString(e.first));
     visitedBitset[nodeID]=true;
   }
+
+  // Unless the repair is pending, live nodes aren't linked to deleted ones
+  bool checkLinks = pendingRepair_.empty() && !repairInProgress_;
+  for (const auto& e : objIdToNodeId_) {
+    const atomic<IdType>* links = graph.getNodeLinks(e.second);
+    IdType                qty = graph.getNodeDegree(e.second);
+    for (IdType i = 0; i < qty; ++i) {
+      IdType neighbId = links[i].load(memory_order_relaxed);
+      CHECK_MSG(neighbId >= 0 && neighbId < graph.nodeQty,
+                "Bug: invalid neighbor ID " + ConvertToString(neighbId) + " of node ID " + ConvertToString(e.second));
+      CHECK_MSG(!checkLinks || graph.getNodeData(neighbId) != nullptr,
+                "Bug: a deleted node is still linked to node ID " + ConvertToString(e.second));
+    }
+  }
 }
 
 template <typename dist_t>
@@ -339,23 +585,141 @@ void SmallWorldRand<dist_t>::CreateIndex(const AnyParams& IndexParams)
   AnyParamManager pmgr(IndexParams);
 
   pmgr.GetParamOptional("NN",                 NN_,                  10);
+  size_t maxNN;
+  pmgr.GetParamOptional("maxNN",              maxNN,                SW_GRAPH_MAX_NN_MULT * NN_);
   pmgr.GetParamOptional("efConstruction",     efConstruction_,      NN_);
   efSearch_ = NN_;
   pmgr.GetParamOptional("indexThreadQty",     indexThreadQty_,      thread::hardware_concurrency());
   pmgr.GetParamOptional("useProxyDist",       use_proxy_dist_,      false);
+  pmgr.GetParamOptional("backgroundRepair",   backgroundRepair_,    false);
+  pmgr.GetParamOptional("repairBudget",       repairBudget_,        SW_GRAPH_REPAIR_BUDGET);
+  string knnGraphFile;
+  pmgr.GetParamOptional("knnGraphFile",       knnGraphFile,         "");
 
   LOG(LIB_INFO) << "NN                  = " << NN_;
+  LOG(LIB_INFO) << "maxNN               = " << maxNN;
   LOG(LIB_INFO) << "efConstruction_     = " << efConstruction_;
   LOG(LIB_INFO) << "indexThreadQty      = " << indexThreadQty_;
   LOG(LIB_INFO) << "useProxyDist        = " << use_proxy_dist_;
+  LOG(LIB_INFO) << "backgroundRepair    = " << backgroundRepair_;
+  LOG(LIB_INFO) << "repairBudget        = " << repairBudget_;
+  LOG(LIB_INFO) << "knnGraphFile        = " << knnGraphFile;
 
   pmgr.CheckUnused();
 
+  CHECK_MSG(maxNN >= NN_, "maxNN should be >= NN");
+  CHECK_MSG(repairBudget_ > 0, "repairBudget should be > 0");
+  stopRepairThread();
+  initGraphMemory(maxNN);
+
   SetQueryTimeParams(getEmptyParams());
 
-  AddBatch(this->data_, PrintProgress_);
+  BuildProfiler& profiler = this->buildProfiler_;
+  profiler.Reset();
+  subPhaseSearchId_ = profiler.RegisterSubPhase("candidate search");
+  subPhaseLinkId_   = profiler.RegisterSubPhase("linking");
+  if (knnGraphFile.empty()) {
+    profiler.StartPhase("insertion");
+    profiler.StartProgress(this->data_.size());
+
+    AddBatch(this->data_, PrintProgress_);
+  } else {
+    profiler.StartPhase("k-NN graph conversion");
+    profiler.StartProgress(this->data_.size());
+
+    CreateFromKNNGraph(knnGraphFile);
+  }
 
-  changedAfterCreateIndex_ = false;
+  profiler.EndPhase();
+
+  if (backgroundRepair_) repairThread_ = thread(&SmallWorldRand<dist_t>::repairThreadMain, this);
+}
+
+template <typename dist_t>
+void SmallWorldRand<dist_t>::selectNeighborsByHeuristic(vector<EvaluatedMSWNodeDirect<dist_t>>& candidates,
+                                                        size_t maxQty,
+                                                        vector<EvaluatedMSWNodeDirect<dist_t>>& neighbors) const {
+  sort(candidates.begin(), candidates.end());
+  neighbors.clear();
+  if (candidates.size() <= maxQty) {
+    neighbors = candidates;
+    return;
+  }
+  vector<EvaluatedMSWNodeDirect<dist_t>> skipped;
+  for (const auto& c : candidates) {
+    if (neighbors.size() >= maxQty) break;
+    const Object* pObj = graph_->getNodeData(c.getNodeId());
+    bool          good = true;
+    for (const auto& neighb : neighbors) {
+      if (nodeDist(neighb.getNodeId(), pObj) < c.getDistance()) {
+        good = false;
+        break;
+      }
+    }
+    if (good) neighbors.push_back(c);
+    else skipped.push_back(c);
+  }
+  for (size_t i = 0; i < skipped.size() && neighbors.size() < maxQty; ++i) neighbors.push_back(skipped[i]);
+}
+
+template <typename dist_t>
+void SmallWorldRand<dist_t>::CreateFromKNNGraph(const string& location) {
+  vector<vector<KNNGraphEntry>> knnGraph;
+  ReadKNNGraph(location, this->data_, true, knnGraph);
+
+  unique_lock<mutex> updateLock(updateMutex_);
+  const IdType nodeQty = this->data_.size();
+  resizeGraph(nodeQty);
+  SWGraph& graph = *graph_;
+  for (IdType nodeId = 0; nodeId < nodeQty; ++nodeId) {
+    graph.setNodeData(nodeId, this->data_[nodeId]);
+    objIdToNodeId_.emplace(this->data_[nodeId]->id(), nodeId);
+  }
+  if (nodeQty == 0) return;
+  size_t threadQty = max<size_t>(indexThreadQty_, 1);
+
+  /*
+   * 1) Each node keeps at most NN of its k-NN graph neighbors selected by the HNSW heuristic.
+   *    Distances are recomputed, because the graph could have been built using a different space.
+   */
+  vector<vector<EvaluatedMSWNodeDirect<dist_t>>> selected(nodeQty);
+  ParallelFor(0, nodeQty, threadQty, [&](IdType nodeId) {
+    const Object*                            pObj = graph.getNodeData(nodeId);
+    vector<EvaluatedMSWNodeDirect<dist_t>>   candidates;
+    for (const KNNGraphEntry& e : knnGraph[nodeId]) {
+      if (e.key != nodeId) candidates.emplace_back(nodeDist(e.key, pObj), e.key);
+    }
+    vector<KNNGraphEntry>().swap(knnGraph[nodeId]);
+    selectNeighborsByHeuristic(candidates, NN_, selected[nodeId]);
+  });
+
+  // 2) Reverse edges: if j is selected by i, then i is a candidate neighbor of j
+  vector<vector<IdType>> reverse(nodeQty);
+  for (IdType nodeId = 0; nodeId < nodeQty; ++nodeId) {
+    for (const auto& c : selected[nodeId]) reverse[c.getNodeId()].push_back(nodeId);
+  }
+
+  // 3) Direct and reverse neighbors are merged, lists longer than maxNN are pruned again
+  ParallelFor(0, nodeQty, threadQty, [&](IdType nodeId) {
+    const Object*                            pObj = graph.getNodeData(nodeId);
+    vector<EvaluatedMSWNodeDirect<dist_t>>&  candidates = selected[nodeId];
+    vector<EvaluatedMSWNodeDirect<dist_t>>   neighbors;
+    for (IdType neighbId : reverse[nodeId]) {
+      bool found = false;
+      for (const auto& c : candidates) found = found || c.getNodeId() == neighbId;
+      if (!found) candidates.emplace_back(nodeDist(neighbId, pObj), neighbId);
+    }
+    selectNeighborsByHeuristic(candidates, graph.maxNN, neighbors);
+    atomic<IdType>* links = graph.getNodeLinks(nodeId);
+    for (size_t i = 0; i < neighbors.size(); ++i) links[i].store(neighbors[i].getNodeId(), memory_order_relaxed);
+    graph.setNodeDegree(nodeId, neighbors.size());
+    vector<EvaluatedMSWNodeDirect<dist_t>>().swap(candidates);
+    this->buildProfiler_.AddProgress();
+  });
+  graph.entryPointId = 0;
+
+  LOG(LIB_INFO) << "Converted the k-NN graph from " << location << " into the SW-graph with "
+                << nodeQty << " nodes";
 }
 
 template <typename dist_t>
@@ -385,10 +749,7 @@ const std::string SmallWorldRand<dist_t>::StrDesc() const {
 
 template <typename dist_t>
 SmallWorldRand<dist_t>::~SmallWorldRand() {
-  for (auto e : ElList_) {
-    MSWNode* pNode = e.second;
-    delete pNode;
-  }
+  stopRepairThread();
 }
 
 template <typename dist_t>
@@ -408,19 +769,19 @@ SmallWorldRand<dist_t>::searchForIndexing(const Object *queryObj,
  */
   vector<bool>                        visitedBitset(nextNodeIdUpperBound); // seems to be working efficiently even in a multi-threaded mode.
 
-  vector<MSWNode*> neighborCopy;
+  const SWGraph& graph = *graph_;
+  vector<IdType> neighborCopy(graph.maxNN);
 
   /**
    * Search for the k most closest elements to the query.
    */
-  MSWNode* provider = pEntryPoint_;
-  CHECK_MSG(provider != nullptr, "Bug: there is not entry point set!")
+  IdType provider = graph.entryPointId;
+  CHECK_MSG(provider >= 0, "Bug: there is not entry point set!")
 
   priority_queue <dist_t>                     closestDistQueue;                      
   priority_queue <EvaluatedMSWNodeReverse<dist_t>>   candidateSet; 
 
-  dist_t d = use_proxy_dist_ ?  space_.ProxyDistance(provider->getData(), queryObj) : 
-                                space_.IndexTimeDistance(provider->getData(), queryObj);
+  dist_t d = nodeDist(provider, queryObj);
   EvaluatedMSWNodeReverse<dist_t> ev(d, provider);
 
   candidateSet.push(ev);
@@ -430,11 +791,10 @@ SmallWorldRand<dist_t>::searchForIndexing(const Object *queryObj,
     closestDistQueue.pop();
   }
 
-  IdType nodeId = provider->getId();
-  CHECK_MSG(nodeId < nextNodeIdUpperBound, 
-            "Bug: nodeId (" + ConvertToString(nodeId) + ") > nextNodeIdUpperBound (" + ConvertToString(nextNodeIdUpperBound));
+  CHECK_MSG(provider < nextNodeIdUpperBound, 
+            "Bug: nodeId (" + ConvertToString(provider) + ") > nextNodeIdUpperBound (" + ConvertToString(nextNodeIdUpperBound));
   
-  visitedBitset[nodeId] = true;
+  visitedBitset[provider] = true;
   resultSet.emplace(d, provider);
       
   if (resultSet.size() > NN_) { // TODO check somewhere that NN > 0
@@ -451,49 +811,36 @@ SmallWorldRand<dist_t>::searchForIndexing(const Object *queryObj,
     if (currEv.getDistance() > lowerBound) {
       break;
     }
-    MSWNode* currNode = currEv.getMSWNode();
-
-    /*
-     * This lock protects currNode from being modified
-     * while we are accessing elements of currNode.
-     */
-    size_t neighborQty = 0;
-    {
-      unique_lock<mutex> lock(currNode->accessGuard_);
+    IdType currNodeId = currEv.getNodeId();
 
-      //const vector<MSWNode*>& neighbor = currNode->getAllFriends();
-      const vector<MSWNode*>& neighbor = currNode->getAllFriends();
-      neighborQty = neighbor.size();
-      if (neighborQty > neighborCopy.size()) neighborCopy.resize(neighborQty);
-      for (size_t k = 0; k < neighborQty; ++k)
-        neighborCopy[k]=neighbor[k];
-    }
+    // Neighbor lists don't move, so they are copied without locking
+    size_t neighborQty = copyNeighbors(graph, currNodeId, neighborCopy);
 
     // Can't access curEv anymore! The reference would become invalid
     candidateSet.pop();
 
     // calculate distance to each neighbor
-    for (size_t neighborId = 0; neighborId < neighborQty; ++neighborId) {
-      MSWNode* pNeighbor = neighborCopy[neighborId];
+    for (size_t k = 0; k < neighborQty; ++k) {
+      IdType nodeId = neighborCopy[k];
 
-      IdType nodeId = pNeighbor->getId();
       CHECK_MSG(nodeId < nextNodeIdUpperBound, 
                 "Bug: nodeId (" + ConvertToString(nodeId) + ") > nextNodeIdUpperBound (" + ConvertToString(nextNodeIdUpperBound));
       if (!visitedBitset[nodeId]) {
         visitedBitset[nodeId] = true;
-        d = use_proxy_dist_ ? space_.ProxyDistance(pNeighbor->getData(), queryObj) : 
-                              space_.IndexTimeDistance(pNeighbor->getData(), queryObj);
+        // Deleted nodes are skipped
+        if (graph.getNodeData(nodeId) == nullptr) continue;
+        d = nodeDist(nodeId, queryObj);
 
         if (closestDistQueue.size() < efConstruction_ || d < closestDistQueue.top()) {
           closestDistQueue.push(d);
           if (closestDistQueue.size() > efConstruction_) {
             closestDistQueue.pop();
           }
-          candidateSet.emplace(d, pNeighbor);
+          candidateSet.emplace(d, nodeId);
         }
 
         if (resultSet.size() < NN_ || resultSet.top().getDistance() > d) {
-          resultSet.emplace(d, pNeighbor);
+          resultSet.emplace(d, nodeId);
           if (resultSet.size() > NN_) { // TODO check somewhere that NN > 0
             resultSet.pop();
           }
@@ -503,66 +850,136 @@ SmallWorldRand<dist_t>::searchForIndexing(const Object *queryObj,
   }
 }
 
-
 template <typename dist_t>
-void SmallWorldRand<dist_t>::add(MSWNode *newElement, IdType nextNodeIdUpperBound){
-  newElement->removeAllFriends(); 
-
-  bool isEmpty = false;
-
-  {
-    unique_lock<mutex> lock(ElListGuard_);
-    isEmpty = ElList_.empty();
+void SmallWorldRand<dist_t>::addLink(IdType nodeId, IdType neighbId) {
+  SWGraph&           graph = *graph_;
+  unique_lock<mutex> lock(getLinkLock(nodeId));
+
+  atomic<IdType>* links = graph.getNodeLinks(nodeId);
+  IdType          qty = graph.getNodeDegree(nodeId);
+  for (IdType i = 0; i < qty; ++i) {
+    if (links[i].load(memory_order_relaxed) == neighbId) return;
+  }
+  if (static_cast<size_t>(qty) < graph.maxNN) {
+    // The link is written before the degree is increased, so searches never read an unwritten slot
+    links[qty].store(neighbId, memory_order_release);
+    graph.setNodeDegree(nodeId, qty + 1);
+    return;
   }
+  // The block is full: the link is kept until growBlocks() makes room for it
+  unique_lock<mutex> overflowLock(overflowMutex_);
+  overflowLinks_.emplace_back(nodeId, neighbId);
+  growRequested_ = true;
+}
 
-  if(isEmpty){
-  // Before add() is called, the first node should be created!
-    LOG(LIB_INFO) << "Bug: the list of nodes shouldn't be empty!";
-    throw runtime_error("Bug: the list of nodes shouldn't be empty!");
+template <typename dist_t>
+void SmallWorldRand<dist_t>::growBlocks() {
+  if (overflowLinks_.empty()) return;
+  const SWGraph& graph = *graph_;
+  /*
+   * Like the capacity, the block size grows geometrically. The same link
+   * can be kept twice, so the new size is computed before duplicates are removed.
+   */
+  unordered_map<IdType, size_t> overflowQty;
+  size_t                        maxNN = max<size_t>(graph.maxNN + 1, graph.maxNN * SW_GRAPH_GROWTH_FACTOR);
+  for (const auto& e : overflowLinks_) {
+    maxNN = max<size_t>(maxNN, graph.getNodeDegree(e.first) + ++overflowQty[e.first]);
   }
+  CHECK_MSG(maxNN <= static_cast<size_t>(numeric_limits<IdType>::max()),
+            "The number of neighbors exceeds the maximum internal node id");
+
+  // The graph is copied, so searches using the old copy aren't affected
+  shared_ptr<SWGraph> newGraph = make_shared<SWGraph>(graph, maxNN, graph.capacity);
+  for (const auto& e : overflowLinks_) {
+    atomic<IdType>* links = newGraph->getNodeLinks(e.first);
+    IdType          qty = newGraph->getNodeDegree(e.first);
+    bool            found = false;
+    for (IdType i = 0; i < qty && !found; ++i) found = links[i].load(memory_order_relaxed) == e.second;
+    if (found) continue;
+    links[qty].store(e.second, memory_order_relaxed);
+    newGraph->setNodeDegree(e.first, qty + 1);
+  }
+  LOG(LIB_INFO) << "Neighbor lists are grown from " << graph.maxNN << " to " << maxNN << " links";
+  overflowLinks_.clear();
+  growRequested_ = false;
+  atomic_store(&graph_, newGraph);
+}
+
+template <typename dist_t>
+void SmallWorldRand<dist_t>::add(IdType nodeId, IdType nextNodeIdUpperBound){
+  CHECK_MSG(graph_->entryPointId >= 0, "Bug: the entry point should be set before add() is called!");
 
   {
     priority_queue<EvaluatedMSWNodeDirect<dist_t>> resultSet;
 
-    searchForIndexing(newElement->getData(), resultSet, nextNodeIdUpperBound);
+    {
+      BuildSubPhaseTimer timer(this->buildProfiler_, subPhaseSearchId_);
+      searchForIndexing(graph_->getNodeData(nodeId), resultSet, nextNodeIdUpperBound);
+    }
 
+    BuildSubPhaseTimer timer(this->buildProfiler_, subPhaseLinkId_);
     // TODO actually we might need to add elements in the reverse order in the future.
     // For the current implementation, however, the order doesn't seem to matter
     while (!resultSet.empty()) {
-      MSWNode::link(resultSet.top().getMSWNode(), newElement);
+      IdType neighbId = resultSet.top().getNodeId();
+      if (neighbId != nodeId) link(neighbId, nodeId);
       resultSet.pop();
     }
   }
 
-  addCriticalSection(newElement);
+  this->buildProfiler_.AddProgress();
 }
 
 template <typename dist_t>
-void SmallWorldRand<dist_t>::addCriticalSection(MSWNode *newElement){
-  unique_lock<mutex> lock(ElListGuard_);
+void SmallWorldRand<dist_t>::Search(RangeQuery<dist_t>* query, IdType) const {
+  throw runtime_error("Range search is not supported!");
+}
 
-  if (nullptr == pEntryPoint_) {
-    // When adding the very first element, assign the value of the entry point!
-    pEntryPoint_ = newElement;
-    CHECK(ElList_.empty()); 
-  }
-  ElList_.insert(make_pair(newElement->getData()->id(), newElement));
+template <typename dist_t>
+void SmallWorldRand<dist_t>::Search(KNNQuery<dist_t>* query, IdType) const {
+  // The reference keeps the graph alive even if it is replaced during the search
+  shared_ptr<const SWGraph> graph = atomic_load(&graph_);
+  if (!graph) return;
+  if (searchAlgoType_ == kV1Merge) SearchV1Merge(query, *graph);
+  else SearchOld(query, *graph);
 }
 
 template <typename dist_t>
-void SmallWorldRand<dist_t>::Search(RangeQuery<dist_t>* query, IdType) const {
-  throw runtime_error("Range search is not supported!");
+IdType SmallWorldRand<dist_t>::getLiveEntryPoint(const SWGraph& graph) const {
+  IdType entryPointId = graph.entryPointId;
+  if (entryPointId < 0 || graph.getNodeData(entryPointId) != nullptr) return entryPointId;
+  /*
+   * The entry point may be deleted after a search has obtained it, but before
+   * DeleteBatch chooses a new one. Neighbor lists of deleted nodes are kept,
+   * so the search starts from the first live neighbor.
+   */
+  const atomic<IdType>* links = graph.getNodeLinks(entryPointId);
+  IdType                qty = graph.getNodeDegree(entryPointId);
+  for (IdType i = 0; i < qty; ++i) {
+    IdType neighbId = links[i].load(memory_order_relaxed);
+    if (graph.getNodeData(neighbId) != nullptr) return neighbId;
+  }
+  return -1;
 }
 
 template <typename dist_t>
-void SmallWorldRand<dist_t>::Search(KNNQuery<dist_t>* query, IdType) const {
-  if (searchAlgoType_ == kV1Merge) SearchV1Merge(query);
-  else SearchOld(query);
+IdType SmallWorldRand<dist_t>::copyNeighbors(const SWGraph& graph, IdType nodeId, vector<IdType>& neighbors) const {
+  /*
+   * Insertions and the repair may modify the list while we are copying it.
+   * Each slot below the degree always holds a valid node id, hence, the copy
+   * can only miss a link being moved or replaced, or contain it twice.
+   */
+  const atomic<IdType>* links = graph.getNodeLinks(nodeId);
+  IdType                qty = graph.getNodeDegree(nodeId);
+  // Acquire loads make sure that the data of a newly linked node is visible
+  for (IdType k = 0; k < qty; ++k) neighbors[k] = links[k].load(memory_order_acquire);
+  return qty;
 }
 
 template <typename dist_t>
-void SmallWorldRand<dist_t>::SearchV1Merge(KNNQuery<dist_t>* query) const {
-  if (ElList_.empty()) return;
+void SmallWorldRand<dist_t>::SearchV1Merge(KNNQuery<dist_t>* query, const SWGraph& graph) const {
+  IdType currNodeId = getLiveEntryPoint(graph);
+  if (currNodeId < 0) return;
   CHECK_MSG(efSearch_ > 0, "efSearch should be > 0");
 /*
  * The trick of using large dense bitsets instead of unordered_set was
@@ -573,31 +990,30 @@ void SmallWorldRand<dist_t>::SearchV1Merge(KNNQuery<dist_t>* query) const {
  * the bitmap is merely 1 MB. Furthermore, setting 1MB of entries to zero via memset would take only
  * a fraction of millisecond.
  */
-  vector<bool>                        visitedBitset(NextNodeId_);
+  vector<bool>                        visitedBitset(graph.capacity);
 
   /**
    * Search of most k-closest elements to the query.
    */
-  MSWNode* currNode = pEntryPoint_;
-  CHECK_MSG(currNode != nullptr, "Bug: there is not entry point set!")
 
-  SortArrBI<dist_t,MSWNode*> sortedArr(max<size_t>(efSearch_, query->GetK()));
+  SortArrBI<dist_t,IdType> sortedArr(max<size_t>(efSearch_, query->GetK()));
 
-  const Object* currObj = currNode->getData();
+  const Object* currObj = graph.getNodeData(currNodeId);
   dist_t d = query->DistanceObjLeft(currObj);
-  sortedArr.push_unsorted_grow(d, currNode); // It won't grow
+  sortedArr.push_unsorted_grow(d, currNodeId); // It won't grow
 
-  IdType nodeId = currNode->getId();
-  CHECK_MSG(nodeId < NextNodeId_, "Bug: nodeId (" + ConvertToString(nodeId) +  ") > NextNodeId_ (" +ConvertToString(NextNodeId_) +")");
+  CHECK_MSG(currNodeId < graph.capacity, "Bug: nodeId (" + ConvertToString(currNodeId) +  ") > capacity (" +ConvertToString(graph.capacity) +")");
 
-  visitedBitset[nodeId] = true;
+  visitedBitset[currNodeId] = true;
+  SEARCH_STAT(query->GetSearchStat().VisitedQty_++);
 
   uint_fast32_t  currElem = 0;
 
-  typedef typename SortArrBI<dist_t,MSWNode*>::Item  QueueItem;
+  typedef typename SortArrBI<dist_t,IdType>::Item  QueueItem;
 
   vector<QueueItem>& queueData = sortedArr.get_data();
-  vector<QueueItem>  itemBuff(8*NN_);
+  vector<QueueItem>  itemBuff(graph.maxNN);
+  vector<IdType>     neighborCopy(graph.maxNN);
 
   // efSearch_ is always <= # of elements in the queueData.size() (the size of the BUFFER), but it can be
   // larger than sortedArr.size(), which returns the number of actual elements in the buffer
@@ -605,33 +1021,38 @@ void SmallWorldRand<dist_t>::SearchV1Merge(KNNQuery<dist_t>* query) const {
     auto& e = queueData[currElem];
     CHECK(!e.used);
     e.used = true;
-    currNode = e.data;
+    currNodeId = e.data;
     ++currElem;
+    SEARCH_STAT(query->GetSearchStat().AddHop(0));
+
+    IdType        neighborQty = copyNeighbors(graph, currNodeId, neighborCopy);
+    const IdType* links = &neighborCopy[0];
 
-    for (MSWNode* neighbor : currNode->getAllFriends()) {
-      _mm_prefetch(reinterpret_cast<const char*>(const_cast<const Object*>(neighbor->getData())), _MM_HINT_T0);
+    for (IdType k = 0; k < neighborQty; ++k) {
+      _mm_prefetch(graph.getNodeBlock(links[k]), _MM_HINT_T0);
     }
-    for (MSWNode* neighbor : currNode->getAllFriends()) {
-      _mm_prefetch(const_cast<const char*>(neighbor->getData()->data()), _MM_HINT_T0);
+    for (IdType k = 0; k < neighborQty; ++k) {
+      const Object* pObj = graph.getNodeData(links[k]);
+      if (pObj != nullptr) _mm_prefetch(pObj->data(), _MM_HINT_T0);
     }
 
-    if (currNode->getAllFriends().size() > itemBuff.size())
-      itemBuff.resize(currNode->getAllFriends().size());
-
     size_t itemQty = 0;
 
     dist_t topKey = sortedArr.top_key();
     //calculate distance to each neighbor
-    for (MSWNode* neighbor : currNode->getAllFriends()) {
-      nodeId = neighbor->getId();
-      CHECK_MSG(nodeId < NextNodeId_, "Bug: nodeId (" + ConvertToString(nodeId) +  ") > NextNodeId_ (" +ConvertToString(NextNodeId_));
+    for (IdType k = 0; k < neighborQty; ++k) {
+      IdType nodeId = links[k];
+      CHECK_MSG(nodeId < graph.capacity, "Bug: nodeId (" + ConvertToString(nodeId) +  ") > capacity (" +ConvertToString(graph.capacity));
 
       if (!visitedBitset[nodeId]) {
-        currObj = neighbor->getData();
-        d = query->DistanceObjLeft(currObj);
         visitedBitset[nodeId] = true;
+        currObj = graph.getNodeData(nodeId);
+        // Deleted nodes are skipped
+        if (currObj == nullptr) continue;
+        d = query->DistanceObjLeft(currObj);
+        SEARCH_STAT(query->GetSearchStat().VisitedQty_++);
         if (sortedArr.size() < efSearch_ || d < topKey) {
-          itemBuff[itemQty++]=QueueItem(d, neighbor);
+          itemBuff[itemQty++]=QueueItem(d, nodeId);
         }
       }
     }
@@ -639,6 +1060,7 @@ void SmallWorldRand<dist_t>::SearchV1Merge(KNNQuery<dist_t>* query) const {
     if (itemQty) {
       _mm_prefetch(const_cast<const char*>(reinterpret_cast<char*>(&itemBuff[0])), _MM_HINT_T0);
       std::sort(itemBuff.begin(), itemBuff.begin() + itemQty);
+      SEARCH_STAT(query->GetSearchStat().HeapOpQty_ += itemQty);
 
       size_t insIndex=0;
       if (itemQty > MERGE_BUFFER_ALGO_SWITCH_THRESHOLD) {
@@ -664,15 +1086,18 @@ void SmallWorldRand<dist_t>::SearchV1Merge(KNNQuery<dist_t>* query) const {
   }
 
   for (uint_fast32_t i = 0; i < query->GetK() && i < sortedArr.size(); ++i) {
-    query->CheckAndAddToResult(queueData[i].key, queueData[i].data->getData());
+    // A node deleted during the search is filtered out
+    const Object* pObj = graph.getNodeData(queueData[i].data);
+    if (pObj != nullptr) query->CheckAndAddToResult(queueData[i].key, pObj);
   }
 }
 
 
 template <typename dist_t>
-void SmallWorldRand<dist_t>::SearchOld(KNNQuery<dist_t>* query) const {
+void SmallWorldRand<dist_t>::SearchOld(KNNQuery<dist_t>* query, const SWGraph& graph) const {
 
-  if (ElList_.empty()) return;
+  IdType provider = getLiveEntryPoint(graph);
+  if (provider < 0) return;
   CHECK_MSG(efSearch_ > 0, "efSearch should be > 0");
 /*
  * The trick of using large dense bitsets instead of unordered_set was
@@ -683,25 +1108,25 @@ void SmallWorldRand<dist_t>::SearchOld(KNNQuery<dist_t>* query) const {
  * the bitmap is merely 1 MB. Furthermore, setting 1MB of entries to zero via memset would take only
  * a fraction of millisecond.
  */
-  vector<bool>                        visitedBitset(NextNodeId_);
-
-  MSWNode* provider = pEntryPoint_;
-  CHECK_MSG(provider != nullptr, "Bug: there is not entry point set!")
+  vector<bool>                        visitedBitset(graph.capacity);
+  vector<IdType>                      neighborCopy(graph.maxNN);
 
   priority_queue <dist_t>                          closestDistQueue; //The set of all elements which distance was calculated
   priority_queue <EvaluatedMSWNodeReverse<dist_t>> candidateQueue; //the set of elements which we can use to evaluate
 
-  const Object* currObj = provider->getData();
+  const Object* currObj = graph.getNodeData(provider);
   dist_t d = query->DistanceObjLeft(currObj);
   query->CheckAndAddToResult(d, currObj); // This should be done before the object goes to the queue: otherwise it will not be compared to the query at all!
 
   EvaluatedMSWNodeReverse<dist_t> ev(d, provider);
   candidateQueue.push(ev);
+  SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
   closestDistQueue.emplace(d);
+  SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
 
-  IdType nodeId = provider->getId();
-  CHECK_MSG(nodeId < NextNodeId_, "Bug: nodeId (" + ConvertToString(nodeId) +  ") > NextNodeId_ (" +ConvertToString(NextNodeId_) + ")");
-  visitedBitset[nodeId] = true;
+  CHECK_MSG(provider < graph.capacity, "Bug: nodeId (" + ConvertToString(provider) +  ") > capacity (" +ConvertToString(graph.capacity) + ")");
+  visitedBitset[provider] = true;
+  SEARCH_STAT(query->GetSearchStat().VisitedQty_++);
 
   while(!candidateQueue.empty()){
 
@@ -713,34 +1138,45 @@ void SmallWorldRand<dist_t>::SearchOld(KNNQuery<dist_t>* query) const {
       break;
     }
 
-    for (MSWNode* neighbor : (currEv.getMSWNode())->getAllFriends()) {
-      _mm_prefetch(reinterpret_cast<const char*>(const_cast<const Object*>(neighbor->getData())), _MM_HINT_T0);
+    IdType        currNodeId = currEv.getNodeId();
+    IdType        neighborQty = copyNeighbors(graph, currNodeId, neighborCopy);
+    const IdType* links = &neighborCopy[0];
+
+    for (IdType k = 0; k < neighborQty; ++k) {
+      _mm_prefetch(graph.getNodeBlock(links[k]), _MM_HINT_T0);
     }
-    for (MSWNode* neighbor : (currEv.getMSWNode())->getAllFriends()) {
-      _mm_prefetch(const_cast<const char*>(neighbor->getData()->data()), _MM_HINT_T0);
+    for (IdType k = 0; k < neighborQty; ++k) {
+      const Object* pObj = graph.getNodeData(links[k]);
+      if (pObj != nullptr) _mm_prefetch(pObj->data(), _MM_HINT_T0);
     }
 
-    const vector<MSWNode*>& neighbor = (currEv.getMSWNode())->getAllFriends();
-
     // Can't access curEv anymore! The reference would become invalid
     candidateQueue.pop();
+    SEARCH_STAT(query->GetSearchStat().AddHop(0));
+    SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
 
     //calculate distance to each neighbor
-    for (auto iter = neighbor.begin(); iter != neighbor.end(); ++iter){
-      nodeId = (*iter)->getId();
-      CHECK_MSG(nodeId < NextNodeId_, "Bug: nodeId (" + ConvertToString(nodeId) +  ") > NextNodeId_ (" +ConvertToString(NextNodeId_));
+    for (IdType k = 0; k < neighborQty; ++k) {
+      IdType nodeId = links[k];
+      CHECK_MSG(nodeId < graph.capacity, "Bug: nodeId (" + ConvertToString(nodeId) +  ") > capacity (" +ConvertToString(graph.capacity));
       if (!visitedBitset[nodeId]) {
-        currObj = (*iter)->getData();
-        d = query->DistanceObjLeft(currObj);
         visitedBitset[nodeId] = true;
+        currObj = graph.getNodeData(nodeId);
+        // Deleted nodes are skipped
+        if (currObj == nullptr) continue;
+        d = query->DistanceObjLeft(currObj);
+        SEARCH_STAT(query->GetSearchStat().VisitedQty_++);
 
         if (closestDistQueue.size() < efSearch_ || d < closestDistQueue.top()) {
           closestDistQueue.emplace(d);
+          SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
           if (closestDistQueue.size() > efSearch_) {
             closestDistQueue.pop();
+            SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
           }
 
-          candidateQueue.emplace(d, *iter);
+          candidateQueue.emplace(d, nodeId);
+          SEARCH_STAT(query->GetSearchStat().HeapOpQty_++);
         }
 
         query->CheckAndAddToResult(d, currObj);
@@ -751,43 +1187,177 @@ void SmallWorldRand<dist_t>::SearchOld(KNNQuery<dist_t>* query) const {
 
 template <typename dist_t>
 void SmallWorldRand<dist_t>::SaveIndex(const string &location) {
-  CHECK_MSG(!changedAfterCreateIndex_,
-            "It seems that data was added/deleted after calling CreateIndex, in this case saving indices isn't possible");
-  
-  ofstream outFile(location);
-  CHECK_MSG(outFile, "Cannot open file '" + location + "' for writing");
-  outFile.exceptions(std::ios::badbit);
-  size_t lineNum = 0;
-
-  WriteField(outFile, METHOD_DESC, StrDesc()); lineNum++;
-  WriteField(outFile, "NN", NN_); lineNum++;
-
-  for(ElementMap::iterator it = ElList_.begin(); it != ElList_.end(); ++it) {
-    MSWNode* pNode = it->second;
-    IdType nodeID = pNode->getId();
-    CHECK_MSG(nodeID >= 0 && nodeID < (ssize_t)this->data_.size(),
-              "Bug: unexpected node ID " + ConvertToString(nodeID) +
-              " for object ID " + ConvertToString(pNode->getData()->id()) +
-              "data_.size() = " + ConvertToString(this->data_.size()));
-    outFile << nodeID << ":" << pNode->getData()->id() << ":";
-    for (const MSWNode* pNodeFriend: pNode->getAllFriends()) {
-      IdType nodeFriendID = pNodeFriend->getId();
-      CHECK_MSG(nodeFriendID >= 0 && nodeFriendID < (ssize_t)this->data_.size(),
-                "Bug: unexpected node ID " + ConvertToString(nodeFriendID) +
-                " for object ID " + ConvertToString(pNodeFriend->getData()->id()) +
-                "data_.size() = " + ConvertToString(this->data_.size()));
-      outFile << ' ' << nodeFriendID;
-    }
-    outFile << endl; lineNum++;
-  }
-  outFile << endl; lineNum++; // The empty line indicates the end of data entries
-  WriteField(outFile, LINE_QTY, lineNum + 1 /* including this line */);
+  SWGraphFileHeader header;
+  memset(&header, 0, sizeof(header));
+  vector<char>      snapshot;
+
+  {
+    /*
+     * A consistent copy of the graph is taken while updates are blocked.
+     * Searches can proceed, and updates are blocked only during copying,
+     * but not while the file is being written. Ids are compacted in the copy.
+     */
+    unique_lock<mutex> updateLock(updateMutex_);
+    const SWGraph&     graph = *graph_;
+
+    vector<IdType> newNodeIds;
+    IdType         nodeQty = GetCompactNodeIds(newNodeIds);
+
+    snapshot.resize(static_cast<size_t>(nodeQty) * graph.blockSize);
+    for (IdType nodeId = 0; nodeId < graph.nodeQty; ++nodeId) {
+      IdType newNodeId = newNodeIds[nodeId];
+      if (newNodeId < 0) continue;
+      char*  pBlock = &snapshot[static_cast<size_t>(newNodeId) * graph.blockSize];
+      // Instead of the pointer, the block stores the object id
+      IdType objId = graph.getNodeData(nodeId)->id();
+      memcpy(pBlock, &objId, sizeof(objId));
+      const atomic<IdType>* links = graph.getNodeLinks(nodeId);
+      IdType                qty = graph.getNodeDegree(nodeId);
+      IdType*               newLinks = reinterpret_cast<IdType*>(pBlock + sizeof(const Object*) + sizeof(IdType));
+      IdType                newQty = 0;
+      for (IdType i = 0; i < qty; ++i) {
+        // Links to deleted nodes, which aren't repaired yet, are dropped
+        IdType newNeighbId = newNodeIds[links[i].load(memory_order_relaxed)];
+        if (newNeighbId >= 0) newLinks[newQty++] = newNeighbId;
+      }
+      memcpy(pBlock + sizeof(const Object*), &newQty, sizeof(newQty));
+    }
+
+    memcpy(header.magic, SW_GRAPH_FILE_MAGIC, sizeof(header.magic));
+    header.version        = SW_GRAPH_FILE_VERSION;
+    header.idSize         = sizeof(IdType);
+    header.pointerSize    = sizeof(const Object*);
+    header.useProxyDist   = use_proxy_dist_;
+    header.nodeQty        = nodeQty;
+    header.NN             = NN_;
+    header.maxNN          = graph.maxNN;
+    header.efConstruction = efConstruction_;
+    header.blockSize      = graph.blockSize;
+    header.blockOffset    = (sizeof(header) + SW_GRAPH_FILE_ALIGN - 1) / SW_GRAPH_FILE_ALIGN * SW_GRAPH_FILE_ALIGN;
+    IdType entryPointId   = graph.entryPointId;
+    header.entryPointId   = entryPointId >= 0 ? newNodeIds[entryPointId] : -1;
+  }
+
+  string tmpLocation = GetTempFileNameForAtomicWrite(location);
+  ofstream outFile(tmpLocation, std::ios::binary);
+  CHECK_MSG(outFile, "Cannot open file '" + tmpLocation + "' for writing");
+  outFile.exceptions(std::ios::badbit | std::ios::failbit);
+
+  writeBinaryPOD(outFile, header);
+  vector<char> padding(header.blockOffset - sizeof(header));
+  if (!padding.empty()) outFile.write(&padding[0], padding.size());
+  if (!snapshot.empty()) outFile.write(&snapshot[0], snapshot.size());
   outFile.close();
+
+  CommitAtomicWrite(tmpLocation, location);
+  LOG(LIB_INFO) << "Saved " << header.nodeQty << " nodes to " << location;
 }
 
 template <typename dist_t>
 void SmallWorldRand<dist_t>::LoadIndex(const string &location) {
-  vector<MSWNode *> ptrMapper(this->data_.size());
+  MappedFile        file(location);
+  SWGraphFileHeader header;
+
+  if (file.size() < sizeof(header) ||
+      memcmp(file.data(), SW_GRAPH_FILE_MAGIC, sizeof(header.magic)) != 0) {
+    // Indices created by previous versions are text files
+    LoadIndexText(location);
+    return;
+  }
+  memcpy(&header, file.data(), sizeof(header));
+  CHECK_MSG(header.version == SW_GRAPH_FILE_VERSION,
+            "Unsupported version of the SW-graph index file: " + ConvertToString(header.version));
+  CHECK_MSG(header.idSize == sizeof(IdType) && header.pointerSize == sizeof(const Object*),
+            "The index file '" + location + "' was created on an incompatible platform");
+  CHECK_MSG(header.blockOffset >= sizeof(header) &&
+            file.size() >= header.blockOffset + header.nodeQty * header.blockSize,
+            "The index file '" + location + "' is truncated");
+
+  unique_lock<mutex> updateLock(updateMutex_);
+  // The repair refers to ids of the current graph
+  waitForRepair(updateLock);
+
+  CHECK_MSG(header.maxNN > 0 && header.maxNN <= static_cast<uint64_t>(numeric_limits<IdType>::max()) &&
+            header.nodeQty <= static_cast<uint64_t>(numeric_limits<IdType>::max()),
+            "Bug or inconsistent data: invalid graph size in the index file '" + location + "'");
+
+  /*
+   * The graph is filled before it replaces the current one, so searches never see
+   * an empty or partially loaded graph. If loading fails, the current graph is kept.
+   */
+  shared_ptr<SWGraph>           newGraph = make_shared<SWGraph>(header.maxNN, header.nodeQty);
+  unordered_map<IdType, IdType> newObjIdToNodeId;
+  SWGraph&                      graph = *newGraph;
+  CHECK_MSG(graph.blockSize == header.blockSize,
+            "Bug or inconsistent data: unexpected block size " + ConvertToString(header.blockSize));
+
+  file.AdviseSequential();
+  const char* pBlocks = file.data() + header.blockOffset;
+  if (!graph.memory.empty()) memcpy(&graph.memory[0], pBlocks, graph.memory.size());
+
+  /*
+   * Blocks store object ids instead of pointers. Typically, the i-th node
+   * represents the i-th data point, but after updates the data set may
+   * be reordered: then objects are found by ids.
+   */
+  unordered_map<IdType, const Object*> objById;
+  for (IdType nodeId = 0; nodeId < graph.nodeQty; ++nodeId) {
+    IdType objId;
+    memcpy(&objId, graph.getNodeBlock(nodeId), sizeof(objId));
+
+    const Object* pObj = nullptr;
+    if (nodeId < (ssize_t)this->data_.size() && this->data_[nodeId]->id() == objId) {
+      pObj = this->data_[nodeId];
+    } else {
+      if (objById.empty()) {
+        for (const Object* pData : this->data_) objById.emplace(pData->id(), pData);
+      }
+      auto it = objById.find(objId);
+      if (it != objById.end()) pObj = it->second;
+    }
+    CHECK_MSG(pObj != nullptr,
+              DATA_MUTATION_ERROR_MSG + " (the data set has no object with ID " + ConvertToString(objId) + ")");
+    graph.setNodeData(nodeId, pObj);
+    newObjIdToNodeId.emplace(objId, nodeId);
+
+    IdType                qty = graph.getNodeDegree(nodeId);
+    const atomic<IdType>* links = graph.getNodeLinks(nodeId);
+    CHECK_MSG(qty >= 0 && static_cast<size_t>(qty) <= graph.maxNN,
+              "Bug or inconsistent data: invalid number of neighbors for node ID " + ConvertToString(nodeId));
+    for (IdType i = 0; i < qty; ++i) {
+      IdType neighbId = links[i].load(memory_order_relaxed);
+      CHECK_MSG(neighbId >= 0 && neighbId < graph.nodeQty,
+                "Bug or inconsistent data: invalid neighbor ID " + ConvertToString(neighbId) +
+                " for node ID " + ConvertToString(nodeId));
+    }
+  }
+  CHECK_MSG(header.entryPointId < graph.nodeQty && (header.entryPointId >= 0 || graph.nodeQty == 0),
+            "Bug or inconsistent data: invalid entry point ID " + ConvertToString(header.entryPointId));
+  graph.entryPointId = header.entryPointId;
+  NN_             = header.NN;
+  efConstruction_ = header.efConstruction;
+  use_proxy_dist_ = header.useProxyDist != 0;
+  objIdToNodeId_.swap(newObjIdToNodeId);
+  pendingRepair_.clear();
+  atomic_store(&graph_, newGraph);
+
+  LOG(LIB_INFO) << "Next node id: " << graph.nodeQty.load() << " the number of nodes: " << objIdToNodeId_.size();
+}
+
+template <typename dist_t>
+void SmallWorldRand<dist_t>::LoadIndexText(const string &location) {
+  unique_lock<mutex> updateLock(updateMutex_);
+  waitForRepair(updateLock);
+
+  /*
+   * Loads the text format written by previous versions.
+   * The first pass finds the maximum number of neighbors, which determines
+   * the size of node blocks. Links are read in the second pass into a new graph,
+   * which replaces the current one only after it is loaded.
+   */
+  size_t                        maxQty = 0;
+  shared_ptr<SWGraph>           newGraph;
+  unordered_map<IdType, IdType> newObjIdToNodeId;
 
   for (unsigned pass = 0; pass < 2; ++ pass) {
     ifstream inFile(location);
@@ -803,7 +1373,17 @@ void SmallWorldRand<dist_t>::LoadIndex(const string &location) {
     ReadField(inFile, "NN", NN_);
     lineNum++;
 
-    string line;
+    if (pass == 1) {
+      // Text files don't keep the value of efConstruction
+      efConstruction_ = NN_;
+      size_t maxNN = max(maxQty, SW_GRAPH_MAX_NN_MULT * NN_);
+      CHECK_MSG(maxNN > 0 && maxNN <= static_cast<size_t>(numeric_limits<IdType>::max()),
+                "Invalid maximum number of neighbors: " + ConvertToString(maxNN));
+      newGraph = make_shared<SWGraph>(maxNN, this->data_.size());
+    }
+
+    SWGraph* pGraph = newGraph.get();
+    string   line;
     while (getline(inFile, line)) {
       if (line.empty()) {
         lineNum++; break;
@@ -828,29 +1408,24 @@ void SmallWorldRand<dist_t>::LoadIndex(const string &location) {
                 " for data element with ID " + ConvertToString(nodeID) +
                 " expected object ID: " + ConvertToString(objID) + ")"
       );
-      if (pass == 0) {
-        unique_ptr<MSWNode> node(new MSWNode(this->data_[nodeID], nodeID));
-        ptrMapper[nodeID] = node.get();
-        IdType dataId = node->getData()->id();
-        ElList_.insert(make_pair(dataId, node.release()));
-      } else {
-        MSWNode *pNode = ptrMapper[nodeID];
-        CHECK_MSG(pNode != NULL,
-                  "Bug, got NULL pointer in the second pass for nodeID " + ConvertToString(nodeID));
-        IdType nodeFriendID;
-        while (str >> nodeFriendID) {
-          CHECK_MSG(nodeFriendID >= 0 && nodeFriendID < (ssize_t)this->data_.size(),
-                    "Bug: unexpected node ID " + ConvertToString(nodeFriendID) +
-                    "data_.size() = " + ConvertToString(this->data_.size()));
-          MSWNode *pFriendNode = ptrMapper[nodeFriendID];
-          CHECK_MSG(pFriendNode != NULL,
-                    "Bug, got NULL pointer in the second pass for nodeID " + ConvertToString(nodeFriendID));
-          pNode->addFriend(pFriendNode, false /* don't check for duplicates */);
-        }
-        CHECK_MSG(str.eof(),
-                  "It looks like there is some extract erroneous stuff in the end of the line " +
-                  ConvertToString(lineNum));
+      size_t  qty = 0;
+      IdType  nodeFriendID;
+      if (pass == 1) {
+        pGraph->setNodeData(nodeID, this->data_[nodeID]);
+        newObjIdToNodeId.emplace(objID, nodeID);
       }
+      while (str >> nodeFriendID) {
+        CHECK_MSG(nodeFriendID >= 0 && nodeFriendID < (ssize_t)this->data_.size(),
+                  "Bug: unexpected node ID " + ConvertToString(nodeFriendID) +
+                  "data_.size() = " + ConvertToString(this->data_.size()));
+        if (pass == 1) pGraph->getNodeLinks(nodeID)[qty].store(nodeFriendID, memory_order_relaxed);
+        ++qty;
+      }
+      CHECK_MSG(str.eof(),
+                "It looks like there is some extract erroneous stuff in the end of the line " +
+                ConvertToString(lineNum));
+      if (pass == 1) pGraph->setNodeDegree(nodeID, qty);
+      maxQty = max(maxQty, qty);
       ++lineNum;
     }
 
@@ -862,11 +1437,20 @@ void SmallWorldRand<dist_t>::LoadIndex(const string &location) {
     inFile.close();
   }
 
-  pEntryPoint_ = ElList_.empty() ? nullptr : ElList_.begin()->second; 
-  CHECK(pEntryPoint_ != nullptr || ElList_.empty());
-  NextNodeId_ = ElList_.size();
+  SWGraph& graph = *newGraph;
+  for (IdType nodeID = 0; nodeID < graph.nodeQty; ++nodeID) {
+    if (graph.getNodeData(nodeID) != nullptr) {
+      graph.entryPointId = nodeID;
+      break;
+    }
+  }
+  CHECK(graph.entryPointId >= 0 || newObjIdToNodeId.empty());
+  objIdToNodeId_.swap(newObjIdToNodeId);
+  pendingRepair_.clear();
+  atomic_store(&graph_, newGraph);
+  CompactIdsIfNeeded();
 
-  LOG(LIB_INFO) << "Next node id: " << NextNodeId_ << " ElList_.size(): " << ElList_.size(); 
+  LOG(LIB_INFO) << "Next node id: " << graph_->nodeQty.load() << " the number of nodes: " << objIdToNodeId_.size(); 
 }
 
 template class SmallWorldRand<float>;
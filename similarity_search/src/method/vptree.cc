@@ -109,12 +109,16 @@ const std::string VPTree<dist_t, SearchOracle>::StrDesc() const {
 template <typename dist_t, typename SearchOracle>
 void VPTree<dist_t, SearchOracle>::Search(RangeQuery<dist_t>* query, IdType) const {
   int mx = MaxLeavesToVisit_;
+  // FAKE_MAX_LEAVES_TO_VISIT means there's no limit
+  SEARCH_STAT(query->GetSearchStat().LeafLimit_ += MaxLeavesToVisit_ == FAKE_MAX_LEAVES_TO_VISIT ? 0 : MaxLeavesToVisit_);
   root_->GenericSearch(query, mx);
 }
 
 template <typename dist_t, typename SearchOracle>
 void VPTree<dist_t, SearchOracle>::Search(KNNQuery<dist_t>* query, IdType) const {
   int mx = MaxLeavesToVisit_;
+  // FAKE_MAX_LEAVES_TO_VISIT means there's no limit
+  SEARCH_STAT(query->GetSearchStat().LeafLimit_ += MaxLeavesToVisit_ == FAKE_MAX_LEAVES_TO_VISIT ? 0 : MaxLeavesToVisit_);
   root_->GenericSearch(query, mx);
 }
 
@@ -248,6 +252,7 @@ void VPTree<dist_t, SearchOracle>::VPNode::GenericSearch(QueryType* query,
   if (MaxLeavesToVisit <= 0) return; // early termination
   if (bucket_) {
     --MaxLeavesToVisit;
+    SEARCH_STAT(query->GetSearchStat().LeafQty_++);
 
     if (CacheOptimizedBucket_) {
       _mm_prefetch(CacheOptimizedBucket_, _MM_HINT_T0);
@@ -264,6 +269,7 @@ void VPTree<dist_t, SearchOracle>::VPNode::GenericSearch(QueryType* query,
   // Distance can be asymmetric, the pivot is always the left argument (see the function that creates the node)!
   dist_t distQC = query->DistanceObjLeft(pivot_);
   query->CheckAndAddToResult(distQC, pivot_);
+  SEARCH_STAT(query->GetSearchStat().AddHop(0));
 
   if (distQC < mediandist_) {      // the query is inside
     // then first check inside
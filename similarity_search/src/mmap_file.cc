@@ -0,0 +1,105 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fstream>
+#include <stdexcept>
+
+#include "mmap_file.h"
+#include "logging.h"
+
+#ifndef _MSC_VER
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#endif
+
+namespace similarity {
+
+using namespace std;
+
+#ifndef _MSC_VER
+
+MappedFile::MappedFile(const string& fileName) : data_(nullptr), size_(0), mapped_(false) {
+  int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw runtime_error("Cannot open file '" + fileName + "' for reading: " + strerror(errno));
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    int err = errno;
+    close(fd);
+    throw runtime_error("Cannot get the size of the file '" + fileName + "': " + strerror(err));
+  }
+  size_ = static_cast<size_t>(st.st_size);
+  if (size_ > 0) {
+    void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+      int err = errno;
+      close(fd);
+      throw runtime_error("Cannot map the file '" + fileName + "': " + strerror(err));
+    }
+    data_ = static_cast<const char*>(p);
+    mapped_ = true;
+  }
+  // The mapping remains valid after the file is closed
+  close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (mapped_) munmap(const_cast<char*>(data_), size_);
+}
+
+void MappedFile::AdviseSequential() const {
+  if (mapped_) madvise(const_cast<char*>(data_), size_, MADV_SEQUENTIAL);
+}
+
+#else
+
+MappedFile::MappedFile(const string& fileName) : data_(nullptr), size_(0), mapped_(false) {
+  ifstream in(fileName, ios::binary | ios::ate);
+  CHECK_MSG(in, "Cannot open file '" + fileName + "' for reading");
+  size_ = static_cast<size_t>(in.tellg());
+  in.seekg(0);
+  buffer_.resize(size_);
+  CHECK_MSG(size_ == 0 || in.read(&buffer_[0], size_), "Cannot read the file '" + fileName + "'");
+  data_ = buffer_.empty() ? nullptr : &buffer_[0];
+}
+
+MappedFile::~MappedFile() {}
+
+void MappedFile::AdviseSequential() const {}
+
+#endif
+
+string GetTempFileNameForAtomicWrite(const string& fileName) {
+  return fileName + ".tmp";
+}
+
+void CommitAtomicWrite(const string& tmpFileName, const string& fileName) {
+#ifdef _MSC_VER
+  // On Windows, rename() fails if the destination exists
+  remove(fileName.c_str());
+#endif
+  if (rename(tmpFileName.c_str(), fileName.c_str()) != 0) {
+    throw runtime_error("Cannot rename '" + tmpFileName + "' to '" + fileName + "': " + strerror(errno));
+  }
+}
+
+}   // namespace similarity
@@ -0,0 +1,142 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include <algorithm>
+#include <stdexcept>
+
+#include "param_sweep.h"
+#include "params.h"
+#include "utils.h"
+
+namespace similarity {
+
+using std::runtime_error;
+
+void ExpandQueryTimeGrid(const string& gridSpec,
+                         vector<string>& res,
+                         size_t& varyingParamQty) {
+  res.clear();
+  varyingParamQty = 0;
+
+  vector<string>          desc;
+  ParseArg(gridSpec, desc);
+
+  vector<string>          names;
+  vector<vector<string>>  values;
+
+  for (const string& s : desc) {
+    string::size_type p = s.find('=');
+    if (p == string::npos || p == 0 || p + 1 == s.size()) {
+      throw runtime_error("Wrong format of the query-time grid element: '" + s + "'");
+    }
+    vector<string> v;
+    if (!SplitStr(s.substr(p + 1), v, QUERY_TIME_GRID_VALUE_SEP) || v.empty()) {
+      throw runtime_error("Cannot split values in the query-time grid element: '" + s + "'");
+    }
+    if (v.size() > 1) ++varyingParamQty;
+    names.push_back(s.substr(0, p));
+    values.push_back(v);
+  }
+
+  // A mixed-radix counter, where the last digit changes the fastest
+  vector<size_t> pos(names.size());
+
+  while (true) {
+    string curr;
+    for (size_t i = 0; i < names.size(); ++i) {
+      if (i) curr += ",";
+      curr += names[i] + "=" + values[i][pos[i]];
+    }
+    res.push_back(curr);
+
+    size_t k = names.size();
+    while (k > 0) {
+      --k;
+      if (++pos[k] < values[k].size()) break;
+      pos[k] = 0;
+      if (k == 0) return;
+    }
+    if (names.empty()) return;
+  }
+}
+
+void MarkParetoFront(vector<SweepPoint>& points) {
+  for (size_t i = 0; i < points.size(); ++i) {
+    bool dominated = false;
+    for (size_t k = 0; k < points.size() && !dominated; ++k) {
+      if (k == i) continue;
+      dominated = points[k].Recall >= points[i].Recall &&
+                  points[k].QueryPerSec >= points[i].QueryPerSec &&
+                  (points[k].Recall > points[i].Recall ||
+                   points[k].QueryPerSec > points[i].QueryPerSec);
+    }
+    points[i].IsPareto = !dominated;
+  }
+}
+
+int FindCheapestSweepPoint(const vector<SweepPoint>& points, double targetRecall) {
+  int res = -1;
+  for (size_t i = 0; i < points.size(); ++i) {
+    if (points[i].Recall >= targetRecall &&
+        (res < 0 || points[i].QueryPerSec > points[res].QueryPerSec)) {
+      res = static_cast<int>(i);
+    }
+  }
+  return res;
+}
+
+namespace {
+
+vector<SweepPoint> SortByRecall(const vector<SweepPoint>& points) {
+  vector<SweepPoint> res = points;
+  std::stable_sort(res.begin(), res.end(),
+                   [](const SweepPoint& a, const SweepPoint& b) { return a.Recall < b.Recall; });
+  return res;
+}
+
+}
+
+void WriteSweepPointsTSV(std::ostream& out, const string& methodName, const vector<SweepPoint>& points) {
+  out << "MethodName\tRecall\tQueryPerSec\tQueryTime\tQueryTimeP99\tDistComp\tIsPareto\tQueryTimeParams" << std::endl;
+  for (const SweepPoint& p : SortByRecall(points)) {
+    out << "\"" << methodName << "\"\t";
+    out << p.Recall << "\t";
+    out << p.QueryPerSec << "\t";
+    out << p.QueryTime << "\t";
+    out << p.QueryTimeP99 << "\t";
+    out << p.DistComp << "\t";
+    out << (p.IsPareto ? 1 : 0) << "\t";
+    out << "\"" << p.QueryTimeParams << "\"" << std::endl;
+  }
+}
+
+void WriteSweepPointsJSON(std::ostream& out, const string& methodName, const vector<SweepPoint>& points) {
+  vector<SweepPoint> sorted = SortByRecall(points);
+  out << "[" << std::endl;
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    const SweepPoint& p = sorted[i];
+    out << "  {\"method\": \"" << EscapeJSON(methodName) << "\", "
+        << "\"queryTimeParams\": \"" << EscapeJSON(p.QueryTimeParams) << "\", "
+        << "\"recall\": " << p.Recall << ", "
+        << "\"qps\": " << p.QueryPerSec << ", "
+        << "\"queryTime\": " << p.QueryTime << ", "
+        << "\"queryTimeP99\": " << p.QueryTimeP99 << ", "
+        << "\"distComp\": " << p.DistComp << ", "
+        << "\"pareto\": " << (p.IsPareto ? "true" : "false") << "}"
+        << (i + 1 < sorted.size() ? "," : "") << std::endl;
+  }
+  out << "]" << std::endl;
+}
+
+}   // namespace similarity
@@ -24,6 +24,8 @@
 #include "logging.h"
 #include "space.h"
 #include "cmd_options.h"
+#include "open_loop.h"
+#include "param_sweep.h"
 
 #include <cmath>
 
@@ -55,15 +57,22 @@ void ParseCommandLine(int argc, char* argv[], bool& bPrintProgress,
                       string&                 RangeArg,
                       string&                 MethodName,
                       shared_ptr<AnyParams>&          IndexTimeParams,
-                      vector<shared_ptr<AnyParams>>&  QueryTimeParams) {
+                      vector<shared_ptr<AnyParams>>&  QueryTimeParams,
+                      vector<double>&                 ArrivalQPS,
+                      string&                         ArrivalDist,
+                      bool&                           UsePerfCounters,
+                      float&                          TargetRecall) {
   knn.clear();
   RangeArg.clear();
   QueryTimeParams.clear();
+  ArrivalQPS.clear();
 
   string          indexTimeParamStr;
   vector<string>  vQueryTimeParamStr;
   string          spaceParamStr;
   string          knnArg;
+  string          arrivalQPSArg;
+  string          queryTimeGridArg;
   // Conversion to double is due to an Intel's bug with __builtin_signbit being undefined for float
   double          epsTmp;
 
@@ -119,6 +128,16 @@ void ParseCommandLine(int argc, char* argv[], bool& bPrintProgress,
                                &AppendToResFile, false));
   cmd_options.Add(new CmdParam(NO_PROGRESS_PARAM_OPT, NO_PROGRESS_PARAM_MSG,
                                &bSuppressPrintProgress, false));
+  cmd_options.Add(new CmdParam(ARRIVAL_QPS_PARAM_OPT, ARRIVAL_QPS_PARAM_MSG,
+                               &arrivalQPSArg, false));
+  cmd_options.Add(new CmdParam(ARRIVAL_DIST_PARAM_OPT, ARRIVAL_DIST_PARAM_MSG,
+                               &ArrivalDist, false, ARRIVAL_DIST_PARAM_DEFAULT));
+  cmd_options.Add(new CmdParam(PERF_COUNTERS_PARAM_OPT, PERF_COUNTERS_PARAM_MSG,
+                               &UsePerfCounters, false));
+  cmd_options.Add(new CmdParam(QUERY_TIME_GRID_PARAM_OPT, QUERY_TIME_GRID_PARAM_MSG,
+                               &queryTimeGridArg, false));
+  cmd_options.Add(new CmdParam(TARGET_RECALL_PARAM_OPT, TARGET_RECALL_PARAM_MSG,
+                               &TargetRecall, false, TARGET_RECALL_PARAM_DEFAULT));
 
   try {
     cmd_options.Parse(argc, argv);
@@ -143,6 +162,7 @@ void ParseCommandLine(int argc, char* argv[], bool& bPrintProgress,
   ToLower(DistType);
   ToLower(spaceParamStr);
   ToLower(MethodName);
+  ToLower(ArrivalDist);
 
   try {
     {
@@ -157,6 +177,18 @@ void ParseCommandLine(int argc, char* argv[], bool& bPrintProgress,
       IndexTimeParams = shared_ptr<AnyParams>(new AnyParams(desc));
     }
 
+    if (!queryTimeGridArg.empty()) {
+      if (!vQueryTimeParamStr.empty()) {
+        LOG(LIB_FATAL) << "The query-time grid can't be combined with the option " << QUERY_TIME_PARAMS_PARAM_OPT;
+      }
+      size_t varyingParamQty = 0;
+      ExpandQueryTimeGrid(queryTimeGridArg, vQueryTimeParamStr, varyingParamQty);
+      // The binary search assumes that recall grows along the list of parameter sets
+      if (TargetRecall > 0 && varyingParamQty > 1) {
+        LOG(LIB_FATAL) << "The search for a target recall supports grids with only one varying parameter";
+      }
+    }
+
     if (vQueryTimeParamStr.empty())
       vQueryTimeParamStr.push_back("");
 
@@ -171,6 +203,26 @@ void ParseCommandLine(int argc, char* argv[], bool& bPrintProgress,
       LOG(LIB_FATAL) << "Wrong format of the KNN argument: '" << knnArg;
     }
 
+    if (!arrivalQPSArg.empty()) {
+      if (!SplitStr(arrivalQPSArg, ArrivalQPS, ',')) {
+        LOG(LIB_FATAL) << "Wrong format of the arrival QPS argument: '" << arrivalQPSArg << "'";
+      }
+      for (double qps : ArrivalQPS) {
+        if (qps <= 0) LOG(LIB_FATAL) << "Arrival QPS values should be positive!";
+      }
+      // The open-loop sweep goes from the lightest to the heaviest load
+      std::sort(ArrivalQPS.begin(), ArrivalQPS.end());
+    }
+
+    if (ArrivalDist != ARRIVAL_DIST_POISSON && ArrivalDist != ARRIVAL_DIST_FIXED) {
+      LOG(LIB_FATAL) << "Wrong arrival distribution: '" << ArrivalDist
+                     << "', expected " << ARRIVAL_DIST_POISSON << " or " << ARRIVAL_DIST_FIXED;
+    }
+
+    if (TargetRecall < 0 || TargetRecall > 1) {
+      LOG(LIB_FATAL) << "The target recall should be in the range [0,1]";
+    }
+
     if (DataFile.empty()) {
       LOG(LIB_FATAL) << "data file is not specified!";
     }
@@ -0,0 +1,162 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include <sstream>
+
+#include "perf_counters.h"
+
+#ifdef __linux
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <string.h>
+
+#endif
+
+namespace similarity {
+
+const char* GetPerfEventName(unsigned eventId) {
+  switch (eventId) {
+    case kPerfCycles:       return "cycles";
+    case kPerfInstructions: return "instructions";
+    case kPerfLLCMisses:    return "LLC-misses";
+    case kPerfDTLBMisses:   return "dTLB-misses";
+    case kPerfBranchMisses: return "branch-misses";
+  }
+  return "unknown";
+}
+
+string PerfCounterValues::ToString(double qty) const {
+  std::stringstream str;
+
+  if (qty <= 0) qty = 1;
+
+  bool bFirst = true;
+  for (unsigned i = 0; i < kPerfEventQty; ++i) {
+    if (!Valid_[i]) continue;
+    if (!bFirst) str << " ";
+    str << GetPerfEventName(i) << ": " << Counts_[i] / qty;
+    bFirst = false;
+  }
+  if (Valid_[kPerfCycles] && Valid_[kPerfInstructions] && Counts_[kPerfCycles]) {
+    str << " IPC: " << double(Counts_[kPerfInstructions]) / Counts_[kPerfCycles];
+  }
+  if (bFirst) str << "N/A";
+
+  return str.str();
+}
+
+#ifdef __linux
+
+namespace {
+
+int OpenPerfEvent(uint32_t type, uint64_t config) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+
+  attr.size           = sizeof(attr);
+  attr.type           = type;
+  attr.config         = config;
+  attr.disabled       = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv     = 1;
+  // If there are more events than hardware counters, the kernel multiplexes them
+  attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  // pid == 0 && cpu == -1 means the calling thread on any CPU
+  return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+}
+
+PerfCounters::PerfCounters() {
+  const uint64_t dtlbReadMiss = PERF_COUNT_HW_CACHE_DTLB |
+                                (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+  fd_[kPerfCycles]       = OpenPerfEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+  fd_[kPerfInstructions] = OpenPerfEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+  fd_[kPerfLLCMisses]    = OpenPerfEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+  fd_[kPerfDTLBMisses]   = OpenPerfEvent(PERF_TYPE_HW_CACHE, dtlbReadMiss);
+  fd_[kPerfBranchMisses] = OpenPerfEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+}
+
+PerfCounters::~PerfCounters() {
+  for (unsigned i = 0; i < kPerfEventQty; ++i) {
+    if (fd_[i] >= 0) close(fd_[i]);
+  }
+}
+
+bool PerfCounters::IsAvailable() const {
+  for (unsigned i = 0; i < kPerfEventQty; ++i) {
+    if (fd_[i] >= 0) return true;
+  }
+  return false;
+}
+
+void PerfCounters::Start() {
+  for (unsigned i = 0; i < kPerfEventQty; ++i) {
+    if (fd_[i] >= 0) {
+      ioctl(fd_[i], PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd_[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+}
+
+void PerfCounters::Stop() {
+  for (unsigned i = 0; i < kPerfEventQty; ++i) {
+    if (fd_[i] >= 0) ioctl(fd_[i], PERF_EVENT_IOC_DISABLE, 0);
+  }
+}
+
+PerfCounterValues PerfCounters::Read() const {
+  PerfCounterValues res;
+
+  for (unsigned i = 0; i < kPerfEventQty; ++i) {
+    if (fd_[i] < 0) continue;
+    // value, time enabled, time running
+    uint64_t buf[3];
+    if (read(fd_[i], buf, sizeof(buf)) != sizeof(buf)) continue;
+    // A counter that never ran (e.g., b/c all hardware counters are busy) is useless
+    if (!buf[2]) continue;
+    res.Counts_[i] = buf[2] < buf[1] ?
+                      static_cast<uint64_t>(double(buf[0]) * buf[1] / buf[2]) : buf[0];
+    res.Valid_[i]  = true;
+  }
+
+  return res;
+}
+
+#else
+
+PerfCounters::PerfCounters() {
+  for (unsigned i = 0; i < kPerfEventQty; ++i) fd_[i] = -1;
+}
+
+PerfCounters::~PerfCounters() {}
+
+bool PerfCounters::IsAvailable() const { return false; }
+
+void PerfCounters::Start() {}
+
+void PerfCounters::Stop() {}
+
+PerfCounterValues PerfCounters::Read() const { return PerfCounterValues(); }
+
+#endif
+
+}   // namespace similarity
@@ -46,6 +46,7 @@ uint64_t Query<dist_t>::DistanceComputations() const {
 template <typename dist_t>
 void Query<dist_t>::ResetStats() {
   distance_computations_ = 0;
+  search_stat_.Reset();
 }
 
 template <typename dist_t>
@@ -0,0 +1,77 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include "sample_stat.h"
+
+namespace similarity {
+
+void RunningStat::Merge(const RunningStat& other) {
+  if (!other.Qty) return;
+  if (!Qty) {
+    *this = other;
+    return;
+  }
+  uint64_t  qty   = Qty + other.Qty;
+  double    delta = other.Mean - Mean;
+
+  Mean += delta * other.Qty / qty;
+  M2   += other.M2 + delta * delta * (double(Qty) * other.Qty / qty);
+  Qty   = qty;
+  Min   = std::min(Min, other.Min);
+  Max   = std::max(Max, other.Max);
+}
+
+DistHistogram::DistHistogram(double minVal, double maxVal, size_t binQty) :
+                            minVal_(minVal), counts_(binQty),
+                            underflowQty_(0), overflowQty_(0) {
+  CHECK_MSG(binQty > 0, "The number of histogram bins should be positive");
+  CHECK_MSG(maxVal > minVal, "The histogram range should be non-empty");
+  binWidth_ = (maxVal - minVal) / binQty;
+}
+
+void DistHistogram::Merge(const DistHistogram& other) {
+  CHECK_MSG(other.counts_.size() == counts_.size() &&
+            other.minVal_ == minVal_ && other.binWidth_ == binWidth_,
+            "Cannot merge histograms with different bins");
+  for (size_t i = 0; i < counts_.size(); ++i) counts_[i] += other.counts_[i];
+  underflowQty_ += other.underflowQty_;
+  overflowQty_  += other.overflowQty_;
+}
+
+uint64_t DistHistogram::GetTotalQty() const {
+  uint64_t res = underflowQty_ + overflowQty_;
+  for (uint64_t c : counts_) res += c;
+  return res;
+}
+
+void DistHistogram::Write(std::ostream& out) const {
+  const double  inf = std::numeric_limits<double>::infinity();
+  double        totalQty = std::max<double>(1, GetTotalQty());
+  uint64_t      cumQty = 0;
+
+  out << "BinStart\tBinEnd\tQty\tCumFrac" << std::endl;
+
+  cumQty += underflowQty_;
+  out << -inf << "\t" << minVal_ << "\t" << underflowQty_ << "\t" << cumQty / totalQty << std::endl;
+  for (size_t i = 0; i < counts_.size(); ++i) {
+    cumQty += counts_[i];
+    out << minVal_ + i * binWidth_ << "\t" << minVal_ + (i + 1) * binWidth_ << "\t"
+        << counts_[i] << "\t" << cumQty / totalQty << std::endl;
+  }
+  cumQty += overflowQty_;
+  out << minVal_ + counts_.size() * binWidth_ << "\t" << inf << "\t"
+      << overflowQty_ << "\t" << cumQty / totalQty << std::endl;
+}
+
+}   // namespace similarity
@@ -0,0 +1,57 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include <sstream>
+
+#include "search_stat.h"
+
+namespace similarity {
+
+vector<pair<string, uint64_t>> SearchStat::GetNamedValues() const {
+  vector<pair<string, uint64_t>> res;
+
+  for (unsigned i = 0; i < SEARCH_STAT_MAX_LAYER; ++i) {
+    if (HopQty_[i]) {
+      std::stringstream name;
+      name << "hops_l" << i;
+      res.push_back(std::make_pair(name.str(), HopQty_[i]));
+    }
+  }
+  if (VisitedQty_) res.push_back(std::make_pair(string("visited"),    VisitedQty_));
+  if (HeapOpQty_)  res.push_back(std::make_pair(string("heap_ops"),   HeapOpQty_));
+  if (LeafQty_)    res.push_back(std::make_pair(string("leaves"),     LeafQty_));
+  if (LeafLimit_)  res.push_back(std::make_pair(string("leaf_limit"), LeafLimit_));
+  if (CandQty_)    res.push_back(std::make_pair(string("cands"),      CandQty_));
+  if (CandLimit_)  res.push_back(std::make_pair(string("cand_limit"), CandLimit_));
+
+  return res;
+}
+
+string SearchStat::ToString(double qty) const {
+  std::stringstream str;
+
+  if (qty <= 0) qty = 1;
+
+  bool bFirst = true;
+  for (const auto& e : GetNamedValues()) {
+    if (!bFirst) str << " ";
+    str << e.first << ": " << e.second / qty;
+    bFirst = false;
+  }
+  if (bFirst) str << "N/A";
+
+  return str.str();
+}
+
+}   // namespace similarity
@@ -0,0 +1,101 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include <cstring>
+#include <fstream>
+
+#include "string_store.h"
+#include "logging.h"
+#include "utils.h"
+
+#define STRING_STORE_FILE_VERSION 2
+
+namespace similarity {
+
+using namespace std;
+
+const char STRING_STORE_FILE_MAGIC[8] = {'N', 'M', 'S', 'L', 'I', 'B', 'S', 'S'};
+
+void StringStore::Build(size_t qty, const function<string(size_t)>& getStr) {
+  file_.reset();
+  offsetBuf_.assign(1, 0);
+  offsetBuf_.reserve(qty + 1);
+  charBuf_.clear();
+  for (size_t i = 0; i < qty; ++i) {
+    charBuf_.append(getStr(i));
+    offsetBuf_.push_back(charBuf_.size());
+  }
+  charBuf_.shrink_to_fit();
+  qty_         = qty;
+  fingerprint_ = 0;
+  offsets_     = &offsetBuf_[0];
+  chars_       = charBuf_.data();
+}
+
+void StringStore::Save(const string& location) const {
+  StringStoreFileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, STRING_STORE_FILE_MAGIC, sizeof(header.magic));
+  header.version     = STRING_STORE_FILE_VERSION;
+  header.qty         = qty_;
+  header.fingerprint = fingerprint_;
+
+  string tmpLocation = GetTempFileNameForAtomicWrite(location);
+  ofstream outFile(tmpLocation, std::ios::binary);
+  CHECK_MSG(outFile, "Cannot open file '" + tmpLocation + "' for writing");
+  outFile.exceptions(std::ios::badbit | std::ios::failbit);
+
+  writeBinaryPOD(outFile, header);
+  outFile.write(reinterpret_cast<const char*>(offsets_), sizeof(offsets_[0]) * (qty_ + 1));
+  outFile.write(chars_, offsets_[qty_]);
+  outFile.close();
+
+  CommitAtomicWrite(tmpLocation, location);
+  LOG(LIB_INFO) << "Saved " << qty_ << " strings to " << location;
+}
+
+void StringStore::Load(const string& location) {
+  unique_ptr<MappedFile>  file(new MappedFile(location));
+  StringStoreFileHeader   header;
+
+  CHECK_MSG(file->size() >= sizeof(header) &&
+            memcmp(file->data(), STRING_STORE_FILE_MAGIC, sizeof(header.magic)) == 0,
+            "The file '" + location + "' isn't a string store");
+  memcpy(&header, file->data(), sizeof(header));
+  CHECK_MSG(header.version == STRING_STORE_FILE_VERSION,
+            "Unsupported version of the string store file: " + ConvertToString(header.version));
+
+  const size_t dataSize = file->size() - sizeof(header);
+  const uint64_t* offsets = reinterpret_cast<const uint64_t*>(file->data() + sizeof(header));
+  CHECK_MSG(header.qty < dataSize / sizeof(uint64_t),
+            "The string store file '" + location + "' is truncated");
+  const size_t offsetSize = (header.qty + 1) * sizeof(uint64_t);
+  CHECK_MSG(offsets[0] == 0 && offsets[header.qty] == dataSize - offsetSize,
+            "Bug or inconsistent data: invalid offsets in the string store file '" + location + "'");
+  for (size_t i = 0; i < header.qty; ++i) {
+    CHECK_MSG(offsets[i] <= offsets[i + 1],
+              "Bug or inconsistent data: invalid offsets in the string store file '" + location + "'");
+  }
+
+  offsetBuf_.clear();
+  charBuf_.clear();
+  file_        = std::move(file);
+  qty_         = header.qty;
+  fingerprint_ = header.fingerprint;
+  offsets_     = offsets;
+  chars_       = file_->data() + sizeof(header) + offsetSize;
+  LOG(LIB_INFO) << "Mapped " << qty_ << " strings from " << location;
+}
+
+}   // namespace similarity
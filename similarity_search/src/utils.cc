@@ -62,6 +62,28 @@ void RStrip(char* str) {
     str[i--] = '\0';
 }
 
+string EscapeJSON(const string& s) {
+  string res;
+  for (char c : s) {
+    switch (c) {
+      case '"':  res += "\\\""; break;
+      case '\\': res += "\\\\"; break;
+      case '\n': res += "\\n"; break;
+      case '\r': res += "\\r"; break;
+      case '\t': res += "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buf[8];
+          snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+          res += buf;
+        } else {
+          res += c;
+        }
+    }
+  }
+  return res;
+}
+
 // This macro does two things: (a) specialization (b) instantiation
 #define DECLARE_APPROX_EQUAL_INT(INT_TYPE) \
 template <> bool ApproxEqual<INT_TYPE>(const INT_TYPE& x, const INT_TYPE& y, unsigned) { return x == y; }\
@@ -15,7 +15,17 @@
 #ifndef GENRAND_VECT_HPP
 #define GENRAND_VECT_HPP
 
+#include <memory>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "index.h"
+#include "knnquery.h"
+#include "knnqueue.h"
+#include "object.h"
 #include "space/space_sparse_vector.h"
+#include "space/space_vector.h"
 
 namespace similarity {
 
@@ -58,6 +68,50 @@ inline void SetRandZeros(T* pVect, size_t qty, double pZero) {
     for (size_t j = 0; j < qty; ++j) if (RandomReal<T>() < pZero) pVect[j] = T(0);
 }
 
+/*
+ * Appends qty dense vectors with elements uniformly distributed in [0, 1)
+ * (IDs start from startId). The generator is seeded explicitly, so the data
+ * doesn't depend on other tests.
+ */
+inline void CreateRandVectors(const Space<float>& space, size_t qty, size_t dim,
+                              unsigned seed, ObjectVector& res, IdType startId = 0) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<float> distr(0, 1);
+  vector<float> v(dim);
+  for (size_t i = 0; i < qty; ++i) {
+    for (size_t d = 0; d < dim; ++d) v[d] = distr(gen);
+    res.push_back(dynamic_cast<const VectorSpace<float>&>(space).CreateObjFromVect(startId + i, -1, v));
+  }
+}
+
+/*
+ * Returns the fraction of exact K nearest neighbors (found by the brute-force
+ * search among data) that the index returns for the queries. If pFoundIds
+ * is specified, ids of all objects returned by the index are appended to it.
+ */
+inline float ComputeRecall(const Space<float>& space, const Index<float>& index,
+                           const ObjectVector& data, const ObjectVector& queries, unsigned K,
+                           vector<IdType>* pFoundIds = nullptr) {
+  size_t foundQty = 0;
+  for (const Object* pQuery : queries) {
+    KNNQuery<float> exactQuery(space, pQuery, K);
+    for (const Object* pObj : data) exactQuery.CheckAndAddToResult(pObj);
+    std::set<IdType> exactIds;
+    std::unique_ptr<KNNQueue<float>> exactRes(exactQuery.Result()->Clone());
+    while (!exactRes->Empty()) exactIds.insert(exactRes->Pop()->id());
+
+    KNNQuery<float> query(space, pQuery, K);
+    index.Search(&query, -1);
+    std::unique_ptr<KNNQueue<float>> res(query.Result()->Clone());
+    while (!res->Empty()) {
+      IdType id = res->Pop()->id();
+      foundQty += exactIds.count(id);
+      if (pFoundIds != nullptr) pFoundIds->push_back(id);
+    }
+  }
+  return float(foundQty) / (queries.size() * K);
+}
+
 template <typename dist_t>
 void GenSparseVectZipf(size_t maxSize, vector<SparseVectElem<dist_t>>& res) {
   maxSize = max(maxSize, (size_t)1);
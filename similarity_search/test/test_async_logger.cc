@@ -0,0 +1,200 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef _MSC_VER
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "bunit.h"
+#include "async_logger.h"
+#include "thread_pool.h"
+
+namespace similarity {
+
+namespace {
+
+class CollectingLogger : public Logger {
+ public:
+  CollectingLogger(std::vector<std::string>& messages) : messages_(messages) {}
+  void log(LogSeverity, const char *, int, const char *, const std::string & message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    messages_.push_back(message);
+  }
+ private:
+  std::vector<std::string>& messages_;
+  std::mutex                mutex_;
+};
+
+int gEvalQty = 0;
+
+int CountEval() { return ++gEvalQty; }
+
+}
+
+TEST(TestAsyncLoggerDeliversAll) {
+  std::vector<std::string> messages;
+  const int qty = 10000;
+  {
+    // The queue is large enough for all messages, so nothing is dropped
+    AsyncLogger logger(new CollectingLogger(messages), qty);
+    ParallelFor(0, qty, 4, [&](int id) {
+      logger.log(LIB_INFO, __FILE__, __LINE__, __FUNCTION__, std::to_string(id));
+    });
+    logger.flush();
+    EXPECT_EQ(logger.getDroppedQty(), uint64_t(0));
+    EXPECT_EQ(messages.size(), size_t(qty));
+    // Messages logged after stop are written synchronously
+    logger.stop();
+    logger.log(LIB_INFO, __FILE__, __LINE__, __FUNCTION__, "after stop");
+    EXPECT_EQ(messages.size(), size_t(qty + 1));
+  }
+  std::vector<bool> seen(qty);
+  for (int i = 0; i < qty; ++i) seen[std::stoi(messages[i])] = true;
+  for (int i = 0; i < qty; ++i) EXPECT_EQ(bool(seen[i]), true);
+}
+
+TEST(TestAsyncLoggerDropsWhenFull) {
+  std::vector<std::string> messages;
+  uint64_t droppedQty = 0;
+  const int qty = 100000;
+  {
+    AsyncLogger logger(new CollectingLogger(messages), 4);
+    for (int i = 0; i < qty; ++i) {
+      logger.log(LIB_INFO, __FILE__, __LINE__, __FUNCTION__, "msg");
+    }
+    logger.stop();
+    droppedQty = logger.getDroppedQty();
+  }
+  // Each message is either written or dropped, drops are reported as warnings
+  size_t writtenQty = 0;
+  for (const std::string& s : messages) writtenQty += s == "msg";
+  EXPECT_EQ(writtenQty + droppedQty, uint64_t(qty));
+  EXPECT_EQ(messages.size() > writtenQty, droppedQty > 0);
+}
+
+TEST(TestAsyncLoggerKeepsErrors) {
+  std::vector<std::string> messages;
+  const int qty = 10000;
+  {
+    AsyncLogger logger(new CollectingLogger(messages), 4);
+    for (int i = 0; i < qty; ++i) {
+      logger.log(i % 2 ? LIB_INFO : LIB_ERROR, __FILE__, __LINE__, __FUNCTION__, i % 2 ? "info" : "error");
+    }
+    logger.log(LIB_FATAL, __FILE__, __LINE__, __FUNCTION__, "fatal");
+    logger.stop();
+  }
+  // Informational messages can be dropped, but errors can't
+  size_t errorQty = 0, fatalQty = 0;
+  for (const std::string& s : messages) {
+    errorQty += s == "error";
+    fatalQty += s == "fatal";
+  }
+  EXPECT_EQ(errorQty, size_t(qty / 2));
+  EXPECT_EQ(fatalQty, size_t(1));
+}
+
+TEST(TestAsyncLoggerStopWhileLogging) {
+  for (int rep = 0; rep < 20; ++rep) {
+    std::vector<std::string> messages;
+    std::atomic<size_t> loggedQty(0);
+    uint64_t droppedQty = 0;
+    {
+      AsyncLogger logger(new CollectingLogger(messages), 16);
+      std::atomic<bool> done(false);
+      std::vector<std::thread> producers;
+      for (int t = 0; t < 4; ++t) {
+        producers.emplace_back([&]() {
+          while (!done) {
+            logger.log(LIB_INFO, __FILE__, __LINE__, __FUNCTION__, "msg");
+            ++loggedQty;
+          }
+        });
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      // Messages logged during and after stop are neither lost nor left in the queue
+      logger.stop();
+      done = true;
+      for (std::thread& t : producers) t.join();
+      droppedQty = logger.getDroppedQty();
+    }
+    size_t writtenQty = 0;
+    for (const std::string& s : messages) writtenQty += s == "msg";
+    EXPECT_EQ(writtenQty + droppedQty, uint64_t(loggedQty.load()));
+  }
+}
+
+#ifndef _MSC_VER
+TEST(TestAsyncLoggerAfterFork) {
+  std::vector<std::string> messages;
+  AsyncLogger logger(new CollectingLogger(messages));
+  // Another thread keeps logging, so the fork can happen while a message is written
+  std::atomic<bool> done(false);
+  std::thread producer([&]() {
+    while (!done) {
+      logger.log(LIB_INFO, __FILE__, __LINE__, __FUNCTION__, "parent");
+      std::this_thread::sleep_for(std::chrono::microseconds(10));
+    }
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    // The child has no background thread: messages are written synchronously
+    size_t qty = messages.size();
+    logger.log(LIB_INFO, __FILE__, __LINE__, __FUNCTION__, "child");
+    bool ok = messages.size() == qty + 1 && messages.back() == "child";
+    logger.flush();
+    logger.stop();
+    _exit(ok ? 0 : 1);
+  }
+  done = true;
+  producer.join();
+
+  int status = -1;
+  EXPECT_EQ(waitpid(pid, &status, 0), pid);
+  EXPECT_EQ(WIFEXITED(status) && WEXITSTATUS(status) == 0, true);
+  // The parent keeps logging asynchronously
+  logger.flush();
+  size_t qty = messages.size();
+  logger.log(LIB_INFO, __FILE__, __LINE__, __FUNCTION__, "parent");
+  logger.flush();
+  EXPECT_EQ(messages.size(), qty + 1);
+}
+#endif
+
+TEST(TestLogSeverityThreshold) {
+  if (getGlobalLogger() == NULL) return;
+
+  gEvalQty = 0;
+  setLogSeverityThreshold(LIB_WARNING);
+  EXPECT_EQ(IsLogEnabled(LIB_INFO), false);
+  EXPECT_EQ(IsLogEnabled(LIB_ERROR), true);
+  EXPECT_EQ(IsLogEnabled(LIB_FATAL), true);
+  // Arguments of filtered-out messages aren't evaluated
+  LOG(LIB_DEBUG) << CountEval();
+  LOG(LIB_INFO) << CountEval();
+  EXPECT_EQ(gEvalQty, 0);
+
+  setLogSeverityThreshold(LIB_DEBUG);
+  EXPECT_EQ(IsLogEnabled(LIB_INFO), true);
+}
+
+}  // namespace similarity
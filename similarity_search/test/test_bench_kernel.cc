@@ -0,0 +1,61 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include <sstream>
+
+#include "bunit.h"
+#include "bench_kernel.h"
+
+namespace similarity {
+
+TEST(TestBenchMeanConfInterval) {
+  vector<double> vals = {1, 2, 3, 4, 5};
+  double mean, confMin, confMax;
+
+  ComputeMeanConfInterval(vals, 1.96, mean, confMin, confMax);
+  EXPECT_EQ_EPS(mean, 3.0, 1e-9);
+  // stddev = sqrt(2.5), standard error = sqrt(2.5/5)
+  EXPECT_EQ_EPS(confMax - mean, 1.96 * sqrt(0.5), 1e-9);
+  EXPECT_EQ_EPS(mean - confMin, 1.96 * sqrt(0.5), 1e-9);
+
+  // A single value has a degenerate interval
+  ComputeMeanConfInterval(vector<double>(1, 7.0), 1.96, mean, confMin, confMax);
+  EXPECT_EQ_EPS(confMin, 7.0, 1e-9);
+  EXPECT_EQ_EPS(confMax, 7.0, 1e-9);
+}
+
+TEST(TestRunKernelBench) {
+  KernelBenchConfig conf;
+  conf.VectQty        = 100;
+  conf.WarmupMicroSec = 1000;
+  conf.TrialMicroSec  = 1000;
+  conf.TrialQty       = 3;
+
+  vector<float> arr(conf.VectQty * 4, 1.0f);
+  KernelBenchResult r = RunKernelBench(conf, "sum", "float", 4, 4 * sizeof(float),
+                                       [&](size_t i, size_t j) { return double(arr[i * 4] + arr[j * 4]); });
+
+  EXPECT_EQ(r.TrialDistPerSec.size(), size_t(3));
+  EXPECT_EQ(r.BytesPerDist, 8 * sizeof(float));
+  EXPECT_EQ(r.DistPerTrial % (conf.VectQty - 1), uint64_t(0));
+  EXPECT_EQ(r.DistPerSecMean > 0, true);
+  EXPECT_EQ(r.DistPerSecConfMin <= r.DistPerSecMean && r.DistPerSecMean <= r.DistPerSecConfMax, true);
+
+  std::stringstream json;
+  WriteKernelBenchJSON(json, "test", -1, conf, vector<KernelBenchResult>(1, r));
+  EXPECT_EQ(json.str().find("\"name\": \"sum\"") != string::npos, true);
+  EXPECT_EQ(json.str().find("\"trials\": [") != string::npos, true);
+}
+
+}  // namespace similarity
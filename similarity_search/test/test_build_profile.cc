@@ -0,0 +1,106 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include <vector>
+
+#include "bunit.h"
+#include "build_profile.h"
+#include "memory.h"
+#include "thread_pool.h"
+
+namespace similarity {
+
+TEST(TestBuildProfilePhases) {
+  BuildProfiler profiler;
+  profiler.Reset();
+
+  {
+    BuildPhase phase(profiler, "first");
+  }
+  profiler.StartPhase("second");
+  // Starting a phase ends the previous one
+  profiler.StartPhase("third");
+  profiler.EndPhase();
+  // Ending a phase twice has no effect
+  profiler.EndPhase();
+
+  const vector<BuildPhaseStat>& phases = profiler.GetPhases();
+  EXPECT_EQ(phases.size(), size_t(3));
+  EXPECT_EQ(phases[0].Name == "first", true);
+  EXPECT_EQ(phases[2].Name == "third", true);
+  for (const BuildPhaseStat& p : phases) {
+    EXPECT_EQ(p.WallTime >= 0, true);
+    EXPECT_EQ(p.CPUTime >= 0, true);
+  }
+
+  string json = profiler.ToJSON();
+  EXPECT_EQ(json.find("\"name\": \"second\"") != string::npos, true);
+
+  profiler.Reset();
+  EXPECT_EQ(profiler.GetPhases().empty(), true);
+}
+
+TEST(TestBuildProfileProgress) {
+  BuildProfiler profiler;
+  profiler.Reset();
+
+  const unsigned sub = profiler.RegisterSubPhase("sub");
+  // Registering the same name returns the same id
+  EXPECT_EQ(profiler.RegisterSubPhase("sub"), sub);
+
+  const size_t qty = 1000;
+  profiler.StartProgress(qty, 10);
+  ParallelFor(0, qty, 4, [&](int) {
+    BuildSubPhaseTimer timer(profiler, sub);
+    profiler.AddProgress();
+  });
+
+  const vector<BuildProgressSample>& progress = profiler.GetProgress();
+  EXPECT_EQ(progress.empty(), false);
+  EXPECT_EQ(progress.size() <= size_t(10), true);
+  for (size_t i = 1; i < progress.size(); ++i) {
+    EXPECT_EQ(progress[i].DoneQty > progress[i - 1].DoneQty, true);
+  }
+
+  vector<BuildSubPhaseStat> subPhases = profiler.GetSubPhases();
+  EXPECT_EQ(subPhases.size(), size_t(1));
+  EXPECT_EQ(subPhases[0].CallQty, uint64_t(qty));
+
+  // Time of unregistered sub-phases is ignored
+  profiler.AddSubPhaseTime(BUILD_PROFILE_MAX_SUBPHASE, 1000);
+  EXPECT_EQ(profiler.GetSubPhases().size(), size_t(1));
+}
+
+TEST(TestBuildProfilePeakRSS) {
+  // Raise the high-water mark of the process
+  {
+    std::vector<char> buf(64 * 1024 * 1024, 1);
+    EXPECT_EQ(buf.back(), char(1));
+  }
+  const double peakBefore = MemUsage().get_peak_rss();
+
+  BuildProfiler profiler;
+  profiler.Reset();
+  // The high-water mark is shared by the whole process, so it isn't reset
+  EXPECT_EQ(MemUsage().get_peak_rss() >= peakBefore, true);
+  EXPECT_EQ(profiler.GetPeakRSS() >= peakBefore, true);
+  EXPECT_EQ(profiler.GetPeakRSSIncrease() >= 0, true);
+
+  profiler.StartPhase("phase");
+  profiler.EndPhase();
+  EXPECT_EQ(profiler.GetPhases()[0].PeakRSSIncrease >= 0, true);
+  EXPECT_EQ(profiler.ToJSON().find("\"peakRssIncreaseMB\"") != string::npos, true);
+}
+
+}  // namespace similarity
@@ -0,0 +1,92 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include "bunit.h"
+#include "genrand_vect.h"
+#include "gold_standard.h"
+#include "knnquery.h"
+#include "space/space_lp.h"
+
+namespace similarity {
+
+using namespace std;
+
+TEST(TestGoldStandardBlockMatchesFullSort) {
+  SpaceLp<float>  space(2);
+  ObjectVector    data, queries;
+  // The number of data points isn't a multiple of the data chunk size
+  CreateRandVectors(space, EXACT_KNN_DATA_BLOCK_QTY + 123, 8, 0, data);
+  // The number of queries isn't a multiple of the query block size
+  CreateRandVectors(space, EXACT_KNN_QUERY_BLOCK_QTY + 5, 8, 1, queries);
+
+  const unsigned K = 10;
+  const size_t   keepQty = 2 * K;
+
+  vector<unique_ptr<GoldStandard<float>>> vBlock(queries.size());
+
+  ComputeGoldStandardBlock(space, data, queries, 0, EXACT_KNN_QUERY_BLOCK_QTY, keepQty, vBlock);
+  ComputeGoldStandardBlock(space, data, queries, EXACT_KNN_QUERY_BLOCK_QTY, queries.size(), keepQty, vBlock);
+
+  for (size_t q = 0; q < queries.size(); ++q) {
+    KNNQuery<float>     query(space, queries[q], K);
+    GoldStandard<float> full(space, data, &query, 0);
+
+    const vector<ResultEntry<float>>& blockEntries = vBlock[q]->GetSortedEntries();
+    const vector<ResultEntry<float>>& fullEntries = full.GetSortedEntries();
+
+    EXPECT_EQ(blockEntries.size(), keepQty);
+    EXPECT_EQ(fullEntries.size(), data.size());
+    for (size_t i = 0; i < keepQty; ++i) {
+      EXPECT_EQ(blockEntries[i] == fullEntries[i], true);
+    }
+
+    GoldStandard<float> partial(space, data, &query, 2.0);
+    EXPECT_EQ(partial.GetSortedEntries().size(), keepQty);
+    for (size_t i = 0; i < keepQty; ++i) {
+      EXPECT_EQ(partial.GetSortedEntries()[i] == fullEntries[i], true);
+    }
+  }
+
+  for (const Object* o : data) delete o;
+  for (const Object* o : queries) delete o;
+}
+
+TEST(TestGoldStandardWriteRead) {
+  vector<ResultEntry<float>> entries;
+  for (size_t i = 0; i < 50; ++i) {
+    entries.push_back(ResultEntry<float>(IdType(100 - i), LabelType(i % 3), float(i) / 7));
+  }
+  vector<ResultEntry<float>> entriesCopy = entries;
+  GoldStandard<float> gs1(12345, entriesCopy);
+
+  stringstream binary;
+  gs1.Write(binary);
+  // The compact format: the time, the number of entries, and packed entries
+  EXPECT_EQ(binary.str().size(), 2 * sizeof(uint64_t) + entries.size() * ResultEntry<float>::binarySize());
+
+  GoldStandard<float> gs2;
+  gs2.Read(binary);
+
+  EXPECT_EQ(gs2.GetSeqSearchTime(), uint64_t(12345));
+  EXPECT_EQ(gs2.GetSortedEntries().size(), entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    EXPECT_EQ(gs2.GetSortedEntries()[i] == entries[i], true);
+  }
+}
+
+}  // namespace similarity
@@ -0,0 +1,111 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "bunit.h"
+#include "genrand_vect.h"
+#include "index_bundle.h"
+#include "knnquery.h"
+#include "knnqueue.h"
+#include "method/hnsw.h"
+#include "space/space_lp.h"
+
+namespace similarity {
+
+using namespace std;
+
+namespace {
+
+vector<IdType> Search(const Space<float>& space, const Index<float>& index, const Object* pQuery, unsigned K) {
+  KNNQuery<float> query(space, pQuery, K);
+  index.Search(&query, -1);
+  unique_ptr<KNNQueue<float>> res(query.Result()->Clone());
+  vector<IdType> ids;
+  while (!res->Empty()) ids.push_back(res->Pop()->id());
+  return ids;
+}
+
+}
+
+TEST(TestIndexBundleSaveLoad) {
+  unique_ptr<Space<float>> space(SpaceFactoryRegistry<float>::Instance().CreateSpace(SPACE_L2, AnyParams()));
+  ObjectVector    data, queries;
+  vector<string>  externIds;
+  const unsigned  K = 10;
+  // An odd dimensionality: object buffers are padded in the bundle
+  CreateRandVectors(*space, 500, 7, 0, data);
+  CreateRandVectors(*space, 20, 7, 1, queries);
+  for (size_t i = 0; i < data.size(); ++i) externIds.push_back(i % 3 ? "ext" + ConvertToString(i) : "");
+
+  const string location = "tmp_index_bundle.bin";
+  unique_ptr<Index<float>> index(MethodFactoryRegistry<float>::Instance().
+                                 CreateMethod(false, METH_HNSW, SPACE_L2, *space, data));
+  index->CreateIndex(AnyParams({"M=10", "efConstruction=50", "indexThreadQty=1"}));
+  index->SetQueryTimeParams(AnyParams({"ef=50"}));
+  IndexBundle::Save(location, SPACE_L2, AnyParams(), METH_HNSW, data, externIds, *index);
+  EXPECT_EQ(IndexBundle::IsBundle(location), true);
+  EXPECT_EQ(IndexBundle::IsBundle(IndexBundle::GetIndexFileName(location)), false);
+
+  {
+    // Nothing except the bundle is needed to bring the index up
+    IndexBundle     bundle(location);
+    ObjectVector    loadData;
+    vector<string>  loadExternIds;
+    EXPECT_EQ(bundle.GetSpaceType() == SPACE_L2, true);
+    EXPECT_EQ(bundle.GetMethodName() == METH_HNSW, true);
+    EXPECT_EQ(bundle.size(), data.size());
+    bundle.ReadData(loadData, loadExternIds);
+    EXPECT_EQ(loadData.size(), data.size());
+    EXPECT_EQ(loadExternIds == externIds, true);
+    for (size_t i = 0; i < data.size(); ++i) {
+      EXPECT_EQ(loadData[i]->id(), data[i]->id());
+      EXPECT_EQ(loadData[i]->datalength(), data[i]->datalength());
+      EXPECT_EQ(memcmp(loadData[i]->data(), data[i]->data(), data[i]->datalength()), 0);
+      EXPECT_EQ(reinterpret_cast<uintptr_t>(loadData[i]->buffer()) % 16, uintptr_t(0));
+    }
+
+    unique_ptr<Space<float>>  loadSpace(bundle.CreateSpace<float>());
+    unique_ptr<Index<float>>  loadIndex(bundle.LoadIndex(false, *loadSpace, loadData));
+    loadIndex->SetQueryTimeParams(AnyParams({"ef=50"}));
+    // The optimized HNSW index isn't copied, it points to the mapped file
+    const Hnsw<float>* hnsw = dynamic_cast<const Hnsw<float>*>(loadIndex.get());
+    EXPECT_EQ(hnsw != nullptr && hnsw->IsIndexMapped(), true);
+    for (const Object* pQuery : queries) {
+      EXPECT_EQ(Search(*loadSpace, *loadIndex, pQuery, K) == Search(*space, *index, pQuery, K), true);
+    }
+
+    // The distance type should match
+    bool thrown = false;
+    try {
+      unique_ptr<Space<double>> wrongSpace(bundle.CreateSpace<double>());
+    } catch (const exception&) {
+      thrown = true;
+    }
+    EXPECT_EQ(thrown, true);
+
+    loadIndex.reset();
+    for (const Object* pObj : loadData) delete pObj;
+  }
+
+  remove(location.c_str());
+  remove(IndexBundle::GetIndexFileName(location).c_str());
+  for (const Object* pObj : data) delete pObj;
+  for (const Object* pObj : queries) delete pObj;
+}
+
+}  // namespace similarity
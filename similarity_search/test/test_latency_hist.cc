@@ -0,0 +1,86 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include "logging.h"
+#include "bunit.h"
+#include "utils.h"
+#include "latency_histogram.h"
+
+namespace similarity {
+
+using std::vector;
+
+// Exact percentile using the same definition as LatencyHistogram
+uint64_t ExactPercentile(vector<uint64_t> vals, double perc) {
+  std::sort(vals.begin(), vals.end());
+  size_t target = static_cast<size_t>(std::ceil(perc * vals.size() / 100.0 - 1e-9));
+  if (target == 0) target = 1;
+  return vals[target - 1];
+}
+
+TEST(TestLatencyHistogramSmallExact) {
+  LatencyHistogram hist;
+  for (uint64_t i = 1; i <= 1000; ++i) hist.Add(i);
+
+  EXPECT_EQ(hist.GetQty(), uint64_t(1000));
+  EXPECT_EQ(hist.GetMin(), uint64_t(1));
+  EXPECT_EQ(hist.GetMax(), uint64_t(1000));
+  EXPECT_EQ(hist.GetPercentile(50), uint64_t(500));
+  EXPECT_EQ(hist.GetPercentile(99), uint64_t(990));
+  EXPECT_EQ(hist.GetPercentile(99.9), uint64_t(999));
+  EXPECT_EQ(hist.GetPercentile(100), uint64_t(1000));
+}
+
+TEST(TestLatencyHistogramRelError) {
+  LatencyHistogram hist;
+  vector<uint64_t> vals;
+
+  for (size_t i = 0; i < 20000; ++i) {
+    // log-uniform values spanning many orders of magnitude
+    uint64_t v = static_cast<uint64_t>(std::exp(RandomReal<double>() * 25));
+    vals.push_back(v);
+    hist.Add(v);
+  }
+
+  const double percs[] = {0, 10, 50, 90, 99, 99.9, 100};
+  for (double p : percs) {
+    double exact  = ExactPercentile(vals, p);
+    double approx = hist.GetPercentile(p);
+    EXPECT_EQ(approx >= exact, true);
+    EXPECT_EQ(approx - exact <= exact * 1e-3, true);
+  }
+}
+
+TEST(TestLatencyHistogramMerge) {
+  LatencyHistogram h1, h2, hAll;
+
+  for (size_t i = 0; i < 5000; ++i) {
+    uint64_t v = RandomInt() % 1000000;
+    (i % 2 ? h1 : h2).Add(v);
+    hAll.Add(v);
+  }
+  h1.Merge(h2);
+
+  EXPECT_EQ(h1.GetQty(), hAll.GetQty());
+  EXPECT_EQ(h1.GetMin(), hAll.GetMin());
+  EXPECT_EQ(h1.GetMax(), hAll.GetMax());
+  EXPECT_EQ(h1.GetPercentile(50), hAll.GetPercentile(50));
+  EXPECT_EQ(h1.GetPercentile(99.9), hAll.GetPercentile(99.9));
+}
+
+}  // namespace similarity
@@ -0,0 +1,140 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#if defined(WITH_EXTRAS)
+
+#include <algorithm>
+#include <cstdio>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "bunit.h"
+#include "genrand_vect.h"
+#include "knnquery.h"
+#include "knnqueue.h"
+#include "method/nndes.h"
+#include "method/small_world_rand.h"
+#include "space/space_lp.h"
+
+namespace similarity {
+
+using namespace std;
+
+namespace {
+
+// The fraction of exact K nearest neighbors (other than the point itself) present in the graph
+float ComputeGraphRecall(const Space<float>& space, const ObjectVector& data,
+                         const vector<KNN>& graph, unsigned K) {
+  size_t foundQty = 0;
+  vector<pair<float, int>> dists;
+  for (size_t i = 0; i < data.size(); ++i) {
+    dists.clear();
+    for (size_t j = 0; j < data.size(); ++j) {
+      if (j != i) dists.push_back(make_pair(space.IndexTimeDistance(data[i], data[j]), int(j)));
+    }
+    partial_sort(dists.begin(), dists.begin() + K, dists.end());
+    set<int> exactIds;
+    for (unsigned k = 0; k < K; ++k) exactIds.insert(dists[k].second);
+    for (const KNNEntry& e : graph[i]) foundQty += exactIds.count(e.key);
+  }
+  return float(foundQty) / (data.size() * K);
+}
+
+float BuildGraphRecall(const Space<float>& space, const ObjectVector& data,
+                       unsigned K, int threadQty, size_t iterationQty) {
+  NNDescentMethod<float>::SpaceOracle oracle(space, data);
+  NNDescent<NNDescentMethod<float>::SpaceOracle> nndes(data.size(), K, 1.0, oracle, GRAPH_BOTH);
+  nndes.setThreadQty(threadQty);
+  for (size_t it = 0; it < iterationQty; ++it) nndes.iterate(false);
+  return ComputeGraphRecall(space, data, nndes.getNN(), K);
+}
+
+}
+
+TEST(TestNNDescentParallelJoin) {
+  SpaceLp<float>  space(2);
+  ObjectVector    data;
+  const unsigned  K = 10;
+  CreateRandVectors(space, 2000, 8, 0, data);
+
+  // Concurrent updates of neighbor lists don't lose neighbors: the graph is as good as a sequentially built one
+  float recall1 = BuildGraphRecall(space, data, K, 1, 10);
+  float recall4 = BuildGraphRecall(space, data, K, 4, 10);
+  LOG(LIB_INFO) << "Graph recall, 1 thread: " << recall1 << " 4 threads: " << recall4;
+  EXPECT_EQ(recall1 > 0.9, true);
+  EXPECT_EQ(recall4 > recall1 - 0.01, true);
+
+  for (const Object* pObj : data) delete pObj;
+}
+
+TEST(TestNNDescentSaveLoadWarmStart) {
+  SpaceLp<float>  space(2);
+  ObjectVector    data, newData, queries;
+  const size_t    dim = 8, qty = 2000;
+  const unsigned  K = 10;
+  CreateRandVectors(space, qty, dim, 0, data);
+  CreateRandVectors(space, 200, dim, 1, newData, qty);
+  CreateRandVectors(space, 50, dim, 2, queries);
+
+  const string location = "tmp_nndes_graph.bin";
+  const AnyParams queryParams({"efSearch=50", "initSearchAttempts=2"});
+  NNDescentMethod<float> index(false, space, data);
+  index.CreateIndex(AnyParams({"NN=10", "indexThreadQty=4"}));
+  index.SetQueryTimeParams(queryParams);
+  float recall = ComputeRecall(space, index, data, queries, K);
+  EXPECT_EQ(recall > 0.9, true);
+  index.SaveIndex(location);
+
+  // The saved graph can be converted into an SW-graph
+  SmallWorldRand<float> swIndex(false, space, data);
+  swIndex.CreateIndex(AnyParams({"NN=10", "knnGraphFile=" + location}));
+  swIndex.SetQueryTimeParams(AnyParams({"efSearch=50"}));
+  EXPECT_EQ(ComputeRecall(space, swIndex, data, queries, K) > 0.95, true);
+
+  // Nodes are matched by object ids, so the order of data points may change
+  ObjectVector loadData(data.rbegin(), data.rend());
+  NNDescentMethod<float> loadedIndex(false, space, loadData);
+  loadedIndex.LoadIndex(location);
+  loadedIndex.SetQueryTimeParams(queryParams);
+  EXPECT_EQ(ComputeRecall(space, loadedIndex, loadData, queries, K) > recall - 0.05, true);
+
+  // A data set with missing points can't be used for loading
+  ObjectVector partialData(data.begin() + 1, data.end());
+  NNDescentMethod<float> badIndex(false, space, partialData);
+  bool thrown = false;
+  try {
+    badIndex.LoadIndex(location);
+  } catch (const exception&) {
+    thrown = true;
+  }
+  EXPECT_EQ(thrown, true);
+
+  // Warm start with new points and without some old ones converges in a couple of iterations
+  ObjectVector warmData(data.begin() + 100, data.end());
+  warmData.insert(warmData.end(), newData.begin(), newData.end());
+  NNDescentMethod<float> warmIndex(false, space, warmData);
+  warmIndex.CreateIndex(AnyParams({"NN=10", "iterationQty=2", "warmStartFile=" + location}));
+  warmIndex.SetQueryTimeParams(queryParams);
+  EXPECT_EQ(ComputeRecall(space, warmIndex, warmData, queries, K) > 0.9, true);
+  remove(location.c_str());
+
+  for (const Object* pObj : data) delete pObj;
+  for (const Object* pObj : newData) delete pObj;
+  for (const Object* pObj : queries) delete pObj;
+}
+
+}  // namespace similarity
+
+#endif
@@ -0,0 +1,144 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include <cmath>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+#include "logging.h"
+#include "bunit.h"
+#include "utils.h"
+#include "open_loop.h"
+
+namespace similarity {
+
+using std::vector;
+
+OpenLoopStat MakeOpenLoopStat(double offeredQPS, double achievedQPS, double p99) {
+  OpenLoopStat res;
+  res.OfferedQPS   = offeredQPS;
+  res.AchievedQPS  = achievedQPS;
+  res.QueryTimeP99 = p99;
+  return res;
+}
+
+TEST(TestOpenLoopKnee) {
+  EXPECT_EQ(FindOpenLoopKnee(vector<OpenLoopStat>()), -1);
+
+  // All rates are sustained
+  EXPECT_EQ(FindOpenLoopKnee({MakeOpenLoopStat(100, 100, 1),
+                              MakeOpenLoopStat(200, 195, 1.5),
+                              MakeOpenLoopStat(400, 370, 2)}), 2);
+  // The throughput falls behind the offered rate
+  EXPECT_EQ(FindOpenLoopKnee({MakeOpenLoopStat(100, 100, 1),
+                              MakeOpenLoopStat(200, 190, 1),
+                              MakeOpenLoopStat(400, 300, 1)}), 1);
+  // The latency grows too much
+  EXPECT_EQ(FindOpenLoopKnee({MakeOpenLoopStat(100, 100, 1),
+                              MakeOpenLoopStat(200, 200, 1.5),
+                              MakeOpenLoopStat(400, 400, 2.5)}), 1);
+  // The latency is compared to the smallest one observed under lighter loads
+  EXPECT_EQ(FindOpenLoopKnee({MakeOpenLoopStat(100, 100, 2),
+                              MakeOpenLoopStat(200, 200, 1),
+                              MakeOpenLoopStat(400, 400, 2.1)}), 1);
+  // Rates after the first unsustained one are ignored
+  EXPECT_EQ(FindOpenLoopKnee({MakeOpenLoopStat(100, 50, 1),
+                              MakeOpenLoopStat(200, 200, 1)}), -1);
+}
+
+TEST(TestOpenLoopFixedSchedule) {
+  vector<uint64_t> arrivalNanoSec;
+  GenArrivalSchedule(1000, 2000, false, arrivalNanoSec);
+  EXPECT_EQ(arrivalNanoSec.size(), size_t(1000));
+  // Queries arrive every 0.5 msec (up to rounding errors)
+  for (size_t i = 0; i < arrivalNanoSec.size(); ++i) {
+    EXPECT_EQ(std::abs(static_cast<double>(arrivalNanoSec[i]) - i * 5e5) <= 1, true);
+  }
+}
+
+TEST(TestOpenLoopPoissonSchedule) {
+  const size_t      qty = 20000;
+  const double      qps = 1000;
+  vector<uint64_t>  arrivalNanoSec;
+  GenArrivalSchedule(qty, qps, true, arrivalNanoSec);
+  EXPECT_EQ(arrivalNanoSec.size(), qty);
+  EXPECT_EQ(arrivalNanoSec[0], uint64_t(0));
+
+  // Inter-arrival times are exponential: the mean and the standard deviation are 1/qps
+  double sum = 0, sumSqr = 0;
+  size_t shortQty = 0;
+  for (size_t i = 1; i < qty; ++i) {
+    EXPECT_EQ(arrivalNanoSec[i] >= arrivalNanoSec[i - 1], true);
+    double gap = (arrivalNanoSec[i] - arrivalNanoSec[i - 1]) / 1e9;
+    sum += gap;
+    sumSqr += gap * gap;
+    if (gap < 1 / qps) ++shortQty;
+  }
+  double mean = sum / (qty - 1);
+  double stdDev = std::sqrt(sumSqr / (qty - 1) - mean * mean);
+  EXPECT_EQ(std::abs(mean * qps - 1) < 0.05, true);
+  EXPECT_EQ(std::abs(stdDev * qps - 1) < 0.05, true);
+  // P(gap < mean) = 1 - 1/e
+  EXPECT_EQ(std::abs(double(shortQty) / (qty - 1) - (1 - std::exp(-1.0))) < 0.02, true);
+
+  /*
+   * Each thread has its own generator seeded with defaultRandomSeed,
+   * so new threads produce the same schedule, unless the seed is changed.
+   */
+  vector<uint64_t> schedule1, schedule2, schedule3;
+  std::thread([&]() { GenArrivalSchedule(100, qps, true, schedule1); }).join();
+  std::thread([&]() { GenArrivalSchedule(100, qps, true, schedule2); }).join();
+  int oldSeed = defaultRandomSeed;
+  defaultRandomSeed = oldSeed + 1;
+  std::thread([&]() { GenArrivalSchedule(100, qps, true, schedule3); }).join();
+  defaultRandomSeed = oldSeed;
+  EXPECT_EQ(schedule1 == schedule2, true);
+  EXPECT_EQ(schedule1 == schedule3, false);
+}
+
+TEST(TestRunOpenLoop) {
+  const size_t      qty = 200;
+  const double      qps = 2000;
+  vector<uint64_t>  arrivalNanoSec;
+  GenArrivalSchedule(qty, qps, false, arrivalNanoSec);
+
+  // Each query is executed once
+  vector<std::atomic<int>> execQty(qty);
+  OpenLoopStat stat = RunOpenLoop(2, qps, arrivalNanoSec, [&](size_t q) { ++execQty[q]; });
+  for (const auto& e : execQty) EXPECT_EQ(e.load(), 1);
+
+  EXPECT_EQ(stat.OfferedQPS, qps);
+  // Queries don't start before their arrival times
+  EXPECT_EQ(stat.AchievedQPS > 0 && stat.AchievedQPS <= qty / (arrivalNanoSec.back() / 1e9), true);
+  EXPECT_EQ(stat.QueryTimeP50 <= stat.QueryTimeP90 && stat.QueryTimeP90 <= stat.QueryTimeP99 &&
+            stat.QueryTimeP99 <= stat.QueryTimeP999, true);
+
+  /*
+   * One thread can't keep up with queries arriving every 0.1 msec, each of which takes 1 msec.
+   * The latency includes waiting in the queue, so the last queries wait for about 90 msec.
+   */
+  const size_t overloadQty = 100;
+  GenArrivalSchedule(overloadQty, 10000, false, arrivalNanoSec);
+  OpenLoopStat overloadStat = RunOpenLoop(1, 10000, arrivalNanoSec, [](size_t) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  });
+  EXPECT_EQ(overloadStat.QueryTimeP50 >= 1, true);
+  EXPECT_EQ(overloadStat.QueryTimeP99 > 50, true);
+  EXPECT_EQ(overloadStat.AchievedQPS < OPEN_LOOP_MIN_THROUGHPUT_FRAC * overloadStat.OfferedQPS, true);
+  EXPECT_EQ(FindOpenLoopKnee({stat, overloadStat}), 0);
+}
+
+}  // namespace similarity
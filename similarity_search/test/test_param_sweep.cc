@@ -0,0 +1,99 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include <sstream>
+
+#include "bunit.h"
+#include "param_sweep.h"
+
+namespace similarity {
+
+TEST(TestExpandQueryTimeGrid) {
+  vector<string> res;
+  size_t         varyingQty = 0;
+
+  ExpandQueryTimeGrid("", res, varyingQty);
+  EXPECT_EQ(res.size(), size_t(1));
+  EXPECT_EQ(res[0].empty(), true);
+  EXPECT_EQ(varyingQty, size_t(0));
+
+  ExpandQueryTimeGrid("ef=10:20:40,algoType=v1merge", res, varyingQty);
+  EXPECT_EQ(res.size(), size_t(3));
+  EXPECT_EQ(varyingQty, size_t(1));
+  EXPECT_EQ(res[0] == "ef=10,algoType=v1merge", true);
+  EXPECT_EQ(res[2] == "ef=40,algoType=v1merge", true);
+
+  // The last parameter varies the fastest
+  ExpandQueryTimeGrid("a=1:2,b=x:y:z", res, varyingQty);
+  EXPECT_EQ(res.size(), size_t(6));
+  EXPECT_EQ(varyingQty, size_t(2));
+  EXPECT_EQ(res[0] == "a=1,b=x", true);
+  EXPECT_EQ(res[1] == "a=1,b=y", true);
+  EXPECT_EQ(res[3] == "a=2,b=x", true);
+  EXPECT_EQ(res[5] == "a=2,b=z", true);
+
+  bool bThrown = false;
+  try {
+    ExpandQueryTimeGrid("ef", res, varyingQty);
+  } catch (const std::exception&) {
+    bThrown = true;
+  }
+  EXPECT_EQ(bThrown, true);
+}
+
+TEST(TestParetoFront) {
+  vector<SweepPoint> points;
+  points.push_back(SweepPoint("ef=10",  0.80, 1000, 1, 2, 100));
+  points.push_back(SweepPoint("ef=20",  0.90, 800,  1, 2, 200));
+  // Dominated by ef=20: lower recall and lower QPS
+  points.push_back(SweepPoint("ef=15",  0.85, 700,  1, 2, 150));
+  points.push_back(SweepPoint("ef=40",  0.95, 500,  2, 4, 400));
+  // Dominated by ef=40: the same recall, but lower QPS
+  points.push_back(SweepPoint("ef=80",  0.95, 300,  3, 6, 800));
+
+  MarkParetoFront(points);
+
+  EXPECT_EQ(points[0].IsPareto, true);
+  EXPECT_EQ(points[1].IsPareto, true);
+  EXPECT_EQ(points[2].IsPareto, false);
+  EXPECT_EQ(points[3].IsPareto, true);
+  EXPECT_EQ(points[4].IsPareto, false);
+
+  EXPECT_EQ(FindCheapestSweepPoint(points, 0.9), 1);
+  EXPECT_EQ(FindCheapestSweepPoint(points, 0.95), 3);
+  EXPECT_EQ(FindCheapestSweepPoint(points, 0.99), -1);
+
+  std::stringstream tsv, json;
+  WriteSweepPointsTSV(tsv, "hnsw", points);
+  WriteSweepPointsJSON(json, "hnsw", points);
+
+  // The header and one line per point
+  size_t lineQty = 0;
+  string line;
+  while (std::getline(tsv, line)) ++lineQty;
+  EXPECT_EQ(lineQty, points.size() + 1);
+  EXPECT_EQ(json.str().find("\"pareto\": true") != string::npos, true);
+}
+
+TEST(TestSweepPointsJSONEscape) {
+  vector<SweepPoint> points;
+  points.push_back(SweepPoint("a\"b\\c\td\x01", 0.5, 100, 1, 2, 10));
+  std::stringstream json;
+  WriteSweepPointsJSON(json, "line1\nline2", points);
+  // Quotes, backslashes, and control characters are escaped
+  EXPECT_EQ(json.str().find("\"line1\\nline2\"") != string::npos, true);
+  EXPECT_EQ(json.str().find("\"a\\\"b\\\\c\\td\\u0001\"") != string::npos, true);
+}
+
+}  // namespace similarity
@@ -0,0 +1,132 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+#include "bunit.h"
+#include "genrand_vect.h"
+#include "sample_stat.h"
+#include "space/space_lp.h"
+
+namespace similarity {
+
+using namespace std;
+
+TEST(TestRunningStatMerge) {
+  RunningStat all, left, right;
+  for (int i = 0; i < 100; ++i) {
+    double x = (i * 37) % 101;
+    all.Add(x);
+    (i < 30 ? left : right).Add(x);
+  }
+  left.Merge(right);
+  EXPECT_EQ(left.Qty, all.Qty);
+  EXPECT_EQ_EPS(left.Mean, all.Mean, 1e-9);
+  EXPECT_EQ_EPS(left.Var(), all.Var(), 1e-9);
+  EXPECT_EQ(left.Min, all.Min);
+  EXPECT_EQ(left.Max, all.Max);
+}
+
+TEST(TestDistHistogram) {
+  DistHistogram hist(0, 10, 5);
+  hist.Add(-1);
+  hist.Add(0);
+  hist.Add(3.9);
+  hist.Add(9.99);
+  hist.Add(10);
+
+  DistHistogram other(0, 10, 5);
+  other.Add(5);
+  hist.Merge(other);
+  EXPECT_EQ(hist.GetTotalQty(), uint64_t(6));
+
+  stringstream out;
+  hist.Write(out);
+  // The header, the underflow bin, 5 regular bins, and the overflow bin
+  size_t lineQty = 0;
+  string line;
+  while (getline(out, line)) ++lineQty;
+  EXPECT_EQ(lineQty, size_t(8));
+}
+
+TEST(TestReservoirSampler) {
+  const size_t sampleQty = 10;
+  ReservoirSampler sampler(sampleQty, 0);
+  vector<int> sample;
+  for (int i = 0; i < 1000; ++i) {
+    int64_t pos = sampler.Offer();
+    EXPECT_EQ(pos < int64_t(sampleQty), true);
+    if (pos < 0) continue;
+    if (size_t(pos) == sample.size()) sample.push_back(i);
+    else sample[pos] = i;
+  }
+  EXPECT_EQ(sample.size(), sampleQty);
+  EXPECT_EQ(sampler.GetSeenQty(), uint64_t(1000));
+}
+
+TEST(TestSampleRandomPairDistancesDeterministic) {
+  SpaceLp<float>  space(2);
+  ObjectVector    data;
+  CreateRandVectors(space, 500, 4, 0, data);
+
+  // More than one chunk
+  const size_t pairQty = SAMPLE_STAT_CHUNK_QTY + 1000;
+
+  RunningStat stat1, stat4;
+  unique_ptr<DistHistogram> hist1, hist4;
+  SampleRandomPairDistances(space, data, pairQty, 1, 123, stat1, &hist1, 20);
+  SampleRandomPairDistances(space, data, pairQty, 4, 123, stat4, &hist4, 20);
+
+  EXPECT_EQ(stat1.Qty, uint64_t(pairQty));
+  EXPECT_EQ(stat1.Mean, stat4.Mean);
+  EXPECT_EQ(stat1.Var(), stat4.Var());
+  EXPECT_EQ(hist1->GetTotalQty(), uint64_t(pairQty));
+  EXPECT_EQ(hist4->GetTotalQty(), uint64_t(pairQty));
+
+  for (const Object* pObj : data) delete pObj;
+}
+
+TEST(TestComputeExactKNN) {
+  SpaceLp<float>  space(2);
+  ObjectVector    data, queries;
+  CreateRandVectors(space, EXACT_KNN_DATA_BLOCK_QTY + 77, 8, 0, data);
+  CreateRandVectors(space, EXACT_KNN_QUERY_BLOCK_QTY + 3, 8, 1, queries);
+
+  vector<char> exclude(data.size());
+  for (size_t i = 0; i < data.size(); i += 3) exclude[i] = 1;
+
+  const size_t K = 5;
+  vector<vector<pair<float, size_t>>> res;
+  ComputeExactKNN(space, data, queries, K, 4, &exclude, res);
+
+  EXPECT_EQ(res.size(), queries.size());
+  for (size_t q = 0; q < queries.size(); ++q) {
+    vector<pair<float, size_t>> all;
+    for (size_t i = 0; i < data.size(); ++i) {
+      if (!exclude[i]) all.push_back(make_pair(space.IndexTimeDistance(data[i], queries[q]), i));
+    }
+    sort(all.begin(), all.end());
+    EXPECT_EQ(res[q].size(), K);
+    for (size_t i = 0; i < K; ++i) {
+      EXPECT_EQ(res[q][i].second, all[i].second);
+    }
+  }
+
+  for (const Object* pObj : data) delete pObj;
+  for (const Object* pObj : queries) delete pObj;
+}
+
+}  // namespace similarity
@@ -0,0 +1,55 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include "bunit.h"
+#include "search_stat.h"
+
+namespace similarity {
+
+TEST(TestSearchStatAddAndNames) {
+  SearchStat s1, s2;
+
+  EXPECT_EQ(s1.GetNamedValues().empty(), true);
+  EXPECT_EQ(s1.ToString(1) == "N/A", true);
+
+  s1.AddHop(0, 10);
+  s1.AddHop(2);
+  // Hops at very high layers are counted at the last layer
+  s1.AddHop(SEARCH_STAT_MAX_LAYER + 5);
+  s1.VisitedQty_ = 7;
+
+  s2.AddHop(0, 5);
+  s2.LeafQty_   = 3;
+  s2.LeafLimit_ = 4;
+
+  s1.Add(s2);
+
+  EXPECT_EQ(s1.HopQty_[0], uint64_t(15));
+  EXPECT_EQ(s1.HopQty_[2], uint64_t(1));
+  EXPECT_EQ(s1.HopQty_[SEARCH_STAT_MAX_LAYER - 1], uint64_t(1));
+  EXPECT_EQ(s1.GetHopQty(), uint64_t(17));
+
+  auto vals = s1.GetNamedValues();
+  EXPECT_EQ(vals.size(), size_t(6));
+  EXPECT_EQ(vals[0].first == "hops_l0", true);
+  EXPECT_EQ(vals[0].second, uint64_t(15));
+  EXPECT_EQ(vals[3].first == "visited", true);
+  EXPECT_EQ(vals[5].first == "leaf_limit", true);
+
+  s1.Reset();
+  EXPECT_EQ(s1.GetHopQty(), uint64_t(0));
+  EXPECT_EQ(s1.GetNamedValues().empty(), true);
+}
+
+}  // namespace similarity
@@ -0,0 +1,120 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include <cstdio>
+#include <vector>
+
+#include "bunit.h"
+#include "genrand_vect.h"
+#include "rangequery.h"
+#include "method/sharded_index.h"
+#include "method/seqsearch.h"
+#include "method/small_world_rand.h"
+#include "space/space_lp.h"
+
+namespace similarity {
+
+using namespace std;
+
+TEST(TestShardedIndexExact) {
+  SpaceLp<float>  space(2);
+  ObjectVector    data, queries;
+  const unsigned  K = 10;
+  CreateRandVectors(space, 1000, 8, 0, data);
+  CreateRandVectors(space, 20, 8, 1, queries);
+
+  for (string partition : {"random", "cluster"}) {
+    ShardedIndex<float> index(false, SPACE_L2, space, data);
+    index.CreateIndex(AnyParams({"shardQty=4", "methodName=" + string(METH_SEQ_SEARCH), "partition=" + partition}));
+    index.SetQueryTimeParams(AnyParams({"searchThreadQty=4"}));
+    size_t totalQty = 0;
+    for (size_t i = 0; i < index.GetShardQty(); ++i) totalQty += index.GetShardData(i).size();
+    EXPECT_EQ(totalQty, data.size());
+
+    // All shards are searched, so the brute-force search remains exact
+    vector<IdType> foundIds;
+    EXPECT_EQ(ComputeRecall(space, index, data, queries, K, &foundIds), 1.0f);
+    EXPECT_EQ(foundIds.size(), queries.size() * K);
+
+    for (const Object* pQuery : queries) {
+      RangeQuery<float> exactQuery(space, pQuery, 0.5), query(space, pQuery, 0.5);
+      for (const Object* pObj : data) exactQuery.CheckAndAddToResult(pObj);
+      index.Search(&query, -1);
+      EXPECT_EQ(query.ResultSize(), exactQuery.ResultSize());
+    }
+  }
+
+  for (const Object* pObj : data) delete pObj;
+  for (const Object* pObj : queries) delete pObj;
+}
+
+TEST(TestShardedIndexProbeSaveLoad) {
+  SpaceLp<float>  space(2);
+  ObjectVector    data, queries;
+  const unsigned  K = 10;
+  CreateRandVectors(space, 4000, 4, 0, data);
+  CreateRandVectors(space, 50, 4, 1, queries);
+
+  const string location = "tmp_sharded_index.txt";
+  ShardedIndex<float> index(false, SPACE_L2, space, data);
+  index.CreateIndex(AnyParams({"shardQty=8", "methodName=" + string(METH_SMALL_WORLD_RAND),
+                               "partition=cluster", "NN=10", "indexThreadQty=1"}));
+  index.SetQueryTimeParams(AnyParams({"efSearch=50"}));
+  // Each query gets K answers
+  vector<IdType> foundIds;
+  float recall = ComputeRecall(space, index, data, queries, K, &foundIds);
+  EXPECT_EQ(foundIds.size(), queries.size() * K);
+  EXPECT_EQ(recall > 0.9, true);
+
+  // Probing the closest shards only
+  index.SetQueryTimeParams(AnyParams({"efSearch=50", "probeQty=4"}));
+  foundIds.clear();
+  EXPECT_EQ(ComputeRecall(space, index, data, queries, K, &foundIds) > 0.8, true);
+  EXPECT_EQ(foundIds.size(), queries.size() * K);
+
+  // Probing is supported only for clustered shards
+  ShardedIndex<float> randIndex(false, SPACE_L2, space, data);
+  randIndex.CreateIndex(AnyParams({"shardQty=2", "methodName=" + string(METH_SEQ_SEARCH)}));
+  bool thrown = false;
+  try {
+    randIndex.SetQueryTimeParams(AnyParams({"probeQty=1"}));
+  } catch (const exception&) {
+    thrown = true;
+  }
+  EXPECT_EQ(thrown, true);
+
+  index.SetQueryTimeParams(AnyParams({"efSearch=50"}));
+  index.SaveIndex(location);
+  // Objects are found by ids, so the order of data points may change
+  ObjectVector loadData(data.rbegin(), data.rend());
+  ShardedIndex<float> loadedIndex(false, SPACE_L2, space, loadData);
+  loadedIndex.LoadIndex(location);
+  loadedIndex.SetQueryTimeParams(AnyParams({"efSearch=50"}));
+  EXPECT_EQ(loadedIndex.GetShardQty(), index.GetShardQty());
+  foundIds.clear();
+  EXPECT_EQ(ComputeRecall(space, loadedIndex, loadData, queries, K, &foundIds), recall);
+  EXPECT_EQ(foundIds.size(), queries.size() * K);
+
+  // A shard can be loaded on its own
+  SmallWorldRand<float> shard(false, space, loadedIndex.GetShardData(0));
+  shard.LoadIndex(ShardedIndex<float>::GetShardFileName(location, 0));
+
+  remove(location.c_str());
+  for (size_t i = 0; i < index.GetShardQty(); ++i) remove(ShardedIndex<float>::GetShardFileName(location, i).c_str());
+
+  for (const Object* pObj : data) delete pObj;
+  for (const Object* pObj : queries) delete pObj;
+}
+
+}  // namespace similarity
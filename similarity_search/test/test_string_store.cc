@@ -0,0 +1,78 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "bunit.h"
+#include "string_store.h"
+
+namespace similarity {
+
+using namespace std;
+
+TEST(TestStringStore) {
+  vector<string> strs = {"", "1 2 3", "", "label:abc", string("a\0b", 3)};
+  StringStore    store;
+  EXPECT_EQ(store.size(), size_t(0));
+  store.Build(strs.size(), [&](size_t i) { return strs[i]; });
+  EXPECT_EQ(store.size(), strs.size());
+  for (size_t i = 0; i < strs.size(); ++i) {
+    EXPECT_EQ(store.length(i), strs[i].size());
+    EXPECT_EQ(store.str(i) == strs[i], true);
+  }
+
+  const string location = "tmp_string_store.bin";
+  store.SetFingerprint(0x0123456789abcdefULL);
+  store.Save(location);
+  StringStore loaded;
+  loaded.Load(location);
+  EXPECT_EQ(loaded.size(), strs.size());
+  EXPECT_EQ(loaded.GetFingerprint(), uint64_t(0x0123456789abcdefULL));
+  for (size_t i = 0; i < strs.size(); ++i) EXPECT_EQ(loaded.str(i) == strs[i], true);
+
+  // An empty store can be saved and loaded too
+  StringStore empty;
+  empty.Save(location);
+  loaded.Load(location);
+  EXPECT_EQ(loaded.size(), size_t(0));
+  EXPECT_EQ(loaded.GetFingerprint(), uint64_t(0));
+
+  // Truncated files are rejected
+  store.Save(location);
+  string content;
+  {
+    ifstream inp(location, std::ios::binary);
+    content.assign(std::istreambuf_iterator<char>(inp), std::istreambuf_iterator<char>());
+  }
+  {
+    ofstream out(location, std::ios::binary);
+    out.write(content.data(), content.size() - 1);
+  }
+  bool thrown = false;
+  try {
+    loaded.Load(location);
+  } catch (const exception&) {
+    thrown = true;
+  }
+  EXPECT_EQ(thrown, true);
+  // A failed load leaves the store intact
+  EXPECT_EQ(loaded.size(), size_t(0));
+
+  remove(location.c_str());
+}
+
+}  // namespace similarity
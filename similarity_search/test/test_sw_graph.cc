@@ -0,0 +1,399 @@
+/**
+ * Non-metric Space Library
+ *
+ * Main developers: Bilegsaikhan Naidan, Leonid Boytsov, Yury Malkov, Ben Frederickson, David Novak
+ *
+ * For the complete list of contributors and further details see:
+ * https://github.com/searchivarius/NonMetricSpaceLib
+ *
+ * Copyright (c) 2013-2018
+ *
+ * This code is released under the
+ * Apache License Version 2.0 http://www.apache.org/licenses/.
+ *
+ */
+#include <cstdio>
+#include <fstream>
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "bunit.h"
+#include "genrand_vect.h"
+#include "knnquery.h"
+#include "knnqueue.h"
+#include "knn_graph_file.h"
+#include "method/small_world_rand.h"
+#include "space/space_lp.h"
+
+namespace similarity {
+
+using namespace std;
+
+namespace {
+
+// True if the index returned any of the deleted objects
+bool FoundDeleted(const vector<IdType>& foundIds, const set<IdType>& deletedIds) {
+  for (IdType id : foundIds) {
+    if (deletedIds.count(id)) return true;
+  }
+  return false;
+}
+
+}
+
+TEST(TestSWGraphAddDelete) {
+  SpaceLp<float>  space(2);
+  ObjectVector    data, queries;
+  const size_t    dim = 8, qty = 2000;
+  const unsigned  K = 10;
+  CreateRandVectors(space, qty, dim, 0, data);
+  CreateRandVectors(space, 50, dim, 1, queries);
+
+  SmallWorldRand<float> index(false, space, data);
+  index.CreateIndex(AnyParams({"NN=10", "efConstruction=50", "indexThreadQty=4"}));
+  index.SetQueryTimeParams(AnyParams({"efSearch=50"}));
+
+  set<IdType>    deletedIds;
+  vector<IdType> foundIds;
+  EXPECT_EQ(ComputeRecall(space, index, data, queries, K) > 0.9, true);
+
+  // Deleting 2/3 of points triggers the compaction of ids
+  ObjectVector toDelete, liveData;
+  for (size_t i = 0; i < qty; ++i) {
+    if (i % 3 != 0) {
+      toDelete.push_back(data[i]);
+      deletedIds.insert(data[i]->id());
+    } else {
+      liveData.push_back(data[i]);
+    }
+  }
+  index.DeleteBatch(toDelete, SmallWorldRand<float>::kNeighborsOnly, true /* check ids */);
+  EXPECT_EQ(ComputeRecall(space, index, liveData, queries, K, &foundIds) > 0.8, true);
+  EXPECT_EQ(FoundDeleted(foundIds, deletedIds), false);
+
+  // Adding new points after the deletion
+  ObjectVector newData;
+  CreateRandVectors(space, 500, dim, 2, newData, qty);
+  index.AddBatch(newData, false, true /* check ids */);
+  liveData.insert(liveData.end(), newData.begin(), newData.end());
+  foundIds.clear();
+  EXPECT_EQ(ComputeRecall(space, index, liveData, queries, K, &foundIds) > 0.8, true);
+  EXPECT_EQ(FoundDeleted(foundIds, deletedIds), false);
+
+  // Deletion without patching
+  toDelete.clear();
+  for (size_t i = 0; i < newData.size(); i += 2) {
+    toDelete.push_back(newData[i]);
+    deletedIds.insert(newData[i]->id());
+  }
+  index.DeleteBatch(toDelete, SmallWorldRand<float>::kNone, true /* check ids */);
+  foundIds.clear();
+  ComputeRecall(space, index, liveData, queries, K, &foundIds);
+  EXPECT_EQ(FoundDeleted(foundIds, deletedIds), false);
+
+  for (const Object* pObj : data) delete pObj;
+  for (const Object* pObj : newData) delete pObj;
+  for (const Object* pObj : queries) delete pObj;
+}
+
+TEST(TestSWGraphBackgroundRepair) {
+  SpaceLp<float>  space(2);
+  ObjectVector    data, queries;
+  const size_t    dim = 8, qty = 2000;
+  const unsigned  K = 10;
+  CreateRandVectors(space, qty, dim, 0, data);
+  CreateRandVectors(space, 50, dim, 1, queries);
+
+  SmallWorldRand<float> index(false, space, data);
+  index.CreateIndex(AnyParams({"NN=10", "efConstruction=50", "indexThreadQty=4",
+                               "backgroundRepair=1", "repairBudget=100"}));
+  index.SetQueryTimeParams(AnyParams({"efSearch=50"}));
+
+  // Searches run while nodes are deleted and repaired
+  atomic<bool> stop(false);
+  thread searcher([&]() {
+    while (!stop) {
+      for (const Object* pQuery : queries) {
+        KNNQuery<float> query(space, pQuery, K);
+        index.Search(&query, -1);
+      }
+    }
+  });
+
+  set<IdType>  deletedIds;
+  ObjectVector liveData;
+  for (size_t start = 0; start < qty; start += 500) {
+    ObjectVector toDelete;
+    for (size_t i = start; i < start + 500; ++i) {
+      if (i % 3 != 0) {
+        toDelete.push_back(data[i]);
+        deletedIds.insert(data[i]->id());
+      } else {
+        liveData.push_back(data[i]);
+      }
+    }
+    index.DeleteBatch(toDelete, SmallWorldRand<float>::kNeighborsOnly);
+    // Deleted points are never returned, even before their links are repaired
+    vector<IdType> foundIds;
+    ComputeRecall(space, index, liveData, queries, K, &foundIds);
+    EXPECT_EQ(FoundDeleted(foundIds, deletedIds), false);
+  }
+  stop = true;
+  searcher.join();
+
+  index.WaitForRepair();
+  vector<IdType> foundIds;
+  EXPECT_EQ(ComputeRecall(space, index, liveData, queries, K, &foundIds) > 0.8, true);
+  EXPECT_EQ(FoundDeleted(foundIds, deletedIds), false);
+
+  // After the repair, live nodes aren't linked to deleted ones (checked by AddBatch)
+  ObjectVector newData;
+  CreateRandVectors(space, 100, dim, 2, newData, qty);
+  index.AddBatch(newData, false, true /* check ids */);
+
+  for (const Object* pObj : data) delete pObj;
+  for (const Object* pObj : newData) delete pObj;
+  for (const Object* pObj : queries) delete pObj;
+}
+
+TEST(TestSWGraphConcurrentAdd) {
+  SpaceLp<float>  space(2);
+  ObjectVector    data, newData, queries;
+  const size_t    dim = 8, qty = 1000, batchQty = 20, batchSize = 100;
+  const unsigned  K = 10;
+  CreateRandVectors(space, qty, dim, 0, data);
+  CreateRandVectors(space, batchQty * batchSize, dim, 1, newData, qty);
+  CreateRandVectors(space, 50, dim, 2, queries);
+
+  SmallWorldRand<float> index(false, space, data);
+  index.CreateIndex(AnyParams({"NN=10", "efConstruction=50", "indexThreadQty=2"}));
+  index.SetQueryTimeParams(AnyParams({"efSearch=50"}));
+
+  // Searches run while small batches are added
+  atomic<bool>   stop(false);
+  atomic<size_t> searchQty(0);
+  vector<thread> searchers;
+  for (unsigned i = 0; i < 2; ++i) {
+    searchers.emplace_back([&]() {
+      while (!stop) {
+        for (const Object* pQuery : queries) {
+          KNNQuery<float> query(space, pQuery, K);
+          index.Search(&query, -1);
+          if (query.ResultSize() != K) stop = true;
+          ++searchQty;
+        }
+      }
+    });
+  }
+  for (size_t i = 0; i < batchQty; ++i) {
+    index.AddBatch(ObjectVector(newData.begin() + i * batchSize, newData.begin() + (i + 1) * batchSize), false,
+                   i + 1 == batchQty /* check ids */);
+  }
+  // Each search must have returned K results
+  EXPECT_EQ(stop.load(), false);
+  stop = true;
+  for (thread& t : searchers) t.join();
+  EXPECT_EQ(searchQty > 0, true);
+
+  ObjectVector liveData(data);
+  liveData.insert(liveData.end(), newData.begin(), newData.end());
+  EXPECT_EQ(ComputeRecall(space, index, liveData, queries, K) > 0.9, true);
+
+  for (const Object* pObj : data) delete pObj;
+  for (const Object* pObj : newData) delete pObj;
+  for (const Object* pObj : queries) delete pObj;
+}
+
+void ExpectSameResults(const Space<float>& space, const Index<float>& index1, const Index<float>& index2,
+                       const ObjectVector& queries, unsigned K) {
+  for (const Object* pQuery : queries) {
+    KNNQuery<float> query1(space, pQuery, K), query2(space, pQuery, K);
+    index1.Search(&query1, -1);
+    index2.Search(&query2, -1);
+    unique_ptr<KNNQueue<float>> res1(query1.Result()->Clone()), res2(query2.Result()->Clone());
+    EXPECT_EQ(res1->Size(), res2->Size());
+    while (!res1->Empty() && !res2->Empty()) {
+      EXPECT_EQ(res1->Pop()->id(), res2->Pop()->id());
+    }
+  }
+}
+
+TEST(TestSWGraphFromKNNGraph) {
+  SpaceLp<float>  space(2);
+  ObjectVector    data, newData, queries;
+  const size_t    dim = 8, qty = 2000, NN = 20;
+  const unsigned  K = 10;
+  CreateRandVectors(space, qty, dim, 0, data);
+  CreateRandVectors(space, 200, dim, 1, newData, qty);
+  CreateRandVectors(space, 50, dim, 2, queries);
+
+  // The exact k-NN graph is saved in the same format as the NN-descent graph.
+  // Object ids are equal to indices of data points.
+  const string location = "tmp_sw_graph_knn.bin";
+  WriteKNNGraph(location, data, NN, [&](size_t i, KNNGraphEntry* entries) {
+    KNNQuery<float> query(space, data[i], NN + 1);
+    for (const Object* pObj : data) query.CheckAndAddToResult(pObj);
+    unique_ptr<KNNQueue<float>> res(query.Result()->Clone());
+    size_t j = NN;
+    while (!res->Empty()) {
+      float dist = res->TopDistance();
+      IdType id = res->Pop()->id();
+      if (id != data[i]->id() && j > 0) entries[--j] = KNNGraphEntry{id, dist};
+    }
+  });
+
+  SmallWorldRand<float> index(false, space, data);
+  index.CreateIndex(AnyParams({"NN=10", "indexThreadQty=4", "knnGraphFile=" + location}));
+  index.SetQueryTimeParams(AnyParams({"efSearch=50"}));
+
+  EXPECT_EQ(ComputeRecall(space, index, data, queries, K) > 0.9, true);
+
+  // The converted graph can be updated
+  index.AddBatch(newData, false, true /* check ids */);
+  ObjectVector liveData(data.begin(), data.end());
+  liveData.insert(liveData.end(), newData.begin(), newData.end());
+  EXPECT_EQ(ComputeRecall(space, index, liveData, queries, K) > 0.9, true);
+
+  // The graph must have all the data points
+  ObjectVector partialData(data.begin() + 1, data.end());
+  SmallWorldRand<float> badIndex(false, space, partialData);
+  bool thrown = false;
+  try {
+    badIndex.CreateIndex(AnyParams({"NN=10", "knnGraphFile=" + location}));
+  } catch (const exception&) {
+    thrown = true;
+  }
+  EXPECT_EQ(thrown, true);
+  remove(location.c_str());
+
+  for (const Object* pObj : data) delete pObj;
+  for (const Object* pObj : newData) delete pObj;
+  for (const Object* pObj : queries) delete pObj;
+}
+
+TEST(TestSWGraphSaveLoad) {
+  SpaceLp<float>  space(2);
+  ObjectVector    data, newData, queries;
+  const size_t    dim = 8, qty = 1000;
+  const unsigned  K = 10;
+  CreateRandVectors(space, qty, dim, 0, data);
+  CreateRandVectors(space, 300, dim, 1, newData, qty);
+  CreateRandVectors(space, 20, dim, 2, queries);
+
+  const string location = "tmp_sw_graph_index.bin";
+  SmallWorldRand<float> index(false, space, data);
+  index.CreateIndex(AnyParams({"NN=10", "indexThreadQty=2"}));
+  index.SetQueryTimeParams(AnyParams({"efSearch=10"}));
+
+  // The index is saved after updates
+  index.AddBatch(newData, false);
+  ObjectVector toDelete, liveData;
+  for (size_t i = 0; i < qty; ++i) {
+    if (i % 2) toDelete.push_back(data[i]);
+    else liveData.push_back(data[i]);
+  }
+  index.DeleteBatch(toDelete, SmallWorldRand<float>::kNeighborsOnly);
+  liveData.insert(liveData.end(), newData.begin(), newData.end());
+  index.SaveIndex(location);
+
+  // Objects are found by ids, so the order of data points may change
+  ObjectVector loadData(liveData.rbegin(), liveData.rend());
+  SmallWorldRand<float> loadedIndex(false, space, loadData);
+  loadedIndex.LoadIndex(location);
+  loadedIndex.SetQueryTimeParams(AnyParams({"efSearch=10"}));
+
+  // The search is deterministic, so the loaded index must return the same results
+  ExpectSameResults(space, index, loadedIndex, queries, K);
+
+  // The data set of the original index lacks added points: the load fails, but the current graph is kept
+  bool thrown = false;
+  try {
+    index.LoadIndex(location);
+  } catch (const exception&) {
+    thrown = true;
+  }
+  EXPECT_EQ(thrown, true);
+  ExpectSameResults(space, index, loadedIndex, queries, K);
+
+  // The loaded index can be updated
+  loadedIndex.DeleteBatch(ObjectVector(liveData.begin(), liveData.begin() + 10), SmallWorldRand<float>::kNeighborsOnly, true);
+
+  // An object missing from the data set is detected
+  ObjectVector partialData(liveData.begin() + 1, liveData.end());
+  SmallWorldRand<float> badIndex(false, space, partialData);
+  thrown = false;
+  try {
+    badIndex.LoadIndex(location);
+  } catch (const exception&) {
+    thrown = true;
+  }
+  EXPECT_EQ(thrown, true);
+  remove(location.c_str());
+
+  for (const Object* pObj : data) delete pObj;
+  for (const Object* pObj : newData) delete pObj;
+  for (const Object* pObj : queries) delete pObj;
+}
+
+TEST(TestSWGraphLoadText) {
+  SpaceLp<float>  space(2);
+  ObjectVector    data;
+  CreateRandVectors(space, 3, 2, 0, data);
+
+  // The text format used by previous versions
+  const string location = "tmp_sw_graph_index.txt";
+  {
+    ofstream out(location);
+    out << METHOD_DESC << ":" << METH_SMALL_WORLD_RAND << endl
+        << "NN:1" << endl
+        << "0:0: 1 2" << endl
+        << "1:1: 0" << endl
+        << "2:2: 0" << endl
+        << endl
+        << LINE_QTY << ":7" << endl;
+  }
+  SmallWorldRand<float> index(false, space, data);
+  index.LoadIndex(location);
+  index.SetQueryTimeParams(AnyParams({"efSearch=3"}));
+  remove(location.c_str());
+
+  // All points are reachable
+  KNNQuery<float> query(space, data[2], 3);
+  index.Search(&query, -1);
+  EXPECT_EQ(query.ResultSize(), 3u);
+
+  for (const Object* pObj : data) delete pObj;
+}
+
+TEST(TestSWGraphBlockGrowth) {
+  SpaceLp<float>  space(2);
+  ObjectVector    data, queries;
+  const size_t    dim = 8, qty = 2000;
+  const unsigned  K = 10;
+  CreateRandVectors(space, qty, dim, 0, data);
+  CreateRandVectors(space, 50, dim, 1, queries);
+
+  /*
+   * With one thread, the insertion is deterministic. Because links are never dropped,
+   * the graph doesn't depend on the initial size of neighbor lists.
+   */
+  SmallWorldRand<float> index(false, space, data), smallBlockIndex(false, space, data);
+  index.CreateIndex(AnyParams({"NN=10", "indexThreadQty=1"}));
+  smallBlockIndex.CreateIndex(AnyParams({"NN=10", "maxNN=10", "indexThreadQty=1"}));
+  index.SetQueryTimeParams(AnyParams({"efSearch=50"}));
+  smallBlockIndex.SetQueryTimeParams(AnyParams({"efSearch=50"}));
+  ExpectSameResults(space, index, smallBlockIndex, queries, K);
+
+  // Indexing threads are stopped and restarted when the blocks grow
+  SmallWorldRand<float> parallelIndex(false, space, data);
+  parallelIndex.CreateIndex(AnyParams({"NN=10", "maxNN=10", "indexThreadQty=4"}));
+  parallelIndex.SetQueryTimeParams(AnyParams({"efSearch=50"}));
+  EXPECT_EQ(ComputeRecall(space, parallelIndex, data, queries, K) > 0.9, true);
+
+  for (const Object* pObj : data) delete pObj;
+  for (const Object* pObj : queries) delete pObj;
+}
+
+}  // namespace similarity
@@ -43,4 +43,44 @@ TEST(TestParallelForException) {
   }
   EXPECT_EQ(has_thrown, true);
 }
+
+TEST(TestThreadPool) {
+  ThreadPool pool(3);
+  EXPECT_EQ(pool.GetWorkerQty(), size_t(3));
+  // Concurrent calls share the workers
+  std::vector<std::thread> callers;
+  std::vector<std::vector<double>> squares(4, std::vector<double>(1000));
+  for (size_t k = 0; k < squares.size(); ++k) {
+    callers.emplace_back([&, k]() {
+      for (int rep = 0; rep < 50; ++rep) {
+        pool.ParallelFor(0, squares[k].size(), [&](size_t id) {
+          squares[k][id] = id * id + rep;
+        });
+      }
+    });
+  }
+  for (auto& thread : callers) thread.join();
+  for (size_t k = 0; k < squares.size(); ++k) {
+    for (size_t i = 0; i < squares[k].size(); ++i) {
+      EXPECT_EQ(squares[k][i], static_cast<double>(i * i + 49));
+    }
+  }
+
+  bool has_thrown = false;
+  try {
+    pool.ParallelFor(0, 100, [&](size_t id) {
+      if (id == 50) throw std::invalid_argument("not gonna do it");
+    });
+  } catch (const std::invalid_argument&) {
+    has_thrown = true;
+  }
+  EXPECT_EQ(has_thrown, true);
+
+  // Without workers, everything runs in the calling thread
+  ThreadPool emptyPool(0);
+  std::thread::id callerId = std::this_thread::get_id();
+  bool sameThread = true;
+  emptyPool.ParallelFor(0, 10, [&](size_t) { sameThread = sameThread && std::this_thread::get_id() == callerId; });
+  EXPECT_EQ(sameThread, true);
+}
 }  // namespace similarity